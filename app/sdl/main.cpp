@@ -11,6 +11,7 @@
 
 #include <mirinae/engine.hpp>
 #include <mirinae/lightweight/include_spdlog.hpp>
+#include <mirinae/lightweight/mapped_file.hpp>
 #include <mirinae/vulkan/base/platform_func.hpp>
 #include <sung/basic/os_detect.hpp>
 
@@ -211,6 +212,12 @@ namespace {
             cinfo.filesys_->add_subsys(
                 dal::create_filesubsys_std("", asset_path.parent_path() / "res")
             );
+            cinfo.file_mapper_ = std::make_shared<mirinae::FileMapper>();
+            cinfo.file_mapper_->add_root(":asset", asset_path);
+            cinfo.file_mapper_->add_root("", ::get_documents_path("Mirinapp"));
+            cinfo.file_mapper_->add_root("", asset_path.parent_path() / "res");
+            cinfo.cache_dir_ = ::get_documents_path("Mirinapp") / "cache";
+            cinfo.log_path_ = ::get_documents_path("Mirinapp") / "log.txt";
             window_.fill_vulkan_extensions(cinfo.instance_extensions_);
             window_.get_win_fbuf_size(cinfo.init_width_, cinfo.init_height_);
             cinfo.osio_ = &window_;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <filesystem>
 #include <functional>
 #include <memory>
 #include <string>
@@ -12,11 +13,18 @@
 
 namespace mirinae {
 
+    class FileMapper;
     class VulkanPlatformFunctions;
 
 
     struct EngineCreateInfo {
         std::shared_ptr<dal::Filesystem> filesys_;
+        // Lets large assets be mapped instead of read, optional
+        std::shared_ptr<FileMapper> file_mapper_;
+        // Writable directory for data derived from assets, optional
+        std::filesystem::path cache_dir_;
+        // Log lines are written to this file in the background, optional
+        std::filesystem::path log_path_;
         std::vector<std::string> instance_extensions_;
         IOsIoFunctions* osio_ = nullptr;
         VulkanPlatformFunctions* vulkan_os_ = nullptr;
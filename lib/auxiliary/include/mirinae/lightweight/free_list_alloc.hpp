@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <set>
+#include <utility>
+
+
+namespace mirinae {
+
+    // Hands out ranges of a fixed size space in any order. Picks the
+    // smallest free range that fits, and merges freed ranges with their
+    // free neighbours so the space does not fragment over time.
+    class FreeListAllocator {
+
+    public:
+        explicit FreeListAllocator(size_t capacity);
+
+        // Offset of the range, or null if no free range is large enough
+        std::optional<size_t> alloc(size_t size);
+
+        // `offset` and `size` must be exactly what an `alloc()` call got
+        void free(size_t offset, size_t size);
+
+        size_t capacity() const { return capacity_; }
+        size_t used() const { return used_; }
+        size_t largest_free() const;
+
+    private:
+        void insert_free(size_t offset, size_t size);
+        void erase_free(size_t offset, size_t size);
+
+        // Offset -> size
+        std::map<size_t, size_t> by_offset_;
+        // (size, offset)
+        std::set<std::pair<size_t, size_t>> by_size_;
+        const size_t capacity_;
+        size_t used_ = 0;
+    };
+
+}  // namespace mirinae
@@ -7,10 +7,12 @@
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
 #include <spdlog/spdlog.h>
 
+// Shutting down drains the async logger before aborting
 #define MIRINAE_ABORT(...)                         \
     do {                                           \
         const auto msg = fmt::format(__VA_ARGS__); \
         SPDLOG_CRITICAL("{}", msg);                \
+        spdlog::shutdown();                        \
         std::abort();                              \
     } while (0)
 
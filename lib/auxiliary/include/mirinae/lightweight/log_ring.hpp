@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+
+namespace mirinae {
+
+    struct LogRecord {
+        constexpr static size_t MAX_TEXT = 240;
+
+        std::string_view text() const { return { text_.data(), size_ }; }
+
+        // Position in the ring's history, increasing by one per record
+        uint64_t seq_ = 0;
+        uint16_t size_ = 0;
+        uint8_t level_ = 0;
+        std::array<char, MAX_TEXT> text_;
+    };
+
+
+    // Fixed capacity log buffer which many threads can write to at once.
+    // Writers never block nor allocate. Once full, the oldest records are
+    // overwritten.
+    class LogRing {
+
+    public:
+        // `capacity` is rounded up to a power of two
+        explicit LogRing(size_t capacity);
+        ~LogRing();
+
+        // Thread safe. Text longer than `LogRecord::MAX_TEXT` is truncated.
+        // Records are dropped only if a writer gets a full lap behind.
+        void push(uint8_t level, std::string_view text);
+
+        // Appends records from sequence number `from` onward that are still
+        // in the ring to `out`, oldest first. Returns the sequence number to
+        // pass next time. Thread safe.
+        uint64_t snapshot(uint64_t from, std::vector<LogRecord>& out) const;
+
+        size_t capacity() const;
+        uint64_t dropped() const;
+
+        // Appends new records to `path` from a background thread until
+        // stopped or destructed
+        void start_file_flush(const std::filesystem::path& path);
+        void stop_file_flush();
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> pimpl_;
+    };
+
+    LogRing& log_ring();
+
+}  // namespace mirinae
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <dal/filesys/filesys.hpp>
+
+
+namespace mirinae {
+
+    // Read only view of a whole file mapped into memory
+    class MappedFile {
+
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& rhs) noexcept;
+        MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+        // Empty files fail to map
+        bool open(const std::filesystem::path& path);
+        void close();
+
+        const uint8_t* data() const { return data_; }
+        size_t size() const { return size_; }
+        bool is_open() const { return nullptr != data_; }
+
+    private:
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+
+    // Resolves `dal::Filesystem` paths to files on the local disk so that
+    // they can be mapped instead of read. Roots should mirror the std
+    // subsystems added to the `dal::Filesystem`, in the same order.
+    class FileMapper {
+
+    public:
+        // Paths starting with `prefix` + "/" are looked up under `dir`. An
+        // empty prefix matches any path not starting with ':'.
+        void add_root(
+            const std::string& prefix, const std::filesystem::path& dir
+        );
+
+        // False if no root has the file or it cannot be mapped
+        bool map(const dal::path& path, MappedFile& out) const;
+
+    private:
+        struct Root {
+            std::string prefix_;
+            std::filesystem::path dir_;
+        };
+
+        std::vector<Root> roots_;
+    };
+
+
+    // Contents of a file, mapped in place if possible and read into memory
+    // otherwise. Data stays valid until this is destroyed or loaded again.
+    class FileData {
+
+    public:
+        // `mapper` may be null
+        bool load(
+            const dal::path& path,
+            dal::Filesystem& filesys,
+            const FileMapper* mapper
+        );
+        void clear();
+
+        const uint8_t* data() const;
+        size_t size() const;
+        bool empty() const { return 0 == this->size(); }
+        bool is_mapped() const { return mapped_.is_open(); }
+
+    private:
+        MappedFile mapped_;
+        std::vector<std::byte> buffer_;
+    };
+
+}  // namespace mirinae
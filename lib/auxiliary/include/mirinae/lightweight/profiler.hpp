@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+#define MIRINAE_PROF_CONCAT_IMPL(a, b) a##b
+#define MIRINAE_PROF_CONCAT(a, b) MIRINAE_PROF_CONCAT_IMPL(a, b)
+
+// Times the enclosing scope. `name` must outlive the profiler, which string
+// literals do.
+#define MIRINAE_PROF_ZONE(name) \
+    ::mirinae::ProfZone MIRINAE_PROF_CONCAT(prof_zone_, __LINE__)(name)
+
+
+namespace mirinae {
+
+    using prof_clock_t = std::chrono::steady_clock;
+
+
+    struct ProfZoneStats {
+        std::string name_;
+        // Per frame, over the rolling window
+        double avg_ms_ = 0;
+        double max_ms_ = 0;
+        double avg_calls_ = 0;
+    };
+
+
+    // Events are written to per thread ring buffers without locking and
+    // collected by the main thread once per frame.
+    class Profiler {
+
+    public:
+        Profiler();
+        ~Profiler();
+
+        // Thread safe. An empty `track` puts the event on the calling
+        // thread's track. Use named tracks for spans that overlap each
+        // other on one thread. Both strings must outlive the profiler, so
+        // pass names built at runtime through `intern()`.
+        void record(
+            std::string_view name,
+            prof_clock_t::time_point begin,
+            prof_clock_t::time_point end,
+            std::string_view track = {}
+        );
+
+        // Thread safe. Returns a copy of `name` that lives as long as the
+        // profiler. Call it once when the name is made, not per event.
+        std::string_view intern(std::string_view name);
+
+        bool enabled() const;
+        void set_enabled(bool enabled);
+
+        // Functions below must be called from the main thread
+
+        void new_frame();
+
+        // Writes the next `frames` frames to a Chrome trace JSON file, which
+        // can be opened in chrome://tracing or Perfetto
+        void capture(size_t frames, const std::filesystem::path& path);
+        bool is_capturing() const;
+
+        std::vector<ProfZoneStats> stats() const;
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> pimpl_;
+    };
+
+    Profiler& profiler();
+
+
+    class ProfZone {
+
+    public:
+        explicit ProfZone(std::string_view name);
+        ~ProfZone();
+
+        ProfZone(const ProfZone&) = delete;
+        ProfZone& operator=(const ProfZone&) = delete;
+
+    private:
+        std::string_view name_;
+        prof_clock_t::time_point begin_;
+        bool active_;
+    };
+
+}  // namespace mirinae
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+
+namespace mirinae {
+
+    // Hands out contiguous ranges of a circular buffer and frees them in the
+    // order they were allocated. Positions only ever grow, so whoever owns
+    // a group of ranges remembers `head()` after allocating them and passes
+    // it to `release()` once the consumer is done with them.
+    class RingAllocator {
+
+    public:
+        // Alignments passed to `alloc()` must divide `capacity`
+        explicit RingAllocator(size_t capacity);
+
+        // Offset of the range in the buffer, or null if it does not fit
+        // until older ranges are released. A range never wraps around.
+        std::optional<size_t> alloc(size_t size, size_t alignment);
+
+        // Frees every range allocated before `head()` returned `pos`
+        void release(uint64_t pos);
+
+        uint64_t head() const { return head_; }
+        size_t capacity() const { return capacity_; }
+        size_t used() const { return static_cast<size_t>(head_ - tail_); }
+
+    private:
+        const size_t capacity_;
+        uint64_t head_ = 0;
+        uint64_t tail_ = 0;
+    };
+
+}  // namespace mirinae
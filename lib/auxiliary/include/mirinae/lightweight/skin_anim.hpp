@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <variant>
 
@@ -19,6 +20,93 @@ namespace mirinae {
     );
 
 
+    // Keyframes of a single property, times and values stored separately
+    template <typename T>
+    struct AnimChannel {
+        // `cursor` is a hint from the previous sample and gets updated
+        T sample(float tick, uint32_t& cursor, const T& fallback) const;
+
+        // Returns interpolation factor between `from` and `to` key indices
+        float locate(
+            float tick, uint32_t& cursor, size_t& from, size_t& to
+        ) const;
+
+        bool empty() const { return times_.empty(); }
+
+        std::vector<float> times_;
+        std::vector<T> values_;
+    };
+
+
+    struct AnimJointTrack {
+        bool empty() const {
+            return translations_.empty() && rotations_.empty() &&
+                   scales_.empty();
+        }
+
+        AnimChannel<glm::vec3> translations_;
+        AnimChannel<glm::quat> rotations_;
+        AnimChannel<float> scales_;
+    };
+
+
+    // Local joint transforms in SoA layout for batch processing
+    class AnimPose {
+
+    public:
+        // Capacity is rounded up to the SIMD width, padding is identity
+        void resize(size_t joint_count);
+        void set_identity();
+
+        size_t joint_count() const { return joint_count_; }
+        size_t padded_count() const { return s_.size(); }
+
+        glm::vec3 translation(size_t i) const;
+        glm::quat rotation(size_t i) const;
+
+    public:
+        std::vector<float> tx_, ty_, tz_;
+        std::vector<float> rx_, ry_, rz_, rw_;
+        std::vector<float> s_;
+
+    private:
+        size_t joint_count_ = 0;
+    };
+
+
+    // Per-actor sampling state, reused every frame to avoid allocations
+    class AnimCursor {
+
+    public:
+        // Keyframe positions of the last sample, 3 channels per joint
+        uint32_t* get(size_t anim_idx, size_t joint_count);
+
+        AnimPose pose_;
+        AnimPose next_pose_;
+        std::vector<float> t_factors_, r_factors_, s_factors_;
+
+    private:
+        std::vector<uint32_t> keys_;
+        size_t anim_idx_ = SIZE_MAX;
+    };
+
+
+    // Per-joint blend weights in [0, 1], padded like AnimPose
+    class AnimJointMask {
+
+    public:
+        void resize(size_t joint_count, float weight);
+        void set(size_t joint_index, float weight);
+
+        size_t joint_count() const { return joint_count_; }
+        const float* data() const { return weights_.data(); }
+
+    private:
+        std::vector<float> weights_;
+        size_t joint_count_ = 0;
+    };
+
+
     class SkelAnimPair {
 
     public:
@@ -26,16 +114,113 @@ namespace mirinae {
 
         size_t joint_count() const { return skel_.joints_.size(); }
 
+        // Must be called after modifying `skel_` or `anims_`
+        void compile();
+        bool is_compiled() const;
+
+        // Interpolates all joints of an animation into `out`. Joints without
+        // children keep their bind pose if `skip_leaves` is set.
+        bool sample_pose(
+            double tick_point,
+            size_t anim_idx,
+            AnimCursor& cursor,
+            AnimPose& out,
+            bool skip_leaves = false
+        ) const;
+
+        // Writes `joint_count()` matrices to `out_buf`
+        bool make_skinning_matrix(
+            const AnimPose& pose,
+            glm::mat4* const out_buf,
+            const size_t buf_size
+        ) const;
+
+        bool make_skinning_matrix(
+            double tick_point,
+            size_t anim_idx,
+            AnimCursor& cursor,
+            glm::mat4* const out_buf,
+            const size_t buf_size
+        ) const;
+
+        // Weight 1 for `root_joint` and its descendants, 0 for the others
+        bool make_joint_mask(
+            const std::string& root_joint, AnimJointMask& out
+        ) const;
+
     public:
         dal::Skeleton skel_;
         std::vector<dal::Animation> anims_;
+
+    private:
+        // Parents always come before their children
+        std::vector<dal::jointID_t> joint_order_;
+        std::vector<glm::mat4> inv_offset_mats_;
+        std::vector<glm::mat4> to_parent_mats_;
+        std::vector<uint8_t> is_leaf_;
+        // [anim index][skeleton joint index]
+        std::vector<std::vector<AnimJointTrack>> anim_tracks_;
     };
 
     using HSkelAnim = std::shared_ptr<SkelAnimPair>;
 
 
+    struct AnimBlendInput {
+        size_t anim_idx_ = 0;
+        double tick_ = 0;
+        float weight_ = 1;
+        // Optional, restricts this input to a subset of joints
+        const AnimJointMask* mask_ = nullptr;
+        // Optional, a pose sampled beforehand instead of `anim_idx_` at
+        // `tick_`
+        const AnimPose* pose_ = nullptr;
+    };
+
+
+    // Per-actor buffers for blending several animations into a single pose.
+    // Nothing is allocated once the buffers have grown to fit the skeleton.
+    class AnimBlender {
+
+    public:
+        // Weighted average of all inputs, valid until the next call
+        const AnimPose* blend(
+            const SkelAnimPair& skel_anim,
+            const AnimBlendInput* inputs,
+            size_t input_count,
+            bool skip_leaves = false
+        );
+
+    private:
+        std::vector<AnimCursor> cursors_;
+        AnimPose result_;
+        std::vector<float> weight_sums_;
+        std::vector<float> factors_;
+    };
+
+
+    // Lowers the sampling rate of actors that look small on screen. Screen
+    // ratio is the projected bounding sphere diameter over viewport height.
+    struct AnimLodConfig {
+        float full_rate_above_ = 0.2f;
+        float half_rate_above_ = 0.05f;  // Quarter rate below this
+        float skip_leaves_below_ = 0.03f;
+        float bounding_radius_ = 1;  // Model space
+        // Linearly extrapolate palettes between samples instead of reusing
+        bool extrapolate_ = false;
+        bool enabled_ = true;
+    };
+
+
     class SkinAnimState {
 
+    public:
+        struct LodPalette {
+            const glm::mat4* data_ = nullptr;
+            size_t size_ = 0;
+            // Changes only when the contents of `data_` change
+            uint64_t revision_ = 0;
+        };
+
     public:
         auto& skel() const { return this->skel_anim_->skel_; }
         auto& anims() const { return this->skel_anim_->anims_; }
@@ -43,11 +228,21 @@ namespace mirinae {
         std::optional<size_t> get_cur_anim_idx() const;
         std::optional<std::string> get_cur_anim_name() const;
 
+        // Reuses buffers of this state, so call from one thread at a time
         void sample_anim(
             glm::mat4* const out_buf,
             const size_t buf_size,
             const clock_t& clock
-        ) const;
+        );
+
+        // Samples at a rate chosen by `lod_` and returns a cached palette on
+        // the other frames. `stagger` spreads updates of different actors
+        // across frames.
+        LodPalette sample_anim_lod(
+            const float screen_ratio,
+            const uint32_t stagger,
+            const clock_t& clock
+        );
 
         void update_tick(const clock_t& clock);
         void set_skel_anim(const HSkelAnim& skel_anim);
@@ -56,11 +251,21 @@ namespace mirinae {
         void select_anim_name(const std::string& name, const clock_t& clock);
         void deselect_anim(const clock_t& clock);
 
+        // Blends from the current animation over `duration` seconds
+        void crossfade_anim_index(
+            const size_t index, const double duration, const clock_t& clock
+        );
+        void crossfade_anim_name(
+            const std::string& name, const double duration, const clock_t& clock
+        );
+
         double play_speed() const { return this->selection_.play_speed(); }
         void set_play_speed(const double speed) {
             selection_.set_play_speed(speed);
         }
 
+        AnimLodConfig lod_;
+
     private:
         class AnimSelection {
 
@@ -110,9 +315,52 @@ namespace mirinae {
             const DeferredData& deferred
         );
 
+        class LodCache {
+
+        public:
+            std::vector<glm::mat4> prev_;
+            std::vector<glm::mat4> last_;
+            std::vector<glm::mat4> extrapolated_;
+            double prev_time_ = 0;
+            double last_time_ = 0;
+            uint64_t revision_ = 0;
+            uint32_t frame_ = 0;
+        };
+
+        bool sample_palette(
+            glm::mat4* const out_buf,
+            const size_t buf_size,
+            const clock_t& clock,
+            const bool skip_leaves
+        );
+        void begin_fade(const double duration, const clock_t& clock);
+        const AnimPose* blend_fade(
+            const AnimBlendInput& cur,
+            const clock_t& clock,
+            const bool skip_leaves
+        );
+        std::optional<AnimBlendInput> make_blend_input(
+            const clock_t& clock,
+            const AnimSelection& selection,
+            const DeferredData& deferred
+        ) const;
+
         HSkelAnim skel_anim_;
         AnimSelection selection_;
         DeferredData deferred_data_;
+
+        // Animation being faded out
+        AnimSelection prev_selection_;
+        DeferredData prev_deferred_data_;
+        double fade_duration_ = 0;
+        double fade_elapsed_ = 0;
+        // Pose at the moment a fade was interrupted, faded out instead of
+        // `prev_selection_` so the half blended pose does not pop
+        AnimPose frozen_pose_;
+        bool use_frozen_pose_ = false;
+
+        AnimBlender blender_;
+        LodCache lod_cache_;
     };
 
 }  // namespace mirinae
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -22,6 +24,8 @@ namespace mirinae {
             (deps_[i++].SetDependency(prev, this), ...);
         }
 
+        void succeed_all(const std::vector<const enki::ICompletable*>& prev);
+
         void set_size(uint32_t size);
         void set_size(uint64_t size);
 
@@ -44,6 +48,47 @@ namespace mirinae {
     };
 
 
+    // Records when it runs, i.e. when all its dependencies have finished
+    struct StampTask : public DependingTask {
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override;
+
+        std::chrono::steady_clock::time_point time_;
+    };
+
+
+    // Named shared state a task touches. Within a frame, every task writing
+    // a resource runs before the tasks that only read it, and writers of the
+    // same resource keep their registration order. Tasks declaring nothing
+    // conflict with everything.
+    class AccessSet {
+
+    public:
+        void add_read(std::string_view resource);
+        // Implies reading it as well
+        void add_write(std::string_view resource);
+        // Reads what the writers left in the previous frame, so runs before
+        // them instead of after
+        void add_read_last_frame(std::string_view resource);
+        // Reads the copy of a double-buffered resource written before the
+        // sync point, so it never conflicts with the writers of the next copy
+        void add_read_buffered(std::string_view resource);
+
+        bool empty() const;
+        bool conflicts_with(const AccessSet& other) const;
+        // True if this must run before `other` regardless of registration
+        bool must_precede(const AccessSet& other) const;
+
+    private:
+        std::vector<std::string> reads_;
+        std::vector<std::string> writes_;
+        std::vector<std::string> last_frame_reads_;
+        std::vector<std::string> buffered_reads_;
+    };
+
+
+    class TaskLinker;
+
+
     struct StageTask : public enki::ITaskSet {
 
     public:
@@ -52,20 +97,106 @@ namespace mirinae {
         virtual enki::ITaskSet* get_fence() = 0;
 
         const std::string& name() const { return name_; }
+        const AccessSet& access() const { return access_; }
+        // Set if the stage's tasks are linked with `TaskLinker::link(*this)`
+        const TaskLinker* linker() const { return linker_; }
+
+        // Shared state this stage touches, used to order the stages and to
+        // decide which ones may run concurrently
+        StageTask& reads(std::string_view resource);
+        StageTask& writes(std::string_view resource);
+        StageTask& reads_last_frame(std::string_view resource);
+        StageTask& reads_buffered(std::string_view resource);
+
+        // Starts at `TaskGraph::start_after_sync()` instead, and may still
+        // run while the next frame's stages do. Any stage before the sync
+        // point that conflicts with it makes the next frame wait for it.
+        StageTask& after_sync();
+        bool is_after_sync() const { return after_sync_; }
 
     private:
+        friend class TaskLinker;
+
         std::string name_;
+        AccessSet access_;
+        const TaskLinker* linker_ = nullptr;
+        bool after_sync_ = false;
+    };
+
+
+    // Links the tasks inside a stage from the resources they declare, in the
+    // same order TaskGraph would, instead of chaining DependingTask::succeed
+    // by hand. Start and end times of each task go to the profiler.
+    class TaskLinker {
+
+    public:
+        TaskLinker() = default;
+        TaskLinker(const TaskLinker&) = delete;
+        TaskLinker& operator=(const TaskLinker&) = delete;
+
+        TaskLinker& add(
+            std::string_view name,
+            DependingTask& task,
+            std::initializer_list<std::string_view> reads,
+            std::initializer_list<std::string_view> writes
+        );
+
+        struct TaskTime {
+            std::string_view name_;
+            std::chrono::steady_clock::time_point begin_;
+            std::chrono::steady_clock::time_point end_;
+        };
+
+    public:
+        // Tasks without predecessors succeed `start` and `fence` succeeds
+        // all of them. Call once after adding every task. Aborts on cycles.
+        void link(const enki::ICompletable& start, DependingTask& fence);
+        // Also reports the tasks' times in `TaskGraph::timings()`
+        void link(StageTask& stage, DependingTask& fence);
+
+        // Valid once the fence has run
+        std::vector<TaskTime> times() const;
+
+    private:
+        struct Node {
+            // Interned by the profiler
+            std::string_view name_;
+            DependingTask* task_ = nullptr;
+            AccessSet access_;
+            StampTask begin_;
+            StampTask end_;
+        };
+
+        struct RecordTask : public DependingTask {
+            void ExecuteRange(
+                enki::TaskSetPartition range, uint32_t tid
+            ) override;
+
+            const TaskLinker* linker_ = nullptr;
+        };
+
+        std::vector<std::unique_ptr<Node>> nodes_;
+        RecordTask record_;
     };
 
 
     class TaskGraph {
 
+    public:
+        struct StageTiming {
+            std::string name_;
+            // Milliseconds since the start of the frame
+            double begin_ = 0;
+            double end_ = 0;
+        };
+
     public:
         template <typename T>
         T* push_back(std::unique_ptr<T>&& stage_task) {
             auto& item = stages_.emplace_back();
             auto ptr = stage_task.get();
             item.task_ = std::move(stage_task);
+            built_ = false;
             return ptr;
         }
 
@@ -80,17 +211,69 @@ namespace mirinae {
             auto task = std::make_unique<T>(std::forward<TArgs>(args)...);
             auto ptr = task.get();
             item.task_ = std::move(task);
+            built_ = false;
             return ptr;
         }
 
+        // A frame is `start()`, `wait_all()`, which is the sync point, then
+        // `start_after_sync()`. The stages after the sync point of a frame
+        // may run alongside the stages before the sync point of the next.
+
+        // Runs the stages before the sync point once. In pipelined mode each
+        // starts as soon as the earlier stages it conflicts with have
+        // finished, and they may still be running when this returns.
         void start();
+        // Runs the stages after the sync point once, in the same manner
+        void start_after_sync();
+        // Waits for every stage started so far
+        void wait_all();
+
+        void set_pipelined(bool pipelined);
+
+        // Per stage, valid once the frame has finished. Tasks linked with
+        // TaskLinker follow their stage, named "stage / task".
+        std::vector<StageTiming> timings() const;
 
     private:
+        using clock_t = std::chrono::steady_clock;
+
+        // Wraps a stage with time stamps and links it to the stages it
+        // depends on. Must not move once linked.
+        struct StageNode {
+            // Interned by the profiler, which outlives the stage
+            std::string_view name_;
+            StampTask begin_;
+            StampTask end_;
+            enki::Dependency stage_dep_;
+            std::vector<size_t> preds_;
+        };
+
         struct Stage {
             std::unique_ptr<StageTask> task_;
+            std::unique_ptr<StageNode> node_;
         };
 
+        // Stages on one side of the sync point
+        struct Group {
+            // Stage indices sorted by their dependencies
+            std::vector<size_t> order_;
+            clock_t::time_point frame_start_;
+            bool running_ = false;
+        };
+
+        void build();
+        void sort_group(Group& group, bool after_sync);
+        void run_group(Group& group);
+        void wait_group(Group& group);
+        void record_profile(const Group& group) const;
+
         std::vector<Stage> stages_;
+        Group before_sync_;
+        Group after_sync_;
+        bool pipelined_ = false;
+        bool built_ = false;
+        // Whether any stage before the sync point conflicts with one after
+        bool crosses_sync_ = false;
     };
 
 }  // namespace mirinae
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -26,6 +27,9 @@ namespace mirinae {
 
         virtual bool pop_back() = 0;
         virtual bool clear() = 0;
+
+        // Changes whenever the contents change
+        virtual uint64_t revision() const = 0;
     };
 
 
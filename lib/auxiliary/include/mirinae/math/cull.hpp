@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "mirinae/math/include_glm.hpp"
+
+
+namespace mirinae {
+
+    struct BoundingSphere {
+        // Result covers the sphere after the transform, including scale
+        BoundingSphere transform(const glm::dmat4& m) const;
+
+        glm::vec3 center_{ 0 };
+        float radius_ = 0;
+    };
+
+
+    // Planes of a clip space volume with normals pointing inward
+    class FrustumPlanes {
+
+    public:
+        // `clip` maps to Vulkan clip space, i.e. depth range of [0, 1]. Depth
+        // planes are skipped if `test_depth` is false, which shadow casters
+        // need because they may lie outside of the light's depth range.
+        void set(const glm::dmat4& clip, bool test_depth = true);
+
+        bool test(const BoundingSphere& sphere) const;
+
+        std::array<glm::vec4, 6> planes_;
+        size_t count_ = 0;
+    };
+
+
+    // Spheres in SoA layout so that they can be tested in batches
+    class SphereBatch {
+
+    public:
+        constexpr static size_t WIDTH = 4;
+
+        void clear();
+        void push_back(const BoundingSphere& sphere);
+        void set(size_t index, const BoundingSphere& sphere);
+        // Moves the last sphere to `index`
+        void swap_remove(size_t index);
+
+        size_t size() const { return size_; }
+        size_t block_count() const { return (size_ + WIDTH - 1) / WIDTH; }
+
+        // Writes 1 to `out[i]` if sphere `i` intersects the frustum, else 0,
+        // for spheres in the blocks [block_begin, block_end)
+        void cull(
+            const FrustumPlanes& frustum,
+            size_t block_begin,
+            size_t block_end,
+            uint8_t* out
+        ) const;
+
+    private:
+        // Padded to a multiple of `WIDTH`
+        std::vector<float> x_, y_, z_, r_;
+        size_t size_ = 0;
+    };
+
+}  // namespace mirinae
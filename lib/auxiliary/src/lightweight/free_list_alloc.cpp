@@ -0,0 +1,72 @@
+#include "mirinae/lightweight/free_list_alloc.hpp"
+
+#include <iterator>
+
+
+namespace mirinae {
+
+    FreeListAllocator::FreeListAllocator(size_t capacity)
+        : capacity_(capacity) {
+        if (capacity_ > 0)
+            this->insert_free(0, capacity_);
+    }
+
+    std::optional<size_t> FreeListAllocator::alloc(size_t size) {
+        if (0 == size)
+            return std::nullopt;
+
+        const auto it = by_size_.lower_bound({ size, 0 });
+        if (it == by_size_.end())
+            return std::nullopt;
+
+        const auto [free_size, offset] = *it;
+        this->erase_free(offset, free_size);
+        if (free_size > size)
+            this->insert_free(offset + size, free_size - size);
+
+        used_ += size;
+        return offset;
+    }
+
+    void FreeListAllocator::free(size_t offset, size_t size) {
+        if (0 == size)
+            return;
+
+        used_ -= size;
+
+        auto next = by_offset_.lower_bound(offset);
+        if (next != by_offset_.end() && next->first == offset + size) {
+            size += next->second;
+            this->erase_free(next->first, next->second);
+        }
+
+        next = by_offset_.lower_bound(offset);
+        if (next != by_offset_.begin()) {
+            const auto prev = std::prev(next);
+            if (prev->first + prev->second == offset) {
+                offset = prev->first;
+                size += prev->second;
+                this->erase_free(prev->first, prev->second);
+            }
+        }
+
+        this->insert_free(offset, size);
+    }
+
+    size_t FreeListAllocator::largest_free() const {
+        if (by_size_.empty())
+            return 0;
+        return by_size_.rbegin()->first;
+    }
+
+    void FreeListAllocator::insert_free(size_t offset, size_t size) {
+        by_offset_.emplace(offset, size);
+        by_size_.emplace(size, offset);
+    }
+
+    void FreeListAllocator::erase_free(size_t offset, size_t size) {
+        by_offset_.erase(offset);
+        by_size_.erase({ size, offset });
+    }
+
+}  // namespace mirinae
@@ -0,0 +1,272 @@
+#include "mirinae/lightweight/log_ring.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "mirinae/lightweight/include_spdlog.hpp"
+
+
+namespace {
+
+    constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(500);
+
+
+    size_t round_up_pow2(size_t x) {
+        size_t out = 1;
+        while (out < x) out <<= 1;
+        return out;
+    }
+
+
+    // Writers of different laps may race on `value`
+    void raise_to(std::atomic<uint64_t>& value, uint64_t target) {
+        auto cur = value.load(std::memory_order_relaxed);
+        while (cur < target) {
+            if (value.compare_exchange_weak(
+                    cur, target, std::memory_order_release
+                ))
+                return;
+        }
+    }
+
+
+    constexpr size_t TEXT_WORDS = mirinae::LogRecord::MAX_TEXT / 8;
+    static_assert(TEXT_WORDS * 8 == mirinae::LogRecord::MAX_TEXT);
+
+
+    // `state_` is 2n + 1 while the record of sequence number n is being
+    // written and 2n + 2 once it is done, so readers can tell whether the
+    // record they copied was overwritten in the meantime. Contents are
+    // relaxed atomics because readers may copy them mid-write.
+    struct Slot {
+        std::atomic<uint64_t> state_ = 0;
+        // Writers that give up on sequence number n raise this to n + 1, so
+        // readers stop waiting for it
+        std::atomic<uint64_t> skip_below_ = 0;
+        // Size in the low 16 bits, level above
+        std::atomic<uint32_t> meta_ = 0;
+        std::array<std::atomic<uint64_t>, TEXT_WORDS> text_{};
+    };
+
+}  // namespace
+
+
+// LogRing::Impl
+namespace mirinae {
+
+    class LogRing::Impl {
+
+    public:
+        explicit Impl(size_t capacity)
+            : slots_(::round_up_pow2(std::max<size_t>(capacity, 1)))
+            , mask_(slots_.size() - 1) {}
+
+        ~Impl() { this->stop_file_flush(); }
+
+        void push(uint8_t level, std::string_view text) {
+            const auto seq = head_.fetch_add(1, std::memory_order_relaxed);
+            auto& slot = slots_[seq & mask_];
+
+            // Another writer holding this slot or newer record already in it
+            // means this one fell a full lap behind
+            auto state = slot.state_.load(std::memory_order_relaxed);
+            if ((state & 1) || state > seq * 2 + 2 ||
+                !slot.state_.compare_exchange_strong(
+                    state, seq * 2 + 1, std::memory_order_acquire
+                )) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                ::raise_to(slot.skip_below_, seq + 1);
+                return;
+            }
+
+            const auto size = std::min(text.size(), LogRecord::MAX_TEXT);
+            const auto words = (size + 7) / 8;
+            std::array<uint64_t, ::TEXT_WORDS> buf{};
+            std::memcpy(buf.data(), text.data(), size);
+            for (size_t i = 0; i < words; ++i)
+                slot.text_[i].store(buf[i], std::memory_order_relaxed);
+            slot.meta_.store(
+                static_cast<uint32_t>(size) | (uint32_t(level) << 16),
+                std::memory_order_relaxed
+            );
+
+            slot.state_.store(seq * 2 + 2, std::memory_order_release);
+        }
+
+        uint64_t snapshot(uint64_t from, std::vector<LogRecord>& out) const {
+            const auto head = head_.load(std::memory_order_acquire);
+            const auto cap = slots_.size();
+            auto seq = std::max<uint64_t>(from, head > cap ? head - cap : 0);
+
+            for (; seq < head; ++seq) {
+                const auto& slot = slots_[seq & mask_];
+                const auto state = slot.state_.load(std::memory_order_acquire);
+                // Overwritten by a newer record
+                if (state > seq * 2 + 2)
+                    continue;
+                if (state < seq * 2 + 2) {
+                    const auto skip = slot.skip_below_.load(
+                        std::memory_order_acquire
+                    );
+                    if (skip > seq)
+                        continue;
+                    // Claimed but not written yet, pick it up next time
+                    break;
+                }
+
+                const auto meta = slot.meta_.load(std::memory_order_relaxed);
+                const auto size = std::min<size_t>(
+                    meta & 0xFFFF, LogRecord::MAX_TEXT
+                );
+                std::array<uint64_t, ::TEXT_WORDS> buf;
+                for (size_t i = 0; i < (size + 7) / 8; ++i)
+                    buf[i] = slot.text_[i].load(std::memory_order_relaxed);
+
+                auto& r = out.emplace_back();
+                r.seq_ = seq;
+                r.size_ = static_cast<uint16_t>(size);
+                r.level_ = static_cast<uint8_t>(meta >> 16);
+                std::memcpy(r.text_.data(), buf.data(), size);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.state_.load(std::memory_order_relaxed) != state)
+                    out.pop_back();
+            }
+
+            return seq;
+        }
+
+        void start_file_flush(const std::filesystem::path& path) {
+            this->stop_file_flush();
+
+            std::error_code ec;
+            const auto parent = path.parent_path();
+            if (!parent.empty())
+                std::filesystem::create_directories(parent, ec);
+
+            file_.open(path, std::ios::trunc);
+            if (!file_) {
+                SPDLOG_WARN("Failed to open log file: {}", path.string());
+                return;
+            }
+
+            stop_ = false;
+            const auto from = head_.load(std::memory_order_acquire);
+            flush_thread_ = std::thread([this, from]() {
+                this->flush_loop(from);
+            });
+        }
+
+        void stop_file_flush() {
+            if (!flush_thread_.joinable())
+                return;
+
+            {
+                std::lock_guard<std::mutex> lock(flush_mut_);
+                stop_ = true;
+            }
+            flush_cv_.notify_all();
+            flush_thread_.join();
+            file_.close();
+        }
+
+        size_t capacity() const { return slots_.size(); }
+
+        uint64_t dropped() const {
+            return dropped_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        void flush_loop(uint64_t from) {
+            std::vector<LogRecord> records;
+            auto cursor = from;
+            auto expected = from;
+
+            while (true) {
+                bool stop;
+                {
+                    std::unique_lock<std::mutex> lock(flush_mut_);
+                    flush_cv_.wait_for(lock, ::FLUSH_INTERVAL, [this]() {
+                        return stop_;
+                    });
+                    stop = stop_;
+                }
+
+                records.clear();
+                cursor = this->snapshot(cursor, records);
+
+                for (auto& r : records) {
+                    if (r.seq_ != expected) {
+                        const auto lost = r.seq_ - expected;
+                        file_ << "... " << lost << " lines lost\n";
+                    }
+                    expected = r.seq_ + 1;
+
+                    const auto level = spdlog::level::to_string_view(
+                        static_cast<spdlog::level::level_enum>(r.level_)
+                    );
+                    const std::string_view level_sv{ level.data(),
+                                                     level.size() };
+                    file_ << '[' << level_sv << "] " << r.text() << '\n';
+                }
+                file_.flush();
+
+                if (stop)
+                    return;
+            }
+        }
+
+        std::vector<Slot> slots_;
+        const uint64_t mask_;
+        alignas(64) std::atomic<uint64_t> head_ = 0;
+        alignas(64) std::atomic<uint64_t> dropped_ = 0;
+
+        std::ofstream file_;
+        std::thread flush_thread_;
+        std::mutex flush_mut_;
+        std::condition_variable flush_cv_;
+        bool stop_ = false;
+    };
+
+}  // namespace mirinae
+
+
+// LogRing
+namespace mirinae {
+
+    LogRing::LogRing(size_t capacity)
+        : pimpl_(std::make_unique<Impl>(capacity)) {}
+
+    LogRing::~LogRing() = default;
+
+    void LogRing::push(uint8_t level, std::string_view text) {
+        pimpl_->push(level, text);
+    }
+
+    uint64_t LogRing::snapshot(
+        uint64_t from, std::vector<LogRecord>& out
+    ) const {
+        return pimpl_->snapshot(from, out);
+    }
+
+    size_t LogRing::capacity() const { return pimpl_->capacity(); }
+
+    uint64_t LogRing::dropped() const { return pimpl_->dropped(); }
+
+    void LogRing::start_file_flush(const std::filesystem::path& path) {
+        pimpl_->start_file_flush(path);
+    }
+
+    void LogRing::stop_file_flush() { pimpl_->stop_file_flush(); }
+
+    LogRing& log_ring() {
+        static LogRing inst(4096);
+        return inst;
+    }
+
+}  // namespace mirinae
@@ -0,0 +1,226 @@
+#include "mirinae/lightweight/mapped_file.hpp"
+
+#include <utility>
+
+#include <sung/basic/os_detect.hpp>
+
+#ifdef SUNG_OS_WINDOWS
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+namespace {
+
+#ifdef SUNG_OS_WINDOWS
+
+    const uint8_t* map_file(const std::filesystem::path& path, size_t& size) {
+        const auto file = CreateFileW(
+            path.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_FLAG_SEQUENTIAL_SCAN,
+            nullptr
+        );
+        if (INVALID_HANDLE_VALUE == file)
+            return nullptr;
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+            CloseHandle(file);
+            return nullptr;
+        }
+
+        const auto mapping = CreateFileMappingW(
+            file, nullptr, PAGE_READONLY, 0, 0, nullptr
+        );
+        CloseHandle(file);
+        if (nullptr == mapping)
+            return nullptr;
+
+        // The view keeps the mapping alive
+        const auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (nullptr == view)
+            return nullptr;
+
+        size = static_cast<size_t>(file_size.QuadPart);
+        return static_cast<const uint8_t*>(view);
+    }
+
+    void unmap_file(const uint8_t* data, size_t) {
+        UnmapViewOfFile(data);
+    }
+
+#else
+
+    const uint8_t* map_file(const std::filesystem::path& path, size_t& size) {
+        const auto fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return nullptr;
+
+        struct stat st;
+        if (0 != ::fstat(fd, &st) || st.st_size <= 0) {
+            ::close(fd);
+            return nullptr;
+        }
+
+        const auto file_size = static_cast<size_t>(st.st_size);
+        const auto view = ::mmap(
+            nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0
+        );
+        // The mapping keeps the file alive
+        ::close(fd);
+        if (MAP_FAILED == view)
+            return nullptr;
+
+        // Parsers read front to back, so read ahead aggressively
+        ::madvise(view, file_size, MADV_SEQUENTIAL);
+
+        size = file_size;
+        return static_cast<const uint8_t*>(view);
+    }
+
+    void unmap_file(const uint8_t* data, size_t size) {
+        ::munmap(const_cast<uint8_t*>(data), size);
+    }
+
+#endif
+
+}  // namespace
+
+
+// MappedFile
+namespace mirinae {
+
+    MappedFile::~MappedFile() { this->close(); }
+
+    MappedFile::MappedFile(MappedFile&& rhs) noexcept
+        : data_(rhs.data_), size_(rhs.size_) {
+        rhs.data_ = nullptr;
+        rhs.size_ = 0;
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+        if (this != &rhs) {
+            this->close();
+            std::swap(data_, rhs.data_);
+            std::swap(size_, rhs.size_);
+        }
+        return *this;
+    }
+
+    bool MappedFile::open(const std::filesystem::path& path) {
+        this->close();
+
+        size_t size = 0;
+        data_ = ::map_file(path, size);
+        if (!data_)
+            return false;
+
+        size_ = size;
+        return true;
+    }
+
+    void MappedFile::close() {
+        if (data_)
+            ::unmap_file(data_, size_);
+
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+}  // namespace mirinae
+
+
+// FileMapper
+namespace mirinae {
+
+    void FileMapper::add_root(
+        const std::string& prefix, const std::filesystem::path& dir
+    ) {
+        auto& root = roots_.emplace_back();
+        root.prefix_ = prefix;
+        root.dir_ = dir;
+    }
+
+    bool FileMapper::map(const dal::path& path, MappedFile& out) const {
+        if (path.empty())
+            return false;
+
+        const auto first = path.begin()->string();
+        const auto is_virtual = !first.empty() && first[0] == ':';
+
+        for (auto& root : roots_) {
+            std::filesystem::path native_path;
+            if (root.prefix_.empty()) {
+                if (is_virtual)
+                    continue;
+                native_path = root.dir_ / path;
+            } else {
+                if (first != root.prefix_)
+                    continue;
+                native_path = root.dir_ /
+                              path.lexically_relative(root.prefix_);
+            }
+
+            std::error_code ec;
+            if (!std::filesystem::is_regular_file(native_path, ec))
+                continue;
+            return out.open(native_path);
+        }
+
+        return false;
+    }
+
+}  // namespace mirinae
+
+
+// FileData
+namespace mirinae {
+
+    bool FileData::load(
+        const dal::path& path,
+        dal::Filesystem& filesys,
+        const FileMapper* mapper
+    ) {
+        this->clear();
+
+        if (mapper && mapper->map(path, mapped_))
+            return true;
+
+        filesys.read_file(path, buffer_);
+        return !buffer_.empty();
+    }
+
+    void FileData::clear() {
+        mapped_.close();
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+    }
+
+    const uint8_t* FileData::data() const {
+        if (mapped_.is_open())
+            return mapped_.data();
+        return reinterpret_cast<const uint8_t*>(buffer_.data());
+    }
+
+    size_t FileData::size() const {
+        if (mapped_.is_open())
+            return mapped_.size();
+        return buffer_.size();
+    }
+
+}  // namespace mirinae
@@ -0,0 +1,388 @@
+#include "mirinae/lightweight/profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <unordered_set>
+
+#include "mirinae/lightweight/include_spdlog.hpp"
+
+
+namespace {
+
+    using mirinae::prof_clock_t;
+
+    constexpr size_t RING_SIZE = 1 << 13;
+    constexpr size_t HISTORY_SIZE = 120;
+
+    // Chrome trace needs numeric thread IDs
+    constexpr uint32_t NAMED_TRACK_TID_BASE = 10000;
+
+    std::atomic<uint64_t> g_next_profiler_id = 1;
+
+
+    struct Event {
+        std::string_view name_;
+        std::string_view track_;
+        prof_clock_t::time_point begin_;
+        prof_clock_t::time_point end_;
+    };
+
+
+    // Written only by its owner thread and read only by the main thread
+    class ThreadRing {
+
+    public:
+        explicit ThreadRing(uint32_t tid) : tid_(tid) {}
+
+        void push(const Event& e) {
+            const auto head = head_.load(std::memory_order_relaxed);
+            const auto tail = tail_.load(std::memory_order_acquire);
+            if (head - tail >= RING_SIZE) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            events_[head & MASK] = e;
+            head_.store(head + 1, std::memory_order_release);
+        }
+
+        template <typename TFunc>
+        void drain(TFunc&& func) {
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            const auto head = head_.load(std::memory_order_acquire);
+            for (auto i = tail; i != head; ++i) func(events_[i & MASK]);
+            tail_.store(head, std::memory_order_release);
+        }
+
+        uint64_t take_dropped() { return dropped_.exchange(0); }
+
+        uint32_t tid() const { return tid_; }
+
+    private:
+        constexpr static size_t MASK = RING_SIZE - 1;
+
+        std::array<Event, RING_SIZE> events_;
+        alignas(64) std::atomic<uint64_t> head_ = 0;
+        alignas(64) std::atomic<uint64_t> tail_ = 0;
+        std::atomic<uint64_t> dropped_ = 0;
+        uint32_t tid_;
+    };
+
+
+    struct ZoneHistory {
+        std::array<float, HISTORY_SIZE> ms_{};
+        std::array<uint32_t, HISTORY_SIZE> calls_{};
+    };
+
+
+    struct CapturedEvent {
+        Event event_;
+        uint32_t tid_;
+    };
+
+
+    void write_json_str(std::ostream& out, std::string_view str) {
+        out << '"';
+        for (const auto c : str) {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                out << ' ';
+            else
+                out << c;
+        }
+        out << '"';
+    }
+
+}  // namespace
+
+
+// Profiler::Impl
+namespace mirinae {
+
+    class Profiler::Impl {
+
+    public:
+        Impl()
+            : epoch_(prof_clock_t::now())
+            , last_frame_(epoch_)
+            , id_(::g_next_profiler_id.fetch_add(1)) {}
+
+        void record(const Event& e) { this->local_ring().push(e); }
+
+        void new_frame() {
+            const auto now = prof_clock_t::now();
+            this->record(Event{ "frame", "frame", last_frame_, now });
+            last_frame_ = now;
+
+            const auto slot = frame_count_ % HISTORY_SIZE;
+            for (auto& [name, history] : history_) {
+                history.ms_[slot] = 0;
+                history.calls_[slot] = 0;
+            }
+
+            std::vector<std::shared_ptr<ThreadRing>> rings;
+            {
+                std::lock_guard<std::mutex> lock(rings_mut_);
+                rings = rings_;
+            }
+
+            uint64_t dropped = 0;
+            for (auto& ring : rings) {
+                ring->drain([&](const Event& e) {
+                    const std::chrono::duration<float, std::milli> dur =
+                        e.end_ - e.begin_;
+                    auto& history = history_[e.name_];
+                    history.ms_[slot] += dur.count();
+                    history.calls_[slot] += 1;
+
+                    if (capture_left_ > 0)
+                        captured_.push_back(CapturedEvent{ e, ring->tid() });
+                });
+                dropped += ring->take_dropped();
+            }
+            rings.clear();
+
+            // Rings of exited threads are only referenced here
+            {
+                std::lock_guard<std::mutex> lock(rings_mut_);
+                const auto it = std::remove_if(
+                    rings_.begin(), rings_.end(), [](auto& ring) {
+                        return ring.use_count() == 1;
+                    }
+                );
+                rings_.erase(it, rings_.end());
+            }
+
+            if (dropped > 0)
+                SPDLOG_WARN("Profiler dropped {} events", dropped);
+
+            ++frame_count_;
+
+            if (capture_left_ > 0) {
+                --capture_left_;
+                if (0 == capture_left_) {
+                    this->write_trace();
+                    captured_.clear();
+                }
+            }
+        }
+
+        void capture(size_t frames, const std::filesystem::path& path) {
+            captured_.clear();
+            capture_left_ = frames;
+            capture_path_ = path;
+        }
+
+        bool is_capturing() const { return capture_left_ > 0; }
+
+        std::string_view intern(std::string_view name) {
+            std::lock_guard<std::mutex> lock(names_mut_);
+            // Nodes of the set never move
+            return *names_.emplace(name).first;
+        }
+
+        std::vector<ProfZoneStats> stats() const {
+            std::vector<ProfZoneStats> out;
+            const auto frames = std::min(frame_count_, HISTORY_SIZE);
+            if (0 == frames)
+                return out;
+
+            out.reserve(history_.size());
+            for (auto& [name, history] : history_) {
+                auto& s = out.emplace_back();
+                s.name_ = name;
+
+                double sum = 0;
+                double calls = 0;
+                for (size_t i = 0; i < frames; ++i) {
+                    sum += history.ms_[i];
+                    calls += history.calls_[i];
+                    s.max_ms_ = std::max<double>(s.max_ms_, history.ms_[i]);
+                }
+                s.avg_ms_ = sum / frames;
+                s.avg_calls_ = calls / frames;
+            }
+            return out;
+        }
+
+        std::atomic<bool> enabled_ = true;
+
+    private:
+        ThreadRing& local_ring() {
+            // Address of a destroyed profiler may be reused, hence the ID
+            struct Local {
+                uint64_t owner_ = 0;
+                std::shared_ptr<ThreadRing> ring_;
+            };
+            thread_local Local local;
+
+            if (local.owner_ != id_) {
+                std::lock_guard<std::mutex> lock(rings_mut_);
+                local.ring_ = std::make_shared<ThreadRing>(next_tid_++);
+                local.owner_ = id_;
+                rings_.push_back(local.ring_);
+            }
+
+            return *local.ring_;
+        }
+
+        void write_trace() const {
+            std::error_code ec;
+            const auto parent = capture_path_.parent_path();
+            if (!parent.empty())
+                std::filesystem::create_directories(parent, ec);
+
+            std::ofstream file(capture_path_, std::ios::trunc);
+            if (!file) {
+                SPDLOG_WARN(
+                    "Failed to open trace file: {}", capture_path_.string()
+                );
+                return;
+            }
+
+            std::map<std::string_view, uint32_t> tracks;
+            std::map<uint32_t, std::string> track_names;
+            for (auto& c : captured_) {
+                if (c.event_.track_.empty()) {
+                    const auto name = fmt::format("thread {}", c.tid_);
+                    track_names.emplace(c.tid_, name);
+                    continue;
+                }
+
+                const auto tid = static_cast<uint32_t>(
+                    NAMED_TRACK_TID_BASE + tracks.size()
+                );
+                if (tracks.emplace(c.event_.track_, tid).second)
+                    track_names.emplace(tid, c.event_.track_);
+            }
+
+            const auto to_us = [this](prof_clock_t::time_point t) {
+                const std::chrono::duration<double, std::micro> d = t - epoch_;
+                return d.count();
+            };
+
+            file << "{\"traceEvents\":[\n";
+            bool first = true;
+            for (auto& [tid, name] : track_names) {
+                file << (first ? "" : ",\n");
+                file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                     << "\"tid\":" << tid << ",\"args\":{\"name\":";
+                ::write_json_str(file, name);
+                file << "}}";
+                first = false;
+            }
+
+            for (auto& c : captured_) {
+                auto& e = c.event_;
+                const auto tid = e.track_.empty() ? c.tid_
+                                                  : tracks.at(e.track_);
+
+                file << (first ? "" : ",\n") << "{\"name\":";
+                ::write_json_str(file, e.name_);
+                file << fmt::format(
+                    ",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},"
+                    "\"pid\":1,\"tid\":{}}}",
+                    to_us(e.begin_),
+                    to_us(e.end_) - to_us(e.begin_),
+                    tid
+                );
+                first = false;
+            }
+            file << "\n]}\n";
+
+            SPDLOG_INFO(
+                "Wrote {} profiler events to {}",
+                captured_.size(),
+                capture_path_.string()
+            );
+        }
+
+        const prof_clock_t::time_point epoch_;
+        prof_clock_t::time_point last_frame_;
+        const uint64_t id_;
+        size_t frame_count_ = 0;
+
+        std::vector<std::shared_ptr<ThreadRing>> rings_;
+        std::mutex rings_mut_;
+        uint32_t next_tid_ = 0;
+
+        std::map<std::string_view, ZoneHistory> history_;
+
+        std::unordered_set<std::string> names_;
+        std::mutex names_mut_;
+
+        std::vector<CapturedEvent> captured_;
+        std::filesystem::path capture_path_;
+        size_t capture_left_ = 0;
+    };
+
+}  // namespace mirinae
+
+
+// Profiler
+namespace mirinae {
+
+    Profiler::Profiler() : pimpl_(std::make_unique<Impl>()) {}
+
+    Profiler::~Profiler() = default;
+
+    void Profiler::record(
+        std::string_view name,
+        prof_clock_t::time_point begin,
+        prof_clock_t::time_point end,
+        std::string_view track
+    ) {
+        if (pimpl_->enabled_.load(std::memory_order_relaxed))
+            pimpl_->record(Event{ name, track, begin, end });
+    }
+
+    std::string_view Profiler::intern(std::string_view name) {
+        return pimpl_->intern(name);
+    }
+
+    bool Profiler::enabled() const {
+        return pimpl_->enabled_.load(std::memory_order_relaxed);
+    }
+
+    void Profiler::set_enabled(bool enabled) { pimpl_->enabled_ = enabled; }
+
+    void Profiler::new_frame() { pimpl_->new_frame(); }
+
+    void Profiler::capture(size_t frames, const std::filesystem::path& path) {
+        pimpl_->capture(frames, path);
+    }
+
+    bool Profiler::is_capturing() const { return pimpl_->is_capturing(); }
+
+    std::vector<ProfZoneStats> Profiler::stats() const {
+        return pimpl_->stats();
+    }
+
+    Profiler& profiler() {
+        static Profiler inst;
+        return inst;
+    }
+
+}  // namespace mirinae
+
+
+// ProfZone
+namespace mirinae {
+
+    ProfZone::ProfZone(std::string_view name)
+        : name_(name), active_(profiler().enabled()) {
+        if (active_)
+            begin_ = prof_clock_t::now();
+    }
+
+    ProfZone::~ProfZone() {
+        if (active_)
+            profiler().record(name_, begin_, prof_clock_t::now());
+    }
+
+}  // namespace mirinae
@@ -0,0 +1,41 @@
+#include "mirinae/lightweight/ring_alloc.hpp"
+
+#include <algorithm>
+
+
+namespace {
+
+    uint64_t align_up(uint64_t x, uint64_t alignment) {
+        return (x + alignment - 1) / alignment * alignment;
+    }
+
+}  // namespace
+
+
+namespace mirinae {
+
+    RingAllocator::RingAllocator(size_t capacity) : capacity_(capacity) {}
+
+    std::optional<size_t> RingAllocator::alloc(size_t size, size_t alignment) {
+        if (size > capacity_)
+            return std::nullopt;
+
+        // Nothing in use, so start over from the beginning of the buffer
+        if (head_ == tail_)
+            head_ = tail_ = ::align_up(head_, capacity_);
+
+        auto pos = ::align_up(head_, std::max<size_t>(alignment, 1));
+        if (pos % capacity_ + size > capacity_)
+            pos = ::align_up(pos, capacity_);
+        if (pos + size - tail_ > capacity_)
+            return std::nullopt;
+
+        head_ = pos + size;
+        return static_cast<size_t>(pos % capacity_);
+    }
+
+    void RingAllocator::release(uint64_t pos) {
+        tail_ = std::clamp(pos, tail_, head_);
+    }
+
+}  // namespace mirinae
@@ -1,9 +1,11 @@
 #include "mirinae/lightweight/skin_anim.hpp"
 
 #include <algorithm>
+#include <array>
 #include <unordered_map>
 
 #include "mirinae/lightweight/include_spdlog.hpp"
+#include "skin_anim_simd.hpp"
 
 
 namespace {
@@ -79,6 +81,17 @@ namespace {
     }
 
 
+    glm::mat4 make_trs_mat(
+        const glm::vec3& translate, const glm::quat& rotate, const float scale
+    ) {
+        const glm::mat4 identity{ 1 };
+        const auto translate_mat = glm::translate(identity, translate);
+        const auto rotate_mat = glm::mat4_cast(rotate);
+        const auto scale_mat = glm::scale(identity, glm::vec3{ scale });
+        return translate_mat * rotate_mat * scale_mat;
+    }
+
+
     glm::vec3 make_joint_translation(
         double tick, const dal::AnimJoint& anim_joint
     ) {
@@ -110,15 +123,52 @@ namespace {
         const auto translate = ::make_joint_translation(tick, anim_joint);
         const auto rotate = ::make_joint_rotation(tick, anim_joint);
         const auto scale = ::make_joint_scale(tick, anim_joint);
+        return ::make_trs_mat(translate, rotate, scale);
+    }
 
-        const glm::mat4 identity{ 1 };
-        const auto translate_mat = glm::translate(identity, translate);
-        const auto rotate_mat = glm::mat4_cast(rotate);
-        const auto scale_mat = glm::scale(identity, glm::vec3{ scale });
 
-        return translate_mat * rotate_mat * scale_mat;
+    bool is_key_for_tick(
+        const std::vector<float>& times, const size_t index, const float tick
+    ) {
+        if (index >= times.size())
+            return false;
+        if (index > 0 && tick < times[index])
+            return false;
+        if (index + 1 < times.size() && times[index + 1] <= tick)
+            return false;
+        return true;
     }
 
+    // Same result as `find_index_to_start_interp` but starts from a hint
+    size_t find_key_from_cursor(
+        const std::vector<float>& times, const size_t cursor, const float tick
+    ) {
+        if (::is_key_for_tick(times, cursor, tick))
+            return cursor;
+        if (::is_key_for_tick(times, cursor + 1, tick))
+            return cursor + 1;
+
+        // Seeked or looped, fall back to binary search
+        auto begin = times.begin();
+        if (cursor < times.size() && times[cursor] <= tick)
+            begin += cursor;
+        const auto found = std::upper_bound(begin, times.end(), tick);
+        const auto index = static_cast<size_t>(found - times.begin());
+        return index > 0 ? index - 1 : 0;
+    }
+
+    template <typename T>
+    void fill_channel(
+        mirinae::AnimChannel<T>& dst,
+        const std::vector<std::pair<float, T>>& src
+    ) {
+        dst.times_.resize(src.size());
+        dst.values_.resize(src.size());
+        for (size_t i = 0; i < src.size(); i++) {
+            dst.times_[i] = src[i].first;
+            dst.values_[i] = src[i].second;
+        }
+    }
 
     void set_all_identity(glm::mat4* const mats, const size_t size) {
         for (size_t i = 0; i < size; i++) {
@@ -186,6 +236,130 @@ namespace mirinae {
 }  // namespace mirinae
 
 
+// AnimChannel
+namespace mirinae {
+
+    template <typename T>
+    T AnimChannel<T>::sample(
+        float tick, uint32_t& cursor, const T& fallback
+    ) const {
+        if (times_.empty())
+            return fallback;
+
+        size_t from, to;
+        const auto factor = this->locate(tick, cursor, from, to);
+        if (from == to)
+            return values_[from];
+
+        return ::interpolate(values_[from], values_[to], factor);
+    }
+
+    template <typename T>
+    float AnimChannel<T>::locate(
+        float tick, uint32_t& cursor, size_t& from, size_t& to
+    ) const {
+        from = 0;
+        to = 0;
+        if (times_.size() <= 1)
+            return 0;
+
+        from = ::find_key_from_cursor(times_, cursor, tick);
+        cursor = static_cast<uint32_t>(from);
+
+        to = from + 1;
+        if (to >= times_.size()) {
+            to = from;
+            return 0;
+        }
+
+        const auto delta_time = times_[to] - times_[from];
+        const auto factor = (tick - times_[from]) / delta_time;
+        if (0.f <= factor && factor <= 1.f)
+            return factor;
+        else
+            return 0;
+    }
+
+    template struct AnimChannel<glm::vec3>;
+    template struct AnimChannel<glm::quat>;
+    template struct AnimChannel<float>;
+
+}  // namespace mirinae
+
+
+// AnimPose
+namespace mirinae {
+
+    void AnimPose::resize(size_t joint_count) {
+        if (joint_count_ == joint_count && !s_.empty())
+            return;
+
+        joint_count_ = joint_count;
+        const auto padded = simd::round_up(joint_count);
+        for (auto x : { &tx_, &ty_, &tz_, &rx_, &ry_, &rz_, &rw_, &s_ })
+            x->resize(padded);
+
+        this->set_identity();
+    }
+
+    void AnimPose::set_identity() {
+        for (auto x : { &tx_, &ty_, &tz_, &rx_, &ry_, &rz_ })
+            std::fill(x->begin(), x->end(), 0.f);
+        std::fill(rw_.begin(), rw_.end(), 1.f);
+        std::fill(s_.begin(), s_.end(), 1.f);
+    }
+
+    glm::vec3 AnimPose::translation(size_t i) const {
+        return glm::vec3{ tx_[i], ty_[i], tz_[i] };
+    }
+
+    glm::quat AnimPose::rotation(size_t i) const {
+        return glm::quat{ rw_[i], rx_[i], ry_[i], rz_[i] };
+    }
+
+}  // namespace mirinae
+
+
+// AnimJointMask
+namespace mirinae {
+
+    void AnimJointMask::resize(size_t joint_count, float weight) {
+        joint_count_ = joint_count;
+        weights_.assign(simd::round_up(joint_count), 0.f);
+        std::fill(weights_.begin(), weights_.begin() + joint_count, weight);
+    }
+
+    void AnimJointMask::set(size_t joint_index, float weight) {
+        if (joint_index < joint_count_)
+            weights_[joint_index] = weight;
+    }
+
+}  // namespace mirinae
+
+
+// AnimCursor
+namespace mirinae {
+
+    uint32_t* AnimCursor::get(size_t anim_idx, size_t joint_count) {
+        const auto size = joint_count * 3;
+        if (anim_idx != anim_idx_ || keys_.size() != size) {
+            keys_.assign(size, 0);
+            anim_idx_ = anim_idx;
+        }
+
+        pose_.resize(joint_count);
+        next_pose_.resize(joint_count);
+        const auto padded = pose_.padded_count();
+        t_factors_.resize(padded);
+        r_factors_.resize(padded);
+        s_factors_.resize(padded);
+
+        return keys_.data();
+    }
+
+}  // namespace mirinae
+
+
 // SkelAnimPair
 namespace mirinae {
 
@@ -199,6 +373,371 @@ namespace mirinae {
         return std::nullopt;
     }
 
+    void SkelAnimPair::compile() {
+        const auto joint_count = skel_.joints_.size();
+
+        joint_order_.clear();
+        joint_order_.reserve(joint_count);
+        inv_offset_mats_.resize(joint_count);
+        to_parent_mats_.resize(joint_count);
+        anim_tracks_.clear();
+
+        const auto parent_of = [&](size_t i) -> dal::jointID_t {
+            const auto parent = skel_.joints_[i].parent_index_;
+            if (parent < 0 || static_cast<size_t>(parent) >= joint_count)
+                return -1;
+            return parent;
+        };
+
+        for (size_t i = 0; i < joint_count; i++) {
+            const auto& joint = skel_.joints_[i];
+            inv_offset_mats_[i] = glm::inverse(joint.offset_mat_);
+        }
+
+        is_leaf_.assign(joint_count, 1);
+        for (size_t i = 0; i < joint_count; i++) {
+            const auto parent = parent_of(i);
+            if (parent < 0) {
+                to_parent_mats_[i] = skel_.joints_[i].offset_mat_;
+            } else {
+                to_parent_mats_[i] = inv_offset_mats_[parent] *
+                                     skel_.joints_[i].offset_mat_;
+                is_leaf_[parent] = 0;
+            }
+        }
+
+        // Topological sort, tolerating joints stored before their parents
+        std::vector<uint8_t> visited(joint_count, 0);
+        std::vector<dal::jointID_t> chain;
+        for (size_t i = 0; i < joint_count; i++) {
+            chain.clear();
+            dal::jointID_t cur = static_cast<dal::jointID_t>(i);
+            while (cur >= 0 && !visited[cur]) {
+                visited[cur] = 1;
+                chain.push_back(cur);
+                cur = parent_of(cur);
+            }
+            joint_order_.insert(
+                joint_order_.end(), chain.rbegin(), chain.rend()
+            );
+        }
+
+        std::unordered_map<std::string, dal::jointID_t> name_to_joint;
+        name_to_joint.reserve(joint_count);
+        for (size_t i = 0; i < joint_count; i++)
+            name_to_joint[skel_.joints_[i].name_] = static_cast<
+                dal::jointID_t>(i);
+
+        anim_tracks_.resize(anims_.size());
+        for (size_t i = 0; i < anims_.size(); i++) {
+            auto& tracks = anim_tracks_[i];
+            tracks.clear();
+            tracks.resize(joint_count);
+
+            for (auto& anim_joint : anims_[i].joints_) {
+                auto found = name_to_joint.find(anim_joint.name_);
+                if (found == name_to_joint.end())
+                    continue;
+
+                auto& dst = tracks[found->second];
+                ::fill_channel(dst.translations_, anim_joint.translations_);
+                ::fill_channel(dst.rotations_, anim_joint.rotations_);
+                ::fill_channel(dst.scales_, anim_joint.scales_);
+            }
+        }
+    }
+
+    bool SkelAnimPair::is_compiled() const {
+        return joint_order_.size() == skel_.joints_.size() &&
+               anim_tracks_.size() == anims_.size();
+    }
+
+    bool SkelAnimPair::sample_pose(
+        double tick_point,
+        size_t anim_idx,
+        AnimCursor& cursor,
+        AnimPose& out,
+        bool skip_leaves
+    ) const {
+        if (anim_idx >= anims_.size())
+            return false;
+        if (!this->is_compiled())
+            return false;
+
+        const auto joint_count = skel_.joints_.size();
+        const auto& tracks = anim_tracks_[anim_idx];
+        const auto tick = static_cast<float>(tick_point);
+        const auto keys = cursor.get(anim_idx, joint_count);
+        auto& next = cursor.next_pose_;
+        out.resize(joint_count);
+        const AnimJointTrack empty_track;
+
+        // Gather the keyframe pairs, interpolation is done in batch below
+        for (size_t i = 0; i < joint_count; i++) {
+            const auto& track = (skip_leaves && is_leaf_[i]) ? empty_track
+                                                              : tracks[i];
+            const auto key = keys + i * 3;
+            size_t from, to;
+
+            if (track.translations_.empty()) {
+                out.tx_[i] = next.tx_[i] = 0;
+                out.ty_[i] = next.ty_[i] = 0;
+                out.tz_[i] = next.tz_[i] = 0;
+                cursor.t_factors_[i] = 0;
+            } else {
+                const auto& ch = track.translations_;
+                cursor.t_factors_[i] = ch.locate(tick, key[0], from, to);
+                const auto& a = ch.values_[from];
+                const auto& b = ch.values_[to];
+                out.tx_[i] = a.x;
+                out.ty_[i] = a.y;
+                out.tz_[i] = a.z;
+                next.tx_[i] = b.x;
+                next.ty_[i] = b.y;
+                next.tz_[i] = b.z;
+            }
+
+            if (track.rotations_.empty()) {
+                out.rx_[i] = next.rx_[i] = 0;
+                out.ry_[i] = next.ry_[i] = 0;
+                out.rz_[i] = next.rz_[i] = 0;
+                out.rw_[i] = next.rw_[i] = 1;
+                cursor.r_factors_[i] = 0;
+            } else {
+                const auto& ch = track.rotations_;
+                cursor.r_factors_[i] = ch.locate(tick, key[1], from, to);
+                const auto& a = ch.values_[from];
+                const auto& b = ch.values_[to];
+                out.rx_[i] = a.x;
+                out.ry_[i] = a.y;
+                out.rz_[i] = a.z;
+                out.rw_[i] = a.w;
+                next.rx_[i] = b.x;
+                next.ry_[i] = b.y;
+                next.rz_[i] = b.z;
+                next.rw_[i] = b.w;
+            }
+
+            if (track.scales_.empty()) {
+                out.s_[i] = next.s_[i] = 1;
+                cursor.s_factors_[i] = 0;
+            } else {
+                const auto& ch = track.scales_;
+                cursor.s_factors_[i] = ch.locate(tick, key[2], from, to);
+                out.s_[i] = ch.values_[from];
+                next.s_[i] = ch.values_[to];
+            }
+        }
+
+        const auto count = out.padded_count();
+        const auto tf = cursor.t_factors_.data();
+        simd::lerp(out.tx_.data(), next.tx_.data(), tf, count);
+        simd::lerp(out.ty_.data(), next.ty_.data(), tf, count);
+        simd::lerp(out.tz_.data(), next.tz_.data(), tf, count);
+        simd::lerp(
+            out.s_.data(), next.s_.data(), cursor.s_factors_.data(), count
+        );
+        simd::slerp(
+            out.rx_.data(),
+            out.ry_.data(),
+            out.rz_.data(),
+            out.rw_.data(),
+            next.rx_.data(),
+            next.ry_.data(),
+            next.rz_.data(),
+            next.rw_.data(),
+            cursor.r_factors_.data(),
+            count
+        );
+
+        return true;
+    }
+
+    bool SkelAnimPair::make_skinning_matrix(
+        const AnimPose& pose, glm::mat4* const out_buf, const size_t buf_size
+    ) const {
+        const auto joint_count = skel_.joints_.size();
+        if (buf_size < joint_count)
+            return false;
+        if (pose.joint_count() != joint_count)
+            return false;
+        if (!this->is_compiled())
+            return false;
+
+        // Local transforms first, then model space in place since parents
+        // are always visited before their children
+        simd::compose_trs(pose, out_buf, joint_count);
+        for (const auto i : joint_order_) {
+            auto& m = out_buf[i];
+            simd::mul_mat4(to_parent_mats_[i], m, m);
+
+            const auto parent = skel_.joints_[i].parent_index_;
+            if (parent >= 0 && static_cast<size_t>(parent) < joint_count)
+                simd::mul_mat4(out_buf[parent], m, m);
+        }
+
+        const auto& root = skel_.root_transform_;
+        for (size_t i = 0; i < joint_count; i++) {
+            simd::mul_mat4(out_buf[i], inv_offset_mats_[i], out_buf[i]);
+            simd::mul_mat4(root, out_buf[i], out_buf[i]);
+        }
+
+        return true;
+    }
+
+    bool SkelAnimPair::make_skinning_matrix(
+        double tick_point,
+        size_t anim_idx,
+        AnimCursor& cursor,
+        glm::mat4* const out_buf,
+        const size_t buf_size
+    ) const {
+        if (buf_size < skel_.joints_.size())
+            return false;
+        if (!this->sample_pose(tick_point, anim_idx, cursor, cursor.pose_))
+            return false;
+
+        return this->make_skinning_matrix(cursor.pose_, out_buf, buf_size);
+    }
+
+    bool SkelAnimPair::make_joint_mask(
+        const std::string& root_joint, AnimJointMask& out
+    ) const {
+        if (!this->is_compiled())
+            return false;
+
+        const auto joint_count = skel_.joints_.size();
+        out.resize(joint_count, 0);
+
+        bool found = false;
+        std::vector<uint8_t> included(joint_count, 0);
+        for (const auto i : joint_order_) {
+            const auto& joint = skel_.joints_[i];
+            const auto parent = joint.parent_index_;
+
+            if (joint.name_ == root_joint)
+                included[i] = 1;
+            else if (parent >= 0 && static_cast<size_t>(parent) < joint_count)
+                included[i] = included[parent];
+
+            if (included[i]) {
+                out.set(i, 1);
+                found = true;
+            }
+        }
+
+        return found;
+    }
+
+}  // namespace mirinae
+
+
+// AnimBlender
+namespace mirinae {
+
+    const AnimPose* AnimBlender::blend(
+        const SkelAnimPair& skel_anim,
+        const AnimBlendInput* inputs,
+        size_t input_count,
+        bool skip_leaves
+    ) {
+        if (0 == input_count)
+            return nullptr;
+        if (cursors_.size() < input_count)
+            cursors_.resize(input_count);
+
+        // A single input needs no blending
+        if (1 == input_count && !inputs[0].mask_) {
+            auto& input = inputs[0];
+            auto& cursor = cursors_[0];
+            if (input.pose_)
+                return input.pose_;
+            if (!skel_anim.sample_pose(
+                    input.tick_,
+                    input.anim_idx_,
+                    cursor,
+                    cursor.pose_,
+                    skip_leaves
+                ))
+                return nullptr;
+            return &cursor.pose_;
+        }
+
+        const auto joint_count = skel_anim.joint_count();
+        result_.resize(joint_count);
+        const auto padded = result_.padded_count();
+        weight_sums_.assign(padded, 0.f);
+        factors_.assign(padded, 0.f);
+
+        bool has_sample = false;
+        for (size_t i = 0; i < input_count; i++) {
+            auto& input = inputs[i];
+            auto& cursor = cursors_[i];
+            if (input.weight_ <= 0)
+                continue;
+
+            const AnimPose* src_pose = input.pose_;
+            if (src_pose) {
+                if (src_pose->joint_count() != joint_count)
+                    continue;
+            } else {
+                if (!skel_anim.sample_pose(
+                        input.tick_,
+                        input.anim_idx_,
+                        cursor,
+                        cursor.pose_,
+                        skip_leaves
+                    ))
+                    continue;
+                src_pose = &cursor.pose_;
+            }
+
+            const float* mask = nullptr;
+            if (input.mask_ && input.mask_->joint_count() == joint_count)
+                mask = input.mask_->data();
+
+            // Running weighted average
+            bool contributes = false;
+            for (size_t j = 0; j < joint_count; j++) {
+                const auto w = mask ? input.weight_ * mask[j] : input.weight_;
+                weight_sums_[j] += w;
+                factors_[j] = weight_sums_[j] > 0 ? w / weight_sums_[j] : 0.f;
+                contributes |= w > 0;
+            }
+
+            // Inputs masked out everywhere must not seed the result
+            if (!contributes)
+                continue;
+
+            const auto& src = *src_pose;
+            if (!has_sample) {
+                result_ = src;
+                has_sample = true;
+                continue;
+            }
+
+            const auto f = factors_.data();
+            simd::lerp(result_.tx_.data(), src.tx_.data(), f, padded);
+            simd::lerp(result_.ty_.data(), src.ty_.data(), f, padded);
+            simd::lerp(result_.tz_.data(), src.tz_.data(), f, padded);
+            simd::lerp(result_.s_.data(), src.s_.data(), f, padded);
+            simd::nlerp(
+                result_.rx_.data(),
+                result_.ry_.data(),
+                result_.rz_.data(),
+                result_.rw_.data(),
+                src.rx_.data(),
+                src.ry_.data(),
+                src.rz_.data(),
+                src.rw_.data(),
+                f,
+                padded
+            );
+        }
+
+        return has_sample ? &result_ : nullptr;
+    }
+
 }  // namespace mirinae
 
 
@@ -337,16 +876,85 @@ namespace mirinae {
 
     void SkinAnimState::sample_anim(
         glm::mat4* const out_buf, const size_t buf_size, const clock_t& clock
-    ) const {
-        const auto anim_idx = deferred_data_.anim_index();
-        if (!anim_idx)
-            return ::set_all_identity(out_buf, buf_size);
+    ) {
+        if (!this->sample_palette(out_buf, buf_size, clock, false))
+            ::set_all_identity(out_buf, buf_size);
+    }
 
-        const auto anim_duration = deferred_data_.anim_duration();
-        if (!anim_duration)
-            return ::set_all_identity(out_buf, buf_size);
+    SkinAnimState::LodPalette SkinAnimState::sample_anim_lod(
+        const float screen_ratio, const uint32_t stagger, const clock_t& clock
+    ) {
+        if (!skel_anim_)
+            return {};
+        const auto joint_count = this->skel().joints_.size();
+        if (0 == joint_count)
+            return {};
+
+        uint32_t interval = 1;
+        bool skip_leaves = false;
+        if (lod_.enabled_) {
+            if (screen_ratio < lod_.half_rate_above_)
+                interval = 4;
+            else if (screen_ratio < lod_.full_rate_above_)
+                interval = 2;
+            skip_leaves = screen_ratio < lod_.skip_leaves_below_;
+        }
+
+        auto& cache = lod_cache_;
+        const auto frame = cache.frame_++;
+        const auto now = clock.t();
+
+        const auto due = (frame + stagger) % interval == 0;
+        if (due || cache.last_.size() != joint_count) {
+            std::swap(cache.prev_, cache.last_);
+            cache.prev_time_ = cache.last_time_;
+
+            cache.last_.resize(joint_count);
+            if (!this->sample_palette(
+                    cache.last_.data(), joint_count, clock, skip_leaves
+                ))
+                ::set_all_identity(cache.last_.data(), joint_count);
+
+            cache.last_time_ = now;
+            cache.revision_++;
+            return { cache.last_.data(), joint_count, cache.revision_ };
+        }
+
+        const auto span = cache.last_time_ - cache.prev_time_;
+        if (lod_.extrapolate_ && cache.prev_.size() == joint_count &&
+            span > 0) {
+            const auto t = std::min((now - cache.last_time_) / span, 1.0);
+            const auto factor = static_cast<float>(t);
+
+            cache.extrapolated_.resize(joint_count);
+            for (size_t i = 0; i < joint_count; i++) {
+                const auto& last = cache.last_[i];
+                const auto delta = last - cache.prev_[i];
+                cache.extrapolated_[i] = last + delta * factor;
+            }
+
+            cache.revision_++;
+            return { cache.extrapolated_.data(),
+                     joint_count,
+                     cache.revision_ };
+        }
 
-        auto& anim = this->anims()[*anim_idx];
+        return { cache.last_.data(), joint_count, cache.revision_ };
+    }
+
+    bool SkinAnimState::sample_palette(
+        glm::mat4* const out_buf,
+        const size_t buf_size,
+        const clock_t& clock,
+        const bool skip_leaves
+    ) {
+        const auto cur = this->make_blend_input(
+            clock, selection_, deferred_data_
+        );
+        if (!cur)
+            return false;
+
+        auto& anim = this->anims()[cur->anim_idx_];
         if (buf_size < this->skel().joints_.size()) {
             SPDLOG_WARN(
                 "Buffer size ({}) is too small to store all joint matrices "
@@ -355,47 +963,154 @@ namespace mirinae {
                 this->skel().joints_.size(),
                 anim.name_
             );
-            return ::set_all_identity(out_buf, buf_size);
+            return false;
         }
 
-        const auto tick = this->calc_tick(clock, selection_, deferred_data_);
-        const auto mtick = ::mod_tick(tick, 0, anim_duration.value());
-        const auto mats = make_skinning_matrix(mtick, this->skel(), anim);
+        const auto pose = this->blend_fade(*cur, clock, skip_leaves);
+        if (pose && skel_anim_->make_skinning_matrix(*pose, out_buf, buf_size))
+            return true;
+
+        const auto mats = make_skinning_matrix(cur->tick_, this->skel(), anim);
         const size_t copy_size = std::min(buf_size, mats.size());
         std::copy(mats.begin(), mats.begin() + copy_size, out_buf);
+        return true;
     }
 
     void SkinAnimState::update_tick(const clock_t& clock) {
         selection_.update_clock(clock);
+
+        if (fade_elapsed_ < fade_duration_) {
+            prev_selection_.update_clock(clock);
+            fade_elapsed_ += clock.dt();
+            if (fade_elapsed_ >= fade_duration_)
+                use_frozen_pose_ = false;
+        }
     }
 
     void SkinAnimState::set_skel_anim(const HSkelAnim& skel_anim) {
         skel_anim_ = skel_anim;
         deferred_data_.notify(selection_, skel_anim_);
+        prev_deferred_data_.notify(prev_selection_, skel_anim_);
     }
 
     void SkinAnimState::select_anim_index(
         const size_t index, const clock_t& clock
     ) {
-        selection_.set_index(index, clock);
-        selection_.reset_clock();
-        deferred_data_.notify(selection_, skel_anim_);
+        this->crossfade_anim_index(index, 0, clock);
     }
 
     void SkinAnimState::select_anim_name(
         const std::string& name, const clock_t& clock
     ) {
-        selection_.set_name(name, clock);
-        selection_.reset_clock();
-        deferred_data_.notify(selection_, skel_anim_);
+        this->crossfade_anim_name(name, 0, clock);
     }
 
     void SkinAnimState::deselect_anim(const clock_t& clock) {
+        this->begin_fade(0, clock);
         selection_.reset_anim(clock);
         selection_.reset_clock();
         deferred_data_.notify(selection_, skel_anim_);
     }
 
+    void SkinAnimState::crossfade_anim_index(
+        const size_t index, const double duration, const clock_t& clock
+    ) {
+        this->begin_fade(duration, clock);
+        selection_.set_index(index, clock);
+        selection_.reset_clock();
+        deferred_data_.notify(selection_, skel_anim_);
+    }
+
+    void SkinAnimState::crossfade_anim_name(
+        const std::string& name, const double duration, const clock_t& clock
+    ) {
+        this->begin_fade(duration, clock);
+        selection_.set_name(name, clock);
+        selection_.reset_clock();
+        deferred_data_.notify(selection_, skel_anim_);
+    }
+
+    void SkinAnimState::begin_fade(
+        const double duration, const clock_t& clock
+    ) {
+        if (duration <= 0 || !skel_anim_ || !deferred_data_.is_ready()) {
+            fade_elapsed_ = 0;
+            fade_duration_ = 0;
+            use_frozen_pose_ = false;
+            return;
+        }
+
+        // Fade out of the half blended pose rather than the old target
+        bool frozen = false;
+        if (fade_elapsed_ < fade_duration_) {
+            const auto cur = this->make_blend_input(
+                clock, selection_, deferred_data_
+            );
+            if (cur) {
+                if (auto pose = this->blend_fade(*cur, clock, false)) {
+                    frozen_pose_ = *pose;
+                    frozen = true;
+                }
+            }
+        }
+
+        use_frozen_pose_ = frozen;
+        fade_elapsed_ = 0;
+        prev_selection_ = selection_;
+        prev_deferred_data_ = deferred_data_;
+        fade_duration_ = duration;
+    }
+
+    const AnimPose* SkinAnimState::blend_fade(
+        const AnimBlendInput& cur, const clock_t& clock, const bool skip_leaves
+    ) {
+        std::array<AnimBlendInput, 2> inputs;
+        size_t input_count = 0;
+        inputs[input_count++] = cur;
+
+        if (fade_elapsed_ < fade_duration_) {
+            std::optional<AnimBlendInput> prev;
+            if (use_frozen_pose_) {
+                prev.emplace().pose_ = &frozen_pose_;
+            } else {
+                prev = this->make_blend_input(
+                    clock, prev_selection_, prev_deferred_data_
+                );
+            }
+
+            if (prev) {
+                const auto w = fade_elapsed_ / fade_duration_;
+                inputs[0].weight_ = static_cast<float>(w);
+                prev->weight_ = static_cast<float>(1.0 - w);
+                inputs[input_count++] = *prev;
+            }
+        }
+
+        return blender_.blend(
+            *skel_anim_, inputs.data(), input_count, skip_leaves
+        );
+    }
+
+    std::optional<AnimBlendInput> SkinAnimState::make_blend_input(
+        const clock_t& clock,
+        const AnimSelection& selection,
+        const DeferredData& deferred
+    ) const {
+        const auto anim_idx = deferred.anim_index();
+        if (!anim_idx)
+            return std::nullopt;
+        const auto anim_duration = deferred.anim_duration();
+        if (!anim_duration)
+            return std::nullopt;
+
+        const auto tick = this->calc_tick(clock, selection, deferred);
+
+        AnimBlendInput out;
+        out.anim_idx_ = *anim_idx;
+        out.tick_ = ::mod_tick(tick, 0, anim_duration.value());
+        return out;
+    }
+
     double SkinAnimState::calc_tick(
         const clock_t& clock,
         const SkinAnimState::AnimSelection& selection,
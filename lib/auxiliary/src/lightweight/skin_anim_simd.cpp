@@ -0,0 +1,351 @@
+#include "skin_anim_simd.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #define MIRINAE_SIMD_SSE
+    #include <emmintrin.h>
+#endif
+
+
+#ifdef MIRINAE_SIMD_SSE
+
+namespace {
+
+    __m128 select_mask(__m128 mask, __m128 if_true, __m128 if_false) {
+        return _mm_or_ps(
+            _mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false)
+        );
+    }
+
+    __m128 madd(__m128 a, __m128 b, __m128 c) {
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+
+    // Abramowitz and Stegun 4.4.46, valid in [0, 1]
+    __m128 acos_unit(__m128 x) {
+        auto p = _mm_set1_ps(-0.0012624911f);
+        p = madd(p, x, _mm_set1_ps(0.0066700901f));
+        p = madd(p, x, _mm_set1_ps(-0.0170881256f));
+        p = madd(p, x, _mm_set1_ps(0.0308918810f));
+        p = madd(p, x, _mm_set1_ps(-0.0501743046f));
+        p = madd(p, x, _mm_set1_ps(0.0889789874f));
+        p = madd(p, x, _mm_set1_ps(-0.2145988016f));
+        p = madd(p, x, _mm_set1_ps(1.5707963050f));
+
+        const auto one_minus = _mm_max_ps(
+            _mm_sub_ps(_mm_set1_ps(1), x), _mm_setzero_ps()
+        );
+        return _mm_mul_ps(_mm_sqrt_ps(one_minus), p);
+    }
+
+    // Taylor series, valid in [0, pi/2]
+    __m128 sin_half_pi(__m128 x) {
+        const auto x2 = _mm_mul_ps(x, x);
+        auto p = _mm_set1_ps(-1.f / 39916800.f);
+        p = madd(p, x2, _mm_set1_ps(1.f / 362880.f));
+        p = madd(p, x2, _mm_set1_ps(-1.f / 5040.f));
+        p = madd(p, x2, _mm_set1_ps(1.f / 120.f));
+        p = madd(p, x2, _mm_set1_ps(-1.f / 6.f));
+        p = madd(p, x2, _mm_set1_ps(1.f));
+        return _mm_mul_ps(p, x);
+    }
+
+}  // namespace
+
+
+namespace mirinae::simd {
+
+    void lerp(float* a, const float* b, const float* f, size_t count) {
+        for (size_t i = 0; i < count; i += WIDTH) {
+            const auto va = _mm_loadu_ps(a + i);
+            const auto vb = _mm_loadu_ps(b + i);
+            const auto vf = _mm_loadu_ps(f + i);
+            _mm_storeu_ps(a + i, madd(vf, _mm_sub_ps(vb, va), va));
+        }
+    }
+
+    void slerp(
+        float* xx,
+        float* xy,
+        float* xz,
+        float* xw,
+        const float* yx,
+        const float* yy,
+        const float* yz,
+        const float* yw,
+        const float* f,
+        size_t count
+    ) {
+        const auto zero = _mm_setzero_ps();
+        const auto one = _mm_set1_ps(1);
+        const auto sign_bit = _mm_set1_ps(-0.f);
+        const auto lerp_threshold = _mm_set1_ps(
+            1.f - std::numeric_limits<float>::epsilon()
+        );
+
+        for (size_t i = 0; i < count; i += WIDTH) {
+            const auto ax = _mm_loadu_ps(xx + i);
+            const auto ay = _mm_loadu_ps(xy + i);
+            const auto az = _mm_loadu_ps(xz + i);
+            const auto aw = _mm_loadu_ps(xw + i);
+            auto bx = _mm_loadu_ps(yx + i);
+            auto by = _mm_loadu_ps(yy + i);
+            auto bz = _mm_loadu_ps(yz + i);
+            auto bw = _mm_loadu_ps(yw + i);
+            const auto t = _mm_loadu_ps(f + i);
+
+            auto cos_theta = _mm_mul_ps(ax, bx);
+            cos_theta = madd(ay, by, cos_theta);
+            cos_theta = madd(az, bz, cos_theta);
+            cos_theta = madd(aw, bw, cos_theta);
+
+            // Take the shorter path
+            const auto flip = _mm_and_ps(
+                _mm_cmplt_ps(cos_theta, zero), sign_bit
+            );
+            cos_theta = _mm_xor_ps(cos_theta, flip);
+            bx = _mm_xor_ps(bx, flip);
+            by = _mm_xor_ps(by, flip);
+            bz = _mm_xor_ps(bz, flip);
+            bw = _mm_xor_ps(bw, flip);
+
+            const auto one_minus_t = _mm_sub_ps(one, t);
+            const auto angle = ::acos_unit(cos_theta);
+            const auto sin_angle = ::sin_half_pi(angle);
+            const auto s0 = ::sin_half_pi(_mm_mul_ps(one_minus_t, angle));
+            const auto s1 = ::sin_half_pi(_mm_mul_ps(t, angle));
+
+            // Nearly identical rotations fall back to linear interpolation
+            const auto use_lerp = _mm_cmpgt_ps(cos_theta, lerp_threshold);
+            const auto k0 = ::select_mask(
+                use_lerp, one_minus_t, _mm_div_ps(s0, sin_angle)
+            );
+            const auto k1 = ::select_mask(
+                use_lerp, t, _mm_div_ps(s1, sin_angle)
+            );
+
+            _mm_storeu_ps(xx + i, madd(k0, ax, _mm_mul_ps(k1, bx)));
+            _mm_storeu_ps(xy + i, madd(k0, ay, _mm_mul_ps(k1, by)));
+            _mm_storeu_ps(xz + i, madd(k0, az, _mm_mul_ps(k1, bz)));
+            _mm_storeu_ps(xw + i, madd(k0, aw, _mm_mul_ps(k1, bw)));
+        }
+    }
+
+    void nlerp(
+        float* xx,
+        float* xy,
+        float* xz,
+        float* xw,
+        const float* yx,
+        const float* yy,
+        const float* yz,
+        const float* yw,
+        const float* f,
+        size_t count
+    ) {
+        const auto zero = _mm_setzero_ps();
+        const auto one = _mm_set1_ps(1);
+        const auto sign_bit = _mm_set1_ps(-0.f);
+
+        for (size_t i = 0; i < count; i += WIDTH) {
+            const auto ax = _mm_loadu_ps(xx + i);
+            const auto ay = _mm_loadu_ps(xy + i);
+            const auto az = _mm_loadu_ps(xz + i);
+            const auto aw = _mm_loadu_ps(xw + i);
+            const auto t = _mm_loadu_ps(f + i);
+
+            auto cos_theta = _mm_mul_ps(ax, _mm_loadu_ps(yx + i));
+            cos_theta = madd(ay, _mm_loadu_ps(yy + i), cos_theta);
+            cos_theta = madd(az, _mm_loadu_ps(yz + i), cos_theta);
+            cos_theta = madd(aw, _mm_loadu_ps(yw + i), cos_theta);
+
+            // Negating the weight of y is the same as negating y
+            const auto flip = _mm_and_ps(
+                _mm_cmplt_ps(cos_theta, zero), sign_bit
+            );
+            const auto k0 = _mm_sub_ps(one, t);
+            const auto k1 = _mm_xor_ps(t, flip);
+
+            auto rx = madd(k0, ax, _mm_mul_ps(k1, _mm_loadu_ps(yx + i)));
+            auto ry = madd(k0, ay, _mm_mul_ps(k1, _mm_loadu_ps(yy + i)));
+            auto rz = madd(k0, az, _mm_mul_ps(k1, _mm_loadu_ps(yz + i)));
+            auto rw = madd(k0, aw, _mm_mul_ps(k1, _mm_loadu_ps(yw + i)));
+
+            auto len_sq = _mm_mul_ps(rx, rx);
+            len_sq = madd(ry, ry, len_sq);
+            len_sq = madd(rz, rz, len_sq);
+            len_sq = madd(rw, rw, len_sq);
+            const auto inv_len = _mm_div_ps(one, _mm_sqrt_ps(len_sq));
+
+            _mm_storeu_ps(xx + i, _mm_mul_ps(rx, inv_len));
+            _mm_storeu_ps(xy + i, _mm_mul_ps(ry, inv_len));
+            _mm_storeu_ps(xz + i, _mm_mul_ps(rz, inv_len));
+            _mm_storeu_ps(xw + i, _mm_mul_ps(rw, inv_len));
+        }
+    }
+
+    void compose_trs(const AnimPose& pose, glm::mat4* out, size_t count) {
+        const auto zero = _mm_setzero_ps();
+        const auto one = _mm_set1_ps(1);
+        const auto two = _mm_set1_ps(2);
+
+        for (size_t base = 0; base < count; base += WIDTH) {
+            const auto qx = _mm_loadu_ps(pose.rx_.data() + base);
+            const auto qy = _mm_loadu_ps(pose.ry_.data() + base);
+            const auto qz = _mm_loadu_ps(pose.rz_.data() + base);
+            const auto qw = _mm_loadu_ps(pose.rw_.data() + base);
+            const auto s = _mm_loadu_ps(pose.s_.data() + base);
+
+            const auto xx = _mm_mul_ps(qx, qx);
+            const auto yy = _mm_mul_ps(qy, qy);
+            const auto zz = _mm_mul_ps(qz, qz);
+            const auto xy = _mm_mul_ps(qx, qy);
+            const auto xz = _mm_mul_ps(qx, qz);
+            const auto yz = _mm_mul_ps(qy, qz);
+            const auto wx = _mm_mul_ps(qw, qx);
+            const auto wy = _mm_mul_ps(qw, qy);
+            const auto wz = _mm_mul_ps(qw, qz);
+            const auto s2 = _mm_mul_ps(two, s);
+
+            // Columns of translate * mat4_cast(q) * scale, one joint per lane
+            __m128 c0[4] = {
+                _mm_sub_ps(s, _mm_mul_ps(s2, _mm_add_ps(yy, zz))),
+                _mm_mul_ps(s2, _mm_add_ps(xy, wz)),
+                _mm_mul_ps(s2, _mm_sub_ps(xz, wy)),
+                zero,
+            };
+            __m128 c1[4] = {
+                _mm_mul_ps(s2, _mm_sub_ps(xy, wz)),
+                _mm_sub_ps(s, _mm_mul_ps(s2, _mm_add_ps(xx, zz))),
+                _mm_mul_ps(s2, _mm_add_ps(yz, wx)),
+                zero,
+            };
+            __m128 c2[4] = {
+                _mm_mul_ps(s2, _mm_add_ps(xz, wy)),
+                _mm_mul_ps(s2, _mm_sub_ps(yz, wx)),
+                _mm_sub_ps(s, _mm_mul_ps(s2, _mm_add_ps(xx, yy))),
+                zero,
+            };
+            __m128 c3[4] = {
+                _mm_loadu_ps(pose.tx_.data() + base),
+                _mm_loadu_ps(pose.ty_.data() + base),
+                _mm_loadu_ps(pose.tz_.data() + base),
+                one,
+            };
+
+            _MM_TRANSPOSE4_PS(c0[0], c0[1], c0[2], c0[3]);
+            _MM_TRANSPOSE4_PS(c1[0], c1[1], c1[2], c1[3]);
+            _MM_TRANSPOSE4_PS(c2[0], c2[1], c2[2], c2[3]);
+            _MM_TRANSPOSE4_PS(c3[0], c3[1], c3[2], c3[3]);
+
+            const auto lanes = std::min(WIDTH, count - base);
+            for (size_t lane = 0; lane < lanes; lane++) {
+                auto dst = &out[base + lane][0][0];
+                _mm_storeu_ps(dst + 0, c0[lane]);
+                _mm_storeu_ps(dst + 4, c1[lane]);
+                _mm_storeu_ps(dst + 8, c2[lane]);
+                _mm_storeu_ps(dst + 12, c3[lane]);
+            }
+        }
+    }
+
+    void mul_mat4(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+        const auto a0 = _mm_loadu_ps(&a[0][0]);
+        const auto a1 = _mm_loadu_ps(&a[1][0]);
+        const auto a2 = _mm_loadu_ps(&a[2][0]);
+        const auto a3 = _mm_loadu_ps(&a[3][0]);
+
+        __m128 cols[4];
+        for (int i = 0; i < 4; i++) {
+            auto r = _mm_mul_ps(a0, _mm_set1_ps(b[i][0]));
+            r = madd(a1, _mm_set1_ps(b[i][1]), r);
+            r = madd(a2, _mm_set1_ps(b[i][2]), r);
+            r = madd(a3, _mm_set1_ps(b[i][3]), r);
+            cols[i] = r;
+        }
+
+        for (int i = 0; i < 4; i++)
+            _mm_storeu_ps(&out[i][0], cols[i]);
+    }
+
+}  // namespace mirinae::simd
+
+#else
+
+namespace mirinae::simd {
+
+    void lerp(float* a, const float* b, const float* f, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            a[i] += f[i] * (b[i] - a[i]);
+    }
+
+    void slerp(
+        float* xx,
+        float* xy,
+        float* xz,
+        float* xw,
+        const float* yx,
+        const float* yy,
+        const float* yz,
+        const float* yw,
+        const float* f,
+        size_t count
+    ) {
+        for (size_t i = 0; i < count; i++) {
+            const glm::quat x{ xw[i], xx[i], xy[i], xz[i] };
+            const glm::quat y{ yw[i], yx[i], yy[i], yz[i] };
+            const auto q = glm::slerp(x, y, f[i]);
+            xx[i] = q.x;
+            xy[i] = q.y;
+            xz[i] = q.z;
+            xw[i] = q.w;
+        }
+    }
+
+    void nlerp(
+        float* xx,
+        float* xy,
+        float* xz,
+        float* xw,
+        const float* yx,
+        const float* yy,
+        const float* yz,
+        const float* yw,
+        const float* f,
+        size_t count
+    ) {
+        for (size_t i = 0; i < count; i++) {
+            const glm::quat x{ xw[i], xx[i], xy[i], xz[i] };
+            glm::quat y{ yw[i], yx[i], yy[i], yz[i] };
+            if (glm::dot(x, y) < 0)
+                y = -y;
+
+            const auto q = glm::normalize(x * (1 - f[i]) + y * f[i]);
+            xx[i] = q.x;
+            xy[i] = q.y;
+            xz[i] = q.z;
+            xw[i] = q.w;
+        }
+    }
+
+    void compose_trs(const AnimPose& pose, glm::mat4* out, size_t count) {
+        const glm::mat4 identity{ 1 };
+        for (size_t i = 0; i < count; i++) {
+            const auto t = glm::translate(identity, pose.translation(i));
+            const auto r = glm::mat4_cast(pose.rotation(i));
+            const auto s = glm::scale(identity, glm::vec3{ pose.s_[i] });
+            out[i] = t * r * s;
+        }
+    }
+
+    void mul_mat4(const glm::mat4& a, const glm::mat4& b, glm::mat4& out) {
+        out = a * b;
+    }
+
+}  // namespace mirinae::simd
+
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+
+#include "mirinae/lightweight/skin_anim.hpp"
+
+
+// Batch kernels for the skinning path. Array lengths must be a multiple of
+// `WIDTH`, which `AnimPose` guarantees with its padding.
+namespace mirinae::simd {
+
+    constexpr size_t WIDTH = 4;
+
+    constexpr size_t round_up(size_t count) {
+        return (count + WIDTH - 1) / WIDTH * WIDTH;
+    }
+
+    // a = a + f * (b - a)
+    void lerp(float* a, const float* b, const float* f, size_t count);
+
+    // Same as glm::slerp, writes the result to x
+    void slerp(
+        float* xx,
+        float* xy,
+        float* xz,
+        float* xw,
+        const float* yx,
+        const float* yy,
+        const float* yz,
+        const float* yw,
+        const float* f,
+        size_t count
+    );
+
+    // Normalized lerp along the shorter path, writes the result to x
+    void nlerp(
+        float* xx,
+        float* xy,
+        float* xz,
+        float* xw,
+        const float* yx,
+        const float* yy,
+        const float* yz,
+        const float* yw,
+        const float* f,
+        size_t count
+    );
+
+    // Same as translate * mat4_cast(rotate) * scale, writes `count` matrices
+    void compose_trs(const AnimPose& pose, glm::mat4* out, size_t count);
+
+    void mul_mat4(const glm::mat4& a, const glm::mat4& b, glm::mat4& out);
+
+}  // namespace mirinae::simd
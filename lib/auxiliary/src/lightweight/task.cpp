@@ -1,10 +1,105 @@
 #include "mirinae/lightweight/task.hpp"
 
+#include <algorithm>
+#include <functional>
+#include <queue>
+
 #include "mirinae/lightweight/include_spdlog.hpp"
+#include "mirinae/lightweight/profiler.hpp"
+
+
+namespace {
+
+    template <typename T, typename U>
+    bool contains(const std::vector<T>& list, const U& x) {
+        return std::find(list.begin(), list.end(), x) != list.end();
+    }
+
+    // Kahn's algorithm over the edges implied by the access sets. Conflicting
+    // tasks keep their registration order unless data flow says otherwise.
+    // Returns false if there is a cycle, leaving those out of `order`.
+    bool sort_by_access(
+        const std::vector<const mirinae::AccessSet*>& sets,
+        std::vector<std::vector<size_t>>& preds,
+        std::vector<size_t>& order
+    ) {
+        const auto n = sets.size();
+        std::vector<std::vector<size_t>> succs(n);
+        preds.assign(n, {});
+
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = i + 1; j < n; ++j) {
+                auto& a = *sets[i];
+                auto& b = *sets[j];
+                if (!a.conflicts_with(b))
+                    continue;
+
+                const auto backward = b.must_precede(a);
+                if (a.must_precede(b) || !backward) {
+                    succs[i].push_back(j);
+                    preds[j].push_back(i);
+                }
+                if (backward) {
+                    succs[j].push_back(i);
+                    preds[i].push_back(j);
+                }
+            }
+        }
+
+        std::vector<size_t> in_degree(n);
+        std::priority_queue<size_t, std::vector<size_t>, std::greater<>> ready;
+        for (size_t i = 0; i < n; ++i) {
+            in_degree[i] = preds[i].size();
+            if (0 == in_degree[i])
+                ready.push(i);
+        }
+
+        // Ties go to the earliest registered
+        order.clear();
+        order.reserve(n);
+        while (!ready.empty()) {
+            const auto i = ready.top();
+            ready.pop();
+            order.push_back(i);
+            for (auto s : succs[i]) {
+                if (0 == --in_degree[s])
+                    ready.push(s);
+            }
+        }
+
+        return order.size() == n;
+    }
+
+    template <typename TFunc>
+    std::string list_unsorted(
+        size_t count, const std::vector<size_t>& order, TFunc&& get_name
+    ) {
+        std::string out;
+        for (size_t i = 0; i < count; ++i) {
+            if (::contains(order, i))
+                continue;
+            if (!out.empty())
+                out += ", ";
+            out += get_name(i);
+        }
+        return out;
+    }
+
+}  // namespace
 
 
 namespace mirinae {
 
+    void DependingTask::succeed_all(
+        const std::vector<const enki::ICompletable*>& prev
+    ) {
+        deps_.resize(prev.size());
+        for (size_t i = 0; i < prev.size(); ++i) {
+            assert(prev[i] != this);
+            deps_[i].SetDependency(prev[i], this);
+        }
+    }
+
     void DependingTask::set_size(uint32_t size) { m_SetSize = size; }
 
     void DependingTask::set_size(uint64_t size) {
@@ -20,10 +115,350 @@ namespace mirinae {
     void FenceTask::ExecuteRange(enki::TaskSetPartition range, uint32_t tid) {}
 
 
+    void StampTask::ExecuteRange(enki::TaskSetPartition range, uint32_t tid) {
+        time_ = std::chrono::steady_clock::now();
+    }
+
+
+    void AccessSet::add_read(std::string_view resource) {
+        reads_.emplace_back(resource);
+    }
+
+    void AccessSet::add_write(std::string_view resource) {
+        writes_.emplace_back(resource);
+    }
+
+    void AccessSet::add_read_last_frame(std::string_view resource) {
+        last_frame_reads_.emplace_back(resource);
+    }
+
+    void AccessSet::add_read_buffered(std::string_view resource) {
+        buffered_reads_.emplace_back(resource);
+    }
+
+    bool AccessSet::empty() const {
+        return reads_.empty() && writes_.empty() &&
+               last_frame_reads_.empty() && buffered_reads_.empty();
+    }
+
+    bool AccessSet::conflicts_with(const AccessSet& other) const {
+        if (this->empty() || other.empty())
+            return true;
+
+        for (auto& w : writes_) {
+            if (::contains(other.writes_, w) || ::contains(other.reads_, w))
+                return true;
+            if (::contains(other.last_frame_reads_, w))
+                return true;
+        }
+        for (auto& r : reads_) {
+            if (::contains(other.writes_, r))
+                return true;
+        }
+        for (auto& r : last_frame_reads_) {
+            if (::contains(other.writes_, r))
+                return true;
+        }
+        return false;
+    }
+
+    bool AccessSet::must_precede(const AccessSet& other) const {
+        for (auto& w : writes_) {
+            if (::contains(other.reads_, w) && !::contains(other.writes_, w))
+                return true;
+        }
+        for (auto& r : last_frame_reads_) {
+            if (::contains(other.writes_, r))
+                return true;
+        }
+        return false;
+    }
+
+
+    StageTask& StageTask::reads(std::string_view resource) {
+        access_.add_read(resource);
+        return *this;
+    }
+
+    StageTask& StageTask::writes(std::string_view resource) {
+        access_.add_write(resource);
+        return *this;
+    }
+
+    StageTask& StageTask::reads_last_frame(std::string_view resource) {
+        access_.add_read_last_frame(resource);
+        return *this;
+    }
+
+    StageTask& StageTask::reads_buffered(std::string_view resource) {
+        access_.add_read_buffered(resource);
+        return *this;
+    }
+
+    StageTask& StageTask::after_sync() {
+        after_sync_ = true;
+        return *this;
+    }
+
+
+    TaskLinker& TaskLinker::add(
+        std::string_view name,
+        DependingTask& task,
+        std::initializer_list<std::string_view> reads,
+        std::initializer_list<std::string_view> writes
+    ) {
+        auto& node = *nodes_.emplace_back(std::make_unique<Node>());
+        node.name_ = profiler().intern(name);
+        node.task_ = &task;
+        for (auto r : reads) node.access_.add_read(r);
+        for (auto w : writes) node.access_.add_write(w);
+        return *this;
+    }
+
+    void TaskLinker::link(
+        const enki::ICompletable& start, DependingTask& fence
+    ) {
+        std::vector<const AccessSet*> sets;
+        for (auto& node : nodes_) sets.push_back(&node->access_);
+
+        std::vector<std::vector<size_t>> preds;
+        std::vector<size_t> order;
+        if (!::sort_by_access(sets, preds, order)) {
+            MIRINAE_ABORT(
+                "Cycle among tasks: {}",
+                ::list_unsorted(nodes_.size(), order, [this](size_t i) {
+                    return nodes_[i]->name_;
+                })
+            );
+        }
+
+        std::vector<const enki::ICompletable*> ends;
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            auto& node = *nodes_[i];
+
+            std::vector<const enki::ICompletable*> pred_ends;
+            for (auto p : preds[i]) pred_ends.push_back(&nodes_[p]->end_);
+            if (pred_ends.empty())
+                pred_ends.push_back(&start);
+
+            node.begin_.succeed_all(pred_ends);
+            node.task_->succeed(&node.begin_);
+            node.end_.succeed(node.task_);
+            ends.push_back(&node.end_);
+        }
+
+        record_.linker_ = this;
+        record_.succeed_all(ends);
+        fence.succeed(&record_);
+    }
+
+    void TaskLinker::link(StageTask& stage, DependingTask& fence) {
+        stage.linker_ = this;
+        this->link(static_cast<const enki::ICompletable&>(stage), fence);
+    }
+
+    std::vector<TaskLinker::TaskTime> TaskLinker::times() const {
+        std::vector<TaskTime> out;
+        out.reserve(nodes_.size());
+        for (auto& node : nodes_) {
+            auto& t = out.emplace_back();
+            t.name_ = node->name_;
+            t.begin_ = node->begin_.time_;
+            t.end_ = node->end_.time_;
+        }
+        return out;
+    }
+
+    void TaskLinker::RecordTask::ExecuteRange(
+        enki::TaskSetPartition range, uint32_t tid
+    ) {
+        for (auto& node : linker_->nodes_) {
+            profiler().record(
+                node->name_, node->begin_.time_, node->end_.time_, node->name_
+            );
+        }
+    }
+
+
     void TaskGraph::start() {
+        if (!built_) {
+            this->wait_all();
+            this->build();
+        }
+
+        this->wait_group(before_sync_);
+        if (crosses_sync_)
+            this->wait_group(after_sync_);
+        before_sync_.frame_start_ = clock_t::now();
+        this->run_group(before_sync_);
+    }
+
+    void TaskGraph::start_after_sync() {
+        if (!built_) {
+            this->wait_all();
+            this->build();
+        }
+
+        this->wait_group(after_sync_);
+        // Belongs to the frame started last
+        after_sync_.frame_start_ = before_sync_.frame_start_;
+        this->run_group(after_sync_);
+    }
+
+    void TaskGraph::wait_all() {
+        this->wait_group(before_sync_);
+        this->wait_group(after_sync_);
+    }
+
+    void TaskGraph::set_pipelined(bool pipelined) {
+        if (pipelined == pipelined_)
+            return;
+
+        this->wait_all();
+        pipelined_ = pipelined;
+        built_ = false;
+    }
+
+    std::vector<TaskGraph::StageTiming> TaskGraph::timings() const {
+        std::vector<StageTiming> out;
+        out.reserve(stages_.size());
         for (auto& stage : stages_) {
-            dal::tasker().AddTaskSetToPipe(stage.task_.get());
-            dal::tasker().WaitforTask(stage.task_->get_fence());
+            if (!stage.node_)
+                continue;
+
+            const auto& group = stage.task_->is_after_sync() ? after_sync_
+                                                             : before_sync_;
+            const auto to_ms = [&group](clock_t::time_point t) {
+                using ms_t = std::chrono::duration<double, std::milli>;
+                const auto d = t - group.frame_start_;
+                return std::chrono::duration_cast<ms_t>(d).count();
+            };
+
+            auto& timing = out.emplace_back();
+            timing.name_ = stage.task_->name();
+            timing.begin_ = to_ms(stage.node_->begin_.time_);
+            timing.end_ = to_ms(stage.node_->end_.time_);
+
+            const auto linker = stage.task_->linker();
+            if (!linker)
+                continue;
+            for (auto& t : linker->times()) {
+                auto& task_timing = out.emplace_back();
+                task_timing.name_ = fmt::format(
+                    "{} / {}", stage.task_->name(), t.name_
+                );
+                task_timing.begin_ = to_ms(t.begin_);
+                task_timing.end_ = to_ms(t.end_);
+            }
+        }
+        return out;
+    }
+
+    void TaskGraph::run_group(Group& group) {
+        if (!pipelined_) {
+            for (auto i : group.order_) {
+                auto& stage = stages_[i];
+                auto& node = *stage.node_;
+                node.begin_.time_ = clock_t::now();
+                dal::tasker().AddTaskSetToPipe(stage.task_.get());
+                dal::tasker().WaitforTask(stage.task_->get_fence());
+                node.end_.time_ = clock_t::now();
+            }
+            this->record_profile(group);
+            return;
+        }
+
+        // The others are started by their dependencies
+        group.running_ = true;
+        for (auto i : group.order_) {
+            auto& node = *stages_[i].node_;
+            if (node.preds_.empty())
+                dal::tasker().AddTaskSetToPipe(&node.begin_);
+        }
+    }
+
+    void TaskGraph::wait_group(Group& group) {
+        if (!group.running_)
+            return;
+
+        for (auto i : group.order_)
+            dal::tasker().WaitforTask(&stages_[i].node_->end_);
+        group.running_ = false;
+        this->record_profile(group);
+    }
+
+    void TaskGraph::record_profile(const Group& group) const {
+        // Each on its own track since pipelined stages overlap
+        for (auto i : group.order_) {
+            auto& node = *stages_[i].node_;
+            profiler().record(
+                node.name_, node.begin_.time_, node.end_.time_, node.name_
+            );
+        }
+    }
+
+    void TaskGraph::build() {
+        // Replacing the nodes also clears the old links
+        for (auto& stage : stages_) {
+            stage.node_ = std::make_unique<StageNode>();
+            stage.node_->name_ = profiler().intern(stage.task_->name());
+        }
+
+        this->sort_group(before_sync_, false);
+        this->sort_group(after_sync_, true);
+
+        crosses_sync_ = false;
+        for (auto i : before_sync_.order_) {
+            auto& access = stages_[i].task_->access();
+            for (auto j : after_sync_.order_) {
+                if (access.conflicts_with(stages_[j].task_->access()))
+                    crosses_sync_ = true;
+            }
+        }
+
+        built_ = true;
+    }
+
+    void TaskGraph::sort_group(Group& group, bool after_sync) {
+        std::vector<size_t> indices;
+        std::vector<const AccessSet*> sets;
+        for (size_t i = 0; i < stages_.size(); ++i) {
+            if (stages_[i].task_->is_after_sync() != after_sync)
+                continue;
+            indices.push_back(i);
+            sets.push_back(&stages_[i].task_->access());
+        }
+
+        std::vector<std::vector<size_t>> preds;
+        std::vector<size_t> order;
+        if (!::sort_by_access(sets, preds, order)) {
+            MIRINAE_ABORT(
+                "Cycle among stages: {}",
+                ::list_unsorted(indices.size(), order, [&](size_t i) {
+                    return stages_[indices[i]].task_->name();
+                })
+            );
+        }
+
+        group.order_.clear();
+        for (auto i : order) group.order_.push_back(indices[i]);
+
+        if (!pipelined_)
+            return;
+
+        for (size_t i = 0; i < indices.size(); ++i) {
+            auto& stage = stages_[indices[i]];
+            auto& node = *stage.node_;
+            node.preds_.clear();
+            for (auto p : preds[i]) node.preds_.push_back(indices[p]);
+
+            std::vector<const enki::ICompletable*> pred_stamps;
+            for (auto j : node.preds_)
+                pred_stamps.push_back(&stages_[j].node_->end_);
+
+            node.begin_.succeed_all(pred_stamps);
+            node.stage_dep_.SetDependency(&node.begin_, stage.task_.get());
+            node.end_.succeed(stage.task_->get_fence());
         }
     }
 
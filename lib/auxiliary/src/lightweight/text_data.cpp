@@ -88,11 +88,13 @@ namespace {
     public:
         bool append(char c) override {
             this->last_valid_block().append(static_cast<char32_t>(c));
+            ++revision_;
             return true;
         }
 
         bool append(char32_t c) override {
             this->last_valid_block().append(c);
+            ++revision_;
             return true;
         }
 
@@ -101,10 +103,12 @@ namespace {
             for (auto c : str32) {
                 this->last_valid_block().append(c);
             }
+            ++revision_;
             return true;
         }
 
         bool pop_back() override {
+            ++revision_;
             const auto block_count = blocks_.size();
             for (size_t i = 0; i < block_count; ++i) {
                 auto& block = blocks_[block_count - i - 1];
@@ -120,9 +124,12 @@ namespace {
 
         bool clear() override {
             blocks_.clear();
+            ++revision_;
             return true;
         }
 
+        uint64_t revision() const override { return revision_; }
+
         std::string make_str() const override {
             const auto str32 = this->make_str32();
             return una::utf32to8(str32);
@@ -151,6 +158,7 @@ namespace {
         }
 
         std::vector<TextBlock> blocks_;
+        uint64_t revision_ = 0;
     };
 
 
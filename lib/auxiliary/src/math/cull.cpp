@@ -0,0 +1,188 @@
+#include "mirinae/math/cull.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #define MIRINAE_SIMD_SSE
+    #include <emmintrin.h>
+#endif
+
+
+namespace {
+
+    glm::dvec4 get_row(const glm::dmat4& m, int i) {
+        return glm::dvec4{ m[0][i], m[1][i], m[2][i], m[3][i] };
+    }
+
+    glm::vec4 normalize_plane(const glm::dvec4& p) {
+        const auto len = glm::length(glm::dvec3{ p });
+        // Degenerate planes, e.g. far plane of an infinite projection
+        if (len < 1e-12)
+            return glm::vec4{ 0, 0, 0, 1 };
+        return glm::vec4{ p / len };
+    }
+
+}  // namespace
+
+
+// BoundingSphere
+namespace mirinae {
+
+    BoundingSphere BoundingSphere::transform(const glm::dmat4& m) const {
+        const auto scale = std::max({
+            glm::length(glm::dvec3{ m[0] }),
+            glm::length(glm::dvec3{ m[1] }),
+            glm::length(glm::dvec3{ m[2] }),
+        });
+
+        BoundingSphere out;
+        out.center_ = glm::vec3{ m * glm::dvec4{ center_, 1 } };
+        out.radius_ = static_cast<float>(radius_ * scale);
+        return out;
+    }
+
+}  // namespace mirinae
+
+
+// FrustumPlanes
+namespace mirinae {
+
+    void FrustumPlanes::set(const glm::dmat4& clip, bool test_depth) {
+        const auto r0 = ::get_row(clip, 0);
+        const auto r1 = ::get_row(clip, 1);
+        const auto r2 = ::get_row(clip, 2);
+        const auto r3 = ::get_row(clip, 3);
+
+        count_ = 0;
+        planes_[count_++] = ::normalize_plane(r3 + r0);
+        planes_[count_++] = ::normalize_plane(r3 - r0);
+        planes_[count_++] = ::normalize_plane(r3 + r1);
+        planes_[count_++] = ::normalize_plane(r3 - r1);
+        if (test_depth) {
+            planes_[count_++] = ::normalize_plane(r2);
+            planes_[count_++] = ::normalize_plane(r3 - r2);
+        }
+    }
+
+    bool FrustumPlanes::test(const BoundingSphere& sphere) const {
+        for (size_t i = 0; i < count_; ++i) {
+            const auto& p = planes_[i];
+            const auto d = glm::dot(glm::vec3{ p }, sphere.center_) + p.w;
+            if (d < -sphere.radius_)
+                return false;
+        }
+        return true;
+    }
+
+}  // namespace mirinae
+
+
+// SphereBatch
+namespace mirinae {
+
+    void SphereBatch::clear() {
+        x_.clear();
+        y_.clear();
+        z_.clear();
+        r_.clear();
+        size_ = 0;
+    }
+
+    void SphereBatch::push_back(const BoundingSphere& sphere) {
+        if (size_ % WIDTH == 0) {
+            const auto padded = size_ + WIDTH;
+            x_.resize(padded, 0);
+            y_.resize(padded, 0);
+            z_.resize(padded, 0);
+            r_.resize(padded, 0);
+        }
+
+        ++size_;
+        this->set(size_ - 1, sphere);
+    }
+
+    void SphereBatch::set(size_t index, const BoundingSphere& sphere) {
+        x_[index] = sphere.center_.x;
+        y_[index] = sphere.center_.y;
+        z_[index] = sphere.center_.z;
+        r_[index] = sphere.radius_;
+    }
+
+    void SphereBatch::swap_remove(size_t index) {
+        const auto last = size_ - 1;
+        x_[index] = x_[last];
+        y_[index] = y_[last];
+        z_[index] = z_[last];
+        r_[index] = r_[last];
+
+        // Same as the padding written by `push_back`
+        x_[last] = 0;
+        y_[last] = 0;
+        z_[last] = 0;
+        r_[last] = 0;
+
+        --size_;
+        if (size_ % WIDTH == 0) {
+            x_.resize(size_);
+            y_.resize(size_);
+            z_.resize(size_);
+            r_.resize(size_);
+        }
+    }
+
+#ifdef MIRINAE_SIMD_SSE
+
+    void SphereBatch::cull(
+        const FrustumPlanes& frustum,
+        size_t block_begin,
+        size_t block_end,
+        uint8_t* out
+    ) const {
+        const auto zero = _mm_setzero_ps();
+
+        for (size_t b = block_begin; b < block_end; ++b) {
+            const auto base = b * WIDTH;
+            const auto x = _mm_loadu_ps(x_.data() + base);
+            const auto y = _mm_loadu_ps(y_.data() + base);
+            const auto z = _mm_loadu_ps(z_.data() + base);
+            const auto neg_r = _mm_sub_ps(
+                zero, _mm_loadu_ps(r_.data() + base)
+            );
+
+            auto inside = _mm_cmpeq_ps(zero, zero);
+            for (size_t i = 0; i < frustum.count_; ++i) {
+                const auto& p = frustum.planes_[i];
+                auto d = _mm_mul_ps(_mm_set1_ps(p.x), x);
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(p.y), y));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(p.z), z));
+                d = _mm_add_ps(d, _mm_set1_ps(p.w));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(d, neg_r));
+            }
+
+            const auto bits = _mm_movemask_ps(inside);
+            const auto lanes = std::min(WIDTH, size_ - base);
+            for (size_t lane = 0; lane < lanes; ++lane)
+                out[base + lane] = (bits >> lane) & 1;
+        }
+    }
+
+#else
+
+    void SphereBatch::cull(
+        const FrustumPlanes& frustum,
+        size_t block_begin,
+        size_t block_end,
+        uint8_t* out
+    ) const {
+        const auto end = std::min(block_end * WIDTH, size_);
+        for (size_t i = block_begin * WIDTH; i < end; ++i) {
+            BoundingSphere sphere;
+            sphere.center_ = glm::vec3{ x_[i], y_[i], z_[i] };
+            sphere.radius_ = r_[i];
+            out[i] = frustum.test(sphere) ? 1 : 0;
+        }
+    }
+
+#endif
+
+}  // namespace mirinae
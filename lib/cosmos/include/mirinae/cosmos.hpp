@@ -22,6 +22,7 @@ namespace mirinae {
         std::string anim_walk_;
         std::string anim_run_;
         std::string anim_sprint_;
+        double anim_fade_time_ = 0.2;  // Seconds
         sung::TAngle<double> player_model_heading_;
     };
 
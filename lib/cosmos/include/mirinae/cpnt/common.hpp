@@ -20,7 +20,8 @@ namespace mirinae {
             return dynamic_cast<const U*>(ren_unit_.get());
         }
 
-        std::unique_ptr<T> ren_unit_;
+        // Shared with the render state copied out for the renderer
+        std::shared_ptr<T> ren_unit_;
     };
 
 }  // namespace mirinae
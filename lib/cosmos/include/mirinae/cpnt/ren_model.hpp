@@ -58,6 +58,14 @@ namespace mirinae {
             hidden_.at(index) = !visible;
         }
 
+        bool operator==(const VisibilityArray& rhs) const {
+            return hidden_ == rhs.hidden_;
+        }
+
+        bool operator!=(const VisibilityArray& rhs) const {
+            return !(*this == rhs);
+        }
+
     private:
         constexpr static size_t MAX_SIZE = 128;
         std::vector<bool> hidden_;
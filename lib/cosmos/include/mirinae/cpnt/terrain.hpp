@@ -44,7 +44,8 @@ namespace mirinae::cpnt {
         int tile_count_y_;
 
         // Runtime data
-        std::unique_ptr<ITerrainRenUnit> ren_unit_;
+        // Shared with the render state copied out for the renderer
+        std::shared_ptr<ITerrainRenUnit> ren_unit_;
         double height_scale_;
         float tess_factor_;
     };
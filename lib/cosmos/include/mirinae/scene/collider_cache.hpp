@@ -0,0 +1,54 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+
+
+namespace mirinae {
+
+    class ColliderHasher {
+
+    public:
+        ColliderHasher& add(const void* data, size_t size);
+
+        template <typename T>
+        ColliderHasher& add(const T& value) {
+            return this->add(&value, sizeof(T));
+        }
+
+        uint64_t get() const { return hash_; }
+
+    private:
+        uint64_t hash_ = 0xcbf29ce484222325;
+    };
+
+
+    // Cooked Jolt shapes saved on disk. Each entry stores the hash of the
+    // source data it was cooked from and is ignored once that changes.
+    class ColliderCache {
+
+    public:
+        ColliderCache(const std::filesystem::path& dir);
+
+        // Returns null if there is no entry or it is outdated
+        JPH::Ref<JPH::Shape> load(
+            const std::string& key, uint64_t content_hash
+        ) const;
+
+        bool save(
+            const std::string& key,
+            uint64_t content_hash,
+            const JPH::Shape& shape
+        ) const;
+
+    private:
+        std::filesystem::path make_path(const std::string& key) const;
+
+        std::filesystem::path dir_;
+    };
+
+}  // namespace mirinae
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <filesystem>
 #include <memory>
 
 #include <entt/fwd.hpp>
+#include <sung/basic/threading.hpp>
 
 #include "mirinae/lightweight/debug_ren.hpp"
 
@@ -12,6 +14,17 @@ namespace mirinae {
     class TaskGraph;
 
 
+    struct PhysStepConfig {
+        double step_rate_ = 60;  // Hz
+        // Time beyond this many steps per frame is dropped
+        int max_substeps_ = 4;
+        // Steps with the raw frame time if false
+        bool fixed_step_ = true;
+        // Replaces the measured frame time if positive, for offline runs
+        double frame_dt_ = 0;
+    };
+
+
     class PhysWorld {
 
     public:
@@ -22,6 +35,13 @@ namespace mirinae {
 
         void optimize();
 
+        PhysStepConfig& step_config();
+
+        // Used for cooking colliders off the frame
+        void give_task_sche(sung::HTaskSche task_sche);
+        // Cooked colliders are saved in `dir` and reused on later runs
+        void give_collider_cache(const std::filesystem::path& dir);
+
         void give_debug_ren(IDebugRen& debug_ren);
         void remove_debug_ren();
 
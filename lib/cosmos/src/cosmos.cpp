@@ -168,6 +168,8 @@ namespace {
 
                 tgt_tform->pos_.y += vertical * dt * move_speed;
             }
+
+            reg.patch<cpnt::Transform>(target_);
         }
 
         void post_sync(
@@ -222,7 +224,7 @@ namespace {
                 return;
 
             last_anim_ = anim_name;
-            anim_state.select_anim_name(anim_name, clock);
+            anim_state.crossfade_anim_name(anim_name, anim_fade_time_, clock);
         }
 
         entt::entity target_ = entt::null;
@@ -250,15 +252,14 @@ namespace {
         TaskGlobalInit(mirinae::CosmosSimulator& cosmos)
             : StageTask("global init"), cosmos_(cosmos) {
             fence_.succeed(this);
+            // ImGui widgets may edit any component, so the engine runs them
+            // at the sync point instead
+            this->writes("clock");
         }
 
         void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
             cosmos_.tick_clock();
             cosmos_.scene().do_frame();
-
-            for (auto& imgui : cosmos_.imgui_) {
-                imgui->do_frame(cosmos_.scene().clock());
-            }
         }
 
         enki::ITaskSet* get_fence() override { return &fence_; }
@@ -282,6 +283,8 @@ namespace {
             , cosmos_(cosmos)
             , action_map_(action_map) {
             fence_.succeed(this);
+            this->reads("clock").reads("input");
+            this->writes("transform").writes("anim_state");
         }
 
         void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
@@ -311,11 +314,12 @@ namespace {
             , cosmos_(cosmos)
             , action_map_(action_map) {
             fence_.succeed(this);
+            this->reads("clock").reads("input");
+            this->writes("transform");
         }
 
         void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
             ctrl_->post_sync(cosmos_.scene(), action_map_);
-            action_map_.finish_frame();
         }
 
         enki::ITaskSet* get_fence() override { return &fence_; }
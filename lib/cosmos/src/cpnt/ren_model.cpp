@@ -64,6 +64,22 @@ namespace mirinae::cpnt {
             ImGui::Text("Current animation: %s", anim_name->c_str());
         }
 
+        if (ImGui::CollapsingHeader("Animation LOD")) {
+            auto& lod = anim.lod_;
+            ImGui::Indent(10);
+            ImGui::Checkbox("Enabled", &lod.enabled_);
+            ImGui::Checkbox("Extrapolate", &lod.extrapolate_);
+            ImGui::SliderFloat("Full rate above", &lod.full_rate_above_, 0, 1);
+            ImGui::SliderFloat("Half rate above", &lod.half_rate_above_, 0, 1);
+            ImGui::SliderFloat(
+                "Skip leaves below", &lod.skip_leaves_below_, 0, 1
+            );
+            ImGui::SliderFloat(
+                "Bounding radius", &lod.bounding_radius_, 0.01f, 100
+            );
+            ImGui::Unindent(10);
+        }
+
         if (ImGui::Button("Next animation")) {
             const auto anim_count = anim.anims().size();
             if (anim_count > 0) {
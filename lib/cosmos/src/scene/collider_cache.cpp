@@ -0,0 +1,144 @@
+#include "mirinae/scene/collider_cache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+#include <Jolt/Core/StreamWrapper.h>
+
+#include "mirinae/lightweight/include_spdlog.hpp"
+
+
+namespace {
+
+    constexpr char MAGIC[] = "MRNCOL01";
+    constexpr size_t MAGIC_SIZE = sizeof(MAGIC) - 1;
+
+    constexpr uint64_t FNV_PRIME = 0x100000001b3;
+
+}  // namespace
+
+
+// ColliderHasher
+namespace mirinae {
+
+    ColliderHasher& ColliderHasher::add(const void* data, size_t size) {
+        const auto bytes = static_cast<const uint8_t*>(data);
+
+        // FNV-1a over 8 byte words, source data can be tens of megabytes
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(uint64_t));
+            hash_ = (hash_ ^ word) * FNV_PRIME;
+        }
+        for (; i < size; ++i) hash_ = (hash_ ^ bytes[i]) * FNV_PRIME;
+
+        return *this;
+    }
+
+}  // namespace mirinae
+
+
+// ColliderCache
+namespace mirinae {
+
+    ColliderCache::ColliderCache(const std::filesystem::path& dir)
+        : dir_(dir) {
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+        if (ec) {
+            SPDLOG_WARN(
+                "Failed to create collider cache directory: {}", ec.message()
+            );
+        }
+    }
+
+    JPH::Ref<JPH::Shape> ColliderCache::load(
+        const std::string& key, uint64_t content_hash
+    ) const {
+        std::ifstream file(this->make_path(key), std::ios::binary);
+        if (!file)
+            return nullptr;
+
+        char magic[MAGIC_SIZE];
+        uint64_t stored_hash = 0;
+        file.read(magic, MAGIC_SIZE);
+        file.read(reinterpret_cast<char*>(&stored_hash), sizeof(stored_hash));
+        if (!file)
+            return nullptr;
+        if (0 != std::memcmp(magic, MAGIC, MAGIC_SIZE))
+            return nullptr;
+        if (stored_hash != content_hash)
+            return nullptr;
+
+        JPH::StreamInWrapper stream(file);
+        JPH::Shape::IDToShapeMap shape_map;
+        JPH::Shape::IDToMaterialMap mat_map;
+        auto res = JPH::Shape::sRestoreWithChildren(stream, shape_map, mat_map);
+        if (res.HasError()) {
+            SPDLOG_WARN(
+                "Failed to restore cached collider ({}): {}",
+                key,
+                res.GetError()
+            );
+            return nullptr;
+        }
+
+        return res.Get();
+    }
+
+    bool ColliderCache::save(
+        const std::string& key, uint64_t content_hash, const JPH::Shape& shape
+    ) const {
+        const auto path = this->make_path(key);
+
+        // Several tasks may cook the same collider at once
+        std::ostringstream tmp_name;
+        tmp_name << path.filename().string() << '.'
+                 << std::hash<std::thread::id>{}(std::this_thread::get_id())
+                 << ".tmp";
+        const auto tmp_path = path.parent_path() / tmp_name.str();
+
+        {
+            std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+            if (!file)
+                return false;
+
+            file.write(MAGIC, MAGIC_SIZE);
+            file.write(
+                reinterpret_cast<const char*>(&content_hash),
+                sizeof(content_hash)
+            );
+
+            JPH::StreamOutWrapper stream(file);
+            JPH::Shape::ShapeToIDMap shape_map;
+            JPH::Shape::MaterialToIDMap mat_map;
+            shape.SaveWithChildren(stream, shape_map, mat_map);
+            if (!file) {
+                SPDLOG_WARN("Failed to write cached collider: {}", key);
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        std::filesystem::rename(tmp_path, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmp_path, ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    std::filesystem::path ColliderCache::make_path(
+        const std::string& key
+    ) const {
+        const auto name_hash = ColliderHasher{}.add(key.data(), key.size());
+        return dir_ / fmt::format("{:016x}.jshape", name_hash.get());
+    }
+
+}  // namespace mirinae
@@ -1,5 +1,10 @@
 #include "mirinae/scene/jolt_job_sys.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
+
 #include <Jolt/Core/JobSystemWithBarrier.h>
 #include <dal/common/task_sys.hpp>
 #include <sung/basic/static_pool.hpp>
@@ -34,66 +39,143 @@ namespace {
     };
 
 
+    // Bounded MPMC queue after Dmitry Vyukov's design. Producers reserve
+    // slots with a single `fetch_add` so pushing never fails, as long as
+    // fewer than `N` items are in the queue at once.
+    template <typename T, size_t N>
+    class MpmcRing {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "N must be power of 2");
+
+    public:
+        MpmcRing() {
+            for (size_t i = 0; i < N; ++i)
+                cells_[i].seq_.store(i, std::memory_order_relaxed);
+        }
+
+        void push(const T* items, size_t count) {
+            auto pos = enq_pos_.fetch_add(count, std::memory_order_relaxed);
+            for (size_t i = 0; i < count; ++i, ++pos) {
+                auto& cell = cells_[pos & MASK];
+                // Only waits if a consumer has not yet released this slot
+                while (cell.seq_.load(std::memory_order_acquire) != pos)
+                    std::this_thread::yield();
+
+                cell.data_ = items[i];
+                cell.seq_.store(pos + 1, std::memory_order_release);
+            }
+        }
+
+        bool pop(T& out) {
+            auto pos = deq_pos_.load(std::memory_order_relaxed);
+            for (;;) {
+                auto& cell = cells_[pos & MASK];
+                const auto seq = cell.seq_.load(std::memory_order_acquire);
+                const auto diff = static_cast<intptr_t>(seq) -
+                                  static_cast<intptr_t>(pos + 1);
+
+                if (diff == 0) {
+                    if (deq_pos_.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed
+                        )) {
+                        out = cell.data_;
+                        cell.seq_.store(pos + N, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = deq_pos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+        constexpr static size_t MASK = N - 1;
+
+        struct Cell {
+            std::atomic<size_t> seq_;
+            T data_;
+        };
+
+        std::array<Cell, N> cells_;
+        alignas(64) std::atomic<size_t> enq_pos_ = 0;
+        alignas(64) std::atomic<size_t> deq_pos_ = 0;
+    };
+
+
     class JoltEnkiTaskSystem final : public JPH::JobSystemWithBarrier {
 
     private:
-        class JobTask : private enki::ITaskSet {
+        constexpr static size_t MAX_JOBS = 1024;
+        constexpr static size_t MAX_WORKERS = 64;
+
+        using JobQueue = MpmcRing<Job*, MAX_JOBS * 2>;
+
+        // Drains the queue until it is empty and then goes idle. Producers
+        // reschedule idle workers.
+        class Worker : private enki::ITaskSet {
 
         public:
-            bool try_exec(Job* inJob) {
-                {
-                    std::unique_lock<std::mutex> lock(mut_, std::try_to_lock);
-                    if (!lock.owns_lock())
-                        return false;
-                    if (job_)
-                        return false;
-
-                    this->try_join();
-                    this->set_job(inJob);
-                }
+            void init(JobQueue& queue) { queue_ = &queue; }
 
+            bool try_wake() {
+                auto expected = IDLE;
+                if (!state_.compare_exchange_strong(expected, SCHEDULED))
+                    return false;
+
+                // Finishing the loop below does not mean enki is done with us
+                if (!this->GetIsComplete())
+                    dal::tasker().WaitforTask(this);
                 dal::tasker().AddTaskSetToPipe(this);
                 return true;
             }
 
-        private:
-            void ExecuteRange(enki::TaskSetPartition r, uint32_t tid) override {
-                std::lock_guard<std::mutex> lock(mut_);
-                joinable_ = true;
+            void join() { dal::tasker().WaitforTask(this); }
 
-                if (job_) {
-                    job_->Execute();
-                    this->clear_job();
-                }
-            }
+        private:
+            enum State : uint32_t { IDLE, SCHEDULED };
 
-            void clear_job() {
-                if (job_) {
-                    job_->Release();
-                    job_ = nullptr;
+            void ExecuteRange(enki::TaskSetPartition r, uint32_t tid) override {
+                Job* job = nullptr;
+
+                for (;;) {
+                    while (queue_->pop(job)) this->run(job);
+
+                    // A producer may have pushed before we went idle
+                    state_.store(IDLE);
+                    if (!queue_->pop(job))
+                        return;
+
+                    auto expected = IDLE;
+                    const auto keep_going = state_.compare_exchange_strong(
+                        expected, SCHEDULED
+                    );
+                    this->run(job);
+                    if (!keep_going)
+                        return;
                 }
             }
 
-            void set_job(Job* const inJob) {
-                this->clear_job();
-                inJob->AddRef();
-                job_ = inJob;
-            }
-
-            void try_join() {
-                if (joinable_) {
-                    joinable_ = false;
-                    dal::tasker().WaitforTask(this);
-                }
+            static void run(Job* job) {
+                job->Execute();
+                job->Release();
             }
 
-            std::mutex mut_;
-            Job* job_ = nullptr;
-            bool joinable_ = false;
+            JobQueue* queue_ = nullptr;
+            std::atomic<State> state_ = IDLE;
         };
 
     public:
-        JoltEnkiTaskSystem() : JPH::JobSystemWithBarrier(8) {}
+        JoltEnkiTaskSystem() : JPH::JobSystemWithBarrier(8) {
+            const auto threads = dal::tasker().GetNumTaskThreads();
+            worker_count_ = std::clamp<size_t>(threads - 1, 1, MAX_WORKERS);
+            for (size_t i = 0; i < worker_count_; ++i)
+                workers_[i].init(queue_);
+        }
+
+        ~JoltEnkiTaskSystem() {
+            for (size_t i = 0; i < worker_count_; ++i) workers_[i].join();
+        }
 
         int GetMaxConcurrency() const override {
             return dal::tasker().GetNumTaskThreads() - 1;
@@ -119,25 +201,30 @@ namespace {
             counter_.decrement();
         }
 
-        void QueueJob(Job* inJob) override {
-            for (auto& task : task_pool_) {
-                if (task.try_exec(inJob)) {
-                    return;
-                }
-            }
+        void QueueJob(Job* inJob) override { this->QueueJobs(&inJob, 1); }
 
-            SPDLOG_ERROR("No available task to queue job");
+        void QueueJobs(Job** inJobs, JPH::uint inNumJobs) override {
+            // Released by the worker that executes it
+            for (JPH::uint i = 0; i < inNumJobs; ++i) inJobs[i]->AddRef();
+
+            queue_.push(inJobs, inNumJobs);
+            this->wake_workers(inNumJobs);
         }
 
-        void QueueJobs(Job** inJobs, JPH::uint inNumJobs) override {
-            for (JPH::uint i = 0; i < inNumJobs; ++i) {
-                this->QueueJob(inJobs[i]);
+    private:
+        void wake_workers(size_t count) {
+            for (size_t i = 0; i < worker_count_ && count > 0; ++i) {
+                if (workers_[i].try_wake())
+                    --count;
             }
         }
 
-    private:
-        sung::StaticPool<Job, 1024> job_pool_;
-        std::array<JobTask, 1024> task_pool_;
+        // Every job in the queue is allocated from `job_pool_` so the queue
+        // never holds more than `MAX_JOBS` items
+        sung::StaticPool<Job, MAX_JOBS> job_pool_;
+        JobQueue queue_;
+        std::array<Worker, MAX_WORKERS> workers_;
+        size_t worker_count_ = 0;
         ::Counter counter_;
     };
 
@@ -1,18 +1,23 @@
 #include "mirinae/scene/phys_world.hpp"
 
+#include <atomic>
 #include <cstdarg>
+#include <mutex>
 #include <thread>
 
 // #define MIRINAE_JOLT_DEBUG_RENDERER
 
 #include <Jolt/Jolt.h>
+#include <dal/auxiliary/path.hpp>
 #include <dal/img/img2d.hpp>
 #include <entt/entity/registry.hpp>
+#include <sung/basic/threading.hpp>
 
 #include <Jolt/Core/Factory.h>
 #include <Jolt/Core/TempAllocator.h>
 #include <Jolt/Physics/Body/BodyActivationListener.h>
 #include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Body/BodyLockInterface.h>
 #include <Jolt/Physics/Character/CharacterVirtual.h>
 #include <Jolt/Physics/Collision/Shape/BoxShape.h>
 #include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
@@ -34,7 +39,9 @@
 #include "mirinae/cpnt/terrain.hpp"
 #include "mirinae/cpnt/transform.hpp"
 #include "mirinae/lightweight/include_spdlog.hpp"
+#include "mirinae/lightweight/profiler.hpp"
 #include "mirinae/lightweight/task.hpp"
+#include "mirinae/scene/collider_cache.hpp"
 #include "mirinae/scene/jolt_job_sys.hpp"
 
 
@@ -81,6 +88,12 @@ namespace {
         return glm::dquat(q.GetW(), q.GetX(), q.GetY(), q.GetZ());
     }
 
+    // Jolt recommends one collision step per 1/60 seconds
+    int calc_collision_steps(const double dt) {
+        const auto steps = static_cast<int>(std::ceil(dt * 60.0 - 0.001));
+        return std::max(steps, 1);
+    }
+
     glm::mat4 conv_mat(const JPH::Mat44& m) {
         return glm::mat4(
             ::conv_vec(m.GetColumn4(0)),
@@ -400,7 +413,21 @@ namespace {
                 inBodyID.GetIndexAndSequenceNumber()
             );
             */
+
+            std::lock_guard<std::mutex> lock(mut_);
+            deactivated_.push_back(inBodyID);
+        }
+
+        // Bodies that fell asleep since the last call
+        void take_deactivated(JPH::BodyIDVector& out) {
+            out.clear();
+            std::lock_guard<std::mutex> lock(mut_);
+            out.swap(deactivated_);
         }
+
+    private:
+        std::mutex mut_;
+        JPH::BodyIDVector deactivated_;
     };
 
 
@@ -641,10 +668,194 @@ namespace {
     class PhysWorldStates {
 
     public:
-        std::atomic_bool no_simulate_{ false };
+        mirinae::PhysStepConfig step_cfg_;
+        // Colliders are cooked inline if null
+        sung::HTaskSche task_sche_;
+        // Optional
+        std::shared_ptr<mirinae::ColliderCache> collider_cache_;
+        // Set when static bodies were added since the last update
         std::atomic_bool need_optimization_{ false };
     };
 
+
+    // Bodies created during pre sync, added to the world all at once
+    class BodyAddBatch {
+
+    public:
+        void push(const JPH::BodyID& id) {
+            std::lock_guard<std::mutex> lock(mut_);
+            ids_.push_back(id);
+        }
+
+        // Returns true if any body was added
+        bool flush(JPH::BodyInterface& bodies) {
+            std::lock_guard<std::mutex> lock(mut_);
+            if (ids_.empty())
+                return false;
+
+            const auto count = static_cast<int>(ids_.size());
+            const auto state = bodies.AddBodiesPrepare(ids_.data(), count);
+            bodies.AddBodiesFinalize(
+                ids_.data(), count, state, JPH::EActivation::DontActivate
+            );
+            ids_.clear();
+            return true;
+        }
+
+    private:
+        std::mutex mut_;
+        JPH::BodyIDVector ids_;
+    };
+
+
+    class MeshCookTask : public sung::IStandardLoadTask {
+
+    public:
+        MeshCookTask(
+            std::shared_ptr<mirinae::IRenModel> model,
+            const glm::vec3& scale,
+            std::shared_ptr<const mirinae::ColliderCache> cache,
+            const std::string& cache_key
+        )
+            : model_(model)
+            , scale_(scale)
+            , cache_(cache)
+            , cache_key_(cache_key) {}
+
+        sung::TaskStatus tick() override {
+            MIRINAE_PROF_ZONE("mesh collider cook");
+
+            if (!model_)
+                return this->fail("Model is null");
+
+            ::ModelAccessor model_acc;
+            model_acc.set_scale(scale_);
+            model_->access_positions(model_acc);
+            model_.reset();
+
+            auto& vtx = model_acc.vtx();
+            auto& idx = model_acc.idx();
+            const auto hash = mirinae::ColliderHasher{}
+                                  .add(vtx.data(), vtx.size() * sizeof(vtx[0]))
+                                  .add(idx.data(), idx.size() * sizeof(idx[0]))
+                                  .get();
+
+            if (cache_) {
+                shape_ = cache_->load(cache_key_, hash);
+                if (shape_)
+                    return this->success();
+            }
+
+            JPH::MeshShapeSettings mesh_shape(vtx, idx);
+            mesh_shape.mActiveEdgeCosThresholdAngle = 0.999f;
+            auto res = mesh_shape.Create();
+            if (res.HasError())
+                return this->fail(res.GetError().c_str());
+
+            shape_ = res.Get();
+            if (cache_)
+                cache_->save(cache_key_, hash, *shape_);
+            return this->success();
+        }
+
+        JPH::Ref<JPH::Shape> shape_;
+
+    private:
+        std::shared_ptr<mirinae::IRenModel> model_;
+        glm::vec3 scale_;
+        std::shared_ptr<const mirinae::ColliderCache> cache_;
+        std::string cache_key_;
+    };
+
+
+    class HeightFieldCookTask : public sung::IStandardLoadTask {
+
+    public:
+        // `texels` is RGBA8 with `sample_count` * `sample_count` texels
+        HeightFieldCookTask(
+            std::vector<uint8_t>&& texels,
+            uint32_t sample_count,
+            const JPH::Vec3& offset,
+            const JPH::Vec3& scale,
+            std::shared_ptr<const mirinae::ColliderCache> cache,
+            const std::string& cache_key
+        )
+            : texels_(std::move(texels))
+            , sample_count_(sample_count)
+            , offset_(offset)
+            , scale_(scale)
+            , cache_(cache)
+            , cache_key_(cache_key) {}
+
+        sung::TaskStatus tick() override {
+            MIRINAE_PROF_ZONE("height field cook");
+
+            const auto texel_count = sample_count_ * sample_count_;
+            if (texels_.size() < texel_count * 4)
+                return this->fail("Height map data is too small");
+
+            const auto hash = this->calc_hash();
+            if (cache_) {
+                shape_ = cache_->load(cache_key_, hash);
+                if (shape_)
+                    return this->success();
+            }
+
+            std::vector<float> height_data(texel_count);
+            for (uint32_t i = 0; i < texel_count; ++i)
+                height_data[i] = static_cast<float>(texels_[i * 4]) / 255.0f;
+
+            JPH::HeightFieldShapeSettings shape_settings(
+                height_data.data(), offset_, scale_, sample_count_
+            );
+
+            auto result = shape_settings.Create();
+            if (result.HasError())
+                return this->fail(result.GetError().c_str());
+
+            shape_ = result.Get();
+            texels_.clear();
+            texels_.shrink_to_fit();
+            if (cache_)
+                cache_->save(cache_key_, hash, *shape_);
+            return this->success();
+        }
+
+        JPH::Ref<JPH::Shape> shape_;
+
+    private:
+        uint64_t calc_hash() const {
+            mirinae::ColliderHasher hasher;
+            hasher.add(texels_.data(), texels_.size());
+            hasher.add(sample_count_);
+            for (int i = 0; i < 3; ++i) {
+                hasher.add(offset_[i]);
+                hasher.add(scale_[i]);
+            }
+            return hasher.get();
+        }
+
+        std::vector<uint8_t> texels_;
+        uint32_t sample_count_;
+        JPH::Vec3 offset_;
+        JPH::Vec3 scale_;
+        std::shared_ptr<const mirinae::ColliderCache> cache_;
+        std::string cache_key_;
+    };
+
+
+    void start_cooking(
+        const std::shared_ptr<sung::IStandardLoadTask>& task,
+        const sung::HTaskSche& task_sche
+    ) {
+        if (task_sche) {
+            task_sche->add_task(task);
+        } else {
+            while (task->tick() == sung::TaskStatus::running) {
+            }
+        }
+    }
+
 }  // namespace
 
 
@@ -798,71 +1009,116 @@ namespace { namespace cpnt {
     class PhysBody {
 
     public:
+        void reset_states(JPH::RVec3Arg pos, JPH::QuatArg rot) {
+            prev_pos_ = cur_pos_ = pos;
+            prev_rot_ = cur_rot_ = rot;
+        }
+
+        JPH::RVec3 lerp_pos(const float alpha) const {
+            return prev_pos_ + (cur_pos_ - prev_pos_) * alpha;
+        }
+
+        JPH::Quat lerp_rot(const float alpha) const {
+            return prev_rot_.SLERP(cur_rot_, alpha);
+        }
+
         JPH::BodyID id_;
+        // States before and after the last physics step
+        JPH::RVec3 prev_pos_, cur_pos_;
+        JPH::Quat prev_rot_ = JPH::Quat::sIdentity();
+        JPH::Quat cur_rot_ = JPH::Quat::sIdentity();
     };
 
 
+    // Shape is cooked in background and the body is created afterwards
     class MeshBody {
 
     public:
+        // Returns true when the body has just been created
         bool try_init(
             const mirinae::cpnt::MdlActorStatic* modl,
             const mirinae::cpnt::Transform* tform,
-            JPH::BodyInterface& body_interf
+            JPH::BodyInterface& body_interf,
+            const ::PhysWorldStates& states,
+            ::BodyAddBatch& batch
         ) {
-            namespace cpnt = mirinae::cpnt;
+            if (!task_) {
+                if (!modl) {
+                    // SPDLOG_WARN("Entity does not have a model component");
+                    return false;
+                }
+                if (!modl->model_) {
+                    // SPDLOG_WARN("Entity does not have a model ren unit");
+                    return false;
+                }
+                if (!modl->model_->is_ready()) {
+                    // SPDLOG_WARN("Model is not ready");
+                    return false;
+                }
 
-            if (!modl) {
-                // SPDLOG_WARN("Entity does not have a model component");
-                return false;
+                glm::vec3 scale{ 1, 1, 1 };
+                if (tform)
+                    scale = tform->scale_;
+
+                const auto cache_key = fmt::format(
+                    "mesh:{}:{}:{}:{}",
+                    dal::tostr(modl->model_path_),
+                    scale.x,
+                    scale.y,
+                    scale.z
+                );
+                task_ = std::make_shared<::MeshCookTask>(
+                    modl->model_, scale, states.collider_cache_, cache_key
+                );
+                ::start_cooking(task_, states.task_sche_);
             }
 
-            if (!modl->model_) {
-                // SPDLOG_WARN("Entity does not have a model ren unit");
+            if (!task_->is_done())
                 return false;
-            }
-            if (!modl->model_->is_ready()) {
-                // SPDLOG_WARN("Model is not ready");
+
+            if (task_->has_failed()) {
+                SPDLOG_ERROR(
+                    "Failed to create mesh shape: {}", task_->err_msg()
+                );
+                task_.reset();
+                failed_ = true;
                 return false;
             }
 
+            shape_ = task_->shape_;
+            task_.reset();
+
             JPH::Vec3 pos(0, 0, 0);
             JPH::Quat rot = JPH::Quat::sIdentity();
             if (tform) {
                 pos = ::conv_vec(tform->pos_);
                 rot = ::conv_quat(tform->rot_);
-                model_acc_.set_scale(tform->scale_);
             }
 
-            modl->model_->access_positions(model_acc_);
-
-            JPH::MeshShapeSettings mesh_shape(
-                model_acc_.vtx(), model_acc_.idx()
-            );
-            mesh_shape.mActiveEdgeCosThresholdAngle = 0.999f;
-            auto res = mesh_shape.Create();
-            if (res.HasError()) {
-                SPDLOG_ERROR("Failed to create mesh shape: {}", res.GetError());
-                return false;
-            }
-            shape_ = res.Get();
-
             JPH::BodyCreationSettings body_settings(
                 shape_, pos, rot, JPH::EMotionType::Static, ::Layers::NON_MOVING
             );
 
-            id_ = body_interf.CreateAndAddBody(
-                body_settings, JPH::EActivation::DontActivate
-            );
+            const auto body = body_interf.CreateBody(body_settings);
+            if (!body) {
+                SPDLOG_ERROR("Failed to create mesh body");
+                failed_ = true;
+                return false;
+            }
 
+            id_ = body->GetID();
+            batch.push(id_);
             ready_ = true;
             return true;
         }
 
+        bool is_settled() const { return ready_ || failed_; }
+
         JPH::BodyID id_;
         JPH::Ref<JPH::Shape> shape_;
-        ::ModelAccessor model_acc_;
+        std::shared_ptr<::MeshCookTask> task_;
         bool ready_ = false;
+        bool failed_ = false;
     };
 
 
@@ -872,103 +1128,140 @@ namespace { namespace cpnt {
         bool try_init(
             const mirinae::cpnt::Terrain* terr,
             const mirinae::cpnt::Transform* tform,
-            JPH::BodyInterface& body_interf
+            JPH::BodyInterface& body_interf,
+            const ::PhysWorldStates& states,
+            ::BodyAddBatch& batch
         ) {
-            namespace cpnt = mirinae::cpnt;
+            if (!task_) {
+                task_ = this->create_task(terr, states);
+                if (!task_)
+                    return false;
+                ::start_cooking(task_, states.task_sche_);
+            }
+
+            if (!task_->is_done())
+                return false;
+
+            if (task_->has_failed()) {
+                SPDLOG_ERROR(
+                    "Failed to create height field shape: {}", task_->err_msg()
+                );
+                task_.reset();
+                failed_ = true;
+                return false;
+            }
+
+            shape_ = task_->shape_;
+            task_.reset();
+
+            JPH::BodyCreationSettings body_settings(
+                shape_,
+                JPH::RVec3(),
+                JPH::Quat::sIdentity(),
+                JPH::EMotionType::Static,
+                Layers::NON_MOVING
+            );
+
+            if (tform) {
+                body_settings.mPosition = ::conv_vec(tform->pos_);
+                body_settings.mRotation = ::conv_quat(tform->rot_);
+            }
+
+            const auto body = body_interf.CreateBody(body_settings);
+            if (!body) {
+                SPDLOG_ERROR("Failed to create height field body");
+                failed_ = true;
+                return false;
+            }
+
+            id_ = body->GetID();
+            batch.push(id_);
+            ready_ = true;
+            return true;
+        }
 
+        bool is_settled() const { return ready_ || failed_; }
+
+        JPH::BodyID id_;
+        JPH::Ref<JPH::Shape> shape_;
+        std::shared_ptr<::HeightFieldCookTask> task_;
+        bool ready_ = false;
+        bool failed_ = false;
+
+    private:
+        static std::shared_ptr<::HeightFieldCookTask> create_task(
+            const mirinae::cpnt::Terrain* terr, const ::PhysWorldStates& states
+        ) {
             if (!terr) {
                 // SPDLOG_WARN("Entity does not have a terrain component");
-                return false;
+                return nullptr;
             }
 
             if (!terr->ren_unit_) {
                 // SPDLOG_WARN("Entity does not have a terrain render unit");
-                return false;
+                return nullptr;
             }
 
             const auto height_map = terr->ren_unit_->height_map();
             if (!height_map) {
                 // SPDLOG_WARN("Entity does not have a height map");
-                return false;
+                return nullptr;
             }
 
             const auto img2d = height_map->as<dal::TDataImage2D<uint8_t>>();
             if (!img2d) {
                 // SPDLOG_WARN("Entity does not have a 2D image");
-                return false;
+                return nullptr;
             }
 
             if (4 != img2d->channels()) {
                 // SPDLOG_WARN("Height map does not have 4 channels");
-                return false;
+                return nullptr;
             }
             if (img2d->width() != img2d->height()) {
                 // SPDLOG_WARN("Height map is not square");
-                return false;
+                return nullptr;
             }
 
-            height_data_len_ = img2d->width();
+            // Image is owned by the render unit, so copy it for the task
+            const uint32_t len = img2d->width();
+            const auto data = img2d->texel_ptr(0, 0);
+            std::vector<uint8_t> texels(data, data + len * len * 4);
 
-            const auto texel_count = img2d->width() * img2d->height();
-            height_data_.resize(texel_count);
-            for (uint32_t i = 0; i < texel_count; ++i) {
-                const auto* texel = img2d->texel_ptr(
-                    i % img2d->width(), i / img2d->width()
-                );
-                height_data_[i] = static_cast<float>(texel[0]) / 255.0f;
-            }
-
-            JPH::HeightFieldShapeSettings shape_settings(
-                height_data_.data(),
+            return std::make_shared<::HeightFieldCookTask>(
+                std::move(texels),
+                len,
                 JPH::Vec3(
                     terr->terrain_width_ * -0.5, 0, terr->terrain_height_ * -0.5
                 ),
                 JPH::Vec3(
-                    terr->terrain_width_ / float(height_data_len_ - 1),
+                    terr->terrain_width_ / float(len - 1),
                     terr->height_scale_,
-                    terr->terrain_height_ / float(height_data_len_ - 1)
+                    terr->terrain_height_ / float(len - 1)
                 ),
-                height_data_len_
-            );
-
-            auto result = shape_settings.Create();
-            if (result.HasError()) {
-                SPDLOG_ERROR(
-                    "Failed to create height field shape: {}", result.GetError()
-                );
-                return false;
-            }
-            shape_ = result.Get();
-
-            JPH::BodyCreationSettings body_settings(
-                shape_,
-                JPH::RVec3(),
-                JPH::Quat::sIdentity(),
-                JPH::EMotionType::Static,
-                Layers::NON_MOVING
+                states.collider_cache_,
+                "height:" + dal::tostr(terr->height_map_path_)
             );
+        }
+    };
 
-            if (tform) {
-                body_settings.mPosition = ::conv_vec(tform->pos_);
-                body_settings.mRotation = ::conv_quat(tform->rot_);
-            }
+}}  // namespace ::cpnt
 
-            id_ = body_interf.CreateAndAddBody(
-                body_settings, JPH::EActivation::DontActivate
-            );
 
-            ready_ = true;
-            return true;
-        }
+namespace {
 
-        JPH::BodyID id_;
-        JPH::Ref<JPH::Shape> shape_;
-        std::vector<float> height_data_;
-        uint32_t height_data_len_ = 0;
-        bool ready_ = false;
-    };
+    // Returns null if the body does not belong to a `cpnt::PhysBody`
+    ::cpnt::PhysBody* find_phys_body(
+        const JPH::Body& body, entt::registry& reg
+    ) {
+        const auto e = static_cast<entt::entity>(body.GetUserData());
+        auto phys = reg.try_get<::cpnt::PhysBody>(e);
+        if (!phys || phys->id_ != body.GetID())
+            return nullptr;
+        return phys;
+    }
 
-}}  // namespace ::cpnt
+}  // namespace
 
 
 // Tasks
@@ -980,11 +1273,13 @@ namespace {
         void init(
             ::PhysWorldStates& states,
             entt::registry& reg,
-            JPH::BodyInterface& body_interf
+            JPH::BodyInterface& body_interf,
+            ::BodyAddBatch& batch
         ) {
             states_ = &states;
             reg_ = &reg;
             body_interf_ = &body_interf;
+            batch_ = &batch;
         }
 
         void prepare() {
@@ -994,9 +1289,6 @@ namespace {
         void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
             namespace cpnt = mirinae::cpnt;
 
-            someone_is_preparing_ = false;
-            someone_finished_preparing_ = false;
-
             if (!reg_)
                 return;
             if (!body_interf_)
@@ -1009,29 +1301,22 @@ namespace {
             for (auto it = begin; it != end; ++it) {
                 entt::entity e = *it;
                 auto& body = view.get<::cpnt::MeshBody>(e);
-                if (body.ready_)
+                if (body.is_settled())
                     continue;
 
                 auto tform = reg_->try_get<cpnt::Transform>(e);
                 auto modl = reg_->try_get<cpnt::MdlActorStatic>(e);
-                if (body.try_init(modl, tform, *body_interf_))
-                    someone_finished_preparing_ = true;
-                else
-                    someone_is_preparing_ = true;
+                body.try_init(
+                    modl, tform, *body_interf_, *states_, *batch_
+                );
             }
-
-            if (someone_is_preparing_)
-                states_->no_simulate_.store(true);
-            if (someone_finished_preparing_)
-                states_->need_optimization_.store(true);
         }
 
     private:
         ::PhysWorldStates* states_ = nullptr;
         entt::registry* reg_ = nullptr;
         JPH::BodyInterface* body_interf_ = nullptr;
-        bool someone_is_preparing_ = false;
-        bool someone_finished_preparing_ = false;
+        ::BodyAddBatch* batch_ = nullptr;
     };
 
 
@@ -1041,11 +1326,13 @@ namespace {
         void init(
             ::PhysWorldStates& states,
             entt::registry& reg,
-            JPH::BodyInterface& body_interf
+            JPH::BodyInterface& body_interf,
+            ::BodyAddBatch& batch
         ) {
             states_ = &states;
             reg_ = &reg;
             body_interf_ = &body_interf;
+            batch_ = &batch;
         }
 
         void prepare() {
@@ -1055,9 +1342,6 @@ namespace {
         void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
             namespace cpnt = mirinae::cpnt;
 
-            someone_is_preparing_ = false;
-            someone_finished_preparing_ = false;
-
             if (!reg_)
                 return;
             if (!body_interf_)
@@ -1070,29 +1354,49 @@ namespace {
             for (auto it = begin; it != end; ++it) {
                 const auto e = *it;
                 auto& body = view.get<::cpnt::HeightFieldBody>(e);
-                if (body.ready_)
+                if (body.is_settled())
                     continue;
 
                 auto tform = reg_->try_get<cpnt::Transform>(e);
                 auto terr = reg_->try_get<cpnt::Terrain>(e);
-                if (body.try_init(terr, tform, *body_interf_))
-                    someone_finished_preparing_ = true;
-                else
-                    someone_is_preparing_ = true;
+                body.try_init(
+                    terr, tform, *body_interf_, *states_, *batch_
+                );
             }
+        }
+
+    private:
+        ::PhysWorldStates* states_ = nullptr;
+        entt::registry* reg_ = nullptr;
+        JPH::BodyInterface* body_interf_ = nullptr;
+        ::BodyAddBatch* batch_ = nullptr;
+    };
+
 
-            if (someone_is_preparing_)
-                states_->no_simulate_.store(true);
-            if (someone_finished_preparing_)
+    // Adds static bodies whose colliders finished cooking
+    class TaskPreSync_AddBodies : public mirinae::DependingTask {
+
+    public:
+        void init(
+            ::PhysWorldStates& states,
+            JPH::BodyInterface& body_interf,
+            ::BodyAddBatch& batch
+        ) {
+            states_ = &states;
+            body_interf_ = &body_interf;
+            batch_ = &batch;
+        }
+
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
+            // Large static meshes leave the broad phase tree unbalanced
+            if (batch_->flush(*body_interf_))
                 states_->need_optimization_.store(true);
         }
 
     private:
         ::PhysWorldStates* states_ = nullptr;
-        entt::registry* reg_ = nullptr;
         JPH::BodyInterface* body_interf_ = nullptr;
-        bool someone_is_preparing_ = false;
-        bool someone_finished_preparing_ = false;
+        ::BodyAddBatch* batch_ = nullptr;
     };
 
 
@@ -1113,8 +1417,9 @@ namespace {
             temp_alloc_ = &temp_alloc;
         }
 
-        void prepare(double dt) {
+        void prepare(double dt, int step_count) {
             dt_ = dt;
+            step_count_ = step_count;
             this->set_size(reg_->view<mirinae::cpnt::CharacterPhys>().size());
         }
 
@@ -1123,7 +1428,9 @@ namespace {
 
             const float dt_rcp = static_cast<float>(1.0 / dt_);
             const float dt = static_cast<float>(dt_);
-            const float push_force_factor = 100 * dt_rcp;
+            // Forces are cleared after every physics step, so push with an
+            // impulse that covers all steps taken this frame
+            const float push_impulse = 100.f * step_count_;
 
             auto& reg = *reg_;
             auto& phys_sys = *phys_sys_;
@@ -1157,14 +1464,16 @@ namespace {
                 body->set_linear_vel(vel);
                 body->extended_update(dt, *temp_alloc_, phys_sys);
 
+                if (step_count_ < 1)
+                    continue;
+
                 for (auto& contact : body->chara().GetActiveContacts()) {
                     const auto c_motion = bodies.GetMotionType(contact.mBodyB);
                     if (c_motion != JPH::EMotionType::Dynamic)
                         continue;
 
                     const auto push_dir = -contact.mContactNormal;
-                    const auto push_force = push_dir * push_force_factor;
-                    bodies.AddForce(contact.mBodyB, push_force);
+                    bodies.AddImpulse(contact.mBodyB, push_dir * push_impulse);
                 }
             }
         }
@@ -1176,6 +1485,7 @@ namespace {
         JPH::BodyInterface* body_interf_ = nullptr;
         JPH::TempAllocatorImpl* temp_alloc_ = nullptr;
         double dt_ = 1.0 / 60.0;
+        int step_count_ = 1;
     };
 
 
@@ -1184,88 +1494,145 @@ namespace {
     public:
         void init(
             ::PhysWorldStates& states,
+            entt::registry& reg,
             JPH::DebugRenderer* debug_ren,
             JPH::PhysicsSystem& phys_sys,
             JPH::JobSystem& job_sys,
             JPH::TempAllocatorImpl& temp_alloc
         ) {
             states_ = &states;
+            reg_ = &reg;
             debug_ren_ = debug_ren;
             phys_sys_ = &phys_sys;
             job_sys_ = &job_sys;
             temp_alloc_ = &temp_alloc;
         }
 
-        void prepare(double dt) { dt_ = dt; }
+        void prepare(double step_dt, int step_count) {
+            dt_ = step_dt;
+            step_count_ = step_count;
+        }
 
         void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
-            if (states_->no_simulate_.load())
+            MIRINAE_PROF_ZONE("phys update");
+
+            if (step_count_ < 1)
                 return;
-            if (states_->need_optimization_.load()) {
-                states_->need_optimization_.store(false);
+
+            if (states_->need_optimization_.exchange(false))
                 phys_sys_->OptimizeBroadPhase();
-            }
 
-            const auto res = phys_sys_->Update(dt_, 1, temp_alloc_, job_sys_);
+            const auto dt = static_cast<float>(dt_);
+            const auto coll_steps = ::calc_collision_steps(dt_);
+            for (int i = 0; i < step_count_; ++i) {
+                if (i == step_count_ - 1)
+                    this->store_prev_states();
+                phys_sys_->Update(dt, coll_steps, temp_alloc_, job_sys_);
+            }
 
             if (debug_ren_)
                 phys_sys_->DrawBodies(debug_ren_settings_, debug_ren_);
         }
 
     private:
-        constexpr static double DESIRED_DT = 1.0 / 60.0;
+        // Render interpolation runs between these and the final states
+        void store_prev_states() {
+            auto& bodies = phys_sys_->GetBodyLockInterfaceNoLock();
+            phys_sys_->GetActiveBodies(JPH::EBodyType::RigidBody, active_);
+
+            for (auto& id : active_) {
+                const auto body = bodies.TryGetBody(id);
+                if (!body)
+                    continue;
+                auto phys = ::find_phys_body(*body, *reg_);
+                if (!phys)
+                    continue;
+
+                phys->prev_pos_ = body->GetPosition();
+                phys->prev_rot_ = body->GetRotation();
+            }
+        }
+
         JPH::BodyManager::DrawSettings debug_ren_settings_;
 
         ::PhysWorldStates* states_ = nullptr;
+        entt::registry* reg_ = nullptr;
         JPH::DebugRenderer* debug_ren_ = nullptr;
         JPH::JobSystem* job_sys_ = nullptr;
         JPH::PhysicsSystem* phys_sys_ = nullptr;
         JPH::TempAllocatorImpl* temp_alloc_ = nullptr;
+        JPH::BodyIDVector active_;
         double dt_ = 1.0 / 60.0;
+        int step_count_ = 1;
     };
 
 
+    // Visits awake bodies and those that fell asleep during the last update
+    // instead of every `cpnt::PhysBody` in the scene
     class TaskPostSync_PhysBody : public mirinae::DependingTask {
 
     public:
         void init(
             ::PhysWorldStates& states,
             entt::registry& reg,
-            JPH::BodyInterface& body_interf
+            JPH::PhysicsSystem& phys_sys,
+            ::MyBodyActivationListener& activation
         ) {
             states_ = &states;
             reg_ = &reg;
-            body_interf_ = &body_interf;
+            phys_sys_ = &phys_sys;
+            activation_ = &activation;
         }
 
-        void prepare() {
-            this->set_size(reg_->view<::cpnt::PhysBody>().size());
-        }
+        void prepare(double alpha) { alpha_ = static_cast<float>(alpha); }
 
         void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
-            auto view = reg_->view<::cpnt::PhysBody>();
-            auto begin = view.begin() + range.start;
-            auto end = view.begin() + range.end;
+            // Safe without locks since the update has finished
+            auto& bodies = phys_sys_->GetBodyLockInterfaceNoLock();
 
-            for (auto it = begin; it != end; ++it) {
-                const auto e = *it;
-                auto& body = reg_->get<::cpnt::PhysBody>(e);
-                auto tform = reg_->try_get<mirinae::cpnt::Transform>(e);
-                if (!tform)
-                    continue;
+            phys_sys_->GetActiveBodies(JPH::EBodyType::RigidBody, active_);
+            for (auto& id : active_) {
+                if (auto body = bodies.TryGetBody(id))
+                    this->sync(*body, alpha_);
+            }
 
-                JPH::RVec3 pos;
-                JPH::Quat rot;
-                body_interf_->GetPositionAndRotation(body.id_, pos, rot);
-                tform->pos_ = ::conv_vec(pos);
-                tform->rot_ = ::conv_quat(rot);
+            // Sleeping bodies do not move so they stop at the final state
+            activation_->take_deactivated(deactivated_);
+            for (auto& id : deactivated_) {
+                const auto body = bodies.TryGetBody(id);
+                if (!body || body->IsActive())
+                    continue;
+                if (auto phys = this->sync(*body, 1))
+                    phys->reset_states(phys->cur_pos_, phys->cur_rot_);
             }
         }
 
     private:
+        ::cpnt::PhysBody* sync(const JPH::Body& body, const float alpha) {
+            auto phys = ::find_phys_body(body, *reg_);
+            if (!phys)
+                return nullptr;
+
+            phys->cur_pos_ = body.GetPosition();
+            phys->cur_rot_ = body.GetRotation();
+
+            const auto e = static_cast<entt::entity>(body.GetUserData());
+            if (auto tform = reg_->try_get<mirinae::cpnt::Transform>(e)) {
+                tform->pos_ = ::conv_vec(phys->lerp_pos(alpha));
+                tform->rot_ = ::conv_quat(phys->lerp_rot(alpha));
+                reg_->patch<mirinae::cpnt::Transform>(e);
+            }
+
+            return phys;
+        }
+
         ::PhysWorldStates* states_ = nullptr;
         entt::registry* reg_ = nullptr;
-        JPH::BodyInterface* body_interf_ = nullptr;
+        JPH::PhysicsSystem* phys_sys_ = nullptr;
+        ::MyBodyActivationListener* activation_ = nullptr;
+        JPH::BodyIDVector active_;
+        JPH::BodyIDVector deactivated_;
+        float alpha_ = 1;
     };
 
 
@@ -1297,6 +1664,7 @@ namespace {
                     continue;
 
                 tform->pos_ = ::conv_vec(body->world_pos());
+                reg_->patch<mirinae::cpnt::Transform>(e);
             }
         }
 
@@ -1315,6 +1683,7 @@ namespace {
             JPH::PhysicsSystem& phys_sys,
             JPH::DebugRenderer* debug_ren,
             JPH::BodyInterface& body_interf,
+            ::MyBodyActivationListener& activation,
             JPH::JobSystem& job_sys,
             JPH::TempAllocatorImpl& temp_alloc
         )
@@ -1325,35 +1694,69 @@ namespace {
             , bodies_(&body_interf)
             , job_sys_(&job_sys)
             , temp_alloc_(&temp_alloc) {
-            // Pre
-            pre_mesh_.succeed(this);
-            pre_height_.succeed(this);
-            pre_player_.succeed(&pre_mesh_, &pre_height_);
-            // Update
-            update_.succeed(&pre_player_);
-            // Post
-            post_phys_body_.succeed(&update_);
-            post_player_.succeed(&update_);
-            // Fence
-            fence_.succeed(&post_phys_body_, &post_player_);
-
-            pre_mesh_.init(states, reg, *bodies_);
-            pre_height_.init(states, reg, *bodies_);
+            // Colliders of both kinds are cooked side by side
+            linker_.add("pre mesh", pre_mesh_, { "model" }, { "mesh" });
+            linker_.add("pre height", pre_height_, { "terrain" }, { "height" });
+            linker_.add(
+                "pre add", pre_add_, { "mesh", "height" }, { "bodies" }
+            );
+            linker_.add(
+                "pre player", pre_player_, { "input" }, { "bodies", "chara" }
+            );
+            linker_.add("update", update_, {}, { "bodies" });
+            linker_.add("post body", post_phys_body_, { "bodies" }, {});
+            linker_.add("post player", post_player_, { "bodies", "chara" }, {});
+            linker_.link(*this, fence_);
+
+            // Models and terrains are loaded by the renderer later in the
+            // frame
+            this->reads_last_frame("model").reads_last_frame("terrain");
+            this->writes("transform").writes("physics");
+
+            // Storages are created lazily on first access, which is not
+            // safe while other stages use the registry concurrently
+            reg.storage<::cpnt::PhysBody>();
+            reg.storage<::cpnt::MeshBody>();
+            reg.storage<::cpnt::HeightFieldBody>();
+            reg.storage<mirinae::cpnt::CharacterPhys>();
+            reg.storage<mirinae::cpnt::MdlActorStatic>();
+            reg.storage<mirinae::cpnt::Terrain>();
+            reg.storage<mirinae::cpnt::Transform>();
+
+            pre_mesh_.init(states, reg, *bodies_, add_batch_);
+            pre_height_.init(states, reg, *bodies_, add_batch_);
+            pre_add_.init(states, *bodies_, add_batch_);
             pre_player_.init(states, reg, phys_sys, *bodies_, temp_alloc);
-            update_.init(states, debug_ren, phys_sys, job_sys, temp_alloc);
-            post_phys_body_.init(states, reg, *bodies_);
+            update_.init(states, reg, debug_ren, phys_sys, job_sys, temp_alloc);
+            post_phys_body_.init(states, reg, phys_sys, activation);
             post_player_.init(states, reg);
         }
 
         void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
-            const auto dt = timer_.check_get_elapsed();
-            states_->no_simulate_.store(false);
+            const auto& cfg = states_->step_cfg_;
+            auto dt = timer_.check_get_elapsed();
+            if (cfg.frame_dt_ > 0)
+                dt = cfg.frame_dt_;
+
+            double step_dt = dt;
+            int step_count = 1;
+            double alpha = 1;
+            if (cfg.fixed_step_ && cfg.step_rate_ > 0) {
+                step_dt = 1.0 / cfg.step_rate_;
+                const auto max_steps = std::max(cfg.max_substeps_, 1);
+                accum_ = std::min(accum_ + dt, step_dt * max_steps);
+                step_count = static_cast<int>(accum_ / step_dt);
+                accum_ -= step_count * step_dt;
+                alpha = accum_ / step_dt;
+            } else {
+                accum_ = 0;
+            }
 
             pre_mesh_.prepare();
             pre_height_.prepare();
-            pre_player_.prepare(dt);
-            update_.prepare(dt);
-            post_phys_body_.prepare();
+            pre_player_.prepare(dt, step_count);
+            update_.prepare(step_dt, step_count);
+            post_phys_body_.prepare(alpha);
             post_player_.prepare();
         }
 
@@ -1368,14 +1771,18 @@ namespace {
         JPH::TempAllocatorImpl* temp_alloc_ = nullptr;
 
         sung::MonotonicRealtimeTimer timer_;
+        double accum_ = 0;  // Simulation time not yet stepped
+        ::BodyAddBatch add_batch_;
 
         TaskPreSync_Mesh pre_mesh_;
         TaskPreSync_Height pre_height_;
+        TaskPreSync_AddBodies pre_add_;
         TaskPreSync_Player pre_player_;
         TaskUpdate update_;
         TaskPostSync_PhysBody post_phys_body_;
         TaskPostSync_Player post_player_;
 
+        mirinae::TaskLinker linker_;
         mirinae::FenceTask fence_;
     };
 
@@ -1457,6 +1864,7 @@ namespace mirinae {
                 nullptr,
 #endif
                 this->body_interf(),
+                body_active_listener_,
                 *job_sys_,
                 temp_alloc_
             );
@@ -1464,6 +1872,16 @@ namespace mirinae {
 
         void optimize() { physics_system.OptimizeBroadPhase(); }
 
+        PhysStepConfig& step_config() { return states_.step_cfg_; }
+
+        void give_task_sche(sung::HTaskSche task_sche) {
+            states_.task_sche_ = task_sche;
+        }
+
+        void give_collider_cache(const std::filesystem::path& dir) {
+            states_.collider_cache_ = std::make_shared<ColliderCache>(dir);
+        }
+
         void give_debug_ren(IDebugRen& debug_ren) {
 #ifdef MIRINAE_JOLT_DEBUG_RENDERER
             debug_ren_.debug_ren_ = &debug_ren;
@@ -1505,10 +1923,14 @@ namespace mirinae {
                 Layers::MOVING
             );
             sphere_settings.mMassPropertiesOverride.mMass = 10;
+            sphere_settings.mUserData = entt::to_integral(entity);
 
             body->id_ = this->body_interf().CreateAndAddBody(
                 sphere_settings, JPH::EActivation::Activate
             );
+            body->reset_states(
+                sphere_settings.mPosition, sphere_settings.mRotation
+            );
         }
 
         void give_body_triangles(entt::entity entity, entt::registry& reg) {
@@ -1559,6 +1981,16 @@ namespace mirinae {
 
     void PhysWorld::optimize() { pimpl_->optimize(); }
 
+    PhysStepConfig& PhysWorld::step_config() { return pimpl_->step_config(); }
+
+    void PhysWorld::give_task_sche(sung::HTaskSche task_sche) {
+        pimpl_->give_task_sche(task_sche);
+    }
+
+    void PhysWorld::give_collider_cache(const std::filesystem::path& dir) {
+        pimpl_->give_collider_cache(dir);
+    }
+
     void PhysWorld::give_debug_ren(IDebugRen& debug_ren) {
         pimpl_->give_debug_ren(debug_ren);
     }
@@ -51,7 +51,8 @@ namespace { namespace scene {
     namespace tview {
 
         using Transform = mirinae::cpnt::Transform;
-        using UdataType = Transform*;
+        // Looked up on every call since the storage may move
+        using UdataType = entt::entity;
 
         const char* const UDATA_ID = "mirinae.transform_view";
 
@@ -60,82 +61,94 @@ namespace { namespace scene {
             return *static_cast<UdataType*>(ud);
         }
 
+        Transform& check_tform(lua_State* const L, entt::registry& reg) {
+            const auto e = check_udata(L, 1);
+            auto tform = reg.valid(e) ? reg.try_get<Transform>(e) : nullptr;
+            if (!tform)
+                luaL_error(L, "Transform no longer exists");
+            return *tform;
+        }
+
 
         int get_pos(lua_State* const L) {
             GET_SCENE_PTR();
-            auto& self = check_udata(L, 1);
-            lua_pushnumber(L, self->pos_.x);
-            lua_pushnumber(L, self->pos_.y);
-            lua_pushnumber(L, self->pos_.z);
+            auto& self = check_tform(L, reg);
+            lua_pushnumber(L, self.pos_.x);
+            lua_pushnumber(L, self.pos_.y);
+            lua_pushnumber(L, self.pos_.z);
             return 3;
         }
 
         int set_pos(lua_State* const L) {
             GET_SCENE_PTR();
-            auto& self = check_udata(L, 1);
-            self->pos_.x = luaL_checknumber(L, 2);
-            self->pos_.y = luaL_checknumber(L, 3);
-            self->pos_.z = luaL_checknumber(L, 4);
+            auto& self = check_tform(L, reg);
+            self.pos_.x = luaL_checknumber(L, 2);
+            self.pos_.y = luaL_checknumber(L, 3);
+            self.pos_.z = luaL_checknumber(L, 4);
+            reg.patch<Transform>(check_udata(L, 1));
             return 0;
         }
 
         int rotate(lua_State* const L) {
             GET_SCENE_PTR();
-            auto& self = check_udata(L, 1);
+            auto& self = check_tform(L, reg);
             const auto angle = luaL_checknumber(L, 2);
             const auto x_axis = luaL_checknumber(L, 3);
             const auto y_axis = luaL_checknumber(L, 4);
             const auto z_axis = luaL_checknumber(L, 5);
-            self->rotate(
+            self.rotate(
                 Transform::Angle::from_deg(angle),
                 glm::vec3{ x_axis, y_axis, z_axis }
             );
+            reg.patch<Transform>(check_udata(L, 1));
             return 0;
         }
 
         int get_quat(lua_State* const L) {
             GET_SCENE_PTR();
-            auto& self = check_udata(L, 1);
-            lua_pushnumber(L, self->rot_.w);
-            lua_pushnumber(L, self->rot_.x);
-            lua_pushnumber(L, self->rot_.y);
-            lua_pushnumber(L, self->rot_.z);
+            auto& self = check_tform(L, reg);
+            lua_pushnumber(L, self.rot_.w);
+            lua_pushnumber(L, self.rot_.x);
+            lua_pushnumber(L, self.rot_.y);
+            lua_pushnumber(L, self.rot_.z);
             return 4;
         }
 
         int set_quat(lua_State* const L) {
             GET_SCENE_PTR();
-            auto& self = check_udata(L, 1);
-            self->rot_.w = luaL_checknumber(L, 2);
-            self->rot_.x = luaL_checknumber(L, 3);
-            self->rot_.y = luaL_checknumber(L, 4);
-            self->rot_.z = luaL_checknumber(L, 5);
+            auto& self = check_tform(L, reg);
+            self.rot_.w = luaL_checknumber(L, 2);
+            self.rot_.x = luaL_checknumber(L, 3);
+            self.rot_.y = luaL_checknumber(L, 4);
+            self.rot_.z = luaL_checknumber(L, 5);
+            reg.patch<Transform>(check_udata(L, 1));
             return 0;
         }
 
         int get_scale(lua_State* const L) {
             GET_SCENE_PTR();
-            auto& self = check_udata(L, 1);
-            lua_pushnumber(L, self->scale_.x);
-            lua_pushnumber(L, self->scale_.y);
-            lua_pushnumber(L, self->scale_.z);
+            auto& self = check_tform(L, reg);
+            lua_pushnumber(L, self.scale_.x);
+            lua_pushnumber(L, self.scale_.y);
+            lua_pushnumber(L, self.scale_.z);
             return 3;
         }
 
         int set_scale(lua_State* const L) {
             GET_SCENE_PTR();
-            auto& self = check_udata(L, 1);
+            auto& self = check_tform(L, reg);
 
             if (lua_gettop(L) == 2) {
-                self->scale_.x = luaL_checknumber(L, 2);
-                self->scale_.y = luaL_checknumber(L, 2);
-                self->scale_.z = luaL_checknumber(L, 2);
+                self.scale_.x = luaL_checknumber(L, 2);
+                self.scale_.y = luaL_checknumber(L, 2);
+                self.scale_.z = luaL_checknumber(L, 2);
             } else {
-                self->scale_.x = luaL_checknumber(L, 2);
-                self->scale_.y = luaL_checknumber(L, 3);
-                self->scale_.z = luaL_checknumber(L, 4);
+                self.scale_.x = luaL_checknumber(L, 2);
+                self.scale_.y = luaL_checknumber(L, 3);
+                self.scale_.z = luaL_checknumber(L, 4);
             }
 
+            reg.patch<Transform>(check_udata(L, 1));
             return 0;
         }
 
@@ -284,10 +297,10 @@ namespace { namespace scene {
             GET_SCENE_PTR();
             auto& self = check_udata(L, 1);
 
-            if (auto c = reg.try_get<tview::Transform>(self)) {
+            if (reg.all_of<tview::Transform>(self)) {
                 auto o = ll.push_meta_obj<tview::UdataType>(tview::UDATA_ID);
                 if (o) {
-                    *o = c;
+                    *o = self;
                     return 1;
                 } else {
                     return luaL_error(L, "Failed to push Transform userdata.");
@@ -555,9 +568,16 @@ namespace {
             , scene_(scene)
             , skinned_actor_task_(scene)
             , ocean_task_(scene_) {
-            fence_.succeed(&skinned_actor_task_, &ocean_task_);
-            skinned_actor_task_.succeed(this);
-            ocean_task_.succeed(this);
+            linker_.add("skinned", skinned_actor_task_, {}, { "anim_state" });
+            linker_.add("ocean", ocean_task_, {}, { "ocean" });
+            linker_.link(*this, fence_);
+
+            this->reads("clock");
+            this->writes("anim_state").writes("ocean");
+
+            // Runs alongside physics, so no lazy storage creation in there
+            scene.reg_->storage<mirinae::cpnt::MdlActorSkinned>();
+            scene.reg_->storage<mirinae::cpnt::Ocean>();
         }
 
         void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
@@ -571,6 +591,7 @@ namespace {
         mirinae::Scene& scene_;
         TaskSkinnedActorUpdate skinned_actor_task_;
         TaskOceanUpdate ocean_task_;
+        mirinae::TaskLinker linker_;
         mirinae::FenceTask fence_;
     };
 
@@ -5,13 +5,17 @@
 #define MINIAUDIO_IMPLEMENTATION
 #include <SDL3/SDL_scancode.h>
 #include <miniaudio.h>
+#include <spdlog/async.h>
+#include <spdlog/details/null_mutex.h>
 #include <spdlog/sinks/base_sink.h>
 #include <dal/auxiliary/glm_tool.hpp>
 #include <dal/common/task_sys.hpp>
 #include <sung/basic/threading.hpp>
 
 #include "mirinae/lightweight/include_spdlog.hpp"
+#include "mirinae/lightweight/log_ring.hpp"
 #include "mirinae/lightweight/network.hpp"
+#include "mirinae/lightweight/profiler.hpp"
 #include "mirinae/lightweight/task.hpp"
 #include "mirinae/lua/script.hpp"
 #include "mirinae/math/mamath.hpp"
@@ -361,26 +365,25 @@ namespace {
 
 namespace {
 
-    std::vector<std::string> g_texts;
-
-    class MySink : public spdlog::sinks::base_sink<std::mutex> {
+    // The ring is thread safe and the async logger calls sinks from a single
+    // thread, so spdlog's lock is not needed
+    class MySink
+        : public spdlog::sinks::base_sink<spdlog::details::null_mutex> {
 
     protected:
         void sink_it_(const spdlog::details::log_msg& msg) override {
-            std::string_view sv{ msg.payload.data(), msg.payload.size() };
-
-            std::string ss;
-            for (auto c : sv) {
-                if (c == '\n') {
-                    g_texts.push_back(ss);
-                    ss.clear();
-                } else {
-                    ss += c;
-                }
+            const std::string_view sv{ msg.payload.data(), msg.payload.size() };
+            const auto level = static_cast<uint8_t>(msg.level);
+            auto& ring = mirinae::log_ring();
+
+            size_t begin = 0;
+            while (begin < sv.size()) {
+                auto end = sv.find('\n', begin);
+                if (end == std::string_view::npos)
+                    end = sv.size();
+                ring.push(level, sv.substr(begin, end - begin));
+                begin = end + 1;
             }
-
-            if (!ss.empty())
-                g_texts.push_back(ss);
         }
 
         void flush_() override {
@@ -427,10 +430,31 @@ namespace {
             // client_ = mirinae::create_client();
             script_ = std::make_shared<mirinae::ScriptEngine>();
             cosmos_ = std::make_shared<mirinae::CosmosSimulator>(*script_);
+            cosmos_->phys_world().give_task_sche(task_sche);
+            if (!ecinfo_.cache_dir_.empty()) {
+                cosmos_->phys_world().give_collider_cache(
+                    ecinfo_.cache_dir_ / "collider"
+                );
+            }
 
-            spdlog::default_logger()->sinks().push_back(
-                std::make_shared<MySink>()
-            );
+            // Sinks run on spdlog's thread, so task workers that log never
+            // wait on stdout or on each other
+            {
+                auto sinks = spdlog::default_logger()->sinks();
+                sinks.push_back(std::make_shared<MySink>());
+                spdlog::init_thread_pool(8192, 1);
+                auto logger = std::make_shared<spdlog::async_logger>(
+                    "mirinae",
+                    sinks.begin(),
+                    sinks.end(),
+                    spdlog::thread_pool(),
+                    spdlog::async_overflow_policy::overrun_oldest
+                );
+                logger->set_level(spdlog::default_logger()->level());
+                spdlog::set_default_logger(logger);
+            }
+            if (!ecinfo_.log_path_.empty())
+                mirinae::log_ring().start_file_flush(ecinfo_.log_path_);
 
             mirinae::register_modules(*script_);
             mirinae::spawn_entities(*cosmos_);
@@ -451,11 +475,12 @@ namespace {
             // ImGui Widgets
             {
                 imgui_main_ = mirinae::imgui::create_main_win(
-                    cosmos_, ecinfo_.filesys_, script_
+                    cosmos_, ecinfo_.filesys_, script_, ecinfo_.cache_dir_
                 );
                 cosmos_->imgui_.push_back(imgui_main_);
             }
 
+            tasks_.set_pipelined(true);
             cosmos_->register_tasks(tasks_, action_mapper_);
 
             renderer_ = mirinae::create_vk_renderer(
@@ -466,9 +491,11 @@ namespace {
             cosmos_->phys_world().give_debug_ren(renderer_->debug_ren());
         }
 
-        ~Engine() override {}
+        ~Engine() override { tasks_.wait_all(); }
 
         void do_frame() override {
+            mirinae::profiler().new_frame();
+
             audio_.tick();
             tasks_.start();
 
@@ -497,8 +524,23 @@ namespace {
             }
             */
 
+            // The sync point. Nothing runs from here until the render stage
+            // starts, so ImGui widgets may edit any component.
+            tasks_.wait_all();
+            for (auto& imgui : cosmos_->imgui_) {
+                imgui->do_frame(cosmos_->scene().clock());
+            }
+            // Stages only read input, so it is cleared out here
+            action_mapper_.finish_frame();
+
             // client_->do_frame();
-            renderer_->do_frame();
+            {
+                MIRINAE_PROF_ZONE("renderer frame");
+                renderer_->do_frame();
+            }
+
+            // Renders this frame while the next one simulates
+            tasks_.start_after_sync();
         }
 
         bool is_ongoing() override { return true; }
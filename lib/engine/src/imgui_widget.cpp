@@ -1,5 +1,8 @@
 #include "imgui_widget.hpp"
 
+#include <algorithm>
+#include <ctime>
+
 #include <imgui.h>
 #include <imgui_stdlib.h>
 #include <entt/entity/registry.hpp>
@@ -16,14 +19,13 @@
 #include "mirinae/cpnt/terrain.hpp"
 #include "mirinae/cpnt/transform.hpp"
 #include "mirinae/lightweight/include_spdlog.hpp"
+#include "mirinae/lightweight/log_ring.hpp"
+#include "mirinae/lightweight/profiler.hpp"
 #include "mirinae/lua/script.hpp"
 
 
 namespace {
 
-    std::vector<std::string> g_texts;
-
-
     template <size_t TSize>
     class RollingBuffer {
 
@@ -116,7 +118,9 @@ namespace {
         entt::registry& reg() { return cosmos_->reg(); }
 
         template <typename T, typename... Args>
-        void render_cpnt(T& component, const char* name, Args&&... args) {
+        void render_cpnt(
+            entt::entity e, T& component, const char* name, Args&&... args
+        ) {
             constexpr auto flags = ImGuiTreeNodeFlags_DefaultOpen;
             const auto h_name = fmt::format(
                 "{}###{}", name, fmt::ptr(&component)
@@ -128,6 +132,8 @@ namespace {
                 ImGui::PushID(&component);
                 component.render_imgui(std::forward<Args>(args)...);
                 ImGui::PopID();
+                // Edited in place, so let the signal listeners know
+                this->reg().patch<T>(e);
                 ImGui::Unindent(10);
             }
             ImGui::Unindent(10);
@@ -144,31 +150,31 @@ namespace {
 
             if (ImGui::CollapsingHeader(entt_name.c_str())) {
                 if (auto c = this->reg().try_get<cpnt::Id>(e))
-                    this->render_cpnt(*c, "ID");
+                    this->render_cpnt(e, *c, "ID");
                 if (auto c = this->reg().try_get<cpnt::StandardCamera>(e))
-                    this->render_cpnt(*c, "Standard Camera");
+                    this->render_cpnt(e, *c, "Standard Camera");
                 if (auto c = this->reg().try_get<cpnt::MdlActorStatic>(e))
-                    this->render_cpnt(*c, "Static Actor");
+                    this->render_cpnt(e, *c, "Static Actor");
                 if (auto c = this->reg().try_get<cpnt::MdlActorSkinned>(e))
-                    this->render_cpnt(*c, "Skinned Actor", this->clock());
+                    this->render_cpnt(e, *c, "Skinned Actor", this->clock());
                 if (auto c = this->reg().try_get<cpnt::DLight>(e))
-                    this->render_cpnt(*c, "Directional Light");
+                    this->render_cpnt(e, *c, "Directional Light");
                 if (auto c = this->reg().try_get<cpnt::SLight>(e))
-                    this->render_cpnt(*c, "Spotlight");
+                    this->render_cpnt(e, *c, "Spotlight");
                 if (auto c = this->reg().try_get<cpnt::VPLight>(e))
-                    this->render_cpnt(*c, "Volumetric Point Light");
+                    this->render_cpnt(e, *c, "Volumetric Point Light");
                 if (auto c = this->reg().try_get<cpnt::Terrain>(e))
-                    this->render_cpnt(*c, "Terrain");
+                    this->render_cpnt(e, *c, "Terrain");
                 if (auto c = this->reg().try_get<cpnt::Ocean>(e))
-                    this->render_cpnt(*c, "Ocean");
+                    this->render_cpnt(e, *c, "Ocean");
                 if (auto c = this->reg().try_get<cpnt::AtmosphereSimple>(e))
-                    this->render_cpnt(*c, "Atmosphere Simple");
+                    this->render_cpnt(e, *c, "Atmosphere Simple");
                 if (auto c = this->reg().try_get<cpnt::AtmosphereEpic>(e))
-                    this->render_cpnt(*c, "Atmosphere Epic");
+                    this->render_cpnt(e, *c, "Atmosphere Epic");
                 if (auto c = this->reg().try_get<cpnt::Envmap>(e))
-                    this->render_cpnt(*c, "Envmap");
+                    this->render_cpnt(e, *c, "Envmap");
                 if (auto c = this->reg().try_get<cpnt::Transform>(e))
-                    this->render_cpnt(*c, "Transform");
+                    this->render_cpnt(e, *c, "Transform");
             }
         }
 
@@ -235,15 +241,89 @@ namespace {
     };
 
 
+    class ImGuiProfiler : public IWindowDialog {
+
+    public:
+        // Traces cannot be captured if `trace_dir` is empty
+        ImGuiProfiler(const std::filesystem::path& trace_dir)
+            : trace_dir_(trace_dir) {}
+
+        void render() override {
+            if (!this->begin("Profiler"))
+                return;
+
+            auto& profiler = mirinae::profiler();
+
+            bool enabled = profiler.enabled();
+            if (ImGui::Checkbox("Enabled", &enabled))
+                profiler.set_enabled(enabled);
+
+            ImGui::SetNextItemWidth(100);
+            ImGui::InputInt("Frames", &capture_frames_);
+            capture_frames_ = std::max(capture_frames_, 1);
+            ImGui::SameLine();
+            if (trace_dir_.empty()) {
+                ImGui::TextUnformatted("No cache directory for traces");
+            } else if (profiler.is_capturing()) {
+                ImGui::TextUnformatted("Capturing...");
+            } else if (ImGui::Button("Capture trace")) {
+                const auto file_name = fmt::format(
+                    "trace_{}.json", std::time(nullptr)
+                );
+                profiler.capture(capture_frames_, trace_dir_ / file_name);
+            }
+
+            auto stats = profiler.stats();
+            std::sort(stats.begin(), stats.end(), [](auto& a, auto& b) {
+                return a.avg_ms_ > b.avg_ms_;
+            });
+
+            constexpr auto table_flags = ImGuiTableFlags_Borders |
+                                         ImGuiTableFlags_RowBg |
+                                         ImGuiTableFlags_ScrollY;
+            if (ImGui::BeginTable("zones", 4, table_flags)) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Zone");
+                ImGui::TableSetupColumn("Avg (ms)");
+                ImGui::TableSetupColumn("Max (ms)");
+                ImGui::TableSetupColumn("Calls");
+                ImGui::TableHeadersRow();
+
+                for (auto& s : stats) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(s.name_.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", s.avg_ms_);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", s.max_ms_);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", s.avg_calls_);
+                }
+
+                ImGui::EndTable();
+            }
+
+            this->end();
+        }
+
+    private:
+        std::filesystem::path trace_dir_;
+        int capture_frames_ = 60;
+    };
+
+
     class ImGuiMainWin : public IWindowDialog {
 
     public:
         ImGuiMainWin(
             mirinae::HCosmos cosmos,
             dal::HFilesys filesys,
-            std::shared_ptr<mirinae::ScriptEngine> script
+            std::shared_ptr<mirinae::ScriptEngine> script,
+            const std::filesystem::path& cache_dir
         )
-            : entt_(cosmos) {
+            : entt_(cosmos)
+            , profiler_(cache_dir.empty() ? cache_dir : cache_dir / "trace") {
             show_ = false;
             this->set_init_size(680, 640);
             this->add_begin_flag(ImGuiWindowFlags_MenuBar);
@@ -254,6 +334,9 @@ namespace {
             cvars_.set_init_size(360, 480);
             cvars_.set_init_pos(50, 50);
 
+            profiler_.set_init_size(480, 480);
+            profiler_.set_init_pos(50, 50);
+
             console_.give_script(script);
 
             const auto font_path = ":asset/font/SeoulNamsanM.ttf";
@@ -272,6 +355,9 @@ namespace {
                     if (ImGui::BeginMenu("View")) {
                         ImGui::MenuItem("Entities", nullptr, &entt_.show_);
                         ImGui::MenuItem("CVars", nullptr, &cvars_.show_);
+                        ImGui::MenuItem(
+                            "Profiler", nullptr, &profiler_.show_
+                        );
                         ImGui::EndMenu();
                     }
 
@@ -298,6 +384,7 @@ namespace {
 
             entt_.render();
             cvars_.render();
+            profiler_.render();
         }
 
         void toggle_show() override {
@@ -311,6 +398,8 @@ namespace {
 
         public:
             void render_imgui() {
+                this->fetch_logs();
+
                 if (ImGui::BeginChild(
                         "ScrollingRegion",
                         ImVec2(0, -30),
@@ -318,12 +407,15 @@ namespace {
                         ImGuiWindowFlags_HorizontalScrollbar
                     )) {
                     ImGuiListClipper clipper;
-                    clipper.Begin(g_texts.size());
+                    clipper.Begin(lines_.size());
                     while (clipper.Step())
                         for (int i = clipper.DisplayStart;
                              i < clipper.DisplayEnd;
                              i++) {
-                            ImGui::TextUnformatted(g_texts[i].c_str());
+                            const auto text = lines_[i].text();
+                            ImGui::TextUnformatted(
+                                text.data(), text.data() + text.size()
+                            );
                         }
 
                     if (scroll_to_bottom_)
@@ -355,15 +447,28 @@ namespace {
             }
 
         private:
+            // Only new records are copied from the ring each frame
+            void fetch_logs() {
+                auto& ring = mirinae::log_ring();
+                cursor_ = ring.snapshot(cursor_, lines_);
+                if (lines_.size() > ring.capacity() * 2) {
+                    const auto excess = lines_.size() - ring.capacity();
+                    lines_.erase(lines_.begin(), lines_.begin() + excess);
+                }
+            }
+
             void enter_text() {
-                g_texts.push_back(input_buf_.data());
+                const std::string command = input_buf_.data();
+                mirinae::log_ring().push(SPDLOG_LEVEL_INFO, command);
                 input_buf_.fill(0);
                 scroll_to_bottom_ = true;
 
                 if (script_)
-                    script_->exec(g_texts.back().c_str());
+                    script_->exec(command.c_str());
             }
 
+            std::vector<mirinae::LogRecord> lines_;
+            uint64_t cursor_ = 0;
             std::shared_ptr<mirinae::ScriptEngine> script_;
             std::array<char, 256> input_buf_{};
             bool scroll_to_bottom_ = false;
@@ -390,6 +495,7 @@ namespace {
 
         ImGuiEntt entt_;
         ImGuiCvars cvars_;
+        ImGuiProfiler profiler_;
 
         ImVector<ImWchar> ranges_;
         ::RollingBuffer<300> fps_samples_;
@@ -403,9 +509,12 @@ namespace mirinae::imgui {
     std::shared_ptr<IMainWin> create_main_win(
         mirinae::HCosmos cosmos,
         dal::HFilesys filesys,
-        std::shared_ptr<mirinae::ScriptEngine> script
+        std::shared_ptr<mirinae::ScriptEngine> script,
+        const std::filesystem::path& cache_dir
     ) {
-        return std::make_shared<::ImGuiMainWin>(cosmos, filesys, script);
+        return std::make_shared<::ImGuiMainWin>(
+            cosmos, filesys, script, cache_dir
+        );
     }
 
 }  // namespace mirinae::imgui
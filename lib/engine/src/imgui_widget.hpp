@@ -1,5 +1,6 @@
 #pragma once
 
+#include <filesystem>
 #include <memory>
 
 #include <dal/filesys/filesys.hpp>
@@ -17,7 +18,8 @@ namespace mirinae::imgui {
     std::shared_ptr<IMainWin> create_main_win(
         mirinae::HCosmos cosmos,
         dal::HFilesys filesys,
-        std::shared_ptr<mirinae::ScriptEngine> script
+        std::shared_ptr<mirinae::ScriptEngine> script,
+        const std::filesystem::path& cache_dir
     );
 
 }  // namespace mirinae::imgui
@@ -49,6 +49,10 @@ namespace mirinae {
         size_t frame_index_;
         VkCommandBuffer cmd_buf_;
         VkPipelineLayout pipe_layout_;
+        // Both use `pipe_layout_`. Widgets binding the text pipeline must
+        // bind `pipeline_` back afterwards.
+        VkPipeline pipeline_ = VK_NULL_HANDLE;
+        VkPipeline text_pipeline_ = VK_NULL_HANDLE;
     };
 
 
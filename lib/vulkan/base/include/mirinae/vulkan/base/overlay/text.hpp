@@ -44,6 +44,8 @@ namespace mirinae {
         uint32_t atlas_width() const;
         uint32_t atlas_height() const;
 
+        VulkanDevice& device() { return device_; }
+
     private:
         constexpr static int START_CHAR = 32;
         constexpr static int END_CHAR = 127;
@@ -53,6 +55,7 @@ namespace mirinae {
         std::unique_ptr<mirinae::ITexture> texture_;
         dal::TDataImage2D<unsigned char> bitmap_;
         mirinae::OverlayRenderUnit render_unit_;
+        VulkanDevice& device_;
     };
 
 
@@ -83,8 +86,35 @@ namespace mirinae {
         bool enable_scroll_ = true;
 
     private:
+        // Everything the glyph layout depends on
+        struct LayoutKey {
+            bool operator==(const LayoutKey& rhs) const;
+
+            const ITextData* texts_ = nullptr;
+            uint64_t revision_ = 0;
+            glm::dvec2 pos_{ 0 };
+            glm::dvec2 size_{ 0 };
+            glm::dvec2 scroll_{ 0 };
+            glm::dvec2 win_dim_{ 0 };
+        };
+
+        struct FrameData {
+            Buffer glyph_buf_;
+            size_t capacity_ = 0;
+            uint64_t layout_id_ = 0;
+        };
+
+        LayoutKey make_layout_key(const WidgetRenderUniData& udata) const;
+        void build_layout(const WidgetRenderUniData& udata);
+        void upload_layout(FrameData& fd);
+
         TextRenderData& text_render_data_;
         std::shared_ptr<ITextData> texts_;
+        std::vector<OverlayGlyph> glyphs_;
+        std::vector<FrameData> frame_data_;
+        LayoutKey layout_key_;
+        // Increments every time `glyphs_` is rebuilt, 0 for never
+        uint64_t layout_id_ = 0;
         IOsIoFunctions* osio_ = nullptr;
         glm::dvec2 last_mouse_pos_;
         double line_spacing_ = 1.2;
@@ -273,6 +273,9 @@ namespace mirinae {
             return this->mip_base(0).mip_count(1).layer_base(0).layer_count(1);
         }
 
+        // Ownership transfer between queue families
+        ImageMemoryBarrier& queue_families(uint32_t src, uint32_t dst);
+
         const VkImageMemoryBarrier& get() const;
 
         void record_single(
@@ -501,12 +504,15 @@ namespace mirinae {
 
         DescSetBindInfo& set(VkDescriptorSet set);
         DescSetBindInfo& add(VkDescriptorSet set);
+        // For dynamic buffers of the sets, in binding order
+        DescSetBindInfo& dyn_offset(uint32_t offset);
         DescSetBindInfo& clear();
 
         void record(VkCommandBuffer cmdbuf);
 
     private:
         std::vector<VkDescriptorSet> desc_sets_;
+        std::vector<uint32_t> dyn_offsets_;
         VkPipelineBindPoint bind_point_ = VK_PIPELINE_BIND_POINT_GRAPHICS;
         VkPipelineLayout layout_ = VK_NULL_HANDLE;
         uint32_t first_set_ = 0;
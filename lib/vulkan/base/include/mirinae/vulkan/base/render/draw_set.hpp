@@ -4,83 +4,191 @@
 
 #include "mirinae/cpnt/light.hpp"
 #include "mirinae/cpnt/ocean.hpp"
+#include "mirinae/math/cull.hpp"
 #include "mirinae/vulkan/base/render/renderee.hpp"
 #include "mirinae/vulkan/base/renderee/ren_actor_skinned.hpp"
 
 
 namespace mirinae {
 
-    class DrawSheet {
-
-    public:
-        struct StaticRenderPairs {
-            struct Actor {
-                mirinae::RenderActor* actor_;
-                glm::dmat4 model_mat_;
-            };
-
-            mirinae::RenderUnit* unit_;
-            std::vector<Actor> actors_;
-        };
-
-        struct SkinnedRenderPairs {
-            struct Actor {
-                mirinae::RenderActorSkinned* actor_;
-                glm::dmat4 model_mat_;
-            };
-
-            mirinae::RenderUnitSkinned* unit_;
-            std::vector<Actor> actors_;
-        };
-
-    public:
-        void build(entt::registry& reg);
-
-    private:
-        StaticRenderPairs& get_static(mirinae::RenderUnit& unit);
-        StaticRenderPairs& get_static_trs(mirinae::RenderUnit& unit);
-        SkinnedRenderPairs& get_skinned(mirinae::RenderUnitSkinned& unit);
-        SkinnedRenderPairs& get_skinned_trs(mirinae::RenderUnitSkinned& unit);
-
-    public:
-        std::vector<StaticRenderPairs> static_;
-        std::vector<StaticRenderPairs> static_trs_;
-        std::vector<SkinnedRenderPairs> skinned_;
-        std::vector<SkinnedRenderPairs> skinned_trs_;
-        cpnt::Ocean* ocean_ = nullptr;
-        cpnt::AtmosphereSimple* atmosphere_ = nullptr;
-    };
-
-
     class DrawSetStatic {
 
     public:
         struct StaticActor {
             const mirinae::RenderUnit* unit_ = nullptr;
             const mirinae::RenderActor* actor_ = nullptr;
-            glm::dmat4 model_mat_{ 1 };
+            uint32_t mat_idx_ = 0;
         };
 
         struct SkinnedActor {
             const RenderUnitSkinned* unit_ = nullptr;
             const RenderActorSkinned* actor_ = nullptr;
-            glm::dmat4 model_mat_{ 1 };
+            uint32_t mat_idx_ = 0;
             size_t runit_idx_ = 0;
         };
 
+        // Handle to the items added for one model actor. They share the model
+        // matrix at the same index, but are not contiguous in the lists.
+        using SpanId = uint32_t;
+
+        // Indices into `opa()` and `skin_opa()` of the actors in a view
+        struct ViewList {
+            std::vector<uint32_t> opa_;
+            std::vector<uint32_t> skin_opa_;
+        };
+
+        class CullResult {
+
+        public:
+            const ViewList& view(size_t index) const {
+                return views_.at(index);
+            }
+
+        private:
+            friend class DrawSetStatic;
+            std::vector<ViewList> views_;
+            std::vector<uint8_t> masks_;
+        };
+
         void fetch(const entt::registry& reg);
         void clear();
 
+        SpanId add(
+            const RenderModel& model,
+            const RenderActor& actor,
+            const VisibilityArray& visibility,
+            const glm::dmat4& model_mat
+        );
+        SpanId add(
+            const RenderModelSkinned& model,
+            const RenderActorSkinned& actor,
+            const VisibilityArray& visibility,
+            const glm::dmat4& model_mat
+        );
+        // Swaps the last items into the holes, so other items may move
+        void remove(SpanId span);
+        void set_model_mat(SpanId span, const glm::dmat4& model_mat);
+
+        // Tests opaque actors against each of `views` on the task workers.
+        // Results are in the same order as `views`.
+        void cull(
+            const std::vector<FrustumPlanes>& views, CullResult& out
+        ) const;
+
         const std::vector<StaticActor>& opa() const { return opa_; }
         const std::vector<StaticActor>& trs() const { return trs_; }
         const std::vector<SkinnedActor>& skin_opa() const { return skin_opa_; }
         const std::vector<SkinnedActor>& skin_trs() const { return skin_trs_; }
 
+        const glm::dmat4& model_mat(const StaticActor& item) const {
+            return model_mats_[item.mat_idx_];
+        }
+        const glm::dmat4& model_mat(const SkinnedActor& item) const {
+            return model_mats_[item.mat_idx_];
+        }
+
     private:
+        struct SpanSlot {
+            // Indices into `opa_` and `trs_`, or `skin_opa_` and `skin_trs_`
+            std::vector<uint32_t> opa_;
+            std::vector<uint32_t> trs_;
+            bool skinned_ = false;
+        };
+
+        // Where an item is listed in its span
+        struct ItemRef {
+            SpanId span_ = 0;
+            uint32_t pos_ = 0;
+        };
+
+        using SpanList = std::vector<uint32_t> SpanSlot::*;
+
+        SpanId alloc_span(bool skinned, const glm::dmat4& model_mat);
+        void link_item(std::vector<ItemRef>& refs, SpanId span, SpanList list);
+
+        template <typename T>
+        void swap_remove(
+            std::vector<T>& items,
+            std::vector<ItemRef>& refs,
+            SpanList list,
+            SphereBatch* bounds,
+            uint32_t index
+        );
+
+        // Indexed by `SpanId`
+        std::vector<glm::dmat4> model_mats_;
+        std::vector<SpanSlot> spans_;
+        std::vector<SpanId> free_spans_;
+
         std::vector<StaticActor> opa_;
         std::vector<StaticActor> trs_;
         std::vector<SkinnedActor> skin_opa_;
         std::vector<SkinnedActor> skin_trs_;
+
+        // Parallel to the lists above
+        std::vector<ItemRef> opa_refs_;
+        std::vector<ItemRef> trs_refs_;
+        std::vector<ItemRef> skin_opa_refs_;
+        std::vector<ItemRef> skin_trs_refs_;
+
+        // World space bounds, parallel to `opa_` and `skin_opa_`
+        SphereBatch opa_bounds_;
+        SphereBatch skin_bounds_;
+    };
+
+
+    // Model actor edits read out of the registry by `DrawSetCache::collect`,
+    // so `DrawSetCache::update` can apply them while the registry moves on
+    struct DrawSetChanges {
+        struct Actor {
+            entt::entity entity_;
+            std::shared_ptr<IRenModel> model_;
+            std::shared_ptr<IRenActor> actor_;
+            VisibilityArray visibility_;
+            glm::dmat4 model_mat_{ 1 };
+            // False if the entity no longer has the model actor
+            bool exists_ = false;
+        };
+
+        struct Move {
+            entt::entity entity_;
+            glm::dmat4 model_mat_{ 1 };
+        };
+
+        void clear();
+
+        std::vector<Actor> statics_;
+        std::vector<Actor> skinneds_;
+        std::vector<Move> moves_;
+    };
+
+
+    // Draw lists of all model actors, shared by the passes and kept across
+    // frames. Only entities named by registry signals are visited. Model
+    // actor signals resolve the entity again and replace only its own items
+    // if it changed. Transform signals only rewrite its model matrix, so
+    // anything moving a Transform in place must `patch()` it.
+    class DrawSetCache {
+
+    public:
+        DrawSetCache();
+        ~DrawSetCache();
+
+        void attach(entt::registry& reg);
+        void detach();
+
+        // Reads the entities named by signals since the last call. Nothing
+        // else may edit the registry meanwhile.
+        void collect(DrawSetChanges& out);
+        // Call once per frame before any pass reads `draw_set()`. Does not
+        // touch the registry.
+        void update(const DrawSetChanges& changes);
+
+        const DrawSetStatic& draw_set() const;
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> pimpl_;
     };
 
 
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+
+#include "mirinae/vulkan/base/render/upload.hpp"
+
+
+namespace mirinae {
+
+    // Where a mesh lives in a `GeometryArena`. Offsets and counts are in
+    // vertices and indices, ready for `vkCmdDrawIndexed`.
+    struct GeometrySlice {
+        uint32_t block_ = 0;
+        uint32_t vtx_offset_ = 0;
+        uint32_t vtx_count_ = 0;
+        uint32_t idx_offset_ = 0;
+        uint32_t idx_count_ = 0;
+    };
+
+
+    // Suballocates vertex and index data of one vertex layout from a few
+    // large device local buffers, so meshes sharing a block can be drawn
+    // without rebinding buffers in between.
+    //
+    // Freed ranges are reused only after the frames that may still read
+    // them are done, which is counted in `tick()` calls.
+    class GeometryArena {
+
+    public:
+        GeometryArena(VulkanMemoryAllocator allocator, uint32_t vertex_stride);
+        ~GeometryArena();
+
+        // Meshes larger than a block get a block of their own
+        GeometrySlice alloc(uint32_t vtx_count, uint32_t idx_count);
+        void free(const GeometrySlice& slice);
+
+        UploadTicket upload(
+            const GeometrySlice& slice,
+            const void* vertices,
+            const void* indices,
+            UploadService& uploader
+        );
+
+        void record_bind(VkCommandBuffer cmdbuf, uint32_t block) const;
+
+        // Call once every frame
+        void tick();
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> pimpl_;
+    };
+
+
+    // Remembers the last bound arena block of a command buffer, so a pass
+    // drawing many meshes binds the arena buffers only when they change.
+    class GeometryBindCache {
+
+    public:
+        void bind(
+            VkCommandBuffer cmdbuf,
+            const GeometryArena& arena,
+            const GeometrySlice& slice
+        );
+
+    private:
+        const GeometryArena* arena_ = nullptr;
+        uint32_t block_ = 0;
+    };
+
+}  // namespace mirinae
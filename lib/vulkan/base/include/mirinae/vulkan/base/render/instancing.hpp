@@ -0,0 +1,72 @@
+#pragma once
+
+#include "mirinae/vulkan/base/render/draw_set.hpp"
+#include "mirinae/vulkan/base/render/uniform.hpp"
+#include "mirinae/vulkan/base/render/vkdevice.hpp"
+
+
+namespace mirinae {
+
+    // Opaque static actors grouped by render unit, so that each group is
+    // drawn with a single instanced draw
+    class InstanceGroups {
+
+    public:
+        struct Group {
+            const RenderUnit* unit_ = nullptr;
+            // Range of `mats()`, used as the first instance index
+            uint32_t first_ = 0;
+            uint32_t count_ = 0;
+        };
+
+        void clear();
+
+        // `opa` indexes `draw_set.opa()`. Instance matrices are
+        // `pre * model_mat_`. Returns the index of the first new group.
+        size_t add(
+            const DrawSetStatic& draw_set,
+            const std::vector<uint32_t>& opa,
+            const glm::dmat4& pre
+        );
+
+        const std::vector<Group>& groups() const { return groups_; }
+        const std::vector<glm::mat4>& mats() const { return mats_; }
+
+    private:
+        std::vector<std::pair<const RenderUnit*, uint32_t>> sorted_;
+        std::vector<Group> groups_;
+        std::vector<glm::mat4> mats_;
+    };
+
+
+    // Storage buffer of instance matrices per frame in flight, bound with
+    // the "gbuf:instances" descriptor layout
+    class InstanceBuffer {
+
+    public:
+        InstanceBuffer(VulkanDevice& device);
+        ~InstanceBuffer();
+
+        void init(uint32_t max_flight_count, const DesclayoutManager&);
+        void destroy();
+
+        // Grows the buffer of the frame if needed
+        void upload(FrameIndex f_idx, const std::vector<glm::mat4>& mats);
+
+        VkDescriptorSet descset(FrameIndex f_idx) const;
+
+    private:
+        struct FrameData {
+            Buffer buf_;
+            VkDescriptorSet descset_ = VK_NULL_HANDLE;
+            size_t capacity_ = 0;
+        };
+
+        void reserve(FrameData& fd, size_t count);
+
+        std::vector<FrameData> frame_data_;
+        DescPool desc_pool_;
+        VulkanDevice& device_;
+    };
+
+}  // namespace mirinae
@@ -56,11 +56,20 @@ namespace mirinae {
             const Buffer& src, VkCommandBuffer cmdbuf, VkDevice logi_device
         );
 
+        // Persistent mapping, valid until `unmap()` or `destroy()`
+        void* map();
+        void unmap();
+        // Makes host writes visible to the device
+        void flush();
+        // Makes device writes visible to the host
+        void invalidate();
+
     private:
         VulkanMemoryAllocator allocator_ = nullptr;
         VkBuffer buffer_ = VK_NULL_HANDLE;
         VmaAllocation allocation_ = VK_NULL_HANDLE;
         VkDeviceSize size_ = 0;
+        void* mapped_ = nullptr;
     };
 
 
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <entt/entity/registry.hpp>
+
+#include "mirinae/vulkan/base/render/draw_set.hpp"
+
+
+namespace mirinae {
+
+    // Everything the render passes read of one frame, copied out of the
+    // cosmos before the sync point so the next frame may simulate while this
+    // one renders
+    class RenderState {
+
+    public:
+        struct StaticActor {
+            // Null if not ready yet
+            std::shared_ptr<IRenActor> actor_;
+            glm::dmat4 model_mat_{ 1 };
+        };
+
+        struct SkinnedActor {
+            // Null if not ready yet
+            std::shared_ptr<IRenActor> actor_;
+            glm::dmat4 model_mat_{ 1 };
+            // Empty if nothing was sampled
+            std::vector<glm::mat4> palette_;
+            uint64_t palette_rev_ = 0;
+        };
+
+        // Replaces the cameras, lights, atmospheres, oceans and terrains in
+        // `reg()`, and the transforms of those entities. Entities keep their
+        // identifiers.
+        void copy_scene(const entt::registry& src, entt::entity main_camera);
+        void clear();
+
+        entt::registry& reg() { return reg_; }
+        const entt::registry& reg() const { return reg_; }
+
+        entt::entity main_camera_ = entt::null;
+        double dt_ = 0;
+        // Slots may be filled concurrently, so sized before filling
+        std::vector<StaticActor> statics_;
+        std::vector<SkinnedActor> skinneds_;
+        DrawSetChanges draw_set_changes_;
+
+    private:
+        entt::registry reg_;
+    };
+
+
+    // The render passes read `front()` while `back()` is filled for the next
+    // frame. Only the contents swap, so references to either stay valid.
+    class RenderStates {
+
+    public:
+        RenderState& front() { return front_; }
+        const RenderState& front() const { return front_; }
+        RenderState& back() { return back_; }
+
+        void flip();
+        void clear();
+
+    private:
+        RenderState front_;
+        RenderState back_;
+    };
+
+}  // namespace mirinae
@@ -8,6 +8,8 @@
 
 #include "mirinae/cpnt/ren_model.hpp"
 #include "mirinae/lightweight/skin_anim.hpp"
+#include "mirinae/math/cull.hpp"
+#include "mirinae/vulkan/base/render/geometry.hpp"
 #include "mirinae/vulkan/base/render/texture.hpp"
 #include "mirinae/vulkan/base/render/uniform.hpp"
 #include "mirinae/vulkan/base/render/vkcomposition.hpp"
@@ -26,7 +28,6 @@ namespace mirinae {
             VkImageView albedo_map,
             VkImageView normal_map,
             VkImageView orm_map,
-            CommandPool& cmd_pool,
             DesclayoutManager& desclayouts,
             VulkanDevice& vulkan_device
         );
@@ -35,15 +36,28 @@ namespace mirinae {
         const std::string& name() const { return name_; }
         VkDescriptorSet get_desc_set(size_t index) const;
         void record_bind_vert_buf(VkCommandBuffer cmdbuf) const;
+        void record_bind_vert_buf(
+            VkCommandBuffer cmdbuf, GeometryBindCache& cache
+        ) const;
         uint32_t vertex_count() const;
+        UploadTicket upload_ticket() const;
+
+        // Pass these to `vkCmdDrawIndexed` since units share buffers
+        uint32_t first_index() const { return geo_.idx_offset_; }
+        int32_t vertex_offset() const;
 
         auto& raw_data() const { return raw_data_; }
+        // In model space
+        auto& bounds() const { return bounds_; }
 
     private:
         std::string name_;
         VerticesStaticPair raw_data_;
+        BoundingSphere bounds_;
         DescPool desc_pool_;
-        VertexIndexPair vert_index_pair_;
+        GeometrySlice geo_;
+        GeometryArena* geometry_ = nullptr;
+        UploadTicket upload_ = 0;
         Buffer uniform_buf_;
         std::vector<VkDescriptorSet> desc_sets_;
     };
@@ -60,7 +74,6 @@ namespace mirinae {
             VkImageView albedo_map,
             VkImageView normal_map,
             VkImageView orm_map,
-            CommandPool& cmd_pool,
             DesclayoutManager& desclayouts,
             VulkanDevice& vulkan_device
         );
@@ -70,11 +83,15 @@ namespace mirinae {
         VkDescriptorSet get_desc_set(size_t index) const;
         void record_bind_vert_buf(VkCommandBuffer cmdbuf) const;
         uint32_t vertex_count() const;
+        UploadTicket upload_ticket() const;
 
         const VertexIndexPair& vk_buffers() const { return vert_index_pair_; }
+        // In model space, covering the bind pose with some margin
+        auto& bounds() const { return bounds_; }
 
     private:
         std::string name_;
+        BoundingSphere bounds_;
         DescPool desc_pool_;
         VertexIndexPair vert_index_pair_;
         Buffer uniform_buf_;
@@ -186,13 +203,15 @@ namespace mirinae {
         void init(uint32_t max_flight_count, DesclayoutManager& desclayouts);
         void destroy();
 
+        // Writes to the device's uniform ring, so call it every frame
         void udpate_ubuf(uint32_t index, const U_GbufActor& data);
         VkDescriptorSet get_desc_set(size_t index) const;
+        // Bind the descriptor set with this as its dynamic offset
+        uint32_t ubuf_offset(size_t index) const;
 
     private:
-        DescPool desc_pool_;
-        std::vector<Buffer> uniform_buf_;
         std::vector<VkDescriptorSet> desc_sets_;
+        std::vector<uint32_t> ubuf_offsets_;
         VulkanDevice& device_;
     };
 
@@ -21,6 +21,16 @@ namespace mirinae {
         const VkBuffer src_buffer
     );
 
+    // Generate mipmaps from mip 0. Every mip must be in transfer dst layout
+    // and ends in shader read only layout.
+    void record_img_gen_mips(
+        const VkCommandBuffer cmdbuf,
+        const uint32_t width,
+        const uint32_t height,
+        const uint32_t mip_levels,
+        const VkImage image
+    );
+
 
     enum class FbufUsage {
         color_attachment,
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+
+#include "mirinae/vulkan/base/context/base.hpp"
+#include "mirinae/vulkan/base/render/mem_alloc.hpp"
+
+
+namespace mirinae {
+
+    class DescLayout;
+
+
+    // Per frame uniform data that lives in one persistently mapped buffer
+    // per frame in flight. Allocations are bump-allocated and only valid
+    // until the frame index comes around again, so write them every frame
+    // and bind them with their offset as the dynamic offset.
+    //
+    // Writing is lock free. Each thread claims sub-blocks of the frame's
+    // buffer with a single atomic add and fills them on its own.
+    class UbufRing {
+
+    public:
+        UbufRing(
+            VkDevice logi_device,
+            VulkanMemoryAllocator allocator,
+            VkDeviceSize offset_alignment
+        );
+        ~UbufRing();
+
+        // Forgets everything written to the frame. Call once the frame's
+        // fence has been waited on, before anything writes to it.
+        void begin_frame(FrameIndex f_idx);
+        // Makes writes visible to the device. Call before submitting.
+        void end_frame(FrameIndex f_idx);
+
+        // Offset of `size` bytes of `data` in the frame's buffer, or null
+        // if the frame is out of space
+        std::optional<uint32_t> write(
+            FrameIndex f_idx, const void* data, size_t size
+        );
+
+        template <typename T>
+        std::optional<uint32_t> write(FrameIndex f_idx, const T& data) {
+            return this->write(f_idx, &data, sizeof(T));
+        }
+
+        // For layouts with a single dynamic uniform buffer binding that
+        // reads `range` bytes. Created once and shared by every caller.
+        VkDescriptorSet descset(
+            FrameIndex f_idx, const DescLayout& layout, VkDeviceSize range
+        );
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> pimpl_;
+    };
+
+}  // namespace mirinae
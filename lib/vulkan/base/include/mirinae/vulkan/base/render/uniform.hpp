@@ -32,6 +32,11 @@ namespace mirinae {
     };
 
 
+    struct U_GbufInstPushConst {
+        glm::mat4 proj_;
+    };
+
+
     struct U_EnvmapPushConst {
         glm::mat4 proj_view_;
         glm::vec4 dlight_dir_;
@@ -78,6 +83,15 @@ namespace mirinae {
     };
 
 
+    // Per instance vertex input of the overlay text pipeline
+    struct OverlayGlyph {
+        glm::vec2 pos_offset_;
+        glm::vec2 pos_scale_;
+        glm::vec2 uv_offset_;
+        glm::vec2 uv_scale_;
+    };
+
+
     class U_OverlayMain {
 
     public:
@@ -162,6 +176,7 @@ namespace mirinae {
 
         // Uniform buffer
         DescLayoutBuilder& add_ubuf(VkShaderStageFlags, uint32_t cnt);
+        DescLayoutBuilder& add_ubuf_dyn(VkShaderStageFlags, uint32_t cnt);
         DescLayoutBuilder& add_ubuf_frag(uint32_t cnt) {
             return this->add_ubuf(VK_SHADER_STAGE_FRAGMENT_BIT, cnt);
         }
@@ -273,6 +288,8 @@ namespace mirinae {
 
         DescWriter& add_buf_write(VkDescriptorSet, uint32_t binding);
         DescWriter& add_storage_buf_write(VkDescriptorSet, uint32_t binding);
+        // Uniform buffer bound with a dynamic offset
+        DescWriter& add_dyn_buf_write(VkDescriptorSet, uint32_t binding);
 
         DescWriter& add_sampled_img_write(VkDescriptorSet, uint32_t binding);
         DescWriter& add_storage_img_write(VkDescriptorSet, uint32_t binding);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "mirinae/vulkan/base/render/mem_alloc.hpp"
+
+
+namespace mirinae {
+
+    // Identifies a batch of uploads. Zero is always done.
+    using UploadTicket = uint64_t;
+
+
+    struct UploadQueue {
+        VkQueue queue_ = VK_NULL_HANDLE;
+        uint32_t family_ = 0;
+    };
+
+
+    // Streams data to device local buffers and images without stalling the
+    // graphics queue. Data is copied into a persistently mapped staging ring
+    // and copies are batched until `tick()` submits them, on the transfer
+    // queue if there is one. Resources are handed over to the graphics
+    // family once the returned ticket is done.
+    //
+    // Thread safe. Models and textures upload from task workers while the
+    // render stage is recording, so any other submit to the graphics or
+    // transfer queue must hold `lock_queues()`, as Vulkan requires queues
+    // to be externally synchronized.
+    class UploadService {
+
+    public:
+        UploadService(
+            VkDevice logi_device,
+            VulkanMemoryAllocator allocator,
+            const UploadQueue& graphics,
+            const std::optional<UploadQueue>& transfer,
+            VkDeviceSize copy_alignment
+        );
+        ~UploadService();
+
+        // `dst` must have been created with transfer dst usage. It can be
+        // read by vertex, index and shader stages afterwards.
+        UploadTicket upload_buffer(
+            VkBuffer dst, VkDeviceSize offset, const void* data, size_t size
+        );
+
+        // Fills mip 0 of `dst` with tightly packed texels and generates the
+        // rest. Every mip ends in shader read only optimal layout.
+        UploadTicket upload_image(
+            VkImage dst,
+            uint32_t width,
+            uint32_t height,
+            uint32_t mip_levels,
+            const void* data,
+            size_t size
+        );
+
+        // Submits recorded copies and retires finished batches. Call once
+        // every frame.
+        void tick();
+
+        bool is_done(UploadTicket ticket);
+        void wait(UploadTicket ticket);
+        void wait_all();
+
+        // Held by every queue submit of this service. Do not call upload
+        // functions while holding it.
+        std::unique_lock<std::mutex> lock_queues();
+
+    private:
+        class Impl;
+        std::unique_ptr<Impl> pimpl_;
+    };
+
+}  // namespace mirinae
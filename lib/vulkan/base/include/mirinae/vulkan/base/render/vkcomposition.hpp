@@ -1,5 +1,6 @@
 #pragma once
 
+#include "upload.hpp"
 #include "vkmajorplayers.hpp"
 
 
@@ -8,20 +9,10 @@ namespace mirinae {
     class VertexIndexPair {
 
     public:
-        void init(
-            const VerticesStaticPair& vertices,
-            CommandPool& cmdpool,
-            VulkanMemoryAllocator allocator,
-            VkQueue graphics_q,
-            VkDevice logi_device
-        );
-
         void init(
             const VerticesSkinnedPair& vertices,
-            CommandPool& cmdpool,
-            VulkanMemoryAllocator allocator,
-            VkQueue graphics_q,
-            VkDevice logi_device
+            UploadService& uploader,
+            VulkanMemoryAllocator allocator
         );
 
         void destroy(VulkanMemoryAllocator allocator);
@@ -29,6 +20,8 @@ namespace mirinae {
         void record_bind(VkCommandBuffer cmdbuf) const;
 
         uint32_t vertex_count() const;
+        // Buffers may not be drawn until this is done
+        UploadTicket upload_ticket() const { return upload_; }
 
         const Buffer& vtx() const { return vertex_buf_; }
         const Buffer& idx() const { return index_buf_; }
@@ -37,6 +30,7 @@ namespace mirinae {
         mirinae::Buffer vertex_buf_;
         mirinae::Buffer index_buf_;
         size_t vertex_count_ = 0;
+        UploadTicket upload_ = 0;
     };
 
 }  // namespace mirinae
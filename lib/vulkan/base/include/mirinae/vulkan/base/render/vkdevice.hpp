@@ -13,6 +13,10 @@ struct ImGui_ImplVulkan_InitInfo;
 
 namespace mirinae {
 
+    class GeometryArena;
+    class UbufRing;
+    class UploadService;
+
     size_t align_up(size_t original_size, size_t min_alignment);
 
 
@@ -47,6 +51,11 @@ namespace mirinae {
         const VkPhysicalDeviceFeatures& features() const;
         void wait_idle();
 
+        // Pass to every pipeline creation. Saved when the device is
+        // destroyed, and on `save_pipeline_cache()` if it grew.
+        VkPipelineCache pipeline_cache();
+        void save_pipeline_cache();
+
         // Physical device
         VkPhysicalDevice phys_device();
         std::optional<uint32_t> graphics_queue_family_index();
@@ -56,10 +65,16 @@ namespace mirinae {
         // Sub-systems
         ISamplerManager& samplers();
         IImageFormats& img_formats();
+        UploadService& uploader();
+        // Vertices and indices of every static mesh
+        GeometryArena& geometry();
+        // Uniform data rewritten every frame
+        UbufRing& ubuf_ring();
 
         // Misc
         VulkanMemoryAllocator mem_alloc();
         dal::Filesystem& filesys();
+        const FileMapper* file_mapper() const;
         IOsIoFunctions& osio();
 
         void fill_imgui_info(ImGui_ImplVulkan_InitInfo& info);
@@ -7,6 +7,7 @@
 
 #include "mirinae/lightweight/lightweights.hpp"
 #include "mirinae/vulkan/base/render/meshdata.hpp"
+#include "mirinae/vulkan/base/render/upload.hpp"
 #include "mirinae/vulkan/base/render/vkdevice.hpp"
 
 
@@ -85,6 +86,7 @@ namespace mirinae {
             VkCommandBuffer cmdbuf, VkQueue graphics_q, VkDevice logi_device
         );
         void end_single_time(VkCommandBuffer cmdbuf, VulkanDevice& device) {
+            const auto lock = device.uploader().lock_queues();
             this->end_single_time(
                 cmdbuf, device.graphics_queue(), device.logi_device()
             );
@@ -28,13 +28,13 @@ namespace mirinae {
     };
 
 
-    class TaskAtmosEpic : public mirinae::DependingTask {
+    // Creates the render units of atmospheres that have none
+    class TaskAtmosEpicUnits : public mirinae::DependingTask {
 
     public:
         void init(
             uint32_t max_flight_count,
             entt::registry& reg,
-            RpCtxtBase& rp_ctxt,
             VulkanDevice& device
         );
 
@@ -45,8 +45,23 @@ namespace mirinae {
 
         entt::registry* reg_ = nullptr;
         VulkanDevice* device_ = nullptr;
-        RpCtxtBase* rp_ctxt_ = nullptr;
         uint32_t max_flight_count_ = 0;
     };
 
+
+    // Uploads the parameters of atmospheres that have render units
+    class TaskAtmosEpic : public mirinae::DependingTask {
+
+    public:
+        void init(const entt::registry& reg, RpCtxtBase& rp_ctxt);
+
+        void prepare();
+
+    private:
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override;
+
+        const entt::registry* reg_ = nullptr;
+        RpCtxtBase* rp_ctxt_ = nullptr;
+    };
+
 }  // namespace mirinae
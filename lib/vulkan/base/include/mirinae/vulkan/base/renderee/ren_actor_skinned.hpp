@@ -31,6 +31,7 @@ namespace mirinae {
         );
         void destroy();
 
+        // Writes to the device's uniform ring, so call it every frame
         void update_ubuf(
             const FrameIndex f_index, const U_GbufActor& static_data
         );
@@ -41,7 +42,17 @@ namespace mirinae {
             const size_t joint_count
         );
 
+        // Skips the upload if the frame's buffer already holds `revision`
+        void update_joint_palette(
+            const FrameIndex f_index,
+            const glm::mat4* const joint_palette,
+            const size_t joint_count,
+            const uint64_t revision
+        );
+
         VkDescriptorSet get_descset(FrameIndex f_index) const;
+        // Bind the descriptor set with this as its dynamic offset
+        uint32_t ubuf_offset(FrameIndex f_index) const;
         const IRenUnit& get_runit(size_t unit_idx) const;
         const IRenUnit& get_runit_trs(size_t unit_idx) const;
 
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <mutex>
+
+#include <entt/fwd.hpp>
+
 #include "mirinae/cpnt/terrain.hpp"
+#include "mirinae/lightweight/task.hpp"
 #include "mirinae/vulkan/base/render/texture.hpp"
 #include "mirinae/vulkan/base/render/uniform.hpp"
 
@@ -42,4 +47,28 @@ namespace mirinae {
         uint32_t vtx_count_ = 0;
     };
 
+
+    // Creates the render units of terrains that have none
+    class TaskTerrainUnits : public mirinae::DependingTask {
+
+    public:
+        void init(
+            entt::registry& reg,
+            ITextureManager& tex,
+            DesclayoutManager& desclayouts,
+            VulkanDevice& device
+        );
+
+        void prepare();
+
+    private:
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override;
+
+        entt::registry* reg_ = nullptr;
+        ITextureManager* tex_ = nullptr;
+        DesclayoutManager* desclayouts_ = nullptr;
+        VulkanDevice* device_ = nullptr;
+        std::mutex tex_mut_;
+    };
+
 }  // namespace mirinae
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mutex>
+
 #include "mirinae/vulkan/base/render/vkdevice.hpp"
 
 
@@ -453,4 +455,35 @@ namespace mirinae {
         VulkanDevice& device
     );
 
+
+    // Lets render passes be constructed on several threads. Holders run one
+    // at a time, so shared registries need no locking of their own, except
+    // that shader loads and pipeline compiles release the lock because
+    // Vulkan allows them to run concurrently.
+    class RpCreateLock {
+
+    public:
+        // Does not lock again if the thread already holds `mut`
+        explicit RpCreateLock(std::mutex& mut);
+        ~RpCreateLock();
+
+        RpCreateLock(const RpCreateLock&) = delete;
+        RpCreateLock& operator=(const RpCreateLock&) = delete;
+
+        // Releases the calling thread's lock while alive, if it holds one
+        class Unlocked {
+
+        public:
+            Unlocked();
+            ~Unlocked();
+
+        private:
+            RpCreateLock* owner_ = nullptr;
+        };
+
+    private:
+        std::unique_lock<std::mutex> lock_;
+        RpCreateLock* prev_ = nullptr;
+    };
+
 }  // namespace mirinae
@@ -8,13 +8,14 @@
 #include "mirinae/cpnt/camera.hpp"
 #include "mirinae/lightweight/debug_ren.hpp"
 #include "mirinae/vulkan/base/context/camera.hpp"
+#include "mirinae/vulkan/base/render/draw_set.hpp"
+#include "mirinae/vulkan/base/render/render_state.hpp"
 #include "mirinae/vulkan/base/render/renderee.hpp"
 
 
 namespace mirinae {
 
     class CosmosSimulator;
-    class DrawSheet;
 
 
     class RenderPass {
@@ -240,11 +241,13 @@ namespace mirinae {
         ~RpResources();
 
         DesclayoutManager desclays_;
+        DrawSetCache draw_sets_;
         FbufImageBundle gbuf_;
         HEnvmapBundle envmaps_;
         HShadowMaps shadow_maps_;
         HTexMgr tex_man_;
         RenderTargetManager ren_img_;
+        RenderStates ren_states_;
         RpCommandPool cmd_pool_;
 
         VulkanDevice& device_;
@@ -414,6 +417,11 @@ namespace mirinae {
         virtual void destroy() = 0;
         virtual VkFramebuffer fbuf_at(uint32_t index) const = 0;
 
+        // Extra pipelines sharing `pipe_layout()`, null if out of range
+        virtual VkPipeline sub_pipeline(size_t index) const {
+            return VK_NULL_HANDLE;
+        }
+
         VkPipeline pipeline() const override { return pipeline_; }
         VkPipelineLayout pipe_layout() const override { return layout_; }
         VkRenderPass render_pass() const override { return renderpass_; }
@@ -4,10 +4,12 @@
 #include <SDL3/SDL_scancode.h>
 #include <stb_truetype.h>
 
+#include <algorithm>
 #include <sstream>
 
 #include "mirinae/lightweight/include_spdlog.hpp"
 #include "mirinae/vulkan/base/render/cmdbuf.hpp"
+#include "mirinae/vulkan/base/render/mem_cinfo.hpp"
 
 
 namespace {
@@ -57,7 +59,7 @@ namespace mirinae {
 namespace mirinae {
 
     TextRenderData::TextRenderData(mirinae::VulkanDevice& device)
-        : render_unit_(device) {}
+        : render_unit_(device), device_(device) {}
 
     void TextRenderData::init_ascii(
         FontLibrary& fonts,
@@ -126,92 +128,51 @@ namespace mirinae {
     }
 
     void TextBox::record_render(const mirinae::WidgetRenderUniData& udata) {
-        mirinae::DescSetBindInfo{}
-            .layout(udata.pipe_layout_)
-            .set(text_render_data_.get_desc_set(udata.frame_index_))
-            .record(udata.cmd_buf_);
-
-        const sung::Aabb2D<double> widget_box(
-            pos_.x, pos_.x + size_.x, pos_.y, pos_.y + size_.y
-        );
-        auto x_offset = pos_.x;
-        auto y_offset = pos_.y + text_render_data_.text_height();
+        const auto key = this->make_layout_key(udata);
+        if (0 == layout_id_ || !(key == layout_key_)) {
+            this->build_layout(udata);
+            layout_key_ = key;
+            ++layout_id_;
+        }
 
-        PushConstInfo pc_info{};
-        pc_info.layout(udata.pipe_layout_).add_stage_vert().add_stage_frag();
+        if (glyphs_.empty())
+            return;
 
-        for (auto c : texts_->make_str32()) {
-            if ('\n' == c) {
-                x_offset = pos_.x;
-                y_offset += text_render_data_.text_height() * line_spacing_;
-                continue;
-            }
+        if (frame_data_.size() <= udata.frame_index_)
+            frame_data_.resize(udata.frame_index_ + 1);
+        auto& fd = frame_data_.at(udata.frame_index_);
+        if (fd.layout_id_ != layout_id_)
+            this->upload_layout(fd);
 
-            const auto& char_info = text_render_data_.get_char_info(c);
-            const sung::Aabb2D<double> char_info_box(
-                char_info.x0, char_info.x1, char_info.y0, char_info.y1
-            );
-            const auto char_info_min = ::get_aabb_min(char_info_box);
-            const auto char_info_dim = ::get_aabb_dim(char_info_box);
-            const glm::dvec2 texture_dim(
-                text_render_data_.atlas_width(),
-                text_render_data_.atlas_height()
-            );
+        vkCmdBindPipeline(
+            udata.cmd_buf_,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            udata.text_pipeline_
+        );
 
-            const sung::Aabb2D<double> glyph_box(
-                x_offset + char_info.xoff + scroll_.x,
-                x_offset + char_info.xoff + scroll_.x + char_info_dim.x,
-                y_offset + char_info.yoff + scroll_.y,
-                y_offset + char_info.yoff + scroll_.y + char_info_dim.y
-            );
+        mirinae::DescSetBindInfo{}
+            .layout(udata.pipe_layout_)
+            .set(text_render_data_.get_desc_set(udata.frame_index_))
+            .record(udata.cmd_buf_);
 
-            mirinae::U_OverlayPushConst push_const;
-            sung::Aabb2D<double> clipped_glyph_box;
-            if (widget_box.make_intersection(glyph_box, clipped_glyph_box)) {
-                const auto clipped_glyph_area = clipped_glyph_box.area();
-                if (clipped_glyph_area <= 0.0) {
-                    x_offset += char_info.xadvance;
-                    continue;
-                } else if (clipped_glyph_area < glyph_box.area()) {
-                    push_const.pos_offset = udata.pos_2_ndc(
-                        clipped_glyph_box.x_min(), clipped_glyph_box.y_min()
-                    );
-                    push_const.pos_scale = udata.len_2_ndc(
-                        clipped_glyph_box.width(), clipped_glyph_box.height()
-                    );
-                    push_const.uv_scale = char_info_dim *
-                                          ::get_aabb_dim(clipped_glyph_box) /
-                                          (::get_aabb_dim(glyph_box) *
-                                           texture_dim);
-                    const auto texture_space_offset =
-                        (::get_aabb_min(clipped_glyph_box) -
-                         ::get_aabb_min(glyph_box)) *
-                        char_info_dim / ::get_aabb_dim(glyph_box);
-                    push_const.uv_offset = (char_info_min +
-                                            texture_space_offset) /
-                                           texture_dim;
-                } else {
-                    push_const.pos_offset = udata.pos_2_ndc(
-                        glyph_box.x_min(), glyph_box.y_min()
-                    );
-                    push_const.pos_scale = udata.len_2_ndc(
-                        glyph_box.width(), glyph_box.height()
-                    );
-                    push_const.uv_offset = char_info_min / texture_dim;
-                    push_const.uv_scale = char_info_dim / texture_dim;
-                }
-            } else {
-                x_offset += char_info.xadvance;
-                continue;
-            }
+        mirinae::U_OverlayPushConst push_const;
+        push_const.color = { 1, 1, 1, 1 };
+        PushConstInfo{}
+            .layout(udata.pipe_layout_)
+            .add_stage_vert()
+            .add_stage_frag()
+            .record(udata.cmd_buf_, push_const);
 
-            push_const.color = { 1, 1, 1, 1 };
+        mirinae::BindVertBufInfo<1>{}
+            .set_at<0>(fd.glyph_buf_)
+            .record(udata.cmd_buf_);
 
-            pc_info.record(udata.cmd_buf_, push_const);
+        const auto glyph_count = static_cast<uint32_t>(glyphs_.size());
+        vkCmdDraw(udata.cmd_buf_, 6, glyph_count, 0, 0);
 
-            vkCmdDraw(udata.cmd_buf_, 6, 1, 0, 0);
-            x_offset += char_info.xadvance;
-        }
+        vkCmdBindPipeline(
+            udata.cmd_buf_, VK_PIPELINE_BIND_POINT_GRAPHICS, udata.pipeline_
+        );
     }
 
     bool TextBox::on_key_event(const mirinae::key::Event& e) {
@@ -294,4 +255,113 @@ namespace mirinae {
     }
     void TextBox::replace_osio(IOsIoFunctions& osio) { osio_ = &osio; }
 
+    bool TextBox::LayoutKey::operator==(const LayoutKey& rhs) const {
+        return texts_ == rhs.texts_ && revision_ == rhs.revision_ &&
+               pos_ == rhs.pos_ && size_ == rhs.size_ &&
+               scroll_ == rhs.scroll_ && win_dim_ == rhs.win_dim_;
+    }
+
+    TextBox::LayoutKey TextBox::make_layout_key(
+        const WidgetRenderUniData& udata
+    ) const {
+        LayoutKey out;
+        out.texts_ = texts_.get();
+        out.revision_ = texts_->revision();
+        out.pos_ = pos_;
+        out.size_ = size_;
+        out.scroll_ = scroll_;
+        out.win_dim_ = glm::dvec2{ udata.width(), udata.height() };
+        return out;
+    }
+
+    void TextBox::build_layout(const WidgetRenderUniData& udata) {
+        glyphs_.clear();
+
+        const sung::Aabb2D<double> widget_box(
+            pos_.x, pos_.x + size_.x, pos_.y, pos_.y + size_.y
+        );
+        const glm::dvec2 texture_dim(
+            text_render_data_.atlas_width(), text_render_data_.atlas_height()
+        );
+        auto x_offset = pos_.x;
+        auto y_offset = pos_.y + text_render_data_.text_height();
+
+        for (auto c : texts_->make_str32()) {
+            if ('\n' == c) {
+                x_offset = pos_.x;
+                y_offset += text_render_data_.text_height() * line_spacing_;
+                continue;
+            }
+
+            const auto& char_info = text_render_data_.get_char_info(c);
+            const sung::Aabb2D<double> char_info_box(
+                char_info.x0, char_info.x1, char_info.y0, char_info.y1
+            );
+            const auto char_info_min = ::get_aabb_min(char_info_box);
+            const auto char_info_dim = ::get_aabb_dim(char_info_box);
+
+            const sung::Aabb2D<double> glyph_box(
+                x_offset + char_info.xoff + scroll_.x,
+                x_offset + char_info.xoff + scroll_.x + char_info_dim.x,
+                y_offset + char_info.yoff + scroll_.y,
+                y_offset + char_info.yoff + scroll_.y + char_info_dim.y
+            );
+            x_offset += char_info.xadvance;
+
+            sung::Aabb2D<double> clipped_glyph_box;
+            if (!widget_box.make_intersection(glyph_box, clipped_glyph_box))
+                continue;
+            const auto clipped_glyph_area = clipped_glyph_box.area();
+            if (clipped_glyph_area <= 0.0)
+                continue;
+
+            auto& glyph = glyphs_.emplace_back();
+            if (clipped_glyph_area < glyph_box.area()) {
+                glyph.pos_offset_ = udata.pos_2_ndc(
+                    clipped_glyph_box.x_min(), clipped_glyph_box.y_min()
+                );
+                glyph.pos_scale_ = udata.len_2_ndc(
+                    clipped_glyph_box.width(), clipped_glyph_box.height()
+                );
+                glyph.uv_scale_ = char_info_dim *
+                                  ::get_aabb_dim(clipped_glyph_box) /
+                                  (::get_aabb_dim(glyph_box) * texture_dim);
+                const auto texture_space_offset =
+                    (::get_aabb_min(clipped_glyph_box) -
+                     ::get_aabb_min(glyph_box)) *
+                    char_info_dim / ::get_aabb_dim(glyph_box);
+                glyph.uv_offset_ = (char_info_min + texture_space_offset) /
+                                   texture_dim;
+            } else {
+                glyph.pos_offset_ = udata.pos_2_ndc(
+                    glyph_box.x_min(), glyph_box.y_min()
+                );
+                glyph.pos_scale_ = udata.len_2_ndc(
+                    glyph_box.width(), glyph_box.height()
+                );
+                glyph.uv_offset_ = char_info_min / texture_dim;
+                glyph.uv_scale_ = char_info_dim / texture_dim;
+            }
+        }
+    }
+
+    // Each frame in flight has its own buffer, which its previous
+    // submission is done with by the time it records again
+    void TextBox::upload_layout(FrameData& fd) {
+        if (fd.capacity_ < glyphs_.size()) {
+            fd.capacity_ = std::max(glyphs_.size(), fd.capacity_ * 2);
+
+            BufferCreateInfo cinfo;
+            cinfo.set_usage(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+                .add_alloc_flag_host_access_seq_write()
+                .set_size(fd.capacity_ * sizeof(OverlayGlyph));
+            fd.glyph_buf_.init(cinfo, text_render_data_.device().mem_alloc());
+        }
+
+        fd.glyph_buf_.set_data(
+            glyphs_.data(), glyphs_.size() * sizeof(OverlayGlyph)
+        );
+        fd.layout_id_ = layout_id_;
+    }
+
 }  // namespace mirinae
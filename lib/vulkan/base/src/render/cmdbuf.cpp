@@ -117,6 +117,12 @@ namespace mirinae {
         return *this;
     }
 
+    CLS& CLS::queue_families(uint32_t src, uint32_t dst) {
+        info_.srcQueueFamilyIndex = src;
+        info_.dstQueueFamilyIndex = dst;
+        return *this;
+    }
+
     const VkImageMemoryBarrier& CLS::get() const { return info_; }
 
     void CLS::record_single(
@@ -199,6 +205,7 @@ namespace mirinae {
     DescSetBindInfo& CLS::set(VkDescriptorSet set) {
         desc_sets_.resize(1);
         desc_sets_[0] = set;
+        dyn_offsets_.clear();
         return *this;
     }
 
@@ -207,8 +214,14 @@ namespace mirinae {
         return *this;
     }
 
+    DescSetBindInfo& CLS::dyn_offset(uint32_t offset) {
+        dyn_offsets_.push_back(offset);
+        return *this;
+    }
+
     DescSetBindInfo& CLS::clear() {
         desc_sets_.clear();
+        dyn_offsets_.clear();
         return *this;
     }
 
@@ -220,8 +233,8 @@ namespace mirinae {
             first_set_,
             static_cast<uint32_t>(desc_sets_.size()),
             desc_sets_.data(),
-            0,
-            nullptr
+            static_cast<uint32_t>(dyn_offsets_.size()),
+            dyn_offsets_.data()
         );
     }
 
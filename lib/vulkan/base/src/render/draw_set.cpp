@@ -1,15 +1,117 @@
 #include "mirinae/vulkan/base/render/draw_set.hpp"
 
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
 #include <entt/entity/registry.hpp>
 
 #include "mirinae/cpnt/ren_model.hpp"
 #include "mirinae/cpnt/transform.hpp"
+#include "mirinae/lightweight/profiler.hpp"
+#include "mirinae/lightweight/task.hpp"
+
+
+namespace {
+
+    // Below this many sphere blocks per task, dispatching costs more than it
+    // saves
+    constexpr uint32_t CULL_MIN_BLOCKS = 64;
+
+
+    // Blocks of `opa` come first, then those of `skin`
+    class CullTask : public enki::ITaskSet {
+
+    public:
+        CullTask(
+            const mirinae::SphereBatch& opa,
+            const mirinae::SphereBatch& skin,
+            const std::vector<mirinae::FrustumPlanes>& views,
+            uint8_t* masks
+        )
+            : opa_(opa), skin_(skin), views_(views), masks_(masks) {}
+
+        uint32_t block_count() const {
+            return static_cast<uint32_t>(
+                opa_.block_count() + skin_.block_count()
+            );
+        }
+
+        void run(uint32_t block_begin, uint32_t block_end) const {
+            const auto stride = opa_.size() + skin_.size();
+            const auto opa_blocks = static_cast<uint32_t>(opa_.block_count());
+            const auto opa_end = std::min(block_end, opa_blocks);
+            const auto skin_begin = std::max(block_begin, opa_blocks);
+
+            for (size_t i = 0; i < views_.size(); ++i) {
+                auto mask = masks_ + i * stride;
+                if (block_begin < opa_end)
+                    opa_.cull(views_[i], block_begin, opa_end, mask);
+
+                mask += opa_.size();
+                if (skin_begin < block_end) {
+                    skin_.cull(
+                        views_[i],
+                        skin_begin - opa_blocks,
+                        block_end - opa_blocks,
+                        mask
+                    );
+                }
+            }
+        }
+
+    private:
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
+            this->run(range.start, range.end);
+        }
+
+        const mirinae::SphereBatch& opa_;
+        const mirinae::SphereBatch& skin_;
+        const std::vector<mirinae::FrustumPlanes>& views_;
+        uint8_t* masks_;
+    };
 
 
-// DrawSheet
+    void sort_unique(std::vector<entt::entity>& v) {
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+    }
+
+    glm::dmat4 make_model_mat(const entt::registry& reg, entt::entity e) {
+        if (auto tform = reg.try_get<mirinae::cpnt::Transform>(e))
+            return tform->make_model_mat();
+        return glm::dmat4(1);
+    }
+
+    template <typename TMdlActor>
+    void collect_actor(
+        entt::entity e,
+        const entt::registry& reg,
+        std::vector<mirinae::DrawSetChanges::Actor>& out
+    ) {
+        auto mactor = reg.valid(e) ? reg.try_get<TMdlActor>(e) : nullptr;
+
+        auto& dst = out.emplace_back();
+        dst.entity_ = e;
+        if (!mactor)
+            return;
+
+        dst.model_ = mactor->model_;
+        dst.actor_ = mactor->actor_;
+        dst.visibility_ = mactor->visibility_;
+        dst.model_mat_ = ::make_model_mat(reg, e);
+        dst.exists_ = true;
+    }
+
+}  // namespace
+
+
+// DrawSetStatic
 namespace mirinae {
 
-    void DrawSheet::build(entt::registry& reg) {
+    void DrawSetStatic::fetch(const entt::registry& reg) {
         namespace cpnt = mirinae::cpnt;
 
         for (const auto e : reg.view<cpnt::MdlActorStatic>()) {
@@ -23,33 +125,9 @@ namespace mirinae {
             if (!actor)
                 continue;
 
-            glm::dmat4 model_mat(1);
-            if (auto tfrom = reg.try_get<cpnt::Transform>(e))
-                model_mat = tfrom->make_model_mat();
-
-            const auto unit_count = renmdl->render_units_.size();
-            for (size_t i = 0; i < unit_count; ++i) {
-                if (!mactor.visibility_.get(i))
-                    continue;
-
-                auto& unit = renmdl->render_units_[i];
-                auto& dst = this->get_static(unit);
-                auto& dst_actor = dst.actors_.emplace_back();
-                dst_actor.actor_ = actor;
-                dst_actor.model_mat_ = model_mat;
-            }
-
-            const auto unit_trs_count = renmdl->render_units_alpha_.size();
-            for (size_t i = 0; i < unit_trs_count; ++i) {
-                if (!mactor.visibility_.get(i + unit_count))
-                    continue;
-
-                auto& unit = renmdl->render_units_alpha_[i];
-                auto& dst = this->get_static_trs(unit);
-                auto& dst_actor = dst.actors_.emplace_back();
-                dst_actor.actor_ = actor;
-                dst_actor.model_mat_ = model_mat;
-            }
+            this->add(
+                *renmdl, *actor, mactor.visibility_, ::make_model_mat(reg, e)
+            );
         }
 
         for (const auto e : reg.view<cpnt::MdlActorSkinned>()) {
@@ -63,195 +141,479 @@ namespace mirinae {
             if (!actor)
                 continue;
 
-            glm::dmat4 model_mat(1);
-            if (auto tfrom = reg.try_get<cpnt::Transform>(e))
-                model_mat = tfrom->make_model_mat();
+            this->add(
+                *renmdl, *actor, mactor.visibility_, ::make_model_mat(reg, e)
+            );
+        }
+    }
 
-            const auto unit_count = renmdl->runits_.size();
-            for (size_t i = 0; i < unit_count; ++i) {
-                if (!mactor.visibility_.get(i))
-                    continue;
+    void DrawSetStatic::clear() {
+        model_mats_.clear();
+        spans_.clear();
+        free_spans_.clear();
+        opa_.clear();
+        trs_.clear();
+        skin_opa_.clear();
+        skin_trs_.clear();
+        opa_refs_.clear();
+        trs_refs_.clear();
+        skin_opa_refs_.clear();
+        skin_trs_refs_.clear();
+        opa_bounds_.clear();
+        skin_bounds_.clear();
+    }
 
-                auto& unit = renmdl->runits_[i];
-                auto& dst = this->get_skinned(unit);
-                auto& dst_actor = dst.actors_.emplace_back();
-                dst_actor.actor_ = actor;
-                dst_actor.model_mat_ = model_mat;
-            }
+    DrawSetStatic::SpanId DrawSetStatic::add(
+        const RenderModel& model,
+        const RenderActor& actor,
+        const VisibilityArray& visibility,
+        const glm::dmat4& model_mat
+    ) {
+        const auto span = this->alloc_span(false, model_mat);
 
-            const auto unit_trs_count = renmdl->runits_alpha_.size();
-            for (size_t i = 0; i < unit_trs_count; ++i) {
-                if (!mactor.visibility_.get(i + unit_count))
-                    continue;
+        const auto unit_count = model.render_units_.size();
+        for (size_t i = 0; i < unit_count; ++i) {
+            if (!visibility.get(i))
+                continue;
 
-                auto& unit = renmdl->runits_alpha_[i];
-                auto& dst = this->get_skinned_trs(unit);
-                auto& dst_actor = dst.actors_.emplace_back();
-                dst_actor.actor_ = actor;
-                dst_actor.model_mat_ = model_mat;
-            }
+            auto& dst = opa_.emplace_back();
+            dst.unit_ = &model.render_units_[i];
+            dst.actor_ = &actor;
+            dst.mat_idx_ = span;
+            opa_bounds_.push_back(dst.unit_->bounds().transform(model_mat));
+            this->link_item(opa_refs_, span, &SpanSlot::opa_);
         }
 
-        this->ocean_ = nullptr;
-        for (auto e : reg.view<cpnt::Ocean>()) {
-            // Only one ocean is allowed
-            this->ocean_ = &reg.get<cpnt::Ocean>(e);
-            break;
-        }
+        const auto unit_trs_count = model.render_units_alpha_.size();
+        for (size_t i = 0; i < unit_trs_count; ++i) {
+            if (!visibility.get(i + unit_count))
+                continue;
 
-        this->atmosphere_ = nullptr;
-        for (auto e : reg.view<cpnt::AtmosphereSimple>()) {
-            // Only one atmosphere is allowed
-            this->atmosphere_ = &reg.get<cpnt::AtmosphereSimple>(e);
-            break;
+            auto& dst = trs_.emplace_back();
+            dst.unit_ = &model.render_units_alpha_[i];
+            dst.actor_ = &actor;
+            dst.mat_idx_ = span;
+            this->link_item(trs_refs_, span, &SpanSlot::trs_);
         }
+
+        return span;
     }
 
-    DrawSheet::StaticRenderPairs& DrawSheet::get_static(
-        mirinae::RenderUnit& unit
+    DrawSetStatic::SpanId DrawSetStatic::add(
+        const RenderModelSkinned& model,
+        const RenderActorSkinned& actor,
+        const VisibilityArray& visibility,
+        const glm::dmat4& model_mat
     ) {
-        for (auto& x : static_) {
-            if (x.unit_ == &unit)
-                return x;
+        const auto span = this->alloc_span(true, model_mat);
+
+        const auto unit_count = model.runits_.size();
+        for (size_t i = 0; i < unit_count; ++i) {
+            if (!visibility.get(i))
+                continue;
+
+            auto& dst = skin_opa_.emplace_back();
+            dst.unit_ = &model.runits_.at(i);
+            dst.actor_ = &actor;
+            dst.mat_idx_ = span;
+            dst.runit_idx_ = i;
+            skin_bounds_.push_back(dst.unit_->bounds().transform(model_mat));
+            this->link_item(skin_opa_refs_, span, &SpanSlot::opa_);
+        }
+
+        const auto unit_trs_count = model.runits_alpha_.size();
+        for (size_t i = 0; i < unit_trs_count; ++i) {
+            if (!visibility.get(i + unit_count))
+                continue;
+
+            auto& dst = skin_trs_.emplace_back();
+            dst.unit_ = &model.runits_alpha_.at(i);
+            dst.actor_ = &actor;
+            dst.mat_idx_ = span;
+            dst.runit_idx_ = i;
+            this->link_item(skin_trs_refs_, span, &SpanSlot::trs_);
+        }
+
+        return span;
+    }
+
+    void DrawSetStatic::remove(SpanId span) {
+        auto& slot = spans_[span];
+
+        // Highest first, so the last item of a list never belongs to `span`
+        // unless it is the one being removed
+        std::sort(slot.opa_.begin(), slot.opa_.end(), std::greater<>());
+        std::sort(slot.trs_.begin(), slot.trs_.end(), std::greater<>());
+
+        if (slot.skinned_) {
+            for (const auto i : slot.opa_) {
+                this->swap_remove(
+                    skin_opa_, skin_opa_refs_, &SpanSlot::opa_, &skin_bounds_, i
+                );
+            }
+            for (const auto i : slot.trs_) {
+                this->swap_remove(
+                    skin_trs_, skin_trs_refs_, &SpanSlot::trs_, nullptr, i
+                );
+            }
+        } else {
+            for (const auto i : slot.opa_) {
+                this->swap_remove(
+                    opa_, opa_refs_, &SpanSlot::opa_, &opa_bounds_, i
+                );
+            }
+            for (const auto i : slot.trs_)
+                this->swap_remove(trs_, trs_refs_, &SpanSlot::trs_, nullptr, i);
         }
 
-        auto& output = static_.emplace_back();
-        output.unit_ = &unit;
-        return output;
+        slot.opa_.clear();
+        slot.trs_.clear();
+        free_spans_.push_back(span);
     }
 
-    DrawSheet::StaticRenderPairs& DrawSheet::get_static_trs(
-        mirinae::RenderUnit& unit
+    void DrawSetStatic::set_model_mat(
+        SpanId span, const glm::dmat4& model_mat
     ) {
-        for (auto& x : static_trs_) {
-            if (x.unit_ == &unit)
-                return x;
+        model_mats_[span] = model_mat;
+
+        const auto& slot = spans_[span];
+        if (slot.skinned_) {
+            for (const auto i : slot.opa_) {
+                const auto& bounds = skin_opa_[i].unit_->bounds();
+                skin_bounds_.set(i, bounds.transform(model_mat));
+            }
+        } else {
+            for (const auto i : slot.opa_) {
+                const auto& bounds = opa_[i].unit_->bounds();
+                opa_bounds_.set(i, bounds.transform(model_mat));
+            }
+        }
+    }
+
+    void DrawSetStatic::cull(
+        const std::vector<FrustumPlanes>& views, CullResult& out
+    ) const {
+        const auto stride = opa_.size() + skin_opa_.size();
+        out.masks_.resize(views.size() * stride);
+
+        ::CullTask task(opa_bounds_, skin_bounds_, views, out.masks_.data());
+        const auto block_count = task.block_count();
+        if (block_count <= ::CULL_MIN_BLOCKS) {
+            task.run(0, block_count);
+        } else {
+            task.m_SetSize = block_count;
+            task.m_MinRange = ::CULL_MIN_BLOCKS;
+            dal::tasker().AddTaskSetToPipe(&task);
+            dal::tasker().WaitforTask(&task);
         }
 
-        auto& output = static_trs_.emplace_back();
-        output.unit_ = &unit;
-        return output;
+        // Keeps the capacity of the lists across frames
+        out.views_.resize(views.size());
+        for (size_t v = 0; v < views.size(); ++v) {
+            auto& list = out.views_[v];
+            list.opa_.clear();
+            list.skin_opa_.clear();
+
+            const auto mask = out.masks_.data() + v * stride;
+            for (uint32_t i = 0; i < opa_.size(); ++i) {
+                if (mask[i])
+                    list.opa_.push_back(i);
+            }
+
+            const auto skin_mask = mask + opa_.size();
+            for (uint32_t i = 0; i < skin_opa_.size(); ++i) {
+                if (skin_mask[i])
+                    list.skin_opa_.push_back(i);
+            }
+        }
     }
 
-    DrawSheet::SkinnedRenderPairs& DrawSheet::get_skinned(
-        mirinae::RenderUnitSkinned& unit
+
+    DrawSetStatic::SpanId DrawSetStatic::alloc_span(
+        bool skinned, const glm::dmat4& model_mat
     ) {
-        for (auto& x : skinned_) {
-            if (x.unit_ == &unit)
-                return x;
+        SpanId span;
+        if (free_spans_.empty()) {
+            span = static_cast<SpanId>(spans_.size());
+            spans_.emplace_back();
+            model_mats_.push_back(model_mat);
+        } else {
+            span = free_spans_.back();
+            free_spans_.pop_back();
+            model_mats_[span] = model_mat;
         }
 
-        auto& output = skinned_.emplace_back();
-        output.unit_ = &unit;
-        return output;
+        spans_[span].skinned_ = skinned;
+        return span;
+    }
+
+    void DrawSetStatic::link_item(
+        std::vector<ItemRef>& refs, SpanId span, SpanList list
+    ) {
+        auto& indices = spans_[span].*list;
+        auto& ref = refs.emplace_back();
+        ref.span_ = span;
+        ref.pos_ = static_cast<uint32_t>(indices.size());
+        indices.push_back(static_cast<uint32_t>(refs.size() - 1));
     }
 
-    DrawSheet::SkinnedRenderPairs& DrawSheet::get_skinned_trs(
-        mirinae::RenderUnitSkinned& unit
+    template <typename T>
+    void DrawSetStatic::swap_remove(
+        std::vector<T>& items,
+        std::vector<ItemRef>& refs,
+        SpanList list,
+        SphereBatch* bounds,
+        uint32_t index
     ) {
-        for (auto& x : skinned_trs_) {
-            if (x.unit_ == &unit)
-                return x;
+        const auto last = static_cast<uint32_t>(items.size() - 1);
+        if (index != last) {
+            items[index] = items[last];
+            refs[index] = refs[last];
+            const auto& ref = refs[index];
+            (spans_[ref.span_].*list)[ref.pos_] = index;
         }
 
-        auto& output = skinned_trs_.emplace_back();
-        output.unit_ = &unit;
-        return output;
+        items.pop_back();
+        refs.pop_back();
+        if (bounds)
+            bounds->swap_remove(index);
     }
 
 }  // namespace mirinae
 
 
-// DrawSetStatic
+// DrawSetChanges
 namespace mirinae {
 
-    void DrawSetStatic::fetch(const entt::registry& reg) {
-        namespace cpnt = mirinae::cpnt;
+    void DrawSetChanges::clear() {
+        statics_.clear();
+        skinneds_.clear();
+        moves_.clear();
+    }
 
-        for (const auto e : reg.view<cpnt::MdlActorStatic>()) {
-            auto& mactor = reg.get<cpnt::MdlActorStatic>(e);
-            if (!mactor.model_)
-                continue;
-            auto renmdl = mactor.get_model<mirinae::RenderModel>();
-            if (!renmdl)
-                continue;
-            auto actor = mactor.get_actor<mirinae::RenderActor>();
-            if (!actor)
-                continue;
+}  // namespace mirinae
 
-            glm::dmat4 model_mat(1);
-            if (auto tfrom = reg.try_get<cpnt::Transform>(e))
-                model_mat = tfrom->make_model_mat();
 
-            const auto unit_count = renmdl->render_units_.size();
-            for (size_t i = 0; i < unit_count; ++i) {
-                if (!mactor.visibility_.get(i))
-                    continue;
+// DrawSetCache
+namespace mirinae {
 
-                auto& dst = opa_.emplace_back();
-                dst.unit_ = &renmdl->render_units_[i];
-                dst.actor_ = actor;
-                dst.model_mat_ = model_mat;
+    class DrawSetCache::Impl {
+
+    public:
+        ~Impl() { this->detach(); }
+
+        void attach(entt::registry& reg) {
+            this->detach();
+            reg_ = &reg;
+
+            this->connect<cpnt::MdlActorStatic, &Impl::mark>(reg);
+            this->connect<cpnt::MdlActorSkinned, &Impl::mark>(reg);
+            this->connect<cpnt::Transform, &Impl::mark_moved>(reg);
+
+            for (const auto e : reg.view<cpnt::MdlActorStatic>())
+                dirty_.push_back(e);
+            for (const auto e : reg.view<cpnt::MdlActorSkinned>())
+                dirty_.push_back(e);
+        }
+
+        void detach() {
+            if (!reg_)
+                return;
+
+            this->disconnect<cpnt::MdlActorStatic, &Impl::mark>(*reg_);
+            this->disconnect<cpnt::MdlActorSkinned, &Impl::mark>(*reg_);
+            this->disconnect<cpnt::Transform, &Impl::mark_moved>(*reg_);
+
+            reg_ = nullptr;
+            statics_.clear();
+            skinneds_.clear();
+            dirty_.clear();
+            moved_.clear();
+            draw_set_.clear();
+        }
+
+        void collect(DrawSetChanges& out) {
+            out.clear();
+            if (!reg_)
+                return;
+            auto& reg = *reg_;
+
+            {
+                std::lock_guard<std::mutex> lock(dirty_mut_);
+                dirty_swap_.swap(dirty_);
+                moved_swap_.swap(moved_);
             }
+            ::sort_unique(dirty_swap_);
+            ::sort_unique(moved_swap_);
 
-            const auto unit_trs_count = renmdl->render_units_alpha_.size();
-            for (size_t i = 0; i < unit_trs_count; ++i) {
-                if (!mactor.visibility_.get(i + unit_count))
+            for (const auto e : dirty_swap_) {
+                ::collect_actor<cpnt::MdlActorStatic>(e, reg, out.statics_);
+                ::collect_actor<cpnt::MdlActorSkinned>(e, reg, out.skinneds_);
+            }
+
+            for (const auto e : moved_swap_) {
+                if (!reg.valid(e))
+                    continue;
+                if (!reg.any_of<cpnt::MdlActorStatic, cpnt::MdlActorSkinned>(e))
                     continue;
 
-                auto& dst = trs_.emplace_back();
-                dst.unit_ = &renmdl->render_units_alpha_[i];
-                dst.actor_ = actor;
-                dst.model_mat_ = model_mat;
+                auto& move = out.moves_.emplace_back();
+                move.entity_ = e;
+                move.model_mat_ = ::make_model_mat(reg, e);
             }
+
+            dirty_swap_.clear();
+            moved_swap_.clear();
         }
 
-        for (const auto e : reg.view<cpnt::MdlActorSkinned>()) {
-            auto& mactor = reg.get<cpnt::MdlActorSkinned>(e);
-            if (!mactor.model_)
-                continue;
-            auto renmdl = mactor.get_model<mirinae::RenderModelSkinned>();
-            if (!renmdl)
-                continue;
-            auto actor = mactor.get_actor<mirinae::RenderActorSkinned>();
-            if (!actor)
-                continue;
+        void update(const DrawSetChanges& changes) {
+            for (auto& src : changes.statics_) {
+                this->resolve<RenderModel, RenderActor>(src, statics_);
+            }
+            for (auto& src : changes.skinneds_) {
+                this->resolve<RenderModelSkinned, RenderActorSkinned>(
+                    src, skinneds_
+                );
+            }
 
-            glm::dmat4 model_mat(1);
-            if (auto tfrom = reg.try_get<cpnt::Transform>(e))
-                model_mat = tfrom->make_model_mat();
+            for (auto& src : changes.moves_) {
+                this->move(src, statics_);
+                this->move(src, skinneds_);
+            }
+        }
 
-            const auto unit_count = renmdl->runits_.size();
-            for (size_t i = 0; i < unit_count; ++i) {
-                if (!mactor.visibility_.get(i))
-                    continue;
+        const DrawSetStatic& draw_set() const { return draw_set_; }
+
+    private:
+        struct Entry {
+            // Held so the pointers below outlive the draw lists and a new
+            // object at a reused address is never mistaken for the old one
+            std::shared_ptr<IRenModel> model_ref_;
+            std::shared_ptr<IRenActor> actor_ref_;
+            // Null until the model and actor are ready
+            const IRenModel* model_ = nullptr;
+            const IRenActor* actor_ = nullptr;
+
+            VisibilityArray visibility_;
+            // Empty while not in the draw set
+            std::optional<DrawSetStatic::SpanId> span_;
+        };
+
+        using EntryMap = std::unordered_map<entt::entity, Entry>;
+
+        template <typename T, auto Func>
+        void connect(entt::registry& reg) {
+            reg.on_construct<T>().template connect<Func>(*this);
+            reg.on_update<T>().template connect<Func>(*this);
+            reg.on_destroy<T>().template connect<Func>(*this);
+        }
 
-                auto& dst = skin_opa_.emplace_back();
-                dst.unit_ = &renmdl->runits_.at(i);
-                dst.actor_ = actor;
-                dst.model_mat_ = model_mat;
-                dst.runit_idx_ = i;
-            }
+        template <typename T, auto Func>
+        void disconnect(entt::registry& reg) {
+            reg.on_construct<T>().template disconnect<Func>(*this);
+            reg.on_update<T>().template disconnect<Func>(*this);
+            reg.on_destroy<T>().template disconnect<Func>(*this);
+        }
 
-            const auto unit_trs_count = renmdl->runits_alpha_.size();
-            for (size_t i = 0; i < unit_trs_count; ++i) {
-                if (!mactor.visibility_.get(i + unit_count))
-                    continue;
+        // Signals may be emitted from any thread that edits the registry
+        void mark(entt::registry&, entt::entity e) {
+            std::lock_guard<std::mutex> lock(dirty_mut_);
+            dirty_.push_back(e);
+        }
 
-                auto& dst = skin_trs_.emplace_back();
-                dst.unit_ = &renmdl->runits_alpha_.at(i);
-                dst.actor_ = actor;
-                dst.model_mat_ = model_mat;
-                dst.runit_idx_ = i;
+        void mark_moved(entt::registry&, entt::entity e) {
+            std::lock_guard<std::mutex> lock(dirty_mut_);
+            moved_.push_back(e);
+        }
+
+        void remove_span(Entry& entry) {
+            if (!entry.span_)
+                return;
+
+            draw_set_.remove(*entry.span_);
+            entry.span_.reset();
+        }
+
+        template <typename TRenModel, typename TRenActor>
+        void resolve(const DrawSetChanges::Actor& src, EntryMap& map) {
+            if (!src.exists_) {
+                const auto it = map.find(src.entity_);
+                if (it != map.end()) {
+                    this->remove_span(it->second);
+                    map.erase(it);
+                }
+                return;
             }
+
+            auto& entry = map[src.entity_];
+            if (entry.model_ref_ == src.model_ &&
+                entry.actor_ref_ == src.actor_ &&
+                entry.visibility_ == src.visibility_)
+                return;
+
+            this->remove_span(entry);
+
+            entry.model_ref_ = src.model_;
+            entry.actor_ref_ = src.actor_;
+            entry.visibility_ = src.visibility_;
+            entry.model_ = dynamic_cast<const TRenModel*>(src.model_.get());
+            entry.actor_ = dynamic_cast<const TRenActor*>(src.actor_.get());
+            if (!entry.model_ || !entry.actor_) {
+                entry.model_ = nullptr;
+                entry.actor_ = nullptr;
+                return;
+            }
+
+            entry.span_ = draw_set_.add(
+                static_cast<const TRenModel&>(*entry.model_),
+                static_cast<const TRenActor&>(*entry.actor_),
+                entry.visibility_,
+                src.model_mat_
+            );
         }
+
+        void move(const DrawSetChanges::Move& src, EntryMap& map) {
+            const auto it = map.find(src.entity_);
+            if (it == map.end() || !it->second.span_)
+                return;
+
+            draw_set_.set_model_mat(*it->second.span_, src.model_mat_);
+        }
+
+        entt::registry* reg_ = nullptr;
+        EntryMap statics_;
+        EntryMap skinneds_;
+        DrawSetStatic draw_set_;
+
+        // Filled by signals, swapped out once per frame
+        std::vector<entt::entity> dirty_;
+        std::vector<entt::entity> moved_;
+        std::vector<entt::entity> dirty_swap_;
+        std::vector<entt::entity> moved_swap_;
+        std::mutex dirty_mut_;
+    };
+
+
+    DrawSetCache::DrawSetCache() : pimpl_(std::make_unique<Impl>()) {}
+
+    DrawSetCache::~DrawSetCache() = default;
+
+    void DrawSetCache::attach(entt::registry& reg) { pimpl_->attach(reg); }
+
+    void DrawSetCache::detach() { pimpl_->detach(); }
+
+    void DrawSetCache::collect(DrawSetChanges& out) {
+        MIRINAE_PROF_ZONE("draw set collect");
+        pimpl_->collect(out);
     }
 
-    void DrawSetStatic::clear() {
-        opa_.clear();
-        trs_.clear();
-        skin_opa_.clear();
-        skin_trs_.clear();
+    void DrawSetCache::update(const DrawSetChanges& changes) {
+        MIRINAE_PROF_ZONE("draw set cache");
+        pimpl_->update(changes);
+    }
+
+    const DrawSetStatic& DrawSetCache::draw_set() const {
+        return pimpl_->draw_set();
     }
 
 }  // namespace mirinae
@@ -0,0 +1,236 @@
+#include "mirinae/vulkan/base/render/geometry.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "mirinae/lightweight/free_list_alloc.hpp"
+#include "mirinae/lightweight/include_spdlog.hpp"
+#include "mirinae/vulkan/base/context/base.hpp"
+#include "mirinae/vulkan/base/render/cmdbuf.hpp"
+#include "mirinae/vulkan/base/render/mem_cinfo.hpp"
+#include "mirinae/vulkan/base/render/meshdata.hpp"
+
+
+namespace {
+
+    constexpr size_t VTX_BLOCK_SIZE = 64 * 1024 * 1024;
+    constexpr size_t IDX_BLOCK_SIZE = 32 * 1024 * 1024;
+    constexpr uint64_t FREE_DELAY = mirinae::MAX_FRAMES_IN_FLIGHT;
+
+
+    struct Block {
+        Block(
+            uint32_t vtx_capacity,
+            uint32_t idx_capacity,
+            uint32_t vertex_stride,
+            mirinae::VulkanMemoryAllocator allocator
+        )
+            : vtx_alloc_(vtx_capacity), idx_alloc_(idx_capacity) {
+            mirinae::BufferCreateInfo cinfo;
+            cinfo.preset_vertices(size_t(vtx_capacity) * vertex_stride);
+            vtx_buf_.init(cinfo, allocator);
+            cinfo.preset_indices(
+                size_t(idx_capacity) * sizeof(mirinae::VertIndexType_t)
+            );
+            idx_buf_.init(cinfo, allocator);
+        }
+
+        bool can_fit(uint32_t vtx_count, uint32_t idx_count) const {
+            return vtx_alloc_.largest_free() >= vtx_count &&
+                   idx_alloc_.largest_free() >= idx_count;
+        }
+
+        mirinae::Buffer vtx_buf_;
+        mirinae::Buffer idx_buf_;
+        mirinae::FreeListAllocator vtx_alloc_;
+        mirinae::FreeListAllocator idx_alloc_;
+    };
+
+
+    struct PendingFree {
+        mirinae::GeometrySlice slice_;
+        uint64_t tick_ = 0;
+    };
+
+}  // namespace
+
+
+// GeometryArena
+namespace mirinae {
+
+    class GeometryArena::Impl {
+
+    public:
+        Impl(VulkanMemoryAllocator allocator, uint32_t vertex_stride)
+            : allocator_(allocator), vertex_stride_(vertex_stride) {}
+
+        GeometrySlice alloc(uint32_t vtx_count, uint32_t idx_count) {
+            std::lock_guard<std::mutex> lock(mut_);
+
+            GeometrySlice out;
+            out.block_ = this->find_block(vtx_count, idx_count);
+            out.vtx_count_ = vtx_count;
+            out.idx_count_ = idx_count;
+
+            auto& block = *blocks_.at(out.block_);
+            if (vtx_count > 0)
+                out.vtx_offset_ = block.vtx_alloc_.alloc(vtx_count).value();
+            if (idx_count > 0)
+                out.idx_offset_ = block.idx_alloc_.alloc(idx_count).value();
+            return out;
+        }
+
+        void free(const GeometrySlice& slice) {
+            std::lock_guard<std::mutex> lock(mut_);
+            pending_frees_.push_back({ slice, tick_count_ });
+        }
+
+        UploadTicket upload(
+            const GeometrySlice& slice,
+            const void* vertices,
+            const void* indices,
+            UploadService& uploader
+        ) {
+            std::unique_lock<std::mutex> lock(mut_);
+            const auto vtx_buf = blocks_.at(slice.block_)->vtx_buf_.buffer();
+            const auto idx_buf = blocks_.at(slice.block_)->idx_buf_.buffer();
+            lock.unlock();
+
+            constexpr auto IDX_SIZE = sizeof(VertIndexType_t);
+            UploadTicket out = 0;
+            if (slice.vtx_count_ > 0) {
+                out = uploader.upload_buffer(
+                    vtx_buf,
+                    size_t(slice.vtx_offset_) * vertex_stride_,
+                    vertices,
+                    size_t(slice.vtx_count_) * vertex_stride_
+                );
+            }
+            if (slice.idx_count_ > 0) {
+                out = uploader.upload_buffer(
+                    idx_buf,
+                    size_t(slice.idx_offset_) * IDX_SIZE,
+                    indices,
+                    size_t(slice.idx_count_) * IDX_SIZE
+                );
+            }
+            return out;
+        }
+
+        void record_bind(VkCommandBuffer cmdbuf, uint32_t block_index) {
+            static_assert(sizeof(VertIndexType_t) == 4);
+
+            std::lock_guard<std::mutex> lock(mut_);
+            auto& block = *blocks_.at(block_index);
+            BindVertBufInfo<1>{}.set_at<0>(block.vtx_buf_).record(cmdbuf);
+            bind_idx_buf(cmdbuf, block.idx_buf_);
+        }
+
+        void tick() {
+            std::lock_guard<std::mutex> lock(mut_);
+            ++tick_count_;
+
+            // Frames recorded before the free may still be reading it
+            while (!pending_frees_.empty()) {
+                const auto& front = pending_frees_.front();
+                if (tick_count_ - front.tick_ <= ::FREE_DELAY)
+                    break;
+
+                const auto& slice = front.slice_;
+                auto& block = *blocks_.at(slice.block_);
+                block.vtx_alloc_.free(slice.vtx_offset_, slice.vtx_count_);
+                block.idx_alloc_.free(slice.idx_offset_, slice.idx_count_);
+                pending_frees_.pop_front();
+            }
+        }
+
+    private:
+        uint32_t find_block(uint32_t vtx_count, uint32_t idx_count) {
+            for (size_t i = 0; i < blocks_.size(); ++i) {
+                if (blocks_[i]->can_fit(vtx_count, idx_count))
+                    return static_cast<uint32_t>(i);
+            }
+
+            const auto vtx_cap = std::max<uint32_t>(
+                vtx_count, VTX_BLOCK_SIZE / vertex_stride_
+            );
+            const auto idx_cap = std::max<uint32_t>(
+                idx_count, IDX_BLOCK_SIZE / sizeof(VertIndexType_t)
+            );
+            blocks_.push_back(
+                std::make_unique<::Block>(
+                    vtx_cap, idx_cap, vertex_stride_, allocator_
+                )
+            );
+            SPDLOG_DEBUG(
+                "Geometry arena block {} created ({} vertices, {} indices)",
+                blocks_.size() - 1,
+                vtx_cap,
+                idx_cap
+            );
+            return static_cast<uint32_t>(blocks_.size() - 1);
+        }
+
+        std::vector<std::unique_ptr<::Block>> blocks_;
+        std::deque<::PendingFree> pending_frees_;
+        std::mutex mut_;
+        VulkanMemoryAllocator allocator_;
+        const uint32_t vertex_stride_;
+        uint64_t tick_count_ = 0;
+    };
+
+
+    GeometryArena::GeometryArena(
+        VulkanMemoryAllocator allocator, uint32_t vertex_stride
+    )
+        : pimpl_(std::make_unique<Impl>(allocator, vertex_stride)) {}
+
+    GeometryArena::~GeometryArena() = default;
+
+    GeometrySlice GeometryArena::alloc(uint32_t vtx_count, uint32_t idx_count) {
+        return pimpl_->alloc(vtx_count, idx_count);
+    }
+
+    void GeometryArena::free(const GeometrySlice& slice) {
+        pimpl_->free(slice);
+    }
+
+    UploadTicket GeometryArena::upload(
+        const GeometrySlice& slice,
+        const void* vertices,
+        const void* indices,
+        UploadService& uploader
+    ) {
+        return pimpl_->upload(slice, vertices, indices, uploader);
+    }
+
+    void GeometryArena::record_bind(
+        VkCommandBuffer cmdbuf, uint32_t block
+    ) const {
+        pimpl_->record_bind(cmdbuf, block);
+    }
+
+    void GeometryArena::tick() { pimpl_->tick(); }
+
+}  // namespace mirinae
+
+
+// GeometryBindCache
+namespace mirinae {
+
+    void GeometryBindCache::bind(
+        VkCommandBuffer cmdbuf,
+        const GeometryArena& arena,
+        const GeometrySlice& slice
+    ) {
+        if (arena_ == &arena && block_ == slice.block_)
+            return;
+
+        arena.record_bind(cmdbuf, slice.block_);
+        arena_ = &arena;
+        block_ = slice.block_;
+    }
+
+}  // namespace mirinae
@@ -0,0 +1,117 @@
+#include "mirinae/vulkan/base/render/instancing.hpp"
+
+#include <algorithm>
+
+#include "mirinae/vulkan/base/render/mem_cinfo.hpp"
+
+
+namespace {
+
+    constexpr size_t MIN_INSTANCE_CAPACITY = 256;
+
+}  // namespace
+
+
+// InstanceGroups
+namespace mirinae {
+
+    void InstanceGroups::clear() {
+        groups_.clear();
+        mats_.clear();
+    }
+
+    size_t InstanceGroups::add(
+        const DrawSetStatic& draw_set,
+        const std::vector<uint32_t>& opa,
+        const glm::dmat4& pre
+    ) {
+        const auto first_group = groups_.size();
+
+        sorted_.clear();
+        for (auto i : opa)
+            sorted_.emplace_back(draw_set.opa()[i].unit_, i);
+        std::sort(sorted_.begin(), sorted_.end());
+
+        for (auto& [unit, i] : sorted_) {
+            const auto is_new = groups_.size() == first_group ||
+                                groups_.back().unit_ != unit;
+            if (is_new) {
+                auto& group = groups_.emplace_back();
+                group.unit_ = unit;
+                group.first_ = static_cast<uint32_t>(mats_.size());
+            }
+
+            mats_.emplace_back(pre * draw_set.model_mat(draw_set.opa()[i]));
+            ++groups_.back().count_;
+        }
+
+        return first_group;
+    }
+
+}  // namespace mirinae
+
+
+// InstanceBuffer
+namespace mirinae {
+
+    InstanceBuffer::InstanceBuffer(VulkanDevice& device) : device_(device) {}
+
+    InstanceBuffer::~InstanceBuffer() { this->destroy(); }
+
+    void InstanceBuffer::init(
+        const uint32_t max_flight_count, const DesclayoutManager& desclayouts
+    ) {
+        this->destroy();
+
+        auto& desclayout = desclayouts.get("gbuf:instances");
+        desc_pool_.init(
+            max_flight_count, desclayout.size_info(), device_.logi_device()
+        );
+        auto descsets = desc_pool_.alloc(
+            max_flight_count, desclayout.layout(), device_.logi_device()
+        );
+
+        for (uint32_t i = 0; i < max_flight_count; ++i) {
+            auto& fd = frame_data_.emplace_back();
+            fd.descset_ = descsets.at(i);
+            this->reserve(fd, MIN_INSTANCE_CAPACITY);
+        }
+    }
+
+    void InstanceBuffer::destroy() {
+        frame_data_.clear();
+        desc_pool_.destroy(device_.logi_device());
+    }
+
+    void InstanceBuffer::upload(
+        const FrameIndex f_idx, const std::vector<glm::mat4>& mats
+    ) {
+        auto& fd = frame_data_.at(f_idx.get());
+        if (mats.size() > fd.capacity_)
+            this->reserve(fd, std::max(mats.size(), fd.capacity_ * 2));
+
+        if (!mats.empty())
+            fd.buf_.set_data(mats.data(), mats.size() * sizeof(glm::mat4));
+    }
+
+    VkDescriptorSet InstanceBuffer::descset(const FrameIndex f_idx) const {
+        return frame_data_.at(f_idx.get()).descset_;
+    }
+
+    // The frame's previous submission has finished by the time it records
+    // again, so its buffer can be replaced.
+    void InstanceBuffer::reserve(FrameData& fd, const size_t count) {
+        BufferCreateInfo cinfo;
+        cinfo.set_usage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+            .add_alloc_flag_host_access_seq_write()
+            .set_size(count * sizeof(glm::mat4));
+        fd.buf_.init(cinfo, device_.mem_alloc());
+        fd.capacity_ = count;
+
+        DescWriter{}
+            .add_buf_info(fd.buf_)
+            .add_storage_buf_write(fd.descset_, 0)
+            .apply_all(device_.logi_device());
+    }
+
+}  // namespace mirinae
@@ -86,6 +86,7 @@ namespace mirinae {
         std::swap(buffer_, rhs.buffer_);
         std::swap(allocation_, rhs.allocation_);
         std::swap(size_, rhs.size_);
+        std::swap(mapped_, rhs.mapped_);
     }
 
     Buffer& Buffer::operator=(Buffer&& rhs) noexcept {
@@ -93,6 +94,7 @@ namespace mirinae {
         std::swap(buffer_, rhs.buffer_);
         std::swap(allocation_, rhs.allocation_);
         std::swap(size_, rhs.size_);
+        std::swap(mapped_, rhs.mapped_);
         return *this;
     }
 
@@ -123,6 +125,7 @@ namespace mirinae {
         if (!allocator_)
             return;
 
+        this->unmap();
         if (buffer_ != VK_NULL_HANDLE) {
             vmaDestroyBuffer(allocator_->get(), buffer_, allocation_);
             buffer_ = VK_NULL_HANDLE;
@@ -135,10 +138,17 @@ namespace mirinae {
 
     void Buffer::set_data(const void* data, size_t size) {
         MIRINAE_ASSERT(nullptr != allocator_);
+        const auto copy_size = std::min<size_t>(size, this->size());
+
+        // Buffers updated every frame stay mapped
+        if (mapped_) {
+            memcpy(mapped_, data, copy_size);
+            return;
+        }
 
         void* ptr;
         vmaMapMemory(allocator_->get(), allocation_, &ptr);
-        memcpy(ptr, data, std::min<size_t>(size, this->size()));
+        memcpy(ptr, data, copy_size);
         vmaUnmapMemory(allocator_->get(), allocation_);
     }
 
@@ -159,6 +169,33 @@ namespace mirinae {
         vkEndCommandBuffer(cmdbuf);
     }
 
+    void* Buffer::map() {
+        MIRINAE_ASSERT(nullptr != allocator_);
+
+        if (!mapped_)
+            VK_CHECK(vmaMapMemory(allocator_->get(), allocation_, &mapped_));
+        return mapped_;
+    }
+
+    void Buffer::unmap() {
+        if (mapped_) {
+            vmaUnmapMemory(allocator_->get(), allocation_);
+            mapped_ = nullptr;
+        }
+    }
+
+    void Buffer::flush() {
+        MIRINAE_ASSERT(nullptr != allocator_);
+        vmaFlushAllocation(allocator_->get(), allocation_, 0, VK_WHOLE_SIZE);
+    }
+
+    void Buffer::invalidate() {
+        MIRINAE_ASSERT(nullptr != allocator_);
+        vmaInvalidateAllocation(
+            allocator_->get(), allocation_, 0, VK_WHOLE_SIZE
+        );
+    }
+
 }  // namespace mirinae
 
 
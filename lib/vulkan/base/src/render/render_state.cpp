@@ -0,0 +1,77 @@
+#include "mirinae/vulkan/base/render/render_state.hpp"
+
+#include "mirinae/cpnt/atmos.hpp"
+#include "mirinae/cpnt/camera.hpp"
+#include "mirinae/cpnt/light.hpp"
+#include "mirinae/cpnt/ocean.hpp"
+#include "mirinae/cpnt/terrain.hpp"
+#include "mirinae/cpnt/transform.hpp"
+#include "mirinae/lightweight/include_spdlog.hpp"
+
+
+namespace {
+
+    template <typename T>
+    void copy_cpnt(const entt::registry& src, entt::registry& dst) {
+        namespace cpnt = mirinae::cpnt;
+
+        // Passes read it concurrently, so no storage may be created lazily
+        dst.storage<T>();
+        dst.storage<cpnt::Transform>();
+
+        for (const auto e : src.view<T>()) {
+            if (!dst.valid(e)) {
+                const auto created = dst.create(e);
+                MIRINAE_ASSERT(created == e);
+            }
+
+            dst.emplace<T>(e, src.get<T>(e));
+            if (auto tform = src.try_get<cpnt::Transform>(e))
+                dst.emplace_or_replace<cpnt::Transform>(e, *tform);
+        }
+    }
+
+}  // namespace
+
+
+// RenderState
+namespace mirinae {
+
+    void RenderState::copy_scene(
+        const entt::registry& src, entt::entity main_camera
+    ) {
+        reg_.clear();
+        ::copy_cpnt<cpnt::StandardCamera>(src, reg_);
+        ::copy_cpnt<cpnt::DLight>(src, reg_);
+        ::copy_cpnt<cpnt::SLight>(src, reg_);
+        ::copy_cpnt<cpnt::VPLight>(src, reg_);
+        ::copy_cpnt<cpnt::AtmosphereSimple>(src, reg_);
+        ::copy_cpnt<cpnt::AtmosphereEpic>(src, reg_);
+        ::copy_cpnt<cpnt::Ocean>(src, reg_);
+        ::copy_cpnt<cpnt::Terrain>(src, reg_);
+        main_camera_ = main_camera;
+    }
+
+    void RenderState::clear() {
+        reg_.clear();
+        main_camera_ = entt::null;
+        dt_ = 0;
+        statics_.clear();
+        skinneds_.clear();
+        draw_set_changes_.clear();
+    }
+
+}  // namespace mirinae
+
+
+// RenderStates
+namespace mirinae {
+
+    void RenderStates::flip() { std::swap(front_, back_); }
+
+    void RenderStates::clear() {
+        front_.clear();
+        back_.clear();
+    }
+
+}  // namespace mirinae
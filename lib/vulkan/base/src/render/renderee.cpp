@@ -1,5 +1,6 @@
 #include "mirinae/vulkan/base/render/renderee.hpp"
 
+#include <algorithm>
 #include <numeric>
 #include <set>
 
@@ -7,12 +8,36 @@
 #include <sung/basic/stringtool.hpp>
 
 #include "mirinae/lightweight/include_spdlog.hpp"
+#include "mirinae/lightweight/mapped_file.hpp"
+#include "mirinae/lightweight/profiler.hpp"
 #include "mirinae/vulkan/base/render/cmdbuf.hpp"
 #include "mirinae/vulkan/base/render/mem_cinfo.hpp"
+#include "mirinae/vulkan/base/render/ubuf_ring.hpp"
 
 
 namespace {
 
+    template <typename TVertex>
+    mirinae::BoundingSphere make_bounds(const std::vector<TVertex>& vertices) {
+        mirinae::BoundingSphere out;
+        if (vertices.empty())
+            return out;
+
+        glm::vec3 min_pos = vertices.front().pos_;
+        glm::vec3 max_pos = min_pos;
+        for (auto& v : vertices) {
+            min_pos = glm::min(min_pos, v.pos_);
+            max_pos = glm::max(max_pos, v.pos_);
+        }
+
+        out.center_ = (min_pos + max_pos) * 0.5f;
+        for (auto& v : vertices) {
+            const auto dist = glm::distance(out.center_, v.pos_);
+            out.radius_ = std::max(out.radius_, dist);
+        }
+        return out;
+    }
+
     void calc_tangents(
         mirinae::VertexStatic& p0,
         mirinae::VertexStatic& p1,
@@ -166,12 +191,12 @@ namespace mirinae {
         VkImageView albedo_map,
         VkImageView normal_map,
         VkImageView orm_map,
-        CommandPool& cmd_pool,
         DesclayoutManager& desclayouts,
         VulkanDevice& device
     ) {
         name_ = name;
         raw_data_ = vertices;
+        bounds_ = ::make_bounds(vertices.vertices_);
 
         auto& desclayout = desclayouts.get("gbuf:model");
         desc_pool_.init(
@@ -196,19 +221,27 @@ namespace mirinae {
         }
         builder.apply_all(device.logi_device());
 
-        vert_index_pair_.init(
-            raw_data_,
-            cmd_pool,
-            device.mem_alloc(),
-            device.graphics_queue(),
-            device.logi_device()
+        geometry_ = &device.geometry();
+        geo_ = geometry_->alloc(
+            static_cast<uint32_t>(raw_data_.vertices_.size()),
+            static_cast<uint32_t>(raw_data_.indices_.size())
+        );
+        upload_ = geometry_->upload(
+            geo_,
+            raw_data_.vertices_.data(),
+            raw_data_.indices_.data(),
+            device.uploader()
         );
     }
 
     void RenderUnit::destroy(
         VulkanMemoryAllocator mem_alloc, VkDevice logi_device
     ) {
-        vert_index_pair_.destroy(mem_alloc);
+        if (geometry_) {
+            geometry_->free(geo_);
+            geometry_ = nullptr;
+            geo_ = {};
+        }
         uniform_buf_.destroy();
         desc_pool_.destroy(logi_device);
     }
@@ -218,11 +251,21 @@ namespace mirinae {
     }
 
     void RenderUnit::record_bind_vert_buf(VkCommandBuffer cmdbuf) const {
-        vert_index_pair_.record_bind(cmdbuf);
+        geometry_->record_bind(cmdbuf, geo_.block_);
     }
 
-    uint32_t RenderUnit::vertex_count() const {
-        return vert_index_pair_.vertex_count();
+    void RenderUnit::record_bind_vert_buf(
+        VkCommandBuffer cmdbuf, GeometryBindCache& cache
+    ) const {
+        cache.bind(cmdbuf, *geometry_, geo_);
+    }
+
+    uint32_t RenderUnit::vertex_count() const { return geo_.idx_count_; }
+
+    UploadTicket RenderUnit::upload_ticket() const { return upload_; }
+
+    int32_t RenderUnit::vertex_offset() const {
+        return static_cast<int32_t>(geo_.vtx_offset_);
     }
 
 }  // namespace mirinae
@@ -239,11 +282,15 @@ namespace mirinae {
         VkImageView albedo_map,
         VkImageView normal_map,
         VkImageView orm_map,
-        CommandPool& cmd_pool,
         DesclayoutManager& desclayouts,
         VulkanDevice& device
     ) {
+        // Animation may move vertices out of the bind pose bounds
+        constexpr float SKINNED_BOUNDS_MARGIN = 1.5f;
+
         name_ = name;
+        bounds_ = ::make_bounds(vertices.vertices_);
+        bounds_.radius_ *= SKINNED_BOUNDS_MARGIN;
 
         auto& desclayout = desclayouts.get("gbuf:model");
         desc_pool_.init(
@@ -268,13 +315,7 @@ namespace mirinae {
         }
         builder.apply_all(device.logi_device());
 
-        vert_index_pair_.init(
-            vertices,
-            cmd_pool,
-            device.mem_alloc(),
-            device.graphics_queue(),
-            device.logi_device()
-        );
+        vert_index_pair_.init(vertices, device.uploader(), device.mem_alloc());
     }
 
     void RenderUnitSkinned::destroy(
@@ -297,6 +338,10 @@ namespace mirinae {
         return vert_index_pair_.vertex_count();
     }
 
+    UploadTicket RenderUnitSkinned::upload_ticket() const {
+        return vert_index_pair_.upload_ticket();
+    }
+
 }  // namespace mirinae
 
 
@@ -474,22 +519,27 @@ namespace {
     class ModelLoadTask : public sung::IStandardLoadTask {
 
     public:
-        ModelLoadTask(const dal::path& path, dal::Filesystem& filesys)
-            : filesys_(filesys), path_(path) {}
+        ModelLoadTask(
+            const dal::path& path,
+            dal::Filesystem& filesys,
+            const mirinae::FileMapper* file_mapper
+        )
+            : filesys_(filesys), file_mapper_(file_mapper), path_(path) {}
 
         sung::TaskStatus tick() override {
+            MIRINAE_PROF_ZONE("model load");
+
             if (path_.empty())
                 return this->fail("Path is empty");
 
-            filesys_.read_file(path_, raw_data_);
-            if (raw_data_.empty())
+            if (!raw_data_.load(path_, filesys_, file_mapper_))
                 return this->fail("Failed to read file");
 
             const auto result = dal::parse_dmd(
-                dmd_,
-                reinterpret_cast<const uint8_t*>(raw_data_.data()),
-                raw_data_.size()
+                dmd_, raw_data_.data(), raw_data_.size()
             );
+            // Parsed model owns its copy of everything
+            raw_data_.clear();
             switch (result) {
                 case dal::ModelParseResult::success:
                     break;
@@ -639,8 +689,9 @@ namespace {
         }
 
         dal::Filesystem& filesys_;
+        const mirinae::FileMapper* file_mapper_;
         dal::path path_;
-        std::vector<std::byte> raw_data_;
+        mirinae::FileData raw_data_;
         dal::Model dmd_;
         std::set<std::string> tex_ids;
         std::set<std::string> tex_ids_srgb;
@@ -655,13 +706,17 @@ namespace {
         LoadTaskManager(
             sung::HTaskSche task_sche, mirinae::VulkanDevice& device
         )
-            : task_sche_(task_sche), filesys_(&device.filesys()) {}
+            : task_sche_(task_sche)
+            , filesys_(&device.filesys())
+            , file_mapper_(device.file_mapper()) {}
 
         bool add_task(const dal::path& path) {
             if (this->has_task(path))
                 return false;
 
-            auto task = std::make_shared<ModelLoadTask>(path, *filesys_);
+            auto task = std::make_shared<ModelLoadTask>(
+                path, *filesys_, file_mapper_
+            );
             task_sche_->add_task(task);
             tasks_.emplace(dal::tostr(path), task);
             return true;
@@ -686,6 +741,7 @@ namespace {
         std::unordered_map<std::string, std::shared_ptr<ModelLoadTask>> tasks_;
         sung::HTaskSche task_sche_;
         dal::Filesystem* filesys_;
+        const mirinae::FileMapper* file_mapper_;
     };
 
 
@@ -694,6 +750,8 @@ namespace {
         std::shared_ptr<::ModelLoadTask> load_task_;
         const dal::Model* dmd_ = nullptr;
         size_t unit_idx_ = 0;
+        // Of the last unit, so the others are done too once it is
+        mirinae::UploadTicket upload_ = 0;
         bool done_ = false;
     };
 
@@ -714,14 +772,7 @@ namespace {
             , desclayouts_(desclayouts)
             , load_tasks_(task_sche, device)
             , task_sche_(task_sche)
-            , tex_man_(tex_man) {
-            cmd_pool_.init(
-                device_.graphics_queue_family_index().value(),
-                device_.logi_device()
-            );
-        }
-
-        ~ModelManager() override { cmd_pool_.destroy(device_.logi_device()); }
+            , tex_man_(tex_man) {}
 
         dal::ReqResult request_static(const dal::path& res_id) override {
             auto found = static_.find(res_id);
@@ -791,22 +842,27 @@ namespace {
                     mat_res.albedo_map_->image_view(),
                     mat_res.normal_map_->image_view(),
                     mat_res.orm_map_->image_view(),
-                    cmd_pool_,
                     desclayouts_,
                     device_
                 );
+                entry.upload_ = dst_unit.upload_ticket();
 
                 ++entry.unit_idx_;
                 return dal::ReqResult::loading;
             }
 
+            if (!device_.uploader().is_done(entry.upload_))
+                return dal::ReqResult::loading;
             return dal::ReqResult::ready;
         }
 
         dal::ReqResult request_skinned(const dal::path& res_id) override {
             auto found = skin_models_.find(res_id);
-            if (skin_models_.end() != found)
-                return dal::ReqResult::ready;
+            if (skin_models_.end() != found) {
+                if (device_.uploader().is_done(skin_uploads_[res_id]))
+                    return dal::ReqResult::ready;
+                return dal::ReqResult::loading;
+            }
 
             auto task = load_tasks_.try_get_task(res_id);
             if (!task) {
@@ -838,6 +894,7 @@ namespace {
             auto output = std::make_shared<mirinae::RenderModelSkinned>(
                 device_
             );
+            mirinae::UploadTicket upload = 0;
 
             for (size_t i = 0; i < dmd->units_indexed_joint_.size(); ++i) {
                 const auto& src_unit = dmd->units_indexed_joint_.at(i);
@@ -860,17 +917,19 @@ namespace {
                     mat_res.albedo_map_->image_view(),
                     mat_res.normal_map_->image_view(),
                     mat_res.orm_map_->image_view(),
-                    cmd_pool_,
                     desclayouts_,
                     device_
                 );
+                upload = dst_unit.upload_ticket();
             }
 
             output->skel_anim_->skel_ = dmd->skeleton_;
             output->skel_anim_->anims_ = dmd->animations_;
+            output->skel_anim_->compile();
 
             skin_models_[res_id] = output;
-            return dal::ReqResult::ready;
+            skin_uploads_[res_id] = upload;
+            return dal::ReqResult::loading;
         }
 
         HRenMdlStatic get_static(const dal::path& res_id) override {
@@ -895,10 +954,10 @@ namespace {
         ::LoadTaskManager load_tasks_;
         sung::HTaskSche task_sche_;
         mirinae::HTexMgr tex_man_;
-        mirinae::CommandPool cmd_pool_;
 
         std::map<dal::path, StaticModelBuilder> static_;
         std::map<dal::path, mirinae::HRenMdlSkinned> skin_models_;
+        std::map<dal::path, mirinae::UploadTicket> skin_uploads_;
     };
 
 }  // namespace
@@ -916,41 +975,35 @@ namespace mirinae {
         uint32_t max_flight_count, DesclayoutManager& desclayouts
     ) {
         auto& desclayout = desclayouts.get("gbuf:actor");
-        desc_pool_.init(
-            max_flight_count, desclayout.size_info(), device_.logi_device()
-        );
-        desc_sets_ = desc_pool_.alloc(
-            max_flight_count, desclayout.layout(), device_.logi_device()
-        );
-
-        BufferCreateInfo ubuf_cinfo;
-        ubuf_cinfo.preset_ubuf(sizeof(U_GbufActor));
+        auto& ring = device_.ubuf_ring();
         for (uint32_t i = 0; i < max_flight_count; ++i) {
-            auto& ubuf = uniform_buf_.emplace_back();
-            ubuf.init(ubuf_cinfo, device_.mem_alloc());
-        }
-
-        DescWriteInfoBuilder builder;
-        for (size_t i = 0; i < max_flight_count; i++) {
-            builder.set_descset(desc_sets_.at(i)).add_ubuf(uniform_buf_.at(i));
+            const FrameIndex f_idx{ static_cast<int>(i) };
+            desc_sets_.push_back(
+                ring.descset(f_idx, desclayout, sizeof(U_GbufActor))
+            );
         }
-        builder.apply_all(device_.logi_device());
+        ubuf_offsets_.assign(max_flight_count, 0);
     }
 
     void RenderActor::destroy() {
-        uniform_buf_.clear();
-        desc_pool_.destroy(device_.logi_device());
+        desc_sets_.clear();
+        ubuf_offsets_.clear();
     }
 
     void RenderActor::udpate_ubuf(uint32_t index, const U_GbufActor& data) {
-        auto& ubuf = uniform_buf_.at(index);
-        ubuf.set_data(&data, sizeof(U_GbufActor));
+        const FrameIndex f_idx{ static_cast<int>(index) };
+        if (const auto offset = device_.ubuf_ring().write(f_idx, data))
+            ubuf_offsets_.at(index) = *offset;
     }
 
     VkDescriptorSet RenderActor::get_desc_set(size_t index) const {
         return desc_sets_.at(index);
     }
 
+    uint32_t RenderActor::ubuf_offset(size_t index) const {
+        return ubuf_offsets_.at(index);
+    }
+
 }  // namespace mirinae
 
 
@@ -173,6 +173,33 @@ namespace { namespace overlay {
         return builder.build(renderpass, pipelineLayout);
     }
 
+    // Draws a quad per instance of `OverlayGlyph`
+    VkPipeline create_pipeline_text(
+        VkRenderPass renderpass,
+        VkPipelineLayout pipelineLayout,
+        mirinae::VulkanDevice& device
+    ) {
+        mirinae::PipelineBuilder builder{ device };
+
+        builder.shader_stages()
+            .add_vert(":asset/spv/misc_overlay_text_vert.spv")
+            .add_frag(":asset/spv/misc_overlay_text_frag.spv");
+
+        using Glyph = mirinae::OverlayGlyph;
+        builder.vertex_input_state()
+            .add_binding(sizeof(Glyph), VK_VERTEX_INPUT_RATE_INSTANCE)
+            .add_attrib_vec2(offsetof(Glyph, pos_offset_))
+            .add_attrib_vec2(offsetof(Glyph, pos_scale_))
+            .add_attrib_vec2(offsetof(Glyph, uv_offset_))
+            .add_attrib_vec2(offsetof(Glyph, uv_scale_));
+
+        builder.color_blend_state().add(true);
+
+        builder.dynamic_state().add_viewport().add_scissor();
+
+        return builder.build(renderpass, pipelineLayout);
+    }
+
 
     class RPBundle : public mirinae::IRenderPassBundle {
 
@@ -200,6 +227,9 @@ namespace { namespace overlay {
                 .pc(0, sizeof(mirinae::U_OverlayPushConst))
                 .build(layout_, device);
             pipeline_ = create_pipeline(renderpass_, layout_, device);
+            text_pipeline_ = create_pipeline_text(
+                renderpass_, layout_, device
+            );
 
             fbufs_.resize(swapchain.views_count());
             for (int i = 0; i < swapchain.views_count(); ++i) {
@@ -216,6 +246,7 @@ namespace { namespace overlay {
         void destroy() override {
             renderpass_.destroy(device_);
             pipeline_.destroy(device_);
+            text_pipeline_.destroy(device_);
             layout_.destroy(device_);
 
             for (auto& handle : fbufs_) {
@@ -228,6 +259,11 @@ namespace { namespace overlay {
             return fbufs_.at(index).get();
         }
 
+        // 0: Text
+        VkPipeline sub_pipeline(size_t index) const override {
+            return 0 == index ? text_pipeline_.get() : VK_NULL_HANDLE;
+        }
+
         const VkClearValue* clear_values() const override {
             return clear_values_.data();
         }
@@ -240,6 +276,7 @@ namespace { namespace overlay {
         std::array<VkFormat, 1> formats_;
         std::array<VkClearValue, 1> clear_values_;
         std::vector<mirinae::Fbuf> fbufs_;  // As many as swapchain images
+        mirinae::RpPipeline text_pipeline_;
     };
 
 }}  // namespace ::overlay
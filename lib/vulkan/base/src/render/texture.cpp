@@ -7,9 +7,12 @@
 #include <sung/basic/time.hpp>
 
 #include "mirinae/lightweight/include_spdlog.hpp"
+#include "mirinae/lightweight/mapped_file.hpp"
+#include "mirinae/lightweight/profiler.hpp"
 #include "mirinae/vulkan/base/render/cmdbuf.hpp"
 #include "mirinae/vulkan/base/render/enum_str.hpp"
 #include "mirinae/vulkan/base/render/mem_cinfo.hpp"
+#include "mirinae/vulkan/base/render/upload.hpp"
 #include "mirinae/vulkan/base/render/vkmajorplayers.hpp"
 
 #define SWITCH_STR(x) \
@@ -224,6 +227,7 @@ namespace {
                 nullptr
             );
             if (res == KTX_SUCCESS) {
+                uploader_ = &device.uploader();
                 initialized_ = true;
                 return true;
             }
@@ -244,6 +248,7 @@ namespace {
             VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_SAMPLED_BIT,
             VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
         ) {
+            const auto lock = uploader_->lock_queues();
             const auto result = ktxTexture_VkUploadEx(
                 &This, &ktx_device_, &vkTexture, tiling, usageFlags, finalLayout
             );
@@ -257,6 +262,7 @@ namespace {
 
     private:
         ktxVulkanDeviceInfo ktx_device_;
+        mirinae::UploadService* uploader_ = nullptr;
         bool initialized_ = false;
     };
 
@@ -271,6 +277,9 @@ namespace {
 
         virtual void destroy() = 0;
         virtual const std::string& id() const = 0;
+
+        // Not ready to be sampled until this is done
+        mirinae::UploadTicket upload_ = 0;
     };
 
 
@@ -286,18 +295,11 @@ namespace {
             const dal::TDataImage2D<uint8_t>& image,
             std::shared_ptr<dal::IImage> img_data,
             bool srgb,
-            mirinae::CommandPool& cmd_pool
+            mirinae::UploadService& uploader
         ) {
             id_ = id;
             img_data_ = img_data;
 
-            mirinae::BufferCreateInfo staging_buf_cinfo;
-            staging_buf_cinfo.preset_staging(image.data_size());
-
-            mirinae::Buffer staging_buffer;
-            staging_buffer.init(staging_buf_cinfo, device_.mem_alloc());
-            staging_buffer.set_data(image.data(), image.data_size());
-
             mirinae::ImageCreateInfo img_info;
             img_info.fetch_from_image(image, srgb)
                 .deduce_mip_levels()
@@ -306,17 +308,14 @@ namespace {
                 .add_usage_sampled();
             texture_.init(img_info.get(), device_.mem_alloc());
 
-            auto cmdbuf = cmd_pool.begin_single_time(device_.logi_device());
-            mirinae::record_img_buf_copy_mip(
-                cmdbuf,
+            upload_ = uploader.upload_image(
+                texture_.image(),
                 texture_.width(),
                 texture_.height(),
                 texture_.mip_levels(),
-                texture_.image(),
-                staging_buffer.buffer()
+                image.data(),
+                image.data_size()
             );
-            cmd_pool.end_single_time(cmdbuf, device_);
-            staging_buffer.destroy();
 
             mirinae::ImageViewBuilder iv_builder;
             iv_builder.format(texture_.format())
@@ -345,18 +344,11 @@ namespace {
             const dal::TDataImage2D<float>& image,
             std::shared_ptr<dal::IImage> img_data,
             bool srgb,
-            mirinae::CommandPool& cmd_pool
+            mirinae::UploadService& uploader
         ) {
             id_ = id;
             img_data_ = img_data;
 
-            mirinae::BufferCreateInfo staging_buf_cinfo;
-            staging_buf_cinfo.preset_staging(image.data_size());
-
-            mirinae::Buffer staging_buffer;
-            staging_buffer.init(staging_buf_cinfo, device_.mem_alloc());
-            staging_buffer.set_data(image.data(), image.data_size());
-
             mirinae::ImageCreateInfo img_info;
             img_info.fetch_from_image(image, srgb)
                 .deduce_mip_levels()
@@ -365,17 +357,14 @@ namespace {
                 .add_usage_sampled();
             texture_.init(img_info.get(), device_.mem_alloc());
 
-            auto cmdbuf = cmd_pool.begin_single_time(device_.logi_device());
-            mirinae::record_img_buf_copy_mip(
-                cmdbuf,
+            upload_ = uploader.upload_image(
+                texture_.image(),
                 texture_.width(),
                 texture_.height(),
                 texture_.mip_levels(),
-                texture_.image(),
-                staging_buffer.buffer()
+                image.data(),
+                image.data_size()
             );
-            cmd_pool.end_single_time(cmdbuf, device_);
-            staging_buffer.destroy();
 
             mirinae::ImageViewBuilder iv_builder;
             iv_builder.format(texture_.format())
@@ -593,23 +582,28 @@ namespace {
         ImageLoadTask(
             const fs::path& path,
             dal::Filesystem& filesys,
+            const mirinae::FileMapper* file_mapper,
             const VkPhysicalDeviceFeatures& device_features
         )
-            : filesys_(&filesys), path_(path), df_(device_features) {}
+            : filesys_(&filesys)
+            , file_mapper_(file_mapper)
+            , path_(path)
+            , df_(device_features) {}
 
         sung::TaskStatus tick() override {
+            MIRINAE_PROF_ZONE("image load");
+
             if (path_.empty())
                 return this->fail("Path is empty");
             if (!filesys_)
                 return this->fail("Filesystem is not set");
 
-            filesys_->read_file(path_, raw_data_);
-            if (raw_data_.empty())
+            if (!raw_data_.load(path_, *filesys_, file_mapper_))
                 return this->fail("Failed to read file");
 
             dal::ImageParseInfo pinfo;
             pinfo.file_path_ = dal::tostr(path_);
-            pinfo.data_ = reinterpret_cast<uint8_t*>(raw_data_.data());
+            pinfo.data_ = raw_data_.data();
             pinfo.size_ = raw_data_.size();
             pinfo.force_rgba_ = true;
 
@@ -643,8 +637,9 @@ namespace {
     private:
         fs::path path_;
         dal::Filesystem* filesys_;
+        const mirinae::FileMapper* file_mapper_;
         VkPhysicalDeviceFeatures df_;
-        std::vector<std::byte> raw_data_;
+        mirinae::FileData raw_data_;
         std::shared_ptr<dal::IImage> img_;
     };
 
@@ -657,6 +652,7 @@ namespace {
         )
             : task_sche_(task_sche)
             , filesys_(&device.filesys())
+            , file_mapper_(device.file_mapper())
             , device_features_(device.features()) {}
 
         bool add_task(const fs::path& path) {
@@ -664,7 +660,7 @@ namespace {
                 return false;
 
             auto task = std::make_shared<ImageLoadTask>(
-                path, *filesys_, device_features_
+                path, *filesys_, file_mapper_, device_features_
             );
             task_sche_->add_task(task);
             tasks_.emplace(dal::tostr(path), task);
@@ -690,6 +686,7 @@ namespace {
         std::unordered_map<std::string, std::shared_ptr<ImageLoadTask>> tasks_;
         sung::HTaskSche task_sche_;
         dal::Filesystem* filesys_;
+        const mirinae::FileMapper* file_mapper_;
         VkPhysicalDeviceFeatures device_features_;
     };
 
@@ -741,6 +738,7 @@ namespace {
         }
 
         ~TextureManager() {
+            device_.uploader().wait_all();
             this->destroy_all();
             ktx_device_.destroy();
             cmd_pool_.destroy(device_.logi_device());
@@ -750,8 +748,12 @@ namespace {
             if (res_id.empty())
                 return dal::ReqResult::cannot_read_file;
 
-            if (auto index = this->find_index(res_id))
-                return dal::ReqResult::ready;
+            if (auto index = this->find_index(res_id)) {
+                const auto& tex = textures_.at(index.value());
+                if (device_.uploader().is_done(tex->upload_))
+                    return dal::ReqResult::ready;
+                return dal::ReqResult::loading;
+            }
 
             auto task = loader_mgr_.try_get_task(res_id);
             if (!task) {
@@ -780,14 +782,18 @@ namespace {
                 }
             } else if (auto raw_img = img->as<dal::TDataImage2D<uint8_t>>()) {
                 auto out = std::make_shared<TextureData>(device_);
-                out->init_iimage2d(id, *raw_img, img, srgb, cmd_pool_);
+                out->init_iimage2d(
+                    id, *raw_img, img, srgb, device_.uploader()
+                );
                 textures_.push_back(out);
-                return dal::ReqResult::ready;
+                return dal::ReqResult::loading;
             } else if (auto raw_img = img->as<dal::TDataImage2D<float>>()) {
                 auto out = std::make_shared<TextureData>(device_);
-                out->init_iimage2d(id, *raw_img, img, srgb, cmd_pool_);
+                out->init_iimage2d(
+                    id, *raw_img, img, srgb, device_.uploader()
+                );
                 textures_.push_back(out);
-                return dal::ReqResult::ready;
+                return dal::ReqResult::loading;
             } else {
                 SPDLOG_ERROR("Unsupported image type: {}", id);
                 return dal::ReqResult::not_supported_file;
@@ -813,8 +819,10 @@ namespace {
             const std::string& id, const dal::IImage2D& image, bool srgb
         ) override {
             if (auto img = image.as<dal::TDataImage2D<uint8_t>>()) {
+                auto& uploader = device_.uploader();
                 auto output = std::make_unique<TextureData>(device_);
-                output->init_iimage2d(id, *img, nullptr, srgb, cmd_pool_);
+                output->init_iimage2d(id, *img, nullptr, srgb, uploader);
+                uploader.wait(output->upload_);
                 return output;
             } else {
                 SPDLOG_ERROR("Unsupported image type: {}", id);
@@ -890,6 +898,16 @@ namespace mirinae {
         ::generate_mipmaps(cmdbuf, dst_image, width, height, mip_levels);
     }
 
+    void record_img_gen_mips(
+        const VkCommandBuffer cmdbuf,
+        const uint32_t width,
+        const uint32_t height,
+        const uint32_t mip_levels,
+        const VkImage image
+    ) {
+        ::generate_mipmaps(cmdbuf, image, width, height, mip_levels);
+    }
+
 
     std::unique_ptr<ITexture> create_tex_depth(
         uint32_t width, uint32_t height, VulkanDevice& device
@@ -0,0 +1,224 @@
+#include "mirinae/vulkan/base/render/ubuf_ring.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "mirinae/lightweight/include_spdlog.hpp"
+#include "mirinae/vulkan/base/render/mem_cinfo.hpp"
+#include "mirinae/vulkan/base/render/uniform.hpp"
+
+
+namespace {
+
+    constexpr size_t FRAME_SIZE = 16 * 1024 * 1024;
+    // Claimed by a thread at once. Bigger writes get a range of their own.
+    constexpr size_t SUB_BLOCK_SIZE = 64 * 1024;
+    constexpr uint32_t MAX_LAYOUTS = 4;
+
+
+    size_t align_up(size_t x, size_t alignment) {
+        return (x + alignment - 1) / alignment * alignment;
+    }
+
+
+    // Never reused, so a cursor left over from another frame or ring is
+    // told apart by its generation alone
+    std::atomic<uint64_t> g_generation{ 0 };
+
+
+    struct SubBlockCursor {
+        uint64_t generation_ = 0;
+        size_t pos_ = 0;
+        size_t end_ = 0;
+    };
+
+    thread_local SubBlockCursor t_cursor;
+
+
+    struct FrameBuffer {
+        mirinae::Buffer buf_;
+        uint8_t* mapped_ = nullptr;
+        std::atomic<size_t> head_{ 0 };
+        std::atomic<uint64_t> generation_{ 0 };
+        std::atomic<bool> overflowed_{ false };
+    };
+
+}  // namespace
+
+
+namespace mirinae {
+
+    class UbufRing::Impl {
+
+    public:
+        Impl(
+            VkDevice logi_device,
+            VulkanMemoryAllocator allocator,
+            VkDeviceSize offset_alignment
+        )
+            : logi_device_(logi_device)
+            , alignment_(std::max<VkDeviceSize>(offset_alignment, 16)) {
+            BufferCreateInfo cinfo;
+            cinfo.preset_ubuf(::FRAME_SIZE);
+            for (auto& frame : frames_) {
+                frame.buf_.init(cinfo, allocator);
+                frame.mapped_ = static_cast<uint8_t*>(frame.buf_.map());
+            }
+
+            VkDescriptorPoolSize pool_size{};
+            pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            pool_size.descriptorCount = ::MAX_LAYOUTS * MAX_FRAMES_IN_FLIGHT;
+            desc_pool_.init(
+                ::MAX_LAYOUTS * MAX_FRAMES_IN_FLIGHT,
+                1,
+                &pool_size,
+                logi_device_
+            );
+        }
+
+        ~Impl() { desc_pool_.destroy(logi_device_); }
+
+        void begin_frame(FrameIndex f_idx) {
+            auto& frame = frames_.at(f_idx.get());
+            frame.head_.store(0, std::memory_order_relaxed);
+            frame.overflowed_.store(false, std::memory_order_relaxed);
+            frame.generation_.store(
+                ++::g_generation, std::memory_order_release
+            );
+        }
+
+        void end_frame(FrameIndex f_idx) {
+            frames_.at(f_idx.get()).buf_.flush();
+        }
+
+        std::optional<uint32_t> write(
+            FrameIndex f_idx, const void* data, size_t size
+        ) {
+            auto& frame = frames_.at(f_idx.get());
+            const auto padded = ::align_up(size, alignment_);
+
+            std::optional<size_t> pos;
+            if (padded > ::SUB_BLOCK_SIZE / 4)
+                pos = this->claim(frame, padded);
+            else
+                pos = this->alloc_from_sub_block(frame, padded);
+
+            if (!pos) {
+                if (!frame.overflowed_.exchange(true))
+                    SPDLOG_ERROR("Uniform ring ran out of space this frame");
+                return std::nullopt;
+            }
+
+            std::memcpy(frame.mapped_ + *pos, data, size);
+            return static_cast<uint32_t>(*pos);
+        }
+
+        VkDescriptorSet descset(
+            FrameIndex f_idx, const DescLayout& layout, VkDeviceSize range
+        ) {
+            std::lock_guard<std::mutex> lock(mut_);
+
+            for (auto& entry : descsets_) {
+                if (entry.layout_ == layout.layout() && entry.range_ == range)
+                    return entry.sets_.at(f_idx.get());
+            }
+
+            MIRINAE_ASSERT(descsets_.size() < ::MAX_LAYOUTS);
+            MIRINAE_ASSERT(range <= ::FRAME_SIZE);
+
+            auto& entry = descsets_.emplace_back();
+            entry.layout_ = layout.layout();
+            entry.range_ = range;
+
+            DescWriter writer;
+            for (size_t i = 0; i < frames_.size(); ++i) {
+                const auto set = desc_pool_.alloc(entry.layout_, logi_device_);
+                entry.sets_.at(i) = set;
+
+                writer.add_buf_info()
+                    .set_buffer(frames_[i].buf_.buffer())
+                    .set_offset(0)
+                    .set_range(range);
+                writer.add_dyn_buf_write(set, 0);
+            }
+            writer.apply_all(logi_device_);
+
+            return entry.sets_.at(f_idx.get());
+        }
+
+    private:
+        struct LayoutSets {
+            std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> sets_{};
+            VkDescriptorSetLayout layout_ = VK_NULL_HANDLE;
+            VkDeviceSize range_ = 0;
+        };
+
+        static std::optional<size_t> claim(::FrameBuffer& frame, size_t size) {
+            const auto pos = frame.head_.fetch_add(size);
+            if (pos + size > ::FRAME_SIZE)
+                return std::nullopt;
+            return pos;
+        }
+
+        static std::optional<size_t> alloc_from_sub_block(
+            ::FrameBuffer& frame, size_t size
+        ) {
+            auto& cursor = ::t_cursor;
+            const auto gen = frame.generation_.load(std::memory_order_acquire);
+
+            if (cursor.generation_ != gen || cursor.pos_ + size > cursor.end_) {
+                const auto block = claim(frame, ::SUB_BLOCK_SIZE);
+                if (!block)
+                    return std::nullopt;
+
+                cursor.generation_ = gen;
+                cursor.pos_ = *block;
+                cursor.end_ = *block + ::SUB_BLOCK_SIZE;
+            }
+
+            const auto out = cursor.pos_;
+            cursor.pos_ += size;
+            return out;
+        }
+
+        std::array<::FrameBuffer, MAX_FRAMES_IN_FLIGHT> frames_;
+        std::vector<LayoutSets> descsets_;
+        DescPool desc_pool_;
+        std::mutex mut_;
+        VkDevice logi_device_;
+        const size_t alignment_;
+    };
+
+
+    UbufRing::UbufRing(
+        VkDevice logi_device,
+        VulkanMemoryAllocator allocator,
+        VkDeviceSize offset_alignment
+    )
+        : pimpl_(
+              std::make_unique<Impl>(logi_device, allocator, offset_alignment)
+          ) {}
+
+    UbufRing::~UbufRing() = default;
+
+    void UbufRing::begin_frame(FrameIndex f_idx) { pimpl_->begin_frame(f_idx); }
+
+    void UbufRing::end_frame(FrameIndex f_idx) { pimpl_->end_frame(f_idx); }
+
+    std::optional<uint32_t> UbufRing::write(
+        FrameIndex f_idx, const void* data, size_t size
+    ) {
+        return pimpl_->write(f_idx, data, size);
+    }
+
+    VkDescriptorSet UbufRing::descset(
+        FrameIndex f_idx, const DescLayout& layout, VkDeviceSize range
+    ) {
+        return pimpl_->descset(f_idx, layout, range);
+    }
+
+}  // namespace mirinae
@@ -118,6 +118,16 @@ namespace mirinae {
             .finish_binding();
     }
 
+    DescLayoutBuilder& DescLayoutBuilder::add_ubuf_dyn(
+        VkShaderStageFlags stage_flags, uint32_t count
+    ) {
+        return this->new_binding()
+            .set_type(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+            .set_count(count)
+            .set_stage(stage_flags)
+            .finish_binding();
+    }
+
     DescLayoutBuilder& DescLayoutBuilder::add_sbuf(
         VkShaderStageFlags stage_flags, uint32_t count
     ) {
@@ -477,6 +487,25 @@ namespace mirinae {
         return *this;
     }
 
+    DescWriter& DescWriter::add_dyn_buf_write(
+        VkDescriptorSet descset, uint32_t binding
+    ) {
+        const auto& buf_info = buffer_info_.back();
+        buffer_info_.emplace_back();
+
+        auto& write = write_info_.emplace_back();
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = descset;
+        write.dstBinding = binding;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        write.descriptorCount = buf_info.size();
+        write.pImageInfo = nullptr;
+        write.pBufferInfo = buf_info.data();
+
+        return *this;
+    }
+
     DescWriter& DescWriter::add_sampled_img_write(
         VkDescriptorSet descset, uint32_t binding
     ) {
@@ -0,0 +1,490 @@
+#include "mirinae/vulkan/base/render/upload.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+
+#include "mirinae/lightweight/include_spdlog.hpp"
+#include "mirinae/lightweight/ring_alloc.hpp"
+#include "mirinae/vulkan/base/render/cmdbuf.hpp"
+#include "mirinae/vulkan/base/render/mem_cinfo.hpp"
+#include "mirinae/vulkan/base/render/texture.hpp"
+#include "mirinae/vulkan/base/render/vkcheck.hpp"
+#include "mirinae/vulkan/base/render/vkmajorplayers.hpp"
+
+
+namespace {
+
+    constexpr size_t RING_SIZE = 64 * 1024 * 1024;
+    // Bigger ones get a staging buffer of their own
+    constexpr size_t MAX_RING_UPLOAD = RING_SIZE / 4;
+
+    constexpr VkPipelineStageFlags BUF_DST_STAGES =
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    constexpr VkAccessFlags BUF_DST_ACCESS =
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+        VK_ACCESS_SHADER_READ_BIT;
+
+
+    VkCommandBuffer begin_cmdbuf(
+        mirinae::CommandPool& pool, VkDevice logi_device
+    ) {
+        const auto cmdbuf = pool.alloc(logi_device);
+
+        VkCommandBufferBeginInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CHECK(vkBeginCommandBuffer(cmdbuf, &info));
+        return cmdbuf;
+    }
+
+    VkBufferMemoryBarrier make_buf_barrier(
+        VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size
+    ) {
+        VkBufferMemoryBarrier out{};
+        out.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        out.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        out.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        out.buffer = buffer;
+        out.offset = offset;
+        out.size = size;
+        return out;
+    }
+
+    void record_buf_barrier(
+        VkCommandBuffer cmdbuf,
+        const VkBufferMemoryBarrier& barrier,
+        VkPipelineStageFlags src_stage,
+        VkPipelineStageFlags dst_stage
+    ) {
+        vkCmdPipelineBarrier(
+            cmdbuf, src_stage, dst_stage, 0, 0, nullptr, 1, &barrier, 0, nullptr
+        );
+    }
+
+
+    // Copies recorded together and retired together
+    struct Batch {
+        mirinae::UploadTicket ticket_ = 0;
+        // Null without a dedicated transfer queue, then copies go to `gfx_`
+        VkCommandBuffer xfer_ = VK_NULL_HANDLE;
+        VkCommandBuffer gfx_ = VK_NULL_HANDLE;
+        VkSemaphore xfer_done_ = VK_NULL_HANDLE;
+        VkFence fence_ = VK_NULL_HANDLE;
+        // Ring head right after this batch's last allocation
+        uint64_t ring_pos_ = 0;
+        std::vector<mirinae::Buffer> own_staging_;
+    };
+
+
+    struct Staged {
+        VkBuffer buffer_ = VK_NULL_HANDLE;
+        VkDeviceSize offset_ = 0;
+        mirinae::Buffer own_;
+    };
+
+}  // namespace
+
+
+// UploadService::Impl
+namespace mirinae {
+
+    class UploadService::Impl {
+
+    public:
+        Impl(
+            VkDevice logi_device,
+            VulkanMemoryAllocator allocator,
+            const UploadQueue& graphics,
+            const std::optional<UploadQueue>& transfer,
+            VkDeviceSize copy_alignment
+        )
+            : device_(logi_device)
+            , allocator_(allocator)
+            , gfx_q_(graphics)
+            , ring_(::RING_SIZE)
+            , align_(std::max<VkDeviceSize>(copy_alignment, 16)) {
+            if (transfer && transfer->family_ != graphics.family_)
+                xfer_q_ = transfer;
+
+            gfx_pool_.init(gfx_q_.family_, device_);
+            if (xfer_q_)
+                xfer_pool_.init(xfer_q_->family_, device_);
+
+            BufferCreateInfo cinfo;
+            cinfo.preset_staging(::RING_SIZE);
+            ring_buf_.init(cinfo, allocator_);
+            ring_data_ = static_cast<uint8_t*>(ring_buf_.map());
+
+            SPDLOG_INFO(
+                "Upload service uses {} queue",
+                xfer_q_ ? "a dedicated transfer" : "the graphics"
+            );
+        }
+
+        ~Impl() {
+            this->wait_all();
+            ring_buf_.destroy();
+            xfer_pool_.destroy(device_);
+            gfx_pool_.destroy(device_);
+        }
+
+        UploadTicket upload_buffer(
+            VkBuffer dst, VkDeviceSize offset, const void* data, size_t size
+        ) {
+            std::lock_guard<std::mutex> lock(mut_);
+
+            auto staged = this->stage(data, size);
+            auto& batch = this->open_batch();
+            const auto copy_cmd = batch.xfer_ ? batch.xfer_ : batch.gfx_;
+
+            VkBufferCopy region{};
+            region.srcOffset = staged.offset_;
+            region.dstOffset = offset;
+            region.size = size;
+            vkCmdCopyBuffer(copy_cmd, staged.buffer_, dst, 1, &region);
+
+            auto barrier = ::make_buf_barrier(dst, offset, size);
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = ::BUF_DST_ACCESS;
+            if (xfer_q_) {
+                // Release on the transfer queue, acquire on graphics
+                barrier.srcQueueFamilyIndex = xfer_q_->family_;
+                barrier.dstQueueFamilyIndex = gfx_q_.family_;
+                ::record_buf_barrier(
+                    batch.xfer_,
+                    barrier,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+                );
+                ::record_buf_barrier(
+                    batch.gfx_,
+                    barrier,
+                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                    ::BUF_DST_STAGES
+                );
+            } else {
+                ::record_buf_barrier(
+                    batch.gfx_,
+                    barrier,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    ::BUF_DST_STAGES
+                );
+            }
+
+            if (staged.own_.buffer())
+                batch.own_staging_.push_back(std::move(staged.own_));
+            return batch.ticket_;
+        }
+
+        UploadTicket upload_image(
+            VkImage dst,
+            uint32_t width,
+            uint32_t height,
+            uint32_t mip_levels,
+            const void* data,
+            size_t size
+        ) {
+            std::lock_guard<std::mutex> lock(mut_);
+
+            auto staged = this->stage(data, size);
+            auto& batch = this->open_batch();
+            const auto copy_cmd = batch.xfer_ ? batch.xfer_ : batch.gfx_;
+
+            ImageMemoryBarrier barrier;
+            barrier.image(dst)
+                .set_aspect_mask(VK_IMAGE_ASPECT_COLOR_BIT)
+                .mip_base(0)
+                .mip_count(mip_levels)
+                .layer_base(0)
+                .layer_count(1)
+                .set_src_access(0)
+                .set_dst_access(VK_ACCESS_TRANSFER_WRITE_BIT)
+                .old_layout(VK_IMAGE_LAYOUT_UNDEFINED)
+                .new_layout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            barrier.record_single(
+                copy_cmd,
+                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT
+            );
+
+            VkBufferImageCopy region{};
+            region.bufferOffset = staged.offset_;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = 0;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageExtent = { width, height, 1 };
+            vkCmdCopyBufferToImage(
+                copy_cmd,
+                staged.buffer_,
+                dst,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1,
+                &region
+            );
+
+            // Blits need the graphics queue, so hand the image over first
+            if (xfer_q_) {
+                barrier.old_layout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+                    .queue_families(xfer_q_->family_, gfx_q_.family_)
+                    .set_src_access(VK_ACCESS_TRANSFER_WRITE_BIT)
+                    .set_dst_access(0);
+                barrier.record_single(
+                    batch.xfer_,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+                );
+
+                barrier.set_src_access(0).set_dst_access(
+                    VK_ACCESS_TRANSFER_WRITE_BIT
+                );
+                barrier.record_single(
+                    batch.gfx_,
+                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT
+                );
+            }
+
+            record_img_gen_mips(batch.gfx_, width, height, mip_levels, dst);
+
+            if (staged.own_.buffer())
+                batch.own_staging_.push_back(std::move(staged.own_));
+            return batch.ticket_;
+        }
+
+        void tick() {
+            std::lock_guard<std::mutex> lock(mut_);
+            this->submit();
+            this->retire_done();
+        }
+
+        bool is_done(UploadTicket ticket) {
+            std::lock_guard<std::mutex> lock(mut_);
+            this->retire_done();
+            return ticket <= completed_;
+        }
+
+        void wait(UploadTicket ticket) {
+            std::lock_guard<std::mutex> lock(mut_);
+            if (ticket <= completed_)
+                return;
+
+            if (open_ && open_->ticket_ <= ticket)
+                this->submit();
+            while (ticket > completed_ && !in_flight_.empty())
+                this->retire_oldest(true);
+        }
+
+        void wait_all() {
+            this->wait(std::numeric_limits<UploadTicket>::max());
+        }
+
+        std::unique_lock<std::mutex> lock_queues() {
+            return std::unique_lock<std::mutex>(queue_mut_);
+        }
+
+    private:
+        ::Batch& open_batch() {
+            if (open_)
+                return *open_;
+
+            auto& batch = open_.emplace();
+            batch.ticket_ = next_ticket_++;
+            batch.gfx_ = ::begin_cmdbuf(gfx_pool_, device_);
+            if (xfer_q_)
+                batch.xfer_ = ::begin_cmdbuf(xfer_pool_, device_);
+            return batch;
+        }
+
+        // May submit the open batch, so call before `open_batch()`
+        ::Staged stage(const void* data, size_t size) {
+            ::Staged out;
+
+            if (size > ::MAX_RING_UPLOAD) {
+                BufferCreateInfo cinfo;
+                cinfo.preset_staging(size);
+                out.own_.init(cinfo, allocator_);
+                out.own_.set_data(data, size);
+                out.buffer_ = out.own_.buffer();
+                return out;
+            }
+
+            while (true) {
+                if (const auto offset = ring_.alloc(size, align_)) {
+                    std::memcpy(ring_data_ + *offset, data, size);
+                    out.buffer_ = ring_buf_.buffer();
+                    out.offset_ = *offset;
+                    return out;
+                }
+
+                // The ring is full of copies not yet done
+                if (in_flight_.empty())
+                    this->submit();
+                this->retire_oldest(true);
+            }
+        }
+
+        void submit() {
+            if (!open_)
+                return;
+
+            auto& batch = open_.value();
+            batch.ring_pos_ = ring_.head();
+            ring_buf_.flush();
+
+            VkFenceCreateInfo fence_cinfo{};
+            fence_cinfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            VK_CHECK(
+                vkCreateFence(device_, &fence_cinfo, nullptr, &batch.fence_)
+            );
+
+            VkSubmitInfo submit{};
+            submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit.commandBufferCount = 1;
+
+            auto queue_lock = this->lock_queues();
+            if (batch.xfer_) {
+                VkSemaphoreCreateInfo sema_cinfo{};
+                sema_cinfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+                VK_CHECK(vkCreateSemaphore(
+                    device_, &sema_cinfo, nullptr, &batch.xfer_done_
+                ));
+
+                VK_CHECK(vkEndCommandBuffer(batch.xfer_));
+                submit.pCommandBuffers = &batch.xfer_;
+                submit.signalSemaphoreCount = 1;
+                submit.pSignalSemaphores = &batch.xfer_done_;
+                VK_CHECK(
+                    vkQueueSubmit(xfer_q_->queue_, 1, &submit, VK_NULL_HANDLE)
+                );
+            }
+
+            const VkPipelineStageFlags wait_stage =
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            VK_CHECK(vkEndCommandBuffer(batch.gfx_));
+            submit.pCommandBuffers = &batch.gfx_;
+            submit.signalSemaphoreCount = 0;
+            submit.pSignalSemaphores = nullptr;
+            if (batch.xfer_done_) {
+                submit.waitSemaphoreCount = 1;
+                submit.pWaitSemaphores = &batch.xfer_done_;
+                submit.pWaitDstStageMask = &wait_stage;
+            }
+            VK_CHECK(vkQueueSubmit(gfx_q_.queue_, 1, &submit, batch.fence_));
+            queue_lock.unlock();
+
+            in_flight_.push_back(std::move(batch));
+            open_.reset();
+        }
+
+        // Batches finish in submission order
+        bool retire_oldest(bool block) {
+            if (in_flight_.empty())
+                return false;
+
+            auto& batch = in_flight_.front();
+            if (block) {
+                VK_CHECK(vkWaitForFences(
+                    device_, 1, &batch.fence_, VK_TRUE, UINT64_MAX
+                ));
+            } else if (VK_SUCCESS != vkGetFenceStatus(device_, batch.fence_)) {
+                return false;
+            }
+
+            vkDestroyFence(device_, batch.fence_, nullptr);
+            if (batch.xfer_done_)
+                vkDestroySemaphore(device_, batch.xfer_done_, nullptr);
+            if (batch.xfer_)
+                xfer_pool_.free(batch.xfer_, device_);
+            gfx_pool_.free(batch.gfx_, device_);
+
+            ring_.release(batch.ring_pos_);
+            completed_ = batch.ticket_;
+            in_flight_.pop_front();
+            return true;
+        }
+
+        void retire_done() {
+            while (this->retire_oldest(false)) {
+            }
+        }
+
+        VkDevice device_;
+        VulkanMemoryAllocator allocator_;
+        UploadQueue gfx_q_;
+        std::optional<UploadQueue> xfer_q_;
+        CommandPool gfx_pool_;
+        CommandPool xfer_pool_;
+
+        Buffer ring_buf_;
+        uint8_t* ring_data_ = nullptr;
+        RingAllocator ring_;
+        const VkDeviceSize align_;
+
+        std::optional<::Batch> open_;
+        std::deque<::Batch> in_flight_;
+        UploadTicket next_ticket_ = 1;
+        UploadTicket completed_ = 0;
+        std::mutex mut_;
+        // Only ever taken after `mut_`
+        std::mutex queue_mut_;
+    };
+
+}  // namespace mirinae
+
+
+// UploadService
+namespace mirinae {
+
+    UploadService::UploadService(
+        VkDevice logi_device,
+        VulkanMemoryAllocator allocator,
+        const UploadQueue& graphics,
+        const std::optional<UploadQueue>& transfer,
+        VkDeviceSize copy_alignment
+    )
+        : pimpl_(std::make_unique<Impl>(
+              logi_device, allocator, graphics, transfer, copy_alignment
+          )) {}
+
+    UploadService::~UploadService() = default;
+
+    UploadTicket UploadService::upload_buffer(
+        VkBuffer dst, VkDeviceSize offset, const void* data, size_t size
+    ) {
+        return pimpl_->upload_buffer(dst, offset, data, size);
+    }
+
+    UploadTicket UploadService::upload_image(
+        VkImage dst,
+        uint32_t width,
+        uint32_t height,
+        uint32_t mip_levels,
+        const void* data,
+        size_t size
+    ) {
+        return pimpl_->upload_image(
+            dst, width, height, mip_levels, data, size
+        );
+    }
+
+    void UploadService::tick() { pimpl_->tick(); }
+
+    bool UploadService::is_done(UploadTicket ticket) {
+        return pimpl_->is_done(ticket);
+    }
+
+    void UploadService::wait(UploadTicket ticket) { pimpl_->wait(ticket); }
+
+    void UploadService::wait_all() { pimpl_->wait_all(); }
+
+    std::unique_lock<std::mutex> UploadService::lock_queues() {
+        return pimpl_->lock_queues();
+    }
+
+}  // namespace mirinae
@@ -2,92 +2,16 @@
 
 #include "mirinae/vulkan/base/render/cmdbuf.hpp"
 #include "mirinae/vulkan/base/render/mem_cinfo.hpp"
-
-
-namespace {
-
-    void set_buffer_data(
-        mirinae::Buffer& dst,
-        const void* src,
-        size_t src_size,
-        mirinae::CommandPool& cmdpool,
-        mirinae::VulkanMemoryAllocator allocator,
-        VkQueue graphics_q,
-        VkDevice logi_device
-    ) {
-        mirinae::BufferCreateInfo buf_cinfo;
-        buf_cinfo.preset_staging(src_size);
-
-        mirinae::Buffer staging_buffer;
-        staging_buffer.init(buf_cinfo, allocator);
-        staging_buffer.set_data(src, src_size);
-
-        auto cmdbuf = cmdpool.alloc(logi_device);
-        dst.record_copy_cmd(staging_buffer, cmdbuf, logi_device);
-
-        VkSubmitInfo submit_info{};
-        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submit_info.commandBufferCount = 1;
-        submit_info.pCommandBuffers = &cmdbuf;
-        vkQueueSubmit(graphics_q, 1, &submit_info, VK_NULL_HANDLE);
-
-        vkQueueWaitIdle(graphics_q);
-        cmdpool.free(cmdbuf, logi_device);
-        staging_buffer.destroy();
-    }
-
-}  // namespace
+#include "mirinae/vulkan/base/render/upload.hpp"
 
 
 // VertexIndexPair
 namespace mirinae {
 
-    void VertexIndexPair::init(
-        const VerticesStaticPair& vertices,
-        CommandPool& cmdpool,
-        VulkanMemoryAllocator allocator,
-        VkQueue graphics_q,
-        VkDevice logi_device
-    ) {
-        BufferCreateInfo buf_cinfo;
-
-        // Vertices data size
-        const auto v_s = sizeof(VertexStatic) * vertices.vertices_.size();
-        buf_cinfo.preset_vertices(v_s);
-        vertex_buf_.init(buf_cinfo, allocator);
-        ::set_buffer_data(
-            vertex_buf_,
-            vertices.vertices_.data(),
-            v_s,
-            cmdpool,
-            allocator,
-            graphics_q,
-            logi_device
-        );
-
-        // Indices data size
-        const auto i_s = sizeof(VertIndexType_t) * vertices.indices_.size();
-        buf_cinfo.preset_indices(i_s);
-        index_buf_.init(buf_cinfo, allocator);
-        ::set_buffer_data(
-            index_buf_,
-            vertices.indices_.data(),
-            i_s,
-            cmdpool,
-            allocator,
-            graphics_q,
-            logi_device
-        );
-
-        vertex_count_ = vertices.indices_.size();
-    }
-
     void VertexIndexPair::init(
         const VerticesSkinnedPair& vertices,
-        CommandPool& cmdpool,
-        VulkanMemoryAllocator allocator,
-        VkQueue graphics_q,
-        VkDevice logi_device
+        UploadService& uploader,
+        VulkanMemoryAllocator allocator
     ) {
         BufferCreateInfo buf_cinfo;
 
@@ -97,28 +21,16 @@ namespace mirinae {
             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
         );
         vertex_buf_.init(buf_cinfo, allocator);
-        ::set_buffer_data(
-            vertex_buf_,
-            vertices.vertices_.data(),
-            v_s,
-            cmdpool,
-            allocator,
-            graphics_q,
-            logi_device
+        uploader.upload_buffer(
+            vertex_buf_.buffer(), 0, vertices.vertices_.data(), v_s
         );
 
         // Indices data size
         const auto i_s = sizeof(VertIndexType_t) * vertices.indices_.size();
         buf_cinfo.preset_indices(i_s);
         index_buf_.init(buf_cinfo, allocator);
-        ::set_buffer_data(
-            index_buf_,
-            vertices.indices_.data(),
-            i_s,
-            cmdpool,
-            allocator,
-            graphics_q,
-            logi_device
+        upload_ = uploader.upload_buffer(
+            index_buf_.buffer(), 0, vertices.indices_.data(), i_s
         );
 
         vertex_count_ = vertices.indices_.size();
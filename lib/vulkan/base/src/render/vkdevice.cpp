@@ -13,9 +13,14 @@
 #include "mirinae/vulkan/base/platform_func.hpp"
 #include "mirinae/vulkan/base/render/cmdbuf.hpp"
 #include "mirinae/vulkan/base/render/enum_str.hpp"
+#include "mirinae/vulkan/base/render/geometry.hpp"
+#include "mirinae/vulkan/base/render/meshdata.hpp"
+#include "mirinae/vulkan/base/render/ubuf_ring.hpp"
+#include "mirinae/vulkan/base/render/upload.hpp"
 #include "mirinae/vulkan/base/render/vkcheck.hpp"
 #include "mirinae/vulkan/base/render/vkmajorplayers.hpp"
 #include "render/vkdevice/logi_device.hpp"
+#include "render/vkdevice/pipeline_cache.hpp"
 #include "render/vkdevice/vk_instance.hpp"
 
 
@@ -393,9 +398,40 @@ namespace mirinae {
 
             samplers_.init(phys_device_, logi_device_);
             img_formats_.init(phys_device_);
+
+            std::filesystem::path cache_path;
+            if (!create_info.cache_dir_.empty())
+                cache_path = create_info.cache_dir_ / "pipeline_cache.bin";
+            pipeline_cache_.init(phys_device_, logi_device_.get(), cache_path);
+
+            std::optional<UploadQueue> transfer_q;
+            if (const auto family = phys_device_.transfer_family_index()) {
+                transfer_q = UploadQueue{ logi_device_.transfer_queue(),
+                                          family.value() };
+            }
+            uploader_ = std::make_unique<UploadService>(
+                logi_device_.get(),
+                mem_allocator_,
+                UploadQueue{ logi_device_.graphics_queue(),
+                             phys_device_.graphics_family_index().value() },
+                transfer_q,
+                phys_device_.limits().optimalBufferCopyOffsetAlignment
+            );
+            geometry_ = std::make_unique<GeometryArena>(
+                mem_allocator_, sizeof(VertexStatic)
+            );
+            ubuf_ring_ = std::make_unique<UbufRing>(
+                logi_device_.get(),
+                mem_allocator_,
+                phys_device_.limits().minUniformBufferOffsetAlignment
+            );
         }
 
         ~Pimpl() {
+            uploader_.reset();
+            geometry_.reset();
+            ubuf_ring_.reset();
+            pipeline_cache_.destroy(logi_device_.get());
             samplers_.destroy(logi_device_);
 
             mirinae::destroy_vma_allocator(mem_allocator_);
@@ -413,7 +449,7 @@ namespace mirinae {
             info.Device = logi_device_.get();
             info.QueueFamily = phys_device_.graphics_family_index().value();
             info.Queue = logi_device_.graphics_queue();
-            info.PipelineCache = VK_NULL_HANDLE;
+            info.PipelineCache = pipeline_cache_.get();
             info.Allocator = VK_NULL_HANDLE;
             info.CheckVkResultFn = ::check_imgui_result;
         }
@@ -421,6 +457,10 @@ namespace mirinae {
         mirinae::VulkanInstance instance_;
         mirinae::PhysDevice phys_device_;
         mirinae::LogiDevice logi_device_;
+        mirinae::PipelineCache pipeline_cache_;
+        std::unique_ptr<UploadService> uploader_;
+        std::unique_ptr<GeometryArena> geometry_;
+        std::unique_ptr<UbufRing> ubuf_ring_;
         ::SamplerManager samplers_;
         ::ImageFormats img_formats_;
         EngineCreateInfo create_info_;
@@ -477,6 +517,12 @@ namespace mirinae {
 
     IImageFormats& VulkanDevice::img_formats() { return pimpl_->img_formats_; }
 
+    UploadService& VulkanDevice::uploader() { return *pimpl_->uploader_; }
+
+    GeometryArena& VulkanDevice::geometry() { return *pimpl_->geometry_; }
+
+    UbufRing& VulkanDevice::ubuf_ring() { return *pimpl_->ubuf_ring_; }
+
     VulkanMemoryAllocator VulkanDevice::mem_alloc() {
         return pimpl_->mem_allocator_;
     }
@@ -485,6 +531,18 @@ namespace mirinae {
         return *pimpl_->create_info_.filesys_;
     }
 
+    const FileMapper* VulkanDevice::file_mapper() const {
+        return pimpl_->create_info_.file_mapper_.get();
+    }
+
+    VkPipelineCache VulkanDevice::pipeline_cache() {
+        return pimpl_->pipeline_cache_.get();
+    }
+
+    void VulkanDevice::save_pipeline_cache() {
+        pimpl_->pipeline_cache_.save(pimpl_->logi_device_.get());
+    }
+
     IOsIoFunctions& VulkanDevice::osio() { return *pimpl_->create_info_.osio_; }
 
     void VulkanDevice::fill_imgui_info(ImGui_ImplVulkan_InitInfo& info) {
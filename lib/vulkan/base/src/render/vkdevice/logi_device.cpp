@@ -59,6 +59,8 @@ namespace mirinae {
             phys_dev.graphics_family_index().value(),
             phys_dev.present_family_index().value(),
         };
+        if (const auto transfer = phys_dev.transfer_family_index())
+            unique_queue_families.insert(transfer.value());
 
         float queue_priority = 1;
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
@@ -101,6 +103,8 @@ namespace mirinae {
         vkGetDeviceQueue(
             device_, phys_dev.present_family_index().value(), 0, &present_queue_
         );
+        if (const auto transfer = phys_dev.transfer_family_index())
+            vkGetDeviceQueue(device_, transfer.value(), 0, &transfer_queue_);
     }
 
     void LogiDevice::destroy() {
@@ -111,6 +115,8 @@ namespace mirinae {
         }
 
         graphics_queue_ = nullptr;
+        present_queue_ = nullptr;
+        transfer_queue_ = nullptr;
     }
 
     void LogiDevice::wait_idle() {
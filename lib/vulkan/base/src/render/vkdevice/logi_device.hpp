@@ -18,12 +18,15 @@ namespace mirinae {
         VkDevice get() { return device_; }
         VkQueue graphics_queue() { return graphics_queue_; }
         VkQueue present_queue() { return present_queue_; }
+        // Null if the device has no dedicated transfer family
+        VkQueue transfer_queue() { return transfer_queue_; }
         const VkPhysicalDeviceFeatures2& features() const { return features_; }
 
     private:
         VkDevice device_ = nullptr;
         VkQueue graphics_queue_ = nullptr;
         VkQueue present_queue_ = nullptr;
+        VkQueue transfer_queue_ = nullptr;
         VkPhysicalDeviceFeatures2 features_;
         VkPhysicalDeviceVulkan11Features feat11_;
     };
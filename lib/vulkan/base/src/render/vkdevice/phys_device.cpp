@@ -89,6 +89,11 @@ namespace mirinae {
             );
             if (present_support)
                 present_family_index_ = i;
+
+            // Copy engines that can run alongside graphics work
+            const auto flags = queue_family[i].queueFlags;
+            if (!transfer_family_index_ && this->is_transfer_only(flags))
+                transfer_family_index_ = i;
         }
     }
 
@@ -98,6 +103,7 @@ namespace mirinae {
         features_.clear();
         graphics_family_index_ = std::nullopt;
         present_family_index_ = std::nullopt;
+        transfer_family_index_ = std::nullopt;
     }
 
     std::string PhysDevice::make_report_str() const {
@@ -260,6 +266,10 @@ namespace mirinae {
         return present_family_index_;
     }
 
+    std::optional<uint32_t> PhysDevice::transfer_family_index() const {
+        return transfer_family_index_;
+    }
+
     bool PhysDevice::is_descrete_gpu() const {
         return properties_.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
     }
@@ -346,4 +356,13 @@ namespace mirinae {
         return true;
     }
 
+    bool PhysDevice::is_transfer_only(const VkQueueFlags flags) {
+        if (0 == (flags & VK_QUEUE_TRANSFER_BIT))
+            return false;
+        else if (flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))
+            return false;
+
+        return true;
+    }
+
 }  // namespace mirinae
@@ -69,11 +69,14 @@ namespace mirinae {
         auto name() const { return properties_.deviceName; }
         auto& features() const { return features_.get(); }
         auto& limits() const { return properties_.limits; }
+        auto& properties() const { return properties_; }
 
         std::string make_report_str() const;
 
         std::optional<uint32_t> graphics_family_index() const;
         std::optional<uint32_t> present_family_index() const;
+        // Family dedicated to transfers, if the device has one
+        std::optional<uint32_t> transfer_family_index() const;
 
         bool is_descrete_gpu() const;
         bool is_texture_format_supported(VkFormat format) const;
@@ -93,11 +96,13 @@ namespace mirinae {
 
     private:
         static bool is_queue_flag_applicable(const VkQueueFlags flags);
+        static bool is_transfer_only(const VkQueueFlags flags);
         VkPhysicalDevice handle_ = nullptr;
         VkPhysicalDeviceProperties properties_{};
         PhysDeviceFeatures features_;
         std::optional<uint32_t> graphics_family_index_;
         std::optional<uint32_t> present_family_index_;
+        std::optional<uint32_t> transfer_family_index_;
     };
 
 }  // namespace mirinae
@@ -0,0 +1,153 @@
+#include "render/vkdevice/pipeline_cache.hpp"
+
+#include <cstring>
+#include <fstream>
+
+#include "mirinae/lightweight/include_spdlog.hpp"
+
+
+namespace {
+
+    std::vector<uint8_t> read_file(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return {};
+
+        std::vector<uint8_t> out(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(out.data()), out.size());
+        if (!file)
+            return {};
+        return out;
+    }
+
+    // Drivers reject foreign data themselves but not all of them do so
+    // gracefully, so the header is checked beforehand
+    bool is_compatible(
+        const std::vector<uint8_t>& data,
+        const VkPhysicalDeviceProperties& props
+    ) {
+        VkPipelineCacheHeaderVersionOne header;
+        if (data.size() < sizeof(header))
+            return false;
+
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (header.headerSize < sizeof(header))
+            return false;
+        if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+            return false;
+        if (header.vendorID != props.vendorID)
+            return false;
+        if (header.deviceID != props.deviceID)
+            return false;
+
+        const auto uuid_cmp = std::memcmp(
+            header.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE
+        );
+        return 0 == uuid_cmp;
+    }
+
+}  // namespace
+
+
+namespace mirinae {
+
+    PipelineCache::~PipelineCache() {
+        if (VK_NULL_HANDLE != handle_)
+            SPDLOG_ERROR("Pipeline cache is not destroyed");
+    }
+
+    void PipelineCache::init(
+        const PhysDevice& phys_dev,
+        VkDevice logi_dev,
+        const std::filesystem::path& file_path
+    ) {
+        file_path_ = file_path;
+
+        std::vector<uint8_t> data;
+        if (!file_path_.empty()) {
+            data = ::read_file(file_path_);
+            const auto& props = phys_dev.properties();
+            if (!data.empty() && !::is_compatible(data, props)) {
+                SPDLOG_INFO("Pipeline cache is from another device or driver");
+                data.clear();
+            }
+        }
+
+        VkPipelineCacheCreateInfo cinfo{};
+        cinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cinfo.initialDataSize = data.size();
+        cinfo.pInitialData = data.empty() ? nullptr : data.data();
+
+        auto res = vkCreatePipelineCache(logi_dev, &cinfo, nullptr, &handle_);
+        if (VK_SUCCESS != res && !data.empty()) {
+            SPDLOG_WARN("Failed to load pipeline cache, starting empty");
+            data.clear();
+            cinfo.initialDataSize = 0;
+            cinfo.pInitialData = nullptr;
+            res = vkCreatePipelineCache(logi_dev, &cinfo, nullptr, &handle_);
+        }
+        if (VK_SUCCESS != res) {
+            SPDLOG_ERROR("Failed to create pipeline cache");
+            handle_ = VK_NULL_HANDLE;
+        }
+
+        saved_size_ = data.size();
+        if (!data.empty())
+            SPDLOG_INFO("Pipeline cache loaded: {} bytes", data.size());
+    }
+
+    void PipelineCache::destroy(VkDevice logi_dev) {
+        if (VK_NULL_HANDLE == handle_)
+            return;
+
+        this->save(logi_dev);
+        vkDestroyPipelineCache(logi_dev, handle_, nullptr);
+        handle_ = VK_NULL_HANDLE;
+    }
+
+    void PipelineCache::save(VkDevice logi_dev) {
+        if (VK_NULL_HANDLE == handle_ || file_path_.empty())
+            return;
+
+        size_t size = 0;
+        auto res = vkGetPipelineCacheData(logi_dev, handle_, &size, nullptr);
+        if (VK_SUCCESS != res || size == saved_size_)
+            return;
+
+        std::vector<uint8_t> data(size);
+        res = vkGetPipelineCacheData(logi_dev, handle_, &size, data.data());
+        if (VK_SUCCESS != res)
+            return;
+        data.resize(size);
+
+        std::error_code ec;
+        const auto parent = file_path_.parent_path();
+        if (!parent.empty())
+            std::filesystem::create_directories(parent, ec);
+
+        // Written aside and then swapped so that a crash never leaves a
+        // truncated cache behind
+        auto tmp_path = file_path_;
+        tmp_path += ".tmp";
+        {
+            std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(data.data()), size);
+            if (!file) {
+                SPDLOG_WARN(
+                    "Failed to write pipeline cache: {}", tmp_path.string()
+                );
+                return;
+            }
+        }
+
+        std::filesystem::rename(tmp_path, file_path_, ec);
+        if (ec) {
+            SPDLOG_WARN("Failed to save pipeline cache: {}", ec.message());
+            return;
+        }
+
+        saved_size_ = size;
+    }
+
+}  // namespace mirinae
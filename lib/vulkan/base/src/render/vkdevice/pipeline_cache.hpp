@@ -0,0 +1,39 @@
+#pragma once
+
+#include <filesystem>
+
+#include "render/vkdevice/phys_device.hpp"
+
+
+namespace mirinae {
+
+    // Shared by every pipeline created on the device. Internally
+    // synchronized, so pipelines may be created from several threads.
+    class PipelineCache {
+
+    public:
+        PipelineCache() = default;
+        ~PipelineCache();
+
+        // Loads `file_path` if it was written by the same driver and device.
+        // Nothing is read nor written if the path is empty.
+        void init(
+            const PhysDevice& phys_dev,
+            VkDevice logi_dev,
+            const std::filesystem::path& file_path
+        );
+        // Saves before destroying
+        void destroy(VkDevice logi_dev);
+
+        // Writes the cache to the file if it grew since the last save
+        void save(VkDevice logi_dev);
+
+        VkPipelineCache get() const { return handle_; }
+
+    private:
+        std::filesystem::path file_path_;
+        VkPipelineCache handle_ = VK_NULL_HANDLE;
+        size_t saved_size_ = 0;
+    };
+
+}  // namespace mirinae
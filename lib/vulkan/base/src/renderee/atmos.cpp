@@ -223,21 +223,53 @@ namespace mirinae {
 }  // namespace mirinae
 
 
-// TaskAtmosEpic
+// TaskAtmosEpicUnits
 namespace mirinae {
 
-    void TaskAtmosEpic::init(
-        uint32_t max_flight_count,
-        entt::registry& reg,
-        RpCtxtBase& rp_ctxt,
-        VulkanDevice& device
+    void TaskAtmosEpicUnits::init(
+        uint32_t max_flight_count, entt::registry& reg, VulkanDevice& device
     ) {
         reg_ = &reg;
-        rp_ctxt_ = &rp_ctxt;
         device_ = &device;
         max_flight_count_ = max_flight_count;
     }
 
+    void TaskAtmosEpicUnits::prepare() {
+        this->set_size(reg_->view<cpnt::AtmosphereEpic>().size());
+    }
+
+    void TaskAtmosEpicUnits::ExecuteRange(
+        enki::TaskSetPartition range, uint32_t tid
+    ) {
+        namespace cpnt = mirinae::cpnt;
+
+        auto& reg = *reg_;
+        auto view = reg.view<cpnt::AtmosphereEpic>();
+        auto begin = view.begin() + range.start;
+        auto end = view.begin() + range.end;
+
+        for (auto it = begin; it != end; ++it) {
+            auto& atmos = reg.get<cpnt::AtmosphereEpic>(*it);
+            if (atmos.ren_unit<RenUnitAtmosEpic>())
+                continue;
+
+            atmos.ren_unit_ = std::make_shared<RenUnitAtmosEpic>(
+                max_flight_count_, *device_
+            );
+        }
+    }
+
+}  // namespace mirinae
+
+
+// TaskAtmosEpic
+namespace mirinae {
+
+    void TaskAtmosEpic::init(const entt::registry& reg, RpCtxtBase& rp_ctxt) {
+        reg_ = &reg;
+        rp_ctxt_ = &rp_ctxt;
+    }
+
     void TaskAtmosEpic::prepare() {
         this->set_size(reg_->view<cpnt::AtmosphereEpic>().size());
     }
@@ -253,18 +285,15 @@ namespace mirinae {
         auto end = view.begin() + range.end;
 
         for (auto it = begin; it != end; ++it) {
-            const auto e = *it;
-            auto& atmos = reg.get<cpnt::AtmosphereEpic>(e);
-            const auto atmos_params = convert_atmos_params(atmos.params_);
-
-            auto ren_unit = atmos.ren_unit<RenUnitAtmosEpic>();
-            if (!ren_unit) {
-                atmos.ren_unit_ = std::make_unique<RenUnitAtmosEpic>(
-                    max_flight_count_, *device_
-                );
-                ren_unit = atmos.ren_unit<RenUnitAtmosEpic>();
-            }
+            auto& atmos = reg.get<cpnt::AtmosphereEpic>(*it);
+            // The component is const, the unit it shares is not
+            auto ren_unit = dynamic_cast<RenUnitAtmosEpic*>(
+                atmos.ren_unit_.get()
+            );
+            if (!ren_unit)
+                continue;
 
+            const auto atmos_params = convert_atmos_params(atmos.params_);
             ren_unit->update_ubuf(
                 rp_ctxt_->f_index_, &atmos_params, sizeof(atmos_params)
             );
@@ -1,7 +1,10 @@
 #include "mirinae/vulkan/base/renderee/ren_actor_skinned.hpp"
 
+#include <algorithm>
+
 #include "mirinae/lightweight/include_spdlog.hpp"
 #include "mirinae/vulkan/base/render/mem_cinfo.hpp"
+#include "mirinae/vulkan/base/render/ubuf_ring.hpp"
 
 
 namespace {
@@ -22,9 +25,10 @@ namespace mirinae {
     class CLS::FrameData {
 
     public:
-        Buffer ubuf_static_;  // U_GbufActor
         Buffer joint_palette_;
         VkDescriptorSet descset_static_;
+        uint32_t ubuf_offset_ = 0;  // U_GbufActor in the uniform ring
+        uint64_t palette_revision_ = 0;
     };
 
 
@@ -66,22 +70,16 @@ namespace mirinae {
         auto& desclayout_anim = desclayouts.get("skin_anim:main");
 
         desc_pool_.init(
-            max_flight_count + (runit_count * max_flight_count),
-            desclayout_static.size_info() + desclayout_anim.size_info(),
+            std::max<uint32_t>(runit_count * max_flight_count, 1),
+            desclayout_anim.size_info(),
             device_.logi_device()
         );
-        auto descsets_static = desc_pool_.alloc(
-            max_flight_count, desclayout_static.layout(), device_.logi_device()
-        );
         auto descsets_anim = desc_pool_.alloc(
             runit_count * max_flight_count,
             desclayout_anim.layout(),
             device_.logi_device()
         );
 
-        BufferCreateInfo ubuf_static_cinfo;
-        ubuf_static_cinfo.preset_ubuf(sizeof(U_GbufActor));
-
         BufferCreateInfo sbuf_joints_cinfo;
         sbuf_joints_cinfo.set_usage(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
             .add_alloc_flag_host_access_seq_write();
@@ -94,17 +92,16 @@ namespace mirinae {
 
         for (uint32_t i = 0; i < max_flight_count; ++i) {
             auto& fd = frame_data_.emplace_back();
-            fd.ubuf_static_.init(ubuf_static_cinfo, device_.mem_alloc());
 
             sbuf_joints_cinfo.set_size(joint_count * sizeof(glm::mat4));
             fd.joint_palette_.init(sbuf_joints_cinfo, device_.mem_alloc());
+            fd.joint_palette_.map();
 
-            fd.descset_static_ = descsets_static.back();
-            descsets_static.pop_back();
-            MIRINAE_ASSERT(VK_NULL_HANDLE != fd.descset_static_);
-
-            dw.add_buf_info(fd.ubuf_static_)
-                .add_buf_write(fd.descset_static_, 0);
+            fd.descset_static_ = device_.ubuf_ring().descset(
+                FrameIndex{ static_cast<int>(i) },
+                desclayout_static,
+                sizeof(U_GbufActor)
+            );
         }
 
         for (auto& src_unit : runit_info) {
@@ -149,8 +146,9 @@ namespace mirinae {
     void CLS::update_ubuf(
         const FrameIndex f_index, const U_GbufActor& static_data
     ) {
-        auto& fd = frame_data_.at(f_index.get());
-        fd.ubuf_static_.set_data(&static_data, sizeof(U_GbufActor));
+        auto& ring = device_.ubuf_ring();
+        if (const auto offset = ring.write(f_index, static_data))
+            frame_data_.at(f_index.get()).ubuf_offset_ = *offset;
     }
 
     void CLS::update_joint_palette(
@@ -162,12 +160,33 @@ namespace mirinae {
         fd.joint_palette_.set_data(
             joint_palette, joint_count * sizeof(glm::mat4)
         );
+        fd.palette_revision_ = 0;
+    }
+
+    void CLS::update_joint_palette(
+        const FrameIndex f_index,
+        const glm::mat4* const joint_palette,
+        const size_t joint_count,
+        const uint64_t revision
+    ) {
+        auto& fd = frame_data_.at(f_index.get());
+        if (0 != revision && fd.palette_revision_ == revision)
+            return;
+
+        fd.joint_palette_.set_data(
+            joint_palette, joint_count * sizeof(glm::mat4)
+        );
+        fd.palette_revision_ = revision;
     }
 
     VkDescriptorSet CLS::get_descset(FrameIndex f_index) const {
         return frame_data_.at(f_index.get()).descset_static_;
     }
 
+    uint32_t CLS::ubuf_offset(FrameIndex f_index) const {
+        return frame_data_.at(f_index.get()).ubuf_offset_;
+    }
+
     const CLS::IRenUnit& CLS::get_runit(size_t unit_idx) const {
         return runits_.at(unit_idx);
     }
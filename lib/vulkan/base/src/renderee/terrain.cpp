@@ -1,5 +1,6 @@
 #include "mirinae/vulkan/base/renderee/terrain.hpp"
 
+#include <entt/entity/registry.hpp>
 #include <sung/basic/mesh_builder.hpp>
 
 #include "mirinae/lightweight/include_spdlog.hpp"
@@ -206,3 +207,44 @@ namespace mirinae {
     }
 
 }  // namespace mirinae
+
+
+// TaskTerrainUnits
+namespace mirinae {
+
+    void TaskTerrainUnits::init(
+        entt::registry& reg,
+        ITextureManager& tex,
+        DesclayoutManager& desclayouts,
+        VulkanDevice& device
+    ) {
+        reg_ = &reg;
+        tex_ = &tex;
+        desclayouts_ = &desclayouts;
+        device_ = &device;
+    }
+
+    void TaskTerrainUnits::prepare() {
+        this->set_size(reg_->view<cpnt::Terrain>().size());
+    }
+
+    void TaskTerrainUnits::ExecuteRange(
+        enki::TaskSetPartition range, uint32_t tid
+    ) {
+        auto view = reg_->view<cpnt::Terrain>();
+        auto it = view.begin() + range.start;
+        auto end = view.begin() + range.end;
+
+        for (; it != end; ++it) {
+            auto& terr = reg_->get<cpnt::Terrain>(*it);
+            if (terr.ren_unit<RenUnitTerrain>())
+                continue;
+
+            std::lock_guard<std::mutex> lock(tex_mut_);
+            terr.ren_unit_ = std::make_shared<RenUnitTerrain>(
+                terr, *tex_, *desclayouts_, *device_
+            );
+        }
+    }
+
+}  // namespace mirinae
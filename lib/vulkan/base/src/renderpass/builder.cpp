@@ -168,7 +168,10 @@ namespace mirinae {
     CLS& CLS::add(
         const dal::path& spv_path, const VkShaderStageFlagBits stage
     ) {
-        modules_.push_back(this->load_spv(spv_path, device_));
+        {
+            RpCreateLock::Unlocked unlocked;
+            modules_.push_back(this->load_spv(spv_path, device_));
+        }
         this->add_stage(stage, modules_.back());
 
         mirinae::DebugAnnoName{}
@@ -696,9 +699,15 @@ namespace mirinae {
         cinfo.basePipelineIndex = -1;
 
 
+        RpCreateLock::Unlocked unlocked;
         VkPipeline out = VK_NULL_HANDLE;
         const auto res = vkCreateGraphicsPipelines(
-            device_.logi_device(), VK_NULL_HANDLE, 1, &cinfo, nullptr, &out
+            device_.logi_device(),
+            device_.pipeline_cache(),
+            1,
+            &cinfo,
+            nullptr,
+            &out
         );
         if (VK_SUCCESS != res) {
             MIRINAE_ABORT("failed to create graphics pipeline.");
@@ -800,9 +809,15 @@ namespace mirinae {
         cinfo.layout = pipeline_layout;
         cinfo.stage = *shader_builder.data();
 
+        RpCreateLock::Unlocked unlocked;
         VkPipeline pipeline = VK_NULL_HANDLE;
         const auto res = vkCreateComputePipelines(
-            device.logi_device(), VK_NULL_HANDLE, 1, &cinfo, nullptr, &pipeline
+            device.logi_device(),
+            device.pipeline_cache(),
+            1,
+            &cinfo,
+            nullptr,
+            &pipeline
         );
         MIRINAE_ASSERT(res == VK_SUCCESS);
 
@@ -810,3 +825,45 @@ namespace mirinae {
     }
 
 }  // namespace mirinae
+
+
+// RpCreateLock
+namespace mirinae {
+
+    namespace {
+
+        thread_local RpCreateLock* g_rp_create_lock = nullptr;
+
+    }
+
+
+    RpCreateLock::RpCreateLock(std::mutex& mut) : prev_(g_rp_create_lock) {
+        for (auto it = prev_; it; it = it->prev_) {
+            if (it->lock_.owns_lock() && it->lock_.mutex() == &mut) {
+                g_rp_create_lock = this;
+                return;
+            }
+        }
+
+        lock_ = std::unique_lock<std::mutex>(mut);
+        g_rp_create_lock = this;
+    }
+
+    RpCreateLock::~RpCreateLock() { g_rp_create_lock = prev_; }
+
+    RpCreateLock::Unlocked::Unlocked() {
+        for (auto it = g_rp_create_lock; it; it = it->prev_) {
+            if (it->lock_.owns_lock()) {
+                owner_ = it;
+                owner_->lock_.unlock();
+                return;
+            }
+        }
+    }
+
+    RpCreateLock::Unlocked::~Unlocked() {
+        if (owner_)
+            owner_->lock_.lock();
+    }
+
+}  // namespace mirinae
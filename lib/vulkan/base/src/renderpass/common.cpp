@@ -6,6 +6,7 @@
 #include "mirinae/lightweight/task.hpp"
 #include "mirinae/vulkan/base/render/mem_cinfo.hpp"
 #include "mirinae/vulkan/base/render/vkdebug.hpp"
+#include "mirinae/vulkan/base/renderpass/builder.hpp"
 
 
 // RenderPass
@@ -60,9 +61,10 @@ namespace mirinae {
     bool RpPipeline::create(
         const VkComputePipelineCreateInfo& cinfo, VulkanDevice& device
     ) {
+        RpCreateLock::Unlocked unlocked;
         return vkCreateComputePipelines(
                    device.logi_device(),
-                   VK_NULL_HANDLE,
+                   device.pipeline_cache(),
                    1,
                    &cinfo,
                    nullptr,
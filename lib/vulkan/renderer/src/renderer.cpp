@@ -18,6 +18,9 @@
 #include "mirinae/vulkan/base/render/draw_set.hpp"
 #include "mirinae/vulkan/base/render/render_graph.hpp"
 #include "mirinae/vulkan/base/render/renderpass.hpp"
+#include "mirinae/vulkan/base/render/geometry.hpp"
+#include "mirinae/vulkan/base/render/ubuf_ring.hpp"
+#include "mirinae/vulkan/base/render/upload.hpp"
 #include "mirinae/vulkan/base/render/vkcheck.hpp"
 #include "mirinae/vulkan/base/renderee/atmos.hpp"
 #include "mirinae/vulkan/base/renderpass/builder.hpp"
@@ -371,6 +374,7 @@ namespace {
             framesync_.init(device_.logi_device());
 
             rp_res_.shadow_maps_ = mirinae::create_shadow_maps_bundle(device_);
+            rp_res_.draw_sets_.attach(cosmos_->reg());
             model_man_ = mirinae::create_model_mgr(
                 task_sche, rp_res_.tex_man_, rp_res_.desclays_, device_
             );
@@ -454,8 +458,7 @@ namespace {
                 );
                 rp_states_imgui_.init(swapchain_);
 
-                for (auto func : mirinae::get_rp_factories())
-                    render_passes_.push_back(func(cbundle));
+                render_passes_ = mirinae::create_render_passes(cbundle);
             }
 
             cmd_pool_.init(
@@ -497,6 +500,8 @@ namespace {
                 rp_res_.envmaps_->record_gpu_init(cmdbuf);
                 cmd_pool_.end_single_time(cmdbuf, device_);
             }
+
+            device_.save_pipeline_cache();
         }
 
         ~RendererVulkan() {
@@ -504,6 +509,9 @@ namespace {
 
             ImGui_ImplVulkan_Shutdown();
 
+            rp_res_.draw_sets_.detach();
+            rp_res_.ren_states_.clear();
+
             auto& reg = cosmos_->reg();
             for (auto e : reg.view<mirinae::cpnt::MdlActorStatic>()) {
                 auto& mactor = reg.get<mirinae::cpnt::MdlActorStatic>(e);
@@ -539,25 +547,18 @@ namespace {
         }
 
         void register_tasks(mirinae::TaskGraph& tasks) override {
+            tasks.push_back(
+                mirinae::create_render_sync_stage(
+                    *cosmos_, *model_man_, rp_res_, swapchain_, device_
+                )
+            );
             tasks.push_back(
                 mirinae::create_render_stage(
                     cmdbufs_,
-                    *cosmos_,
                     flag_ship_,
                     framesync_,
-                    *model_man_,
                     ren_ctxt,
                     rp_res_,
-                    [this]() {
-                        if (this->resize_swapchain()) {
-                            overlay_man_.on_fbuf_resize(
-                                fbuf_width_, fbuf_height_
-                            );
-                            return true;
-                        } else {
-                            return false;
-                        }
-                    },
                     render_passes_,
                     swapchain_,
                     device_
@@ -566,12 +567,33 @@ namespace {
         }
 
         void do_frame() override {
+            // Nothing renders at the sync point, so the swapchain's
+            // relatives may be recreated
+            if (flag_ship_.need_resize()) {
+                if (this->resize_swapchain()) {
+                    overlay_man_.on_fbuf_resize(fbuf_width_, fbuf_height_);
+                    flag_ship_.set_need_resize(false);
+                }
+            }
+
+            this->finish_frame();
+
+            // Shapes drawn by this frame's simulation show with its state
+            std::swap(ren_ctxt.debug_ren_, debug_ren_sim_);
+            debug_ren_sim_.clear();
+
+            rp_res_.ren_states_.flip();
+        }
+
+        // Submits and presents what the render stage recorded
+        void finish_frame() {
             if (flag_ship_.dont_render())
                 return;
 
             const auto f_idx = ren_ctxt.f_index_;
-            auto& cam = cosmos_->reg().get<mirinae::cpnt::StandardCamera>(
-                cosmos_->scene().main_camera_
+            const auto& ren_state = rp_res_.ren_states_.front();
+            auto& cam = ren_state.reg().get<mirinae::cpnt::StandardCamera>(
+                ren_state.main_camera_
             );
 
             // Update widgets
@@ -631,6 +653,8 @@ namespace {
 
                 widget_ren_data.cmd_buf_ = ren_ctxt.cmdbuf_;
                 widget_ren_data.pipe_layout_ = rp.pipeline_layout();
+                widget_ren_data.pipeline_ = rp.pipeline();
+                widget_ren_data.text_pipeline_ = rp.sub_pipeline(0);
                 overlay_man_.record_render(widget_ren_data);
 
                 vkCmdEndRenderPass(ren_ctxt.cmdbuf_);
@@ -659,10 +683,16 @@ namespace {
             }
 
             mirinae::end_cmdbuf(ren_ctxt.cmdbuf_);
-            ren_ctxt.debug_ren_.clear();
+
+            // Uploads recorded while preparing this frame
+            device_.uploader().tick();
+            device_.geometry().tick();
+            device_.ubuf_ring().end_frame(f_idx);
 
             // Submit and present
             {
+                // Workers may still be uploading for the next frame
+                const auto lock = device_.uploader().lock_queues();
                 const VkSemaphore signal_semaph =
                     framesync_.get_cur_render_fin_semaph().get();
 
@@ -685,6 +715,10 @@ namespace {
             }
 
             framesync_.increase_frame_index();
+
+            // Catches pipelines created after startup, e.g. on resize
+            if (pipeline_cache_timer_.check_if_elapsed(30))
+                device_.save_pipeline_cache();
         }
 
         void notify_window_resize(uint32_t width, uint32_t height) override {
@@ -714,7 +748,7 @@ namespace {
             return false;
         }
 
-        mirinae::IDebugRen& debug_ren() override { return ren_ctxt.debug_ren_; }
+        mirinae::IDebugRen& debug_ren() override { return debug_ren_sim_; }
 
     private:
         bool resize_swapchain() {
@@ -790,6 +824,8 @@ namespace {
         mirinae::RenderPassPackage rp_;
         mirinae::Swapchain swapchain_;
         mirinae::RpContext ren_ctxt;
+        // Filled by the simulation while `ren_ctxt` holds the last frame's
+        mirinae::DebugRender debug_ren_sim_;
         mirinae::InputProcesserMgr input_mgrs_;
 
         // Command buffers
@@ -802,6 +838,8 @@ namespace {
         ::RpStatesImgui rp_states_imgui_;
         std::vector<std::unique_ptr<mirinae::IRpBase>> render_passes_;
 
+        sung::MonotonicRealtimeTimer pipeline_cache_timer_;
+
         // PODs
         uint32_t fbuf_width_ = 0;
         uint32_t fbuf_height_ = 0;
@@ -1,5 +1,11 @@
 #include "renderpasses.hpp"
 
+#include <algorithm>
+#include <mutex>
+
+#include <dal/common/task_sys.hpp>
+
+#include "mirinae/vulkan/base/renderpass/builder.hpp"
 #include "mirinae/vulkan/renpass/atmos/sky.hpp"
 #include "mirinae/vulkan/renpass/bloom/bloom.hpp"
 #include "mirinae/vulkan/renpass/compo/compo.hpp"
@@ -12,6 +18,43 @@
 #include "mirinae/vulkan/renpass/transp/transp.hpp"
 
 
+namespace {
+
+    class RpCreateTask : public enki::ITaskSet {
+
+    public:
+        RpCreateTask(
+            const std::vector<mirinae::RpFactory>& factories,
+            const std::vector<size_t>& indices,
+            mirinae::RpCreateBundle& bundle,
+            std::mutex& mut,
+            std::vector<std::unique_ptr<mirinae::IRpBase>>& out
+        )
+            : factories_(factories)
+            , indices_(indices)
+            , bundle_(bundle)
+            , mut_(mut)
+            , out_(out) {}
+
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t) override {
+            for (auto i = range.start; i < range.end; ++i) {
+                const auto index = indices_[i];
+                mirinae::RpCreateLock lock(mut_);
+                out_[index] = factories_[index].func_(bundle_);
+            }
+        }
+
+    private:
+        const std::vector<mirinae::RpFactory>& factories_;
+        const std::vector<size_t>& indices_;
+        mirinae::RpCreateBundle& bundle_;
+        std::mutex& mut_;
+        std::vector<std::unique_ptr<mirinae::IRpBase>>& out_;
+    };
+
+}  // namespace
+
+
 namespace mirinae {
 
     HShadowMaps create_shadow_maps_bundle(VulkanDevice& device) {
@@ -24,40 +67,72 @@ namespace mirinae {
         mirinae::rp::gbuf::create_desc_layouts(desclayouts, device);
     }
 
-    std::vector<RpFactoryFunc> get_rp_factories() {
-        return std::vector<RpFactoryFunc>{
-            mirinae::rp::create_rp_skin_anim,
-            mirinae::rp::create_rp_atmos_trans_lut,
-            mirinae::rp::create_rp_atmos_multi_scat,
-            mirinae::rp::create_rp_sky_view_lut,
-            mirinae::rp::create_rp_atmos_cam_vol,
-            mirinae::rp::create_rp_ocean_h0,
-            mirinae::rp::create_rp_ocean_hkt,
-            mirinae::rp::create_rp_ocean_butterfly,
-            mirinae::rp::create_rp_ocean_post_ift,
-            mirinae::rp::create_rp_envmap,
-            mirinae::rp::create_rp_env_sky_atmos,
-            mirinae::rp::create_rp_env_mip_chain,
-            mirinae::rp::create_rp_env_diffuse,
-            mirinae::rp::create_rp_env_specular,
-            mirinae::rp::create_rp_shadow_static,
-            mirinae::rp::create_rp_shadow_static_trs,
-            mirinae::rp::create_rp_shadow_terrain,
-            mirinae::rp::gbuf::create_rp_gbuf_static,
-            mirinae::rp::gbuf::create_rp_gbuf_terrain,
-            // mirinae::rp::compo::create_rps_dlight,
-            mirinae::rp::compo::create_rps_atmos_surface,
-            mirinae::rp::compo::create_rps_slight,
-            mirinae::rp::compo::create_rps_envmap,
-            mirinae::rp::compo::create_rps_sky_atmos,
-            mirinae::rp::create_rp_ocean_tess,
-            mirinae::rp::compo::create_rps_vplight,
-            mirinae::rp::create_rp_states_transp_static,
-            mirinae::rp::create_bloom_downsample,
-            mirinae::rp::create_bloom_upsample,
-            mirinae::rp::create_bloom_blend,
-            mirinae::rp::create_rp_debug,
+    std::vector<RpFactory> get_rp_factories() {
+        namespace rp = mirinae::rp;
+
+        return std::vector<RpFactory>{
+            { rp::create_rp_skin_anim, 0 },
+            { rp::create_rp_atmos_trans_lut, 0 },
+            { rp::create_rp_atmos_multi_scat, 1 },
+            { rp::create_rp_sky_view_lut, 2 },
+            { rp::create_rp_atmos_cam_vol, 2 },
+            { rp::create_rp_ocean_h0, 0 },
+            { rp::create_rp_ocean_hkt, 1 },
+            { rp::create_rp_ocean_butterfly, 2 },
+            { rp::create_rp_ocean_post_ift, 3 },
+            { rp::create_rp_envmap, 0 },
+            { rp::create_rp_env_sky_atmos, 3 },
+            { rp::create_rp_env_mip_chain, 1 },
+            { rp::create_rp_env_diffuse, 1 },
+            { rp::create_rp_env_specular, 2 },
+            { rp::create_rp_shadow_static, 0 },
+            { rp::create_rp_shadow_static_trs, 0 },
+            { rp::create_rp_shadow_terrain, 0 },
+            { rp::gbuf::create_rp_gbuf_static, 0 },
+            { rp::gbuf::create_rp_gbuf_terrain, 0 },
+            // { rp::compo::create_rps_dlight, 3 },
+            { rp::compo::create_rps_atmos_surface, 3 },
+            { rp::compo::create_rps_slight, 3 },
+            { rp::compo::create_rps_envmap, 3 },
+            { rp::compo::create_rps_sky_atmos, 3 },
+            { rp::create_rp_ocean_tess, 4 },
+            { rp::compo::create_rps_vplight, 3 },
+            { rp::create_rp_states_transp_static, 3 },
+            { rp::create_bloom_downsample, 3 },
+            { rp::create_bloom_upsample, 4 },
+            { rp::create_bloom_blend, 5 },
+            { rp::create_rp_debug, 3 },
         };
     }
 
+    std::vector<std::unique_ptr<IRpBase>> create_render_passes(
+        RpCreateBundle& bundle
+    ) {
+        const auto factories = get_rp_factories();
+        std::vector<std::unique_ptr<IRpBase>> out(factories.size());
+
+        uint32_t last_stage = 0;
+        for (auto& f : factories) last_stage = std::max(last_stage, f.stage_);
+
+        std::mutex mut;
+        std::vector<size_t> indices;
+        for (uint32_t stage = 0; stage <= last_stage; ++stage) {
+            indices.clear();
+            for (size_t i = 0; i < factories.size(); ++i) {
+                if (factories[i].stage_ == stage)
+                    indices.push_back(i);
+            }
+            if (indices.empty())
+                continue;
+
+            ::RpCreateTask task(factories, indices, bundle, mut, out);
+            task.m_SetSize = static_cast<uint32_t>(indices.size());
+            task.m_MinRange = 1;
+            dal::tasker().AddTaskSetToPipe(&task);
+            dal::tasker().WaitforTask(&task);
+        }
+
+        return out;
+    }
+
 }  // namespace mirinae
@@ -16,6 +16,18 @@ namespace mirinae {
     using RpFactoryFunc =
         std::function<std::unique_ptr<IRpBase>(RpCreateBundle&)>;
 
-    std::vector<RpFactoryFunc> get_rp_factories();
+    struct RpFactory {
+        RpFactoryFunc func_;
+        // Passes may only use images and layouts made in earlier stages
+        uint32_t stage_;
+    };
+
+    // In render order
+    std::vector<RpFactory> get_rp_factories();
+
+    // Runs the factories of each stage concurrently, in render order
+    std::vector<std::unique_ptr<IRpBase>> create_render_passes(
+        RpCreateBundle& bundle
+    );
 
 }  // namespace mirinae
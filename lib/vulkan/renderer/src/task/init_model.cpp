@@ -4,6 +4,7 @@
 
 #include <entt/entity/registry.hpp>
 
+#include "mirinae/cpnt/camera.hpp"
 #include "mirinae/cpnt/transform.hpp"
 #include "mirinae/lightweight/include_spdlog.hpp"
 #include "mirinae/vulkan/base/renderee/ren_actor_skinned.hpp"
@@ -14,6 +15,25 @@ namespace {
     std::mutex g_model_mtx;
     std::mutex g_actor_mtx;
 
+
+    glm::dmat4 make_model_mat(entt::entity e, const entt::registry& reg) {
+        if (auto tform = reg.try_get<mirinae::cpnt::Transform>(e))
+            return tform->make_model_mat();
+        return glm::dmat4(1);
+    }
+
+    mirinae::U_GbufActor make_actor_udata(
+        const glm::dmat4& model_mat, const mirinae::CamGeometry& cam
+    ) {
+        const auto vm = cam.view() * model_mat;
+
+        mirinae::U_GbufActor udata;
+        udata.model = model_mat;
+        udata.view_model = vm;
+        udata.pvm = cam.proj() * vm;
+        return udata;
+    }
+
 }  // namespace
 
 
@@ -26,18 +46,19 @@ namespace {
             mirinae::Scene& scene,
             mirinae::VulkanDevice& device,
             mirinae::IModelManager& model_mgr,
-            mirinae::RpCtxt& rp_ctxt,
             mirinae::RpResources& rp_res
         ) override {
             reg_ = scene.reg_.get();
             device_ = &device;
             model_mgr_ = &model_mgr;
-            rp_ctxt_ = &rp_ctxt;
             rp_res_ = &rp_res;
         }
 
         void prepare() override {
-            this->set_size(reg_->view<mirinae::cpnt::MdlActorStatic>().size());
+            const auto size =
+                reg_->view<mirinae::cpnt::MdlActorStatic>().size();
+            rp_res_->ren_states_.back().statics_.resize(size);
+            this->set_size(size);
         }
 
     private:
@@ -45,13 +66,18 @@ namespace {
             namespace cpnt = mirinae::cpnt;
 
             auto& reg = *reg_;
+            auto& slots = rp_res_->ren_states_.back().statics_;
             auto view = reg.view<cpnt::MdlActorStatic>();
             auto begin = view.begin() + range.start;
             auto end = view.begin() + range.end;
 
-            for (auto it = begin; it != end; ++it) {
+            auto i = range.start;
+            for (auto it = begin; it != end; ++it, ++i) {
                 const auto e = *it;
                 auto& mactor = reg.get<cpnt::MdlActorStatic>(e);
+                const auto was_ready = mactor.model_ && mactor.actor_;
+                auto& slot = slots[i];
+                slot.actor_.reset();
 
                 if (!this->load_model(mactor, *model_mgr_))
                     continue;
@@ -59,7 +85,12 @@ namespace {
                 if (!this->create_actor(mactor, rp_res_->desclays_, *device_))
                     continue;
 
-                this->update_ubuf(e, mactor, reg, *rp_ctxt_, *device_);
+                // For the draw set cache
+                if (!was_ready)
+                    reg.patch<cpnt::MdlActorStatic>(e);
+
+                slot.actor_ = mactor.actor_;
+                slot.model_mat_ = ::make_model_mat(e, reg);
             }
 
             return;
@@ -112,35 +143,9 @@ namespace {
             return true;
         }
 
-        static bool update_ubuf(
-            const entt::entity e,
-            mirinae::cpnt::MdlActorStatic& mactor,
-            const entt::registry& reg,
-            const mirinae::RpCtxt& rp_ctxt,
-            mirinae::VulkanDevice& device
-        ) {
-            auto actor = mactor.get_actor<mirinae::RenderActor>();
-
-            glm::dmat4 model_mat(1);
-            if (auto tform = reg.try_get<mirinae::cpnt::Transform>(e))
-                model_mat = tform->make_model_mat();
-            const auto vm = rp_ctxt.main_cam_.view() * model_mat;
-            const auto pvm = rp_ctxt.main_cam_.proj() * vm;
-
-            mirinae::U_GbufActor udata;
-            udata.model = model_mat;
-            udata.view_model = vm;
-            udata.pvm = pvm;
-
-            actor->udpate_ubuf(rp_ctxt.f_index_.get(), udata);
-
-            return true;
-        }
-
         entt::registry* reg_ = nullptr;
         mirinae::VulkanDevice* device_ = nullptr;
         mirinae::IModelManager* model_mgr_ = nullptr;
-        mirinae::RpCtxt* rp_ctxt_ = nullptr;
         mirinae::RpResources* rp_res_ = nullptr;
     };
 
@@ -152,20 +157,28 @@ namespace {
             mirinae::Scene& scene,
             mirinae::VulkanDevice& device,
             mirinae::IModelManager& model_mgr,
-            mirinae::RpCtxt& rp_ctxt,
             mirinae::RpResources& rp_res
         ) override {
             scene_ = &scene;
             device_ = &device;
             model_mgr_ = &model_mgr;
-            rp_ctxt_ = &rp_ctxt;
             rp_res_ = &rp_res;
         }
 
         void prepare() override {
-            this->set_size(
-                scene_->reg_->view<mirinae::cpnt::MdlActorSkinned>().size()
-            );
+            namespace cpnt = mirinae::cpnt;
+
+            auto& reg = *scene_->reg_;
+            const auto e_cam = scene_->main_camera_;
+            cam_pos_ = glm::dvec3(0);
+            if (auto tform = reg.try_get<cpnt::Transform>(e_cam))
+                cam_pos_ = tform->pos_;
+            if (auto cam = reg.try_get<cpnt::StandardCamera>(e_cam))
+                cam_fov_ = cam->proj_.fov_;
+
+            const auto size = reg.view<cpnt::MdlActorSkinned>().size();
+            rp_res_->ren_states_.back().skinneds_.resize(size);
+            this->set_size(size);
         }
 
     private:
@@ -174,13 +187,18 @@ namespace {
 
             auto& reg = *scene_->reg_;
             auto& desclay = rp_res_->desclays_;
+            auto& slots = rp_res_->ren_states_.back().skinneds_;
             auto view = reg.view<cpnt::MdlActorSkinned>();
             auto begin = view.begin() + range.start;
             auto end = view.begin() + range.end;
 
-            for (auto it = begin; it != end; ++it) {
+            auto i = range.start;
+            for (auto it = begin; it != end; ++it, ++i) {
                 const auto e = *it;
                 auto& mactor = reg.get<cpnt::MdlActorSkinned>(e);
+                const auto was_ready = mactor.model_ && mactor.actor_;
+                auto& slot = slots[i];
+                const auto last_actor = std::move(slot.actor_);
 
                 auto ren_model = this->prep_model(mactor, *model_mgr_);
                 if (!ren_model)
@@ -192,9 +210,14 @@ namespace {
                 if (!ren_actor)
                     continue;
 
-                this->update_ubuf(
-                    e, *rp_ctxt_, *scene_, mactor.anim_state_, *ren_actor
+                if (!was_ready)
+                    reg.patch<cpnt::MdlActorSkinned>(e);
+
+                slot.model_mat_ = ::make_model_mat(e, reg);
+                this->sample_palette(
+                    e, last_actor, mactor, slot, cam_pos_, cam_fov_, *scene_
                 );
+                slot.actor_ = mactor.actor_;
             }
         }
 
@@ -269,43 +292,171 @@ namespace {
             return a.get();
         }
 
-        static bool update_ubuf(
+        static void sample_palette(
             const entt::entity e,
-            const mirinae::RpCtxt& rp_ctxt,
-            const mirinae::Scene& scene,
-            const mirinae::SkinAnimState& anim_state,
-            mirinae::RenderActorSkinned& ren_actor
+            const std::shared_ptr<mirinae::IRenActor>& last_actor,
+            mirinae::cpnt::MdlActorSkinned& mactor,
+            mirinae::RenderState::SkinnedActor& slot,
+            const glm::dvec3& cam_pos,
+            const sung::TAngle<double>& cam_fov,
+            const mirinae::Scene& scene
         ) {
-            auto& reg = *scene.reg_;
-
-            glm::dmat4 model_mat(1);
-            if (auto tform = reg.try_get<mirinae::cpnt::Transform>(e))
-                model_mat = tform->make_model_mat();
-            const auto vm = rp_ctxt.main_cam_.view() * model_mat;
-            const auto pvm = rp_ctxt.main_cam_.proj() * vm;
-
-            mirinae::U_GbufActor udata_static;
-            udata_static.model = model_mat;
-            udata_static.view_model = vm;
-            udata_static.pvm = pvm;
-
-            std::array<glm::mat4, 256> joint_palette;
-            anim_state.sample_anim(
-                joint_palette.data(), joint_palette.size(), scene.clock()
+            auto& anim_state = mactor.anim_state_;
+            const auto screen_ratio = calc_screen_ratio(
+                slot.model_mat_, cam_pos, cam_fov, anim_state.lod_
             );
-
-            ren_actor.update_ubuf(rp_ctxt.f_index_, udata_static);
-            ren_actor.update_joint_palette(
-                rp_ctxt.f_index_, joint_palette.data(), joint_palette.size()
+            const auto palette = anim_state.sample_anim_lod(
+                screen_ratio,
+                static_cast<uint32_t>(entt::to_integral(e)),
+                scene.clock()
             );
-            return true;
+
+            if (!palette.data_) {
+                slot.palette_.clear();
+                slot.palette_rev_ = 0;
+                return;
+            }
+
+            // The slot may still hold this palette from two frames ago
+            const auto same = last_actor == mactor.actor_ &&
+                              slot.palette_rev_ == palette.revision_ &&
+                              slot.palette_.size() == palette.size_;
+            if (!same) {
+                slot.palette_.assign(
+                    palette.data_, palette.data_ + palette.size_
+                );
+                slot.palette_rev_ = palette.revision_;
+            }
+        }
+
+        static float calc_screen_ratio(
+            const glm::dmat4& model_mat,
+            const glm::dvec3& cam_pos,
+            const sung::TAngle<double>& cam_fov,
+            const mirinae::AnimLodConfig& lod
+        ) {
+            const glm::dvec3 pos{ model_mat[3] };
+            const auto scale = glm::length(glm::dvec3{ model_mat[0] });
+            const auto radius = lod.bounding_radius_ * scale;
+            const auto dist = glm::distance(pos, cam_pos);
+            const auto half_fov = cam_fov.rad() * 0.5;
+            const auto denom = dist * std::tan(half_fov);
+            if (denom <= radius)
+                return 1;
+
+            return static_cast<float>(radius / denom);
         }
 
         mirinae::Scene* scene_ = nullptr;
         mirinae::VulkanDevice* device_ = nullptr;
         mirinae::IModelManager* model_mgr_ = nullptr;
-        mirinae::RpCtxt* rp_ctxt_ = nullptr;
         mirinae::RpResources* rp_res_ = nullptr;
+        glm::dvec3 cam_pos_{ 0 };
+        sung::TAngle<double> cam_fov_;
+    };
+
+}  // namespace
+
+
+namespace {
+
+    class UpdateStaticActor : public mirinae::IUpdateActorTask {
+
+    public:
+        void init(
+            const mirinae::FlagShip& flag_ship,
+            const mirinae::RpCtxt& rp_ctxt,
+            const mirinae::RpResources& rp_res
+        ) override {
+            flag_ship_ = &flag_ship;
+            rp_ctxt_ = &rp_ctxt;
+            rp_res_ = &rp_res;
+        }
+
+        void prepare() override {
+            this->set_size(rp_res_->ren_states_.front().statics_.size());
+        }
+
+    private:
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
+            if (flag_ship_->dont_render())
+                return;
+
+            const auto& slots = rp_res_->ren_states_.front().statics_;
+            const auto f_index = rp_ctxt_->f_index_.get();
+
+            for (auto i = range.start; i < range.end; ++i) {
+                const auto& slot = slots[i];
+                auto actor = dynamic_cast<mirinae::RenderActor*>(
+                    slot.actor_.get()
+                );
+                if (!actor)
+                    continue;
+
+                actor->udpate_ubuf(
+                    f_index,
+                    ::make_actor_udata(slot.model_mat_, rp_ctxt_->main_cam_)
+                );
+            }
+        }
+
+        const mirinae::FlagShip* flag_ship_ = nullptr;
+        const mirinae::RpCtxt* rp_ctxt_ = nullptr;
+        const mirinae::RpResources* rp_res_ = nullptr;
+    };
+
+
+    class UpdateSkinnedActor : public mirinae::IUpdateActorTask {
+
+    public:
+        void init(
+            const mirinae::FlagShip& flag_ship,
+            const mirinae::RpCtxt& rp_ctxt,
+            const mirinae::RpResources& rp_res
+        ) override {
+            flag_ship_ = &flag_ship;
+            rp_ctxt_ = &rp_ctxt;
+            rp_res_ = &rp_res;
+        }
+
+        void prepare() override {
+            this->set_size(rp_res_->ren_states_.front().skinneds_.size());
+        }
+
+    private:
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
+            if (flag_ship_->dont_render())
+                return;
+
+            const auto& slots = rp_res_->ren_states_.front().skinneds_;
+            const auto f_index = rp_ctxt_->f_index_;
+
+            for (auto i = range.start; i < range.end; ++i) {
+                const auto& slot = slots[i];
+                auto actor = dynamic_cast<mirinae::RenderActorSkinned*>(
+                    slot.actor_.get()
+                );
+                if (!actor)
+                    continue;
+
+                actor->update_ubuf(
+                    f_index,
+                    ::make_actor_udata(slot.model_mat_, rp_ctxt_->main_cam_)
+                );
+                if (!slot.palette_.empty()) {
+                    actor->update_joint_palette(
+                        f_index,
+                        slot.palette_.data(),
+                        slot.palette_.size(),
+                        slot.palette_rev_
+                    );
+                }
+            }
+        }
+
+        const mirinae::FlagShip* flag_ship_ = nullptr;
+        const mirinae::RpCtxt* rp_ctxt_ = nullptr;
+        const mirinae::RpResources* rp_res_ = nullptr;
     };
 
 }  // namespace
@@ -321,4 +472,12 @@ namespace mirinae {
         return std::make_unique<InitSkinnedModel>();
     }
 
+    std::unique_ptr<IUpdateActorTask> create_update_static_actor_task() {
+        return std::make_unique<UpdateStaticActor>();
+    }
+
+    std::unique_ptr<IUpdateActorTask> create_update_skinned_actor_task() {
+        return std::make_unique<UpdateSkinnedActor>();
+    }
+
 }  // namespace mirinae
@@ -3,24 +3,40 @@
 #include "mirinae/lightweight/task.hpp"
 #include "mirinae/scene/scene.hpp"
 #include "mirinae/vulkan/base/renderpass/common.hpp"
+#include "util/flags.hpp"
 
 
 namespace mirinae {
 
+    // Loads models and actors of the cosmos, then lists them in the back
+    // render state
     struct IInitModelTask : public DependingTask {
         virtual void init(
             Scene& scene,
             VulkanDevice& device,
             IModelManager& model_mgr,
-            RpCtxt& rp_ctxt,
             RpResources& rp_res
         ) = 0;
 
         virtual void prepare() = 0;
     };
 
+    // Writes uniform buffers of the actors listed in the front render state
+    struct IUpdateActorTask : public DependingTask {
+        virtual void init(
+            const FlagShip& flag_ship,
+            const RpCtxt& rp_ctxt,
+            const RpResources& rp_res
+        ) = 0;
+
+        virtual void prepare() = 0;
+    };
+
 
     std::unique_ptr<IInitModelTask> create_init_static_model_task();
     std::unique_ptr<IInitModelTask> create_init_skinned_model_task();
 
+    std::unique_ptr<IUpdateActorTask> create_update_static_actor_task();
+    std::unique_ptr<IUpdateActorTask> create_update_skinned_actor_task();
+
 }  // namespace mirinae
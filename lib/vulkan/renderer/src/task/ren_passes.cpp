@@ -1,5 +1,7 @@
 #include "task/ren_passes.hpp"
 
+#include "mirinae/lightweight/profiler.hpp"
+
 
 namespace {
 
@@ -26,14 +28,12 @@ namespace mirinae {
         FlagShip& flag_ship,
         RpCtxt& rp_ctxt,
         RpResources& rp_res,
-        std::function<bool()> resize_func,
         std::vector<std::unique_ptr<IRpBase>>& passes,
         VulkanDevice& device
     ) {
         cmdbuf_list_ = &cmdbuf_list;
         device_ = &device;
         flag_ship_ = &flag_ship;
-        resize_func_ = resize_func;
         rp_ctxt_ = &rp_ctxt;
         rp_res_ = &rp_res;
 
@@ -42,6 +42,25 @@ namespace mirinae {
                 passes_.push_back(std::move(task));
             }
         }
+
+        for (auto& rp : passes_) {
+            auto& prof = *profs_.emplace_back(std::make_unique<PassProf>());
+            const std::string name{ rp->name() };
+            auto& profiler = mirinae::profiler();
+            prof.name_ = profiler.intern(name);
+            prof.update_name_ = profiler.intern(name + " update");
+            prof.record_name_ = profiler.intern(name + " record");
+
+            // Waiting on the stamps also waits on the fences
+            if (auto fence = rp->update_fence()) {
+                prof.update_end_.succeed(fence);
+                prof.update_wait_ = &prof.update_end_;
+            }
+            if (auto fence = rp->record_fence()) {
+                prof.record_end_.succeed(fence);
+                prof.record_wait_ = &prof.record_end_;
+            }
+        }
     }
 
     void RenderPassesTask::prepare() {}
@@ -49,12 +68,10 @@ namespace mirinae {
     void RenderPassesTask::ExecuteRange(
         enki::TaskSetPartition range, uint32_t tid
     ) {
-        if (flag_ship_->need_resize()) {
-            if (resize_func_) {
-                resize_func_();
-                flag_ship_->set_need_resize(false);
-            }
-        }
+        // Even when not rendering, or the changes would be lost
+        rp_res_->draw_sets_.update(
+            rp_res_->ren_states_.front().draw_set_changes_
+        );
 
         if (flag_ship_->dont_render()) {
             return;
@@ -63,13 +80,43 @@ namespace mirinae {
         rp_res_->cmd_pool_.reset_pool(rp_ctxt_->f_index_, *device_);
         cmdbuf_list_->clear(rp_ctxt_->f_index_);
 
+        const auto pass_count = passes_.size();
+        using clock_t = std::chrono::steady_clock;
+
         for (auto& rp : passes_) rp->prepare(*rp_ctxt_);
-        for (auto& rp : passes_) ::try_run(rp->update_task());
-        for (auto& rp : passes_) ::try_wait(rp->update_fence());
-        for (auto& rp : passes_) ::try_run(rp->record_task());
-        for (auto& rp : passes_) ::try_wait(rp->record_fence());
+        for (size_t i = 0; i < pass_count; ++i) {
+            profs_[i]->update_begin_ = clock_t::now();
+            ::try_run(passes_[i]->update_task());
+        }
+        for (auto& prof : profs_) ::try_wait(prof->update_wait_);
+        for (size_t i = 0; i < pass_count; ++i) {
+            profs_[i]->record_begin_ = clock_t::now();
+            ::try_run(passes_[i]->record_task());
+        }
+        for (auto& prof : profs_) ::try_wait(prof->record_wait_);
         for (auto& rp : passes_)
             rp->collect_cmdbuf(cmdbuf_list_->vector(rp_ctxt_->f_index_));
+
+        auto& profiler = mirinae::profiler();
+        for (auto& prof : profs_) {
+            auto& p = *prof;
+            if (p.update_wait_) {
+                profiler.record(
+                    p.update_name_,
+                    p.update_begin_,
+                    p.update_end_.time_,
+                    p.name_
+                );
+            }
+            if (p.record_wait_) {
+                profiler.record(
+                    p.record_name_,
+                    p.record_begin_,
+                    p.record_end_.time_,
+                    p.name_
+                );
+            }
+        }
     }
 
 }  // namespace mirinae
@@ -16,7 +16,6 @@ namespace mirinae {
             FlagShip& flag_ship,
             RpCtxt& rp_ctxt,
             RpResources& rp_res,
-            std::function<bool()> resize_func,
             std::vector<std::unique_ptr<IRpBase>>& passes,
             VulkanDevice& device
         );
@@ -30,10 +29,24 @@ namespace mirinae {
         FlagShip* flag_ship_ = nullptr;
         RpCtxt* rp_ctxt_ = nullptr;
         RpResources* rp_res_ = nullptr;
-        std::function<bool()> resize_func_;
         VulkanDevice* device_ = nullptr;
 
         std::vector<std::unique_ptr<IRpTask>> passes_;
+
+        // Timings from dispatch to fence, parallel to `passes_`
+        struct PassProf {
+            // Interned by the profiler
+            std::string_view name_;
+            std::string_view update_name_;
+            std::string_view record_name_;
+            std::chrono::steady_clock::time_point update_begin_;
+            std::chrono::steady_clock::time_point record_begin_;
+            StampTask update_end_;
+            StampTask record_end_;
+            enki::ITaskSet* update_wait_ = nullptr;
+            enki::ITaskSet* record_wait_ = nullptr;
+        };
+        std::vector<std::unique_ptr<PassProf>> profs_;
     };
 
 }  // namespace mirinae
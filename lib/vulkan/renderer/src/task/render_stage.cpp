@@ -1,6 +1,7 @@
 #include "task/render_stage.hpp"
 
 #include "mirinae/vulkan/base/renderee/atmos.hpp"
+#include "mirinae/vulkan/base/renderee/terrain.hpp"
 #include "task/init_model.hpp"
 #include "task/ren_passes.hpp"
 #include "task/update_dlight.hpp"
@@ -9,61 +10,155 @@
 
 namespace {
 
+    class CopyRenderState : public mirinae::DependingTask {
 
-    class RenderStage : public mirinae::StageTask {
+    public:
+        void init(
+            mirinae::CosmosSimulator& cosmos, mirinae::RpResources& rp_res
+        ) {
+            cosmos_ = &cosmos;
+            rp_res_ = &rp_res;
+        }
+
+    private:
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
+            auto& scene = cosmos_->scene();
+            auto& dst = rp_res_->ren_states_.back();
+
+            rp_res_->draw_sets_.collect(dst.draw_set_changes_);
+            dst.copy_scene(*scene.reg_, scene.main_camera_);
+            dst.dt_ = scene.clock().dt();
+        }
+
+        mirinae::CosmosSimulator* cosmos_ = nullptr;
+        mirinae::RpResources* rp_res_ = nullptr;
+    };
+
+
+    class RenderSyncStage : public mirinae::StageTask {
 
     public:
-        RenderStage() : StageTask("vulan renderer") {
+        RenderSyncStage() : StageTask("render sync") {
             init_static_ = mirinae::create_init_static_model_task();
             init_skinned_ = mirinae::create_init_skinned_model_task();
 
-            update_ren_ctxt_.succeed(this);
-            init_static_->succeed(&update_ren_ctxt_);
-            init_skinned_->succeed(&update_ren_ctxt_);
-            update_dlight_.succeed(&update_ren_ctxt_);
-            update_atmos_epic_.succeed(&update_ren_ctxt_);
-            render_passes_.succeed(
-                init_static_.get(),
-                init_skinned_.get(),
-                &update_dlight_,
-                &update_atmos_epic_
+            linker_.add("init static", *init_static_, {}, { "static" });
+            linker_.add("init skinned", *init_skinned_, {}, { "skinned" });
+            linker_.add("init terrain", init_terrain_, {}, { "terrain" });
+            linker_.add("init atmos", init_atmos_epic_, {}, { "atmos" });
+            linker_.add("update dlight", update_dlight_, {}, { "dlight" });
+            linker_.add(
+                "copy state",
+                copy_state_,
+                { "static", "skinned", "terrain", "atmos", "dlight" },
+                {}
             );
-            fence_.succeed(&render_passes_);
+            linker_.link(*this, fence_);
+
+            this->reads("clock").reads("ocean");
+            // Skinned actors cache sampled palettes, and directional lights
+            // follow the camera
+            this->writes("transform").writes("anim_state");
+            this->writes("model").writes("terrain").writes("render_state");
         }
 
         void init(
-            mirinae::CmdBufList& cmdbufs,
             mirinae::CosmosSimulator& cosmos,
-            mirinae::FlagShip& flag_ship,
-            mirinae::FrameSync& framesync,
             mirinae::IModelManager& model_mgr,
-            mirinae::RpContext& rp_ctxt,
             mirinae::RpResources& rp_res,
-            std::function<bool()> resize_func,
-            std::vector<std::unique_ptr<mirinae::IRpBase>>& passes,
             mirinae::Swapchain& swapchain,
             mirinae::VulkanDevice& device
         ) {
-            update_ren_ctxt_.init(
-                cosmos.scene(), flag_ship, framesync, rp_ctxt, swapchain, device
-            );
+            init_static_->init(cosmos.scene(), device, model_mgr, rp_res);
+            init_skinned_->init(cosmos.scene(), device, model_mgr, rp_res);
 
-            init_static_->init(
-                cosmos.scene(), device, model_mgr, rp_ctxt, rp_res
+            init_terrain_.init(
+                cosmos.reg(), *rp_res.tex_man_, rp_res.desclays_, device
             );
 
-            init_skinned_->init(
-                cosmos.scene(), device, model_mgr, rp_ctxt, rp_res
+            init_atmos_epic_.init(
+                mirinae::MAX_FRAMES_IN_FLIGHT, cosmos.reg(), device
             );
 
             update_dlight_.init(cosmos, swapchain);
+            copy_state_.init(cosmos, rp_res);
+        }
+
+    private:
+        enki::ITaskSet* get_fence() { return &fence_; }
+
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) {
+            init_static_->prepare();
+            init_skinned_->prepare();
+            init_terrain_.prepare();
+            init_atmos_epic_.prepare();
+            update_dlight_.prepare();
+        }
+
+        std::unique_ptr<mirinae::IInitModelTask> init_static_;
+        std::unique_ptr<mirinae::IInitModelTask> init_skinned_;
+        mirinae::TaskTerrainUnits init_terrain_;
+        mirinae::TaskAtmosEpicUnits init_atmos_epic_;
+        mirinae::UpdateDlight update_dlight_;
+        CopyRenderState copy_state_;
+
+        mirinae::TaskLinker linker_;
+        mirinae::FenceTask fence_;
+    };
+
+
+    class RenderStage : public mirinae::StageTask {
+
+    public:
+        RenderStage() : StageTask("vulan renderer") {
+            update_static_ = mirinae::create_update_static_actor_task();
+            update_skinned_ = mirinae::create_update_skinned_actor_task();
 
-            update_atmos_epic_.init(
-                mirinae::MAX_FRAMES_IN_FLIGHT, cosmos.reg(), rp_ctxt, device
+            linker_.add("update ren ctxt", update_ren_ctxt_, {}, { "ctxt" });
+            linker_.add(
+                "update static", *update_static_, { "ctxt" }, { "static" }
+            );
+            linker_.add(
+                "update skinned", *update_skinned_, { "ctxt" }, { "skinned" }
+            );
+            linker_.add(
+                "update atmos", update_atmos_epic_, { "ctxt" }, { "atmos" }
             );
+            linker_.add(
+                "render passes",
+                render_passes_,
+                { "ctxt", "static", "skinned", "atmos" },
+                { "cmdbuf" }
+            );
+            linker_.link(*this, fence_);
+
+            // Reads nothing of the cosmos, so the next frame may simulate
+            // meanwhile
+            this->after_sync().reads_buffered("render_state").writes("render");
+        }
+
+        void init(
+            mirinae::CmdBufList& cmdbufs,
+            mirinae::FlagShip& flag_ship,
+            mirinae::FrameSync& framesync,
+            mirinae::RpContext& rp_ctxt,
+            mirinae::RpResources& rp_res,
+            std::vector<std::unique_ptr<mirinae::IRpBase>>& passes,
+            mirinae::Swapchain& swapchain,
+            mirinae::VulkanDevice& device
+        ) {
+            const auto& ren_state = rp_res.ren_states_.front();
+
+            update_ren_ctxt_.init(
+                ren_state, flag_ship, framesync, rp_ctxt, swapchain, device
+            );
+
+            update_static_->init(flag_ship, rp_ctxt, rp_res);
+            update_skinned_->init(flag_ship, rp_ctxt, rp_res);
+            update_atmos_epic_.init(ren_state.reg(), rp_ctxt);
 
             render_passes_.init(
-                cmdbufs, flag_ship, rp_ctxt, rp_res, resize_func, passes, device
+                cmdbufs, flag_ship, rp_ctxt, rp_res, passes, device
             );
         }
 
@@ -72,20 +167,19 @@ namespace {
 
         void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) {
             update_ren_ctxt_.prepare();
-            init_static_->prepare();
-            init_skinned_->prepare();
-            update_dlight_.prepare();
+            update_static_->prepare();
+            update_skinned_->prepare();
             update_atmos_epic_.prepare();
             render_passes_.prepare();
         }
 
         mirinae::UpdateRenContext update_ren_ctxt_;
-        std::unique_ptr<mirinae::IInitModelTask> init_static_;
-        std::unique_ptr<mirinae::IInitModelTask> init_skinned_;
-        mirinae::UpdateDlight update_dlight_;
+        std::unique_ptr<mirinae::IUpdateActorTask> update_static_;
+        std::unique_ptr<mirinae::IUpdateActorTask> update_skinned_;
         mirinae::TaskAtmosEpic update_atmos_epic_;
         mirinae::RenderPassesTask render_passes_;
 
+        mirinae::TaskLinker linker_;
         mirinae::FenceTask fence_;
     };
 
@@ -94,15 +188,24 @@ namespace {
 
 namespace mirinae {
 
+    std::unique_ptr<StageTask> create_render_sync_stage(
+        CosmosSimulator& cosmos,
+        IModelManager& model_mgr,
+        RpResources& rp_res,
+        Swapchain& swapchain,
+        VulkanDevice& device
+    ) {
+        auto stage = std::make_unique<RenderSyncStage>();
+        stage->init(cosmos, model_mgr, rp_res, swapchain, device);
+        return stage;
+    }
+
     std::unique_ptr<StageTask> create_render_stage(
         CmdBufList& cmdbufs,
-        CosmosSimulator& cosmos,
         FlagShip& flag_ship,
         FrameSync& framesync,
-        IModelManager& model_mgr,
         RpContext& rp_ctxt,
         RpResources& rp_res,
-        std::function<bool()> resize_func,
         std::vector<std::unique_ptr<IRpBase>>& passes,
         Swapchain& swapchain,
         VulkanDevice& device
@@ -110,13 +213,10 @@ namespace mirinae {
         auto stage = std::make_unique<RenderStage>();
         stage->init(
             cmdbufs,
-            cosmos,
             flag_ship,
             framesync,
-            model_mgr,
             rp_ctxt,
             rp_res,
-            resize_func,
             passes,
             swapchain,
             device
@@ -11,15 +11,23 @@
 
 namespace mirinae {
 
+    // Prepares the cosmos for rendering and fills the back render state.
+    // Runs before the sync point.
+    std::unique_ptr<StageTask> create_render_sync_stage(
+        CosmosSimulator& cosmos,
+        IModelManager& model_mgr,
+        RpResources& rp_res,
+        Swapchain& swapchain,
+        VulkanDevice& device
+    );
+
+    // Records the front render state. Runs after the sync point.
     std::unique_ptr<StageTask> create_render_stage(
         CmdBufList& cmdbufs,
-        CosmosSimulator& cosmos,
         FlagShip& flag_ship,
         FrameSync& framesync,
-        IModelManager& model_mgr,
         RpContext& rp_ctxt,
         RpResources& rp_res,
-        std::function<bool()> resize_func,
         std::vector<std::unique_ptr<IRpBase>>& passes,
         Swapchain& swapchain,
         VulkanDevice& device
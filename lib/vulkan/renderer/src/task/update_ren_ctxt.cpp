@@ -2,8 +2,10 @@
 
 #include <entt/entity/registry.hpp>
 
+#include "mirinae/cpnt/camera.hpp"
 #include "mirinae/cpnt/transform.hpp"
 #include "mirinae/lightweight/include_spdlog.hpp"
+#include "mirinae/vulkan/base/render/ubuf_ring.hpp"
 
 
 namespace {
@@ -26,7 +28,7 @@ namespace {
     }
 
     void update(
-        const mirinae::Scene& scene,
+        const mirinae::RenderState& ren_state,
         mirinae::FlagShip& flag_ship,
         mirinae::FrameSync& framesync,
         mirinae::RpContext& ren_ctxt,
@@ -54,8 +56,9 @@ namespace {
         flag_ship.set_need_resize(false);
         flag_ship.set_dont_render(false);
 
-        const auto e_cam = scene.main_camera_;
-        const auto cam = scene.reg_->try_get<cpnt::StandardCamera>(e_cam);
+        const auto& reg = ren_state.reg();
+        const auto e_cam = ren_state.main_camera_;
+        const auto cam = reg.try_get<cpnt::StandardCamera>(e_cam);
         if (!cam) {
             SPDLOG_WARN("No camera found in scene.");
             flag_ship.set_dont_render(true);
@@ -64,14 +67,17 @@ namespace {
 
         ren_ctxt.main_cam_.update(
             *cam,
-            scene.reg_->try_get<cpnt::Transform>(e_cam),
+            reg.try_get<cpnt::Transform>(e_cam),
             swapchain.width(),
             swapchain.height()
         );
 
         ren_ctxt.f_index_ = framesync.get_frame_index();
         ren_ctxt.i_index_ = i_idx.value();
-        ren_ctxt.dt_ = scene.clock().dt();
+        ren_ctxt.dt_ = ren_state.dt_;
+
+        // The frame's fence was waited on above
+        device.ubuf_ring().begin_frame(ren_ctxt.f_index_);
     }
 
 }  // namespace
@@ -81,7 +87,7 @@ namespace {
 namespace mirinae {
 
     void UpdateRenContext::init(
-        const Scene& scene,
+        const RenderState& ren_state,
         FlagShip& flag_ship,
         FrameSync& framesync,
         RpContext& rp_ctxt,
@@ -92,7 +98,7 @@ namespace mirinae {
         flag_ship_ = &flag_ship;
         framesync_ = &framesync;
         ren_ctxt_ = &rp_ctxt;
-        scene_ = &scene;
+        ren_state_ = &ren_state;
         swapchain_ = &swapchain;
     }
 
@@ -102,7 +108,12 @@ namespace mirinae {
         enki::TaskSetPartition range, uint32_t tid
     ) {
         ::update(
-            *scene_, *flag_ship_, *framesync_, *ren_ctxt_, *swapchain_, *device_
+            *ren_state_,
+            *flag_ship_,
+            *framesync_,
+            *ren_ctxt_,
+            *swapchain_,
+            *device_
         );
     }
 
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "mirinae/lightweight/task.hpp"
-#include "mirinae/scene/scene.hpp"
 #include "mirinae/vulkan/base/renderpass/common.hpp"
 #include "util/flags.hpp"
 #include "util/frame_sync.hpp"
@@ -13,7 +12,7 @@ namespace mirinae {
 
     public:
         void init(
-            const Scene& scene,
+            const RenderState& ren_state,
             FlagShip& flag_ship,
             FrameSync& framesync,
             RpContext& rp_ctxt,
@@ -26,7 +25,7 @@ namespace mirinae {
     private:
         void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override;
 
-        const Scene* scene_ = nullptr;
+        const RenderState* ren_state_ = nullptr;
         FlagShip* flag_ship_ = nullptr;
         FrameSync* framesync_ = nullptr;
         RpContext* ren_ctxt_ = nullptr;
@@ -14,7 +14,8 @@ namespace mirinae {
 
     private:
         bool need_resize_{ false };
-        bool dont_render_{ false };
+        // Nothing is recorded before the first frame's render stage
+        bool dont_render_{ true };
     };
 
 }  // namespace mirinae
@@ -350,7 +350,11 @@ namespace {
         std::unique_ptr<mirinae::IRpTask> create_task() override {
             auto out = std::make_unique<::RpTask>();
             out->init(
-                cosmos_.reg(), *this, frame_data_, rp_res_.cmd_pool_, device_
+                rp_res_.ren_states_.front().reg(),
+                *this,
+                frame_data_,
+                rp_res_.cmd_pool_,
+                device_
             );
             return out;
         }
@@ -369,7 +369,7 @@ namespace {
             auto out = std::make_unique<::RpTask>();
             out->init(
                 frame_data_,
-                cosmos_.reg(),
+                rp_res_.ren_states_.front().reg(),
                 rp_res_.gbuf_,
                 *this,
                 rp_res_.cmd_pool_,
@@ -614,7 +614,7 @@ namespace {
             auto out = std::make_unique<task::RpTask>();
             out->init(
                 rp_res_.shadow_maps_->dlights(),
-                cosmos_.reg(),
+                rp_res_.ren_states_.front().reg(),
                 rp_res_.gbuf_,
                 *this,
                 frame_data_,
@@ -351,7 +351,7 @@ namespace {
             auto out = std::make_unique<::RpTask>();
             out->init(
                 frame_data_,
-                cosmos_.reg(),
+                rp_res_.ren_states_.front().reg(),
                 *this,
                 *static_cast<mirinae::EnvmapBundle*>(rp_res_.envmaps_.get()),
                 rp_res_.cmd_pool_,
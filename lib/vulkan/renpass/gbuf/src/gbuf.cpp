@@ -22,7 +22,15 @@ namespace { namespace gbuf {
         mirinae::DesclayoutManager& desclayouts, mirinae::VulkanDevice& device
     ) {
         mirinae::DescLayoutBuilder builder{ "gbuf:actor" };
-        builder.add_ubuf(VK_SHADER_STAGE_VERTEX_BIT, 1);  // U_GbufActor
+        builder.add_ubuf_dyn(VK_SHADER_STAGE_VERTEX_BIT, 1);  // U_GbufActor
+        return desclayouts.add(builder, device.logi_device());
+    }
+
+    VkDescriptorSetLayout create_desclayout_instances(
+        mirinae::DesclayoutManager& desclayouts, mirinae::VulkanDevice& device
+    ) {
+        mirinae::DescLayoutBuilder builder{ "gbuf:instances" };
+        builder.add_sbuf(VK_SHADER_STAGE_VERTEX_BIT, 1);  // Matrices
         return desclayouts.add(builder, device.logi_device());
     }
 
@@ -55,6 +63,7 @@ namespace mirinae::rp::gbuf {
         DesclayoutManager& desclayouts, VulkanDevice& device
     ) {
         ::gbuf::create_desclayout_actor(desclayouts, device);
+        ::gbuf::create_desclayout_instances(desclayouts, device);
         ::gbuf::create_desclayout_model(desclayouts, device);
         ::gbuf_terrain::create_desclayout_main(desclayouts, device);
     }
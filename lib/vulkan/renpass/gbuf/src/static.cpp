@@ -4,6 +4,7 @@
 #include "mirinae/lightweight/task.hpp"
 #include "mirinae/vulkan/base/render/cmdbuf.hpp"
 #include "mirinae/vulkan/base/render/draw_set.hpp"
+#include "mirinae/vulkan/base/render/instancing.hpp"
 #include "mirinae/vulkan/base/renderpass/builder.hpp"
 
 
@@ -16,6 +17,24 @@ namespace {
 
     using FrameDataArr = std::array<FrameData, mirinae::MAX_FRAMES_IN_FLIGHT>;
 
+
+    // Draws static units with one instanced draw per unit
+    struct InstPipeline : public mirinae::IPipelinePair {
+        VkPipeline pipeline() const override { return pipeline_.get(); }
+
+        VkPipelineLayout pipe_layout() const override {
+            return pipe_layout_.get();
+        }
+
+        void destroy(mirinae::VulkanDevice& device) {
+            pipeline_.destroy(device);
+            pipe_layout_.destroy(device);
+        }
+
+        mirinae::RpPipeline pipeline_;
+        mirinae::RpPipeLayout pipe_layout_;
+    };
+
 }  // namespace
 
 
@@ -28,13 +47,17 @@ namespace {
 
         void init(
             const ::FrameDataArr& frame_data,
-            const entt::registry& reg,
+            const mirinae::DrawSetCache& draw_sets,
             const mirinae::IRenPass& rp,
+            const ::InstPipeline& inst_pipe,
+            mirinae::InstanceBuffer& inst_buf,
             mirinae::RpCommandPool& cmd_pool,
             mirinae::VulkanDevice& device
         ) {
             rp_ = &rp;
-            reg_ = &reg;
+            inst_pipe_ = &inst_pipe;
+            inst_buf_ = &inst_buf;
+            draw_sets_ = &draw_sets;
             cmd_pool_ = &cmd_pool;
             device_ = &device;
             frame_data_ = &frame_data;
@@ -56,15 +79,28 @@ namespace {
             if (cmdbuf_ == VK_NULL_HANDLE)
                 return;
 
-            draw_set_.clear();
-            draw_set_.fetch(*reg_);
+            auto& draw_set = draw_sets_->draw_set();
+
+            views_.resize(1);
+            views_[0].set(ctxt_->main_cam_.pv());
+            draw_set.cull(views_, culled_);
+
+            inst_groups_.clear();
+            inst_groups_.add(
+                draw_set, culled_.view(0).opa_, ctxt_->main_cam_.view()
+            );
+            inst_buf_->upload(ctxt_->f_index_, inst_groups_.mats());
 
             mirinae::begin_cmdbuf(cmdbuf_, DEBUG_LABEL);
             this->record(
                 cmdbuf_,
                 frame_data_->at(ctxt_->f_index_.get()),
-                draw_set_,
+                draw_set,
+                culled_,
+                inst_groups_,
+                *inst_buf_,
                 *rp_,
+                *inst_pipe_,
                 *ctxt_
             );
             mirinae::end_cmdbuf(cmdbuf_, DEBUG_LABEL);
@@ -74,7 +110,11 @@ namespace {
             const VkCommandBuffer cmdbuf,
             const ::FrameData& fd,
             const mirinae::DrawSetStatic& draw_set,
+            const mirinae::DrawSetStatic::CullResult& culled,
+            const mirinae::InstanceGroups& inst_groups,
+            const mirinae::InstanceBuffer& inst_buf,
             const mirinae::IRenPass& rp,
+            const ::InstPipeline& inst_pipe,
             const mirinae::RpCtxt& ctxt
         ) {
             mirinae::RenderPassBeginInfo{}
@@ -85,33 +125,61 @@ namespace {
                 .clear_values(rp.clear_values())
                 .record_begin(cmdbuf);
 
-            vkCmdBindPipeline(
-                cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, rp.pipeline()
-            );
-
             mirinae::Viewport{ fd.fbuf_size_ }.record_single(cmdbuf);
             mirinae::Rect2D{ fd.fbuf_size_ }.record_scissor(cmdbuf);
 
-            mirinae::DescSetBindInfo descset_info{ rp.pipe_layout() };
+            auto& view = culled.view(0);
 
-            for (auto& pair : draw_set.opa()) {
-                auto& unit = *pair.unit_;
-                auto& actor = *pair.actor_;
+            if (!inst_groups.groups().empty()) {
+                vkCmdBindPipeline(
+                    cmdbuf,
+                    VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    inst_pipe.pipeline()
+                );
 
-                descset_info.first_set(0)
-                    .set(unit.get_desc_set(ctxt.f_index_.get()))
-                    .record(cmdbuf);
+                mirinae::U_GbufInstPushConst push_const;
+                push_const.proj_ = ctxt.main_cam_.proj();
 
-                unit.record_bind_vert_buf(cmdbuf);
+                const auto layout = inst_pipe.pipe_layout();
+                mirinae::PushConstInfo{}
+                    .layout(layout)
+                    .add_stage_vert()
+                    .record(cmdbuf, push_const);
 
+                mirinae::DescSetBindInfo descset_info{ layout };
                 descset_info.first_set(1)
-                    .set(actor.get_desc_set(ctxt.f_index_.get()))
+                    .set(inst_buf.descset(ctxt.f_index_))
                     .record(cmdbuf);
 
-                vkCmdDrawIndexed(cmdbuf, unit.vertex_count(), 1, 0, 0, 0);
+                mirinae::GeometryBindCache geo_binds;
+                for (auto& group : inst_groups.groups()) {
+                    auto& unit = *group.unit_;
+
+                    descset_info.first_set(0)
+                        .set(unit.get_desc_set(ctxt.f_index_.get()))
+                        .record(cmdbuf);
+
+                    unit.record_bind_vert_buf(cmdbuf, geo_binds);
+
+                    vkCmdDrawIndexed(
+                        cmdbuf,
+                        unit.vertex_count(),
+                        group.count_,
+                        unit.first_index(),
+                        unit.vertex_offset(),
+                        group.first_
+                    );
+                }
             }
 
-            for (auto& pair : draw_set.skin_opa()) {
+            vkCmdBindPipeline(
+                cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, rp.pipeline()
+            );
+
+            mirinae::DescSetBindInfo descset_info{ rp.pipe_layout() };
+
+            for (auto i : view.skin_opa_) {
+                auto& pair = draw_set.skin_opa()[i];
                 auto& unit = *pair.unit_;
                 auto& actor = *pair.actor_;
                 auto& ac_unit = actor.get_runit(pair.runit_idx_);
@@ -127,6 +195,7 @@ namespace {
 
                 descset_info.first_set(1)
                     .set(actor.get_descset(ctxt.f_index_))
+                    .dyn_offset(actor.ubuf_offset(ctxt.f_index_))
                     .record(cmdbuf);
 
                 vkCmdDrawIndexed(cmdbuf, unit.vertex_count(), 1, 0, 0, 0);
@@ -140,12 +209,16 @@ namespace {
         };
 
         mirinae::FenceTask fence_;
-        mirinae::DrawSetStatic draw_set_;
+        mirinae::DrawSetStatic::CullResult culled_;
+        mirinae::InstanceGroups inst_groups_;
+        std::vector<mirinae::FrustumPlanes> views_;
         VkCommandBuffer cmdbuf_ = VK_NULL_HANDLE;
 
         const ::FrameDataArr* frame_data_ = nullptr;
-        const entt::registry* reg_ = nullptr;
+        const mirinae::DrawSetCache* draw_sets_ = nullptr;
         const mirinae::IRenPass* rp_ = nullptr;
+        const ::InstPipeline* inst_pipe_ = nullptr;
+        mirinae::InstanceBuffer* inst_buf_ = nullptr;
         const mirinae::RpCtxt* ctxt_ = nullptr;
         mirinae::RpCommandPool* cmd_pool_ = nullptr;
         mirinae::VulkanDevice* device_ = nullptr;
@@ -157,12 +230,22 @@ namespace {
     public:
         void init(
             const ::FrameDataArr& frame_data,
-            const entt::registry& reg,
+            const mirinae::DrawSetCache& draw_sets,
             const mirinae::IRenPass& rp,
+            const ::InstPipeline& inst_pipe,
+            mirinae::InstanceBuffer& inst_buf,
             mirinae::RpCommandPool& cmd_pool,
             mirinae::VulkanDevice& device
         ) {
-            record_tasks_.init(frame_data, reg, rp, cmd_pool, device);
+            record_tasks_.init(
+                frame_data,
+                draw_sets,
+                rp,
+                inst_pipe,
+                inst_buf,
+                cmd_pool,
+                device
+            );
         }
 
         std::string_view name() const override { return "gbuf static"; }
@@ -223,15 +306,15 @@ namespace {
     }
 
     VkPipeline create_pipeline(
+        const char* vert_path,
+        const char* frag_path,
         VkRenderPass renderpass,
         VkPipelineLayout pipelineLayout,
         mirinae::VulkanDevice& device
     ) {
         mirinae::PipelineBuilder builder{ device };
 
-        builder.shader_stages()
-            .add_vert(":asset/spv/gbuf_static_vert.spv")
-            .add_frag(":asset/spv/gbuf_static_frag.spv");
+        builder.shader_stages().add_vert(vert_path).add_frag(frag_path);
 
         builder.vertex_input_state().set_static();
 
@@ -259,7 +342,10 @@ namespace {
             mirinae::RpResources& rp_res,
             mirinae::VulkanDevice& device
         )
-            : cosmos_(cosmos), rp_res_(rp_res), device_(device) {
+            : cosmos_(cosmos)
+            , rp_res_(rp_res)
+            , inst_buf_(device)
+            , device_(device) {
             clear_values_.at(0).depthStencil = { 0, 0 };
             clear_values_.at(1).color = { 0.0f, 0.0f, 0.0f, 1.0f };
             clear_values_.at(2).color = { 0.0f, 0.0f, 0.0f, 1.0f };
@@ -278,7 +364,30 @@ namespace {
                 .desc(rp_res.desclays_.get("gbuf:actor").layout())
                 .build(pipe_layout_, device);
 
-            pipeline_ = ::create_pipeline(render_pass_, pipe_layout_, device);
+            pipeline_ = ::create_pipeline(
+                ":asset/spv/gbuf_static_vert.spv",
+                ":asset/spv/gbuf_static_frag.spv",
+                render_pass_,
+                pipe_layout_,
+                device
+            );
+
+            mirinae::PipelineLayoutBuilder{}
+                .desc(rp_res.desclays_.get("gbuf:model").layout())
+                .desc(rp_res.desclays_.get("gbuf:instances").layout())
+                .add_vertex_flag()
+                .pc<mirinae::U_GbufInstPushConst>()
+                .build(inst_pipe_.pipe_layout_, device);
+
+            inst_pipe_.pipeline_ = ::create_pipeline(
+                ":asset/spv/gbuf_static_inst_vert.spv",
+                ":asset/spv/gbuf_static_inst_frag.spv",
+                render_pass_,
+                inst_pipe_.pipe_layout_,
+                device
+            );
+
+            inst_buf_.init(mirinae::MAX_FRAMES_IN_FLIGHT, rp_res.desclays_);
 
             this->recreate_fbuf(fdata_);
         }
@@ -288,6 +397,7 @@ namespace {
                 fd.fbuf_.destroy(device_.logi_device());
             }
 
+            inst_pipe_.destroy(device_);
             this->destroy_render_pass_elements(device_);
         }
 
@@ -300,7 +410,13 @@ namespace {
         std::unique_ptr<mirinae::IRpTask> create_task() override {
             auto task = std::make_unique<RpTask>();
             task->init(
-                fdata_, cosmos_.reg(), *this, rp_res_.cmd_pool_, device_
+                fdata_,
+                rp_res_.draw_sets_,
+                *this,
+                inst_pipe_,
+                inst_buf_,
+                rp_res_.cmd_pool_,
+                device_
             );
             return task;
         }
@@ -330,6 +446,8 @@ namespace {
 
         mirinae::CosmosSimulator& cosmos_;
         mirinae::RpResources& rp_res_;
+        ::InstPipeline inst_pipe_;
+        mirinae::InstanceBuffer inst_buf_;
         mirinae::VulkanDevice& device_;
     };
 
@@ -1,7 +1,5 @@
 #include "mirinae/vulkan/renpass/gbuf/gbuf.hpp"
 
-#include <mutex>
-
 #include <entt/entity/registry.hpp>
 
 #include "mirinae/cosmos.hpp"
@@ -75,64 +73,6 @@ namespace {
 
 namespace {
 
-    class UpdateTask : public mirinae::DependingTask {
-
-    public:
-        UpdateTask() { fence_.succeed(this); }
-
-        void init(
-            entt::registry& reg,
-            mirinae::RpResources& rp_res,
-            mirinae::VulkanDevice& device
-        ) {
-            reg_ = &reg;
-            rp_res_ = &rp_res;
-            device_ = &device;
-        }
-
-        enki::ITaskSet& fence() { return fence_; }
-
-        void prepare() {
-            this->set_size(reg_->view<mirinae::cpnt::Terrain>().size());
-        }
-
-    private:
-        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
-            auto view = reg_->view<mirinae::cpnt::Terrain>();
-            auto it = view.begin() + range.start;
-            auto end = view.begin() + range.end;
-
-            for (; it != end; ++it) {
-                const auto e = *it;
-                auto& terr = reg_->get<mirinae::cpnt::Terrain>(e);
-                this->update(terr, *rp_res_, *device_, tex_mut_);
-            }
-        }
-
-        static void update(
-            mirinae::cpnt::Terrain& terr,
-            mirinae::RpResources& rp_res,
-            mirinae::VulkanDevice& device,
-            std::mutex& tex_mut
-        ) {
-            auto unit = terr.ren_unit<mirinae::RenUnitTerrain>();
-            if (!unit) {
-                std::lock_guard<std::mutex> lock(tex_mut);
-                terr.ren_unit_ = std::make_unique<mirinae::RenUnitTerrain>(
-                    terr, *rp_res.tex_man_, rp_res.desclays_, device
-                );
-            }
-        }
-
-        mirinae::FenceTask fence_;
-        std::mutex tex_mut_;
-
-        entt::registry* reg_ = nullptr;
-        mirinae::RpResources* rp_res_ = nullptr;
-        mirinae::VulkanDevice* device_ = nullptr;
-    };
-
-
     class DrawTasks : public mirinae::DependingTask {
 
     public:
@@ -318,12 +258,10 @@ namespace {
         void init(
             const ::FrameDataArr& frame_data,
             const mirinae::IRenPass& rp,
-            entt::registry& reg,
+            const entt::registry& reg,
             mirinae::RpResources& rp_res,
             mirinae::VulkanDevice& device
         ) {
-            update_task_.init(reg, rp_res, device);
-
             record_tasks_.init(
                 frame_data, reg, rp_res.gbuf_, rp, rp_res.cmd_pool_, device
             );
@@ -332,7 +270,6 @@ namespace {
         std::string_view name() const override { return "gbuf terrain"; }
 
         void prepare(const mirinae::RpCtxt& ctxt) override {
-            update_task_.prepare();
             record_tasks_.prepare(ctxt);
         }
 
@@ -340,12 +277,6 @@ namespace {
             record_tasks_.collect_cmdbuf(out);
         }
 
-        enki::ITaskSet* update_task() override { return &update_task_; }
-
-        enki::ITaskSet* update_fence() override {
-            return &update_task_.fence();
-        }
-
         enki::ITaskSet* record_task() override { return &record_tasks_; }
 
         enki::ITaskSet* record_fence() override {
@@ -353,7 +284,6 @@ namespace {
         }
 
     private:
-        UpdateTask update_task_;
         DrawTasks record_tasks_;
     };
 
@@ -491,7 +421,8 @@ namespace {
 
         std::unique_ptr<mirinae::IRpTask> create_task() override {
             auto task = std::make_unique<RpTask>();
-            task->init(fdata_, *this, cosmos_.reg(), rp_res_, device_);
+            const auto& reg = rp_res_.ren_states_.front().reg();
+            task->init(fdata_, *this, reg, rp_res_, device_);
             return task;
         }
 
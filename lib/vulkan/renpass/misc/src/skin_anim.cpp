@@ -6,6 +6,7 @@
 #include "mirinae/cpnt/transform.hpp"
 #include "mirinae/lightweight/task.hpp"
 #include "mirinae/vulkan/base/render/cmdbuf.hpp"
+#include "mirinae/vulkan/base/render/draw_set.hpp"
 #include "mirinae/vulkan/base/render/mem_cinfo.hpp"
 #include "mirinae/vulkan/base/render/renderee.hpp"
 #include "mirinae/vulkan/base/renderee/ren_actor_skinned.hpp"
@@ -30,72 +31,6 @@ namespace {
 
     using FrameDataArr = std::array<FrameData, mirinae::MAX_FRAMES_IN_FLIGHT>;
 
-
-    class DrawSheet {
-
-    public:
-        void clear() {
-            opa_.clear();
-            trs_.clear();
-        }
-
-        void fetch(const entt::registry& reg) {
-            for (const auto e : reg.view<cpnt::MdlActorSkinned>()) {
-                auto& mactor = reg.get<cpnt::MdlActorSkinned>(e);
-                if (!mactor.model_)
-                    continue;
-                auto renmdl = mactor.get_model<mirinae::RenderModelSkinned>();
-                if (!renmdl)
-                    continue;
-                auto actor = mactor.get_actor<mirinae::RenderActorSkinned>();
-                if (!actor)
-                    continue;
-
-                glm::dmat4 model_mat(1);
-                if (auto tfrom = reg.try_get<cpnt::Transform>(e))
-                    model_mat = tfrom->make_model_mat();
-
-                const auto unit_count = renmdl->runits_.size();
-                for (size_t i = 0; i < unit_count; ++i) {
-                    if (!mactor.visibility_.get(i))
-                        continue;
-
-                    auto& dst = opa_.emplace_back();
-                    dst.unit_ = &renmdl->runits_[i];
-                    dst.actor_ = actor;
-                    dst.model_mat_ = model_mat;
-                    dst.unit_idx_ = i;
-                }
-
-                const auto unit_trs_count = renmdl->runits_alpha_.size();
-                for (size_t i = 0; i < unit_trs_count; ++i) {
-                    if (!mactor.visibility_.get(i + unit_count))
-                        continue;
-
-                    auto& dst = trs_.emplace_back();
-                    dst.unit_ = &renmdl->runits_alpha_[i];
-                    dst.actor_ = actor;
-                    dst.model_mat_ = model_mat;
-                    dst.unit_idx_ = i;
-                }
-            }
-        }
-
-        struct RenderPair {
-            const mirinae::RenderUnitSkinned* unit_ = nullptr;
-            const mirinae::RenderActorSkinned* actor_ = nullptr;
-            glm::dmat4 model_mat_{ 1 };
-            size_t unit_idx_ = 0;
-        };
-
-        auto& opa() const { return opa_; }
-        auto& trs() const { return trs_; }
-
-    private:
-        std::vector<RenderPair> opa_;
-        std::vector<RenderPair> trs_;
-    };
-
 }  // namespace
 
 
@@ -107,14 +42,14 @@ namespace {
         DrawTasks() { fence_.succeed(this); }
 
         void init(
-            const entt::registry& reg,
+            const mirinae::DrawSetCache& draw_sets,
             const mirinae::IPipelinePair& rp,
             mirinae::RpCommandPool& cmd_pool,
             mirinae::VulkanDevice& device
         ) {
             cmd_pool_ = &cmd_pool;
             device_ = &device;
-            reg_ = &reg;
+            draw_sets_ = &draw_sets;
             rp_ = &rp;
         }
 
@@ -134,12 +69,9 @@ namespace {
             if (cmdbuf_ == VK_NULL_HANDLE)
                 return;
 
-            draw_set_.clear();
-            draw_set_.fetch(*reg_);
-
             mirinae::begin_cmdbuf(cmdbuf_, DEBUG_LABEL);
             const auto res = this->record(
-                cmdbuf_, draw_set_, *rp_, *ctxt_, *device_
+                cmdbuf_, draw_sets_->draw_set(), *rp_, *ctxt_, *device_
             );
             mirinae::end_cmdbuf(cmdbuf_, DEBUG_LABEL);
 
@@ -151,7 +83,7 @@ namespace {
 
         static bool record(
             const VkCommandBuffer cmdbuf,
-            const ::DrawSheet& draw_set,
+            const mirinae::DrawSetStatic& draw_set,
             const mirinae::IPipelinePair& rp,
             const mirinae::RpCtxt& ctxt,
             mirinae::VulkanDevice& device
@@ -165,10 +97,10 @@ namespace {
 
             ::U_SkinAnim push_const;
 
-            for (auto& pair : draw_set.opa()) {
+            for (auto& pair : draw_set.skin_opa()) {
                 auto& unit = *pair.unit_;
                 auto& actor = *pair.actor_;
-                auto& ac_unit = actor.get_runit(pair.unit_idx_);
+                auto& ac_unit = actor.get_runit(pair.runit_idx_);
 
                 unit.record_bind_vert_buf(cmdbuf);
 
@@ -183,10 +115,10 @@ namespace {
                 vkCmdDispatch(cmdbuf, ceil_div(unit.vertex_count(), 128), 1, 1);
             }
 
-            for (auto& pair : draw_set.trs()) {
+            for (auto& pair : draw_set.skin_trs()) {
                 auto& unit = *pair.unit_;
                 auto& actor = *pair.actor_;
-                auto& ac_unit = actor.get_runit_trs(pair.unit_idx_);
+                auto& ac_unit = actor.get_runit_trs(pair.runit_idx_);
 
                 unit.record_bind_vert_buf(cmdbuf);
 
@@ -208,9 +140,8 @@ namespace {
 
         mirinae::FenceTask fence_;
         VkCommandBuffer cmdbuf_ = VK_NULL_HANDLE;
-        ::DrawSheet draw_set_;
 
-        const entt::registry* reg_ = nullptr;
+        const mirinae::DrawSetCache* draw_sets_ = nullptr;
         const mirinae::IPipelinePair* rp_ = nullptr;
         const mirinae::RpCtxt* ctxt_ = nullptr;
         mirinae::RpCommandPool* cmd_pool_ = nullptr;
@@ -222,12 +153,12 @@ namespace {
 
     public:
         void init(
-            const entt::registry& reg,
+            const mirinae::DrawSetCache& draw_sets,
             const mirinae::IPipelinePair& rp,
             mirinae::RpCommandPool& cmd_pool,
             mirinae::VulkanDevice& device
         ) {
-            record_tasks_.init(reg, rp, cmd_pool, device);
+            record_tasks_.init(draw_sets, rp, cmd_pool, device);
         }
 
         std::string_view name() const override { return "skin anim"; }
@@ -298,7 +229,9 @@ namespace {
 
         std::unique_ptr<mirinae::IRpTask> create_task() override {
             auto task = std::make_unique<RpTask>();
-            task->init(cosmos_.reg(), *this, rp_res_.cmd_pool_, device_);
+            task->init(
+                rp_res_.draw_sets_, *this, rp_res_.cmd_pool_, device_
+            );
             return task;
         }
 
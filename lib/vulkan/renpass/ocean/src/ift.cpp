@@ -599,7 +599,13 @@ namespace {
 
         std::unique_ptr<mirinae::IRpTask> create_task() override {
             auto out = std::make_unique<task::butterfly::RpTask>();
-            out->init(cosmos_.reg(), *this, fdata_, rp_res_.cmd_pool_, device_);
+            out->init(
+                rp_res_.ren_states_.front().reg(),
+                *this,
+                fdata_,
+                rp_res_.cmd_pool_,
+                device_
+            );
             return out;
         }
 
@@ -747,7 +753,8 @@ namespace {
         }
 
         void record(const mirinae::RpContext& ctxt) override {
-            auto ocean = mirinae::find_ocean_cpnt(cosmos_.reg());
+            const auto& reg = rp_res_.ren_states_.front().reg();
+            auto ocean = mirinae::find_ocean_cpnt(reg);
             if (!ocean)
                 return;
             auto& ocean_entt = *ocean;
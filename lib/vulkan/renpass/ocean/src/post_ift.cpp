@@ -469,7 +469,13 @@ namespace {
 
         std::unique_ptr<mirinae::IRpTask> create_task() override {
             auto out = std::make_unique<task::RpTask>();
-            out->init(cosmos_.reg(), *this, fdata_, rp_res_.cmd_pool_, device_);
+            out->init(
+                rp_res_.ren_states_.front().reg(),
+                *this,
+                fdata_,
+                rp_res_.cmd_pool_,
+                device_
+            );
             return out;
         }
 
@@ -9,11 +9,34 @@
 #include "mirinae/lightweight/task.hpp"
 #include "mirinae/vulkan/base/render/cmdbuf.hpp"
 #include "mirinae/vulkan/base/render/draw_set.hpp"
+#include "mirinae/vulkan/base/render/instancing.hpp"
 #include "mirinae/vulkan/base/renderpass/builder.hpp"
 
 #include "bundles.hpp"
 
 
+namespace {
+
+    // Draws static units with one instanced draw per unit
+    struct InstPipeline : public mirinae::IPipelinePair {
+        VkPipeline pipeline() const override { return pipeline_.get(); }
+
+        VkPipelineLayout pipe_layout() const override {
+            return pipe_layout_.get();
+        }
+
+        void destroy(mirinae::VulkanDevice& device) {
+            pipeline_.destroy(device);
+            pipe_layout_.destroy(device);
+        }
+
+        mirinae::RpPipeline pipeline_;
+        mirinae::RpPipeLayout pipe_layout_;
+    };
+
+}  // namespace
+
+
 // Tasks
 namespace { namespace task {
 
@@ -136,13 +159,19 @@ namespace { namespace task {
 
         void init(
             const entt::registry& reg,
+            const mirinae::DrawSetCache& draw_sets,
             const mirinae::IRenPass& rp,
+            const ::InstPipeline& inst_pipe,
+            mirinae::InstanceBuffer& inst_buf,
             const mirinae::ShadowMapBundle& shadow_maps,
             mirinae::RpCommandPool& cmd_pool,
             mirinae::VulkanDevice& device
         ) {
             reg_ = &reg;
+            draw_sets_ = &draw_sets;
             rp_ = &rp;
+            inst_pipe_ = &inst_pipe;
+            inst_buf_ = &inst_buf;
             shadow_maps_ = &shadow_maps;
             cmd_pool_ = &cmd_pool;
             device_ = &device;
@@ -164,22 +193,112 @@ namespace { namespace task {
             if (cmdbuf_ == VK_NULL_HANDLE)
                 return;
 
-            draw_set_.clear();
-            draw_set_.fetch(*reg_);
+            auto& draw_set = draw_sets_->draw_set();
+
+            views_.clear();
+            view_mats_.clear();
+            this->collect_views(views_, view_mats_, *reg_, *shadow_maps_);
+            draw_set.cull(views_, culled_);
+
+            // Groups of view `i` are in [view_groups_[i], view_groups_[i + 1])
+            inst_groups_.clear();
+            view_groups_.clear();
+            for (size_t i = 0; i < views_.size(); ++i) {
+                view_groups_.push_back(inst_groups_.add(
+                    draw_set, culled_.view(i).opa_, view_mats_[i]
+                ));
+            }
+            view_groups_.push_back(inst_groups_.groups().size());
+            inst_buf_->upload(ctxt_->f_index_, inst_groups_.mats());
+
+            const Instancing inst{
+                inst_groups_, view_groups_, *inst_pipe_, *inst_buf_
+            };
 
+            size_t view_idx = 0;
             mirinae::begin_cmdbuf(cmdbuf_, DEBUG_LABEL);
             this->record_dlight(
-                cmdbuf_, draw_set_, *rp_, *ctxt_, *reg_, shadow_maps_->dlights()
+                cmdbuf_,
+                draw_set,
+                culled_,
+                inst,
+                view_idx,
+                *rp_,
+                *ctxt_,
+                *reg_,
+                shadow_maps_->dlights()
             );
             this->record_slight(
-                cmdbuf_, draw_set_, *rp_, *ctxt_, *reg_, *shadow_maps_
+                cmdbuf_,
+                draw_set,
+                culled_,
+                inst,
+                view_idx,
+                *rp_,
+                *ctxt_,
+                *reg_,
+                *shadow_maps_
             );
             mirinae::end_cmdbuf(cmdbuf_, DEBUG_LABEL);
         }
 
+        struct Instancing {
+            const mirinae::InstanceGroups& groups_;
+            const std::vector<size_t>& view_groups_;
+            const ::InstPipeline& pipe_;
+            const mirinae::InstanceBuffer& buf_;
+        };
+
+        static glm::dmat4 make_slight_mat(
+            const mirinae::cpnt::SLight& slight,
+            const entt::entity e,
+            const entt::registry& reg
+        ) {
+            auto light_mat = slight.make_proj_mat();
+            if (auto tform = reg.try_get<mirinae::cpnt::Transform>(e))
+                light_mat = light_mat * tform->make_view_mat();
+            return light_mat;
+        }
+
+        // Same order as the views are recorded in. Depth planes are not
+        // tested since casters outside of them are clamped.
+        static void collect_views(
+            std::vector<mirinae::FrustumPlanes>& out,
+            std::vector<glm::dmat4>& out_mats,
+            const entt::registry& reg,
+            const mirinae::ShadowMapBundle& shadow_maps
+        ) {
+            auto& dlights = shadow_maps.dlights();
+            for (uint32_t i = 0; i < dlights.count(); ++i) {
+                const auto e = dlights.at(i).entt();
+                auto dlight = reg.try_get<mirinae::cpnt::DLight>(e);
+                if (!dlight)
+                    continue;
+
+                for (auto& cascade : dlight->cascades_.cascades_) {
+                    out.emplace_back().set(cascade.light_mat_, false);
+                    out_mats.push_back(cascade.light_mat_);
+                }
+            }
+
+            for (auto& shadow : shadow_maps.slights_) {
+                const auto e = shadow.entt_;
+                auto slight = reg.try_get<mirinae::cpnt::SLight>(e);
+                if (!slight)
+                    continue;
+
+                const auto light_mat = make_slight_mat(*slight, e, reg);
+                out.emplace_back().set(light_mat, false);
+                out_mats.push_back(light_mat);
+            }
+        }
+
         static void record_dlight(
             const VkCommandBuffer cmdbuf,
             const mirinae::DrawSetStatic& draw_set,
+            const mirinae::DrawSetStatic::CullResult& culled,
+            const Instancing& inst,
+            size_t& view_idx,
             const mirinae::IRenPass& rp,
             const mirinae::RpCtxt& ctxt,
             const entt::registry& reg,
@@ -230,38 +349,20 @@ namespace { namespace task {
                     rp_info.fbuf(shadow.fbuf(ctxt.f_index_, layer))
                         .record_begin(cmdbuf);
 
-                    vkCmdBindPipeline(
-                        cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, rp.pipeline()
-                    );
                     vkCmdSetDepthBias(cmdbuf, -10, 0, -5);
 
                     viewport.record_single(cmdbuf);
                     rect2d.record_scissor(cmdbuf);
 
-                    for (auto& pair : draw_set.opa()) {
-                        auto& unit = *pair.unit_;
-                        auto& actor = *pair.actor_;
-
-                        unit.record_bind_vert_buf(cmdbuf);
-
-                        descset_info
-                            .set(actor.get_desc_set(ctxt.f_index_.get()))
-                            .record(cmdbuf);
-
-                        mirinae::U_ShadowPushConst push_const;
-                        push_const.pvm_ = cascade.light_mat_ * pair.model_mat_;
+                    record_instanced(cmdbuf, inst, view_idx, ctxt);
+                    auto& view = culled.view(view_idx++);
 
-                        mirinae::PushConstInfo{}
-                            .layout(rp.pipe_layout())
-                            .add_stage_vert()
-                            .record(cmdbuf, push_const);
-
-                        vkCmdDrawIndexed(
-                            cmdbuf, unit.vertex_count(), 1, 0, 0, 0
-                        );
-                    }
+                    vkCmdBindPipeline(
+                        cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, rp.pipeline()
+                    );
 
-                    for (auto& pair : draw_set.skin_opa()) {
+                    for (auto i : view.skin_opa_) {
+                        auto& pair = draw_set.skin_opa()[i];
                         auto& unit = *pair.unit_;
                         auto& actor = *pair.actor_;
                         auto& ac_unit = actor.get_runit(pair.runit_idx_);
@@ -273,10 +374,12 @@ namespace { namespace task {
 
                         descset_info.first_set(0)
                             .set(actor.get_descset(ctxt.f_index_))
+                            .dyn_offset(actor.ubuf_offset(ctxt.f_index_))
                             .record(cmdbuf);
 
                         mirinae::U_ShadowPushConst push_const;
-                        push_const.pvm_ = cascade.light_mat_ * pair.model_mat_;
+                        push_const.pvm_ = cascade.light_mat_ *
+                                          draw_set.model_mat(pair);
 
                         mirinae::PushConstInfo{}
                             .layout(rp.pipe_layout())
@@ -296,6 +399,9 @@ namespace { namespace task {
         static void record_slight(
             const VkCommandBuffer cmdbuf,
             const mirinae::DrawSetStatic& draw_set,
+            const mirinae::DrawSetStatic::CullResult& culled,
+            const Instancing& inst,
+            size_t& view_idx,
             const mirinae::IRenPass& rp,
             const mirinae::RpCtxt& ctxt,
             const entt::registry& reg,
@@ -324,9 +430,7 @@ namespace { namespace task {
                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
                     );
 
-                auto light_mat = slight->make_proj_mat();
-                if (auto tform = reg.try_get<mirinae::cpnt::Transform>(e))
-                    light_mat = light_mat * tform->make_view_mat();
+                const auto light_mat = make_slight_mat(*slight, e, reg);
 
                 mirinae::RenderPassBeginInfo{}
                     .rp(rp.render_pass())
@@ -336,9 +440,6 @@ namespace { namespace task {
                     .clear_values(rp.clear_values())
                     .record_begin(cmdbuf);
 
-                vkCmdBindPipeline(
-                    cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, rp.pipeline()
-                );
                 vkCmdSetDepthBias(cmdbuf, 0, 0, -3);
 
                 mirinae::Viewport{}
@@ -348,29 +449,17 @@ namespace { namespace task {
                     .set_wh(shadow.width(), shadow.height())
                     .record_scissor(cmdbuf);
 
-                mirinae::DescSetBindInfo descset_info{ rp.pipe_layout() };
-
-                for (auto& pair : draw_set.opa()) {
-                    auto& unit = *pair.unit_;
-                    auto& actor = *pair.actor_;
-
-                    unit.record_bind_vert_buf(cmdbuf);
+                record_instanced(cmdbuf, inst, view_idx, ctxt);
+                auto& view = culled.view(view_idx++);
 
-                    descset_info.set(actor.get_desc_set(ctxt.f_index_.get()))
-                        .record(cmdbuf);
-
-                    mirinae::U_ShadowPushConst push_const;
-                    push_const.pvm_ = light_mat * pair.model_mat_;
-
-                    mirinae::PushConstInfo{}
-                        .layout(rp.pipe_layout())
-                        .add_stage_vert()
-                        .record(cmdbuf, push_const);
+                vkCmdBindPipeline(
+                    cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, rp.pipeline()
+                );
 
-                    vkCmdDrawIndexed(cmdbuf, unit.vertex_count(), 1, 0, 0, 0);
-                }
+                mirinae::DescSetBindInfo descset_info{ rp.pipe_layout() };
 
-                for (auto& pair : draw_set.skin_opa()) {
+                for (auto i : view.skin_opa_) {
+                    auto& pair = draw_set.skin_opa()[i];
                     auto& unit = *pair.unit_;
                     auto& actor = *pair.actor_;
                     auto& ac_unit = actor.get_runit(pair.runit_idx_);
@@ -381,10 +470,11 @@ namespace { namespace task {
                     mirinae::bind_idx_buf(cmdbuf, unit.vk_buffers().idx());
 
                     descset_info.set(actor.get_descset(ctxt.f_index_))
+                        .dyn_offset(actor.ubuf_offset(ctxt.f_index_))
                         .record(cmdbuf);
 
                     mirinae::U_ShadowPushConst push_const;
-                    push_const.pvm_ = light_mat * pair.model_mat_;
+                    push_const.pvm_ = light_mat * draw_set.model_mat(pair);
 
                     mirinae::PushConstInfo{}
                         .layout(rp.pipe_layout())
@@ -398,14 +488,59 @@ namespace { namespace task {
             }
         }
 
+        static void record_instanced(
+            const VkCommandBuffer cmdbuf,
+            const Instancing& inst,
+            const size_t view_idx,
+            const mirinae::RpCtxt& ctxt
+        ) {
+            const auto begin = inst.view_groups_.at(view_idx);
+            const auto end = inst.view_groups_.at(view_idx + 1);
+            if (begin == end)
+                return;
+
+            vkCmdBindPipeline(
+                cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, inst.pipe_.pipeline()
+            );
+
+            mirinae::DescSetBindInfo{ inst.pipe_.pipe_layout() }
+                .set(inst.buf_.descset(ctxt.f_index_))
+                .record(cmdbuf);
+
+            mirinae::GeometryBindCache geo_binds;
+            for (auto i = begin; i < end; ++i) {
+                auto& group = inst.groups_.groups()[i];
+                auto& unit = *group.unit_;
+
+                unit.record_bind_vert_buf(cmdbuf, geo_binds);
+
+                vkCmdDrawIndexed(
+                    cmdbuf,
+                    unit.vertex_count(),
+                    group.count_,
+                    unit.first_index(),
+                    unit.vertex_offset(),
+                    group.first_
+                );
+            }
+        }
+
         const mirinae::DebugLabel DEBUG_LABEL{
             "Shadow Static", 0.38, 0.38, 0.38
         };
 
         mirinae::FenceTask fence_;
-        mirinae::DrawSetStatic draw_set_;
+        mirinae::DrawSetStatic::CullResult culled_;
+        mirinae::InstanceGroups inst_groups_;
+        std::vector<mirinae::FrustumPlanes> views_;
+        std::vector<glm::dmat4> view_mats_;
+        std::vector<size_t> view_groups_;
         VkCommandBuffer cmdbuf_ = VK_NULL_HANDLE;
 
+        const mirinae::DrawSetCache* draw_sets_ = nullptr;
+        const ::InstPipeline* inst_pipe_ = nullptr;
+        mirinae::InstanceBuffer* inst_buf_ = nullptr;
+
         const mirinae::ShadowMapBundle* shadow_maps_ = nullptr;
         const entt::registry* reg_ = nullptr;
         const mirinae::IRenPass* rp_ = nullptr;
@@ -422,13 +557,25 @@ namespace { namespace task {
 
         void init(
             const entt::registry& reg,
+            const mirinae::DrawSetCache& draw_sets,
             const mirinae::IRenPass& rp,
+            const ::InstPipeline& inst_pipe,
+            mirinae::InstanceBuffer& inst_buf,
             mirinae::ShadowMapBundle& shadow_maps,
             mirinae::RpCommandPool& cmd_pool,
             mirinae::VulkanDevice& device
         ) {
             update_tasks_.init(reg, shadow_maps);
-            record_tasks_.init(reg, rp, shadow_maps, cmd_pool, device);
+            record_tasks_.init(
+                reg,
+                draw_sets,
+                rp,
+                inst_pipe,
+                inst_buf,
+                shadow_maps,
+                cmd_pool,
+                device
+            );
         }
 
         std::string_view name() const override { return "shadow static"; }
@@ -465,6 +612,40 @@ namespace { namespace task {
 // Shadow static
 namespace {
 
+    VkPipeline create_pipeline(
+        const char* vert_path,
+        const char* frag_path,
+        VkRenderPass render_pass,
+        VkPipelineLayout pipe_layout,
+        mirinae::VulkanDevice& device
+    ) {
+        mirinae::PipelineBuilder builder{ device };
+
+        builder.shader_stages().add_vert(vert_path).add_frag(frag_path);
+
+        using Vertex = mirinae::VertexStatic;
+        builder.vertex_input_state()
+            .add_binding<Vertex>()
+            .add_attrib_vec3(offsetof(Vertex, pos_))
+            .add_attrib_vec2(offsetof(Vertex, texcoord_));
+
+        builder.rasterization_state()
+            .depth_clamp_enable(device.features().depthClamp)
+            .depth_bias(0, 1);
+
+        builder.depth_stencil_state()
+            .depth_test_enable(true)
+            .depth_write_enable(true);
+
+        builder.dynamic_state()
+            .add(VK_DYNAMIC_STATE_DEPTH_BIAS)
+            .add_viewport()
+            .add_scissor();
+
+        return builder.build(render_pass, pipe_layout);
+    }
+
+
     class RpStatesShadowStatic
         : public mirinae::IRpBase
         , public mirinae::RenPassBundle<1> {
@@ -475,7 +656,10 @@ namespace {
             mirinae::RpResources& rp_res,
             mirinae::VulkanDevice& device
         )
-            : device_(device), cosmos_(cosmos), rp_res_(rp_res) {
+            : device_(device)
+            , cosmos_(cosmos)
+            , rp_res_(rp_res)
+            , inst_buf_(device) {
             auto shadow_maps = dynamic_cast<mirinae::ShadowMapBundle*>(
                 rp_res_.shadow_maps_.get()
             );
@@ -509,32 +693,30 @@ namespace {
 
             // Pipeline
             {
-                mirinae::PipelineBuilder builder{ device };
-
-                builder.shader_stages()
-                    .add_vert(":asset/spv/shadow_static_vert.spv")
-                    .add_frag(":asset/spv/shadow_static_frag.spv");
-
-                using Vertex = mirinae::VertexStatic;
-                builder.vertex_input_state()
-                    .add_binding<Vertex>()
-                    .add_attrib_vec3(offsetof(Vertex, pos_))
-                    .add_attrib_vec2(offsetof(Vertex, texcoord_));
-
-                builder.rasterization_state()
-                    .depth_clamp_enable(device.features().depthClamp)
-                    .depth_bias(0, 1);
-
-                builder.depth_stencil_state()
-                    .depth_test_enable(true)
-                    .depth_write_enable(true);
+                pipeline_ = ::create_pipeline(
+                    ":asset/spv/shadow_static_vert.spv",
+                    ":asset/spv/shadow_static_frag.spv",
+                    render_pass_.get(),
+                    pipe_layout_,
+                    device
+                );
+            }
 
-                builder.dynamic_state()
-                    .add(VK_DYNAMIC_STATE_DEPTH_BIAS)
-                    .add_viewport()
-                    .add_scissor();
+            // Instanced pipeline
+            {
+                mirinae::PipelineLayoutBuilder{}
+                    .desc(rp_res.desclays_.get("gbuf:instances").layout())
+                    .build(inst_pipe_.pipe_layout_, device);
+
+                inst_pipe_.pipeline_ = ::create_pipeline(
+                    ":asset/spv/shadow_static_inst_vert.spv",
+                    ":asset/spv/shadow_static_inst_frag.spv",
+                    render_pass_.get(),
+                    inst_pipe_.pipe_layout_,
+                    device
+                );
 
-                pipeline_ = builder.build(render_pass_.get(), pipe_layout_);
+                inst_buf_.init(mirinae::MAX_FRAMES_IN_FLIGHT, rp_res.desclays_);
             }
 
             // Misc
@@ -547,6 +729,7 @@ namespace {
         }
 
         ~RpStatesShadowStatic() override {
+            inst_pipe_.destroy(device_);
             this->destroy_render_pass_elements(device_);
         }
 
@@ -559,7 +742,14 @@ namespace {
 
             auto out = std::make_unique<task::RpTask>();
             out->init(
-                cosmos_.reg(), *this, *shadow_maps, rp_res_.cmd_pool_, device_
+                rp_res_.ren_states_.front().reg(),
+                rp_res_.draw_sets_,
+                *this,
+                inst_pipe_,
+                inst_buf_,
+                *shadow_maps,
+                rp_res_.cmd_pool_,
+                device_
             );
             return out;
         }
@@ -568,6 +758,8 @@ namespace {
         mirinae::VulkanDevice& device_;
         mirinae::CosmosSimulator& cosmos_;
         mirinae::RpResources& rp_res_;
+        ::InstPipeline inst_pipe_;
+        mirinae::InstanceBuffer inst_buf_;
     };
 
 }  // namespace
@@ -28,12 +28,14 @@ namespace { namespace task {
 
         void init(
             const entt::registry& reg,
+            const mirinae::DrawSetCache& draw_sets,
             const mirinae::IRenPass& rp,
             const mirinae::ShadowMapBundle& shadow_maps,
             mirinae::RpCommandPool& cmd_pool,
             mirinae::VulkanDevice& device
         ) {
             reg_ = &reg;
+            draw_sets_ = &draw_sets;
             rp_ = &rp;
             shadow_maps_ = &shadow_maps;
             cmd_pool_ = &cmd_pool;
@@ -56,15 +58,14 @@ namespace { namespace task {
             if (cmdbuf_ == VK_NULL_HANDLE)
                 return;
 
-            draw_set_.clear();
-            draw_set_.fetch(*reg_);
+            auto& draw_set = draw_sets_->draw_set();
 
             mirinae::begin_cmdbuf(cmdbuf_, DEBUG_LABEL);
             this->record_dlight(
-                cmdbuf_, draw_set_, *rp_, *ctxt_, *reg_, shadow_maps_->dlights()
+                cmdbuf_, draw_set, *rp_, *ctxt_, *reg_, shadow_maps_->dlights()
             );
             this->record_slight(
-                cmdbuf_, draw_set_, *rp_, *ctxt_, *reg_, *shadow_maps_
+                cmdbuf_, draw_set, *rp_, *ctxt_, *reg_, *shadow_maps_
             );
             mirinae::end_cmdbuf(cmdbuf_, DEBUG_LABEL);
         }
@@ -132,11 +133,12 @@ namespace { namespace task {
                     viewport.record_single(cmdbuf);
                     rect2d.record_scissor(cmdbuf);
 
+                    mirinae::GeometryBindCache geo_binds;
                     for (auto& pair : draw_set.trs()) {
                         auto& unit = *pair.unit_;
                         auto& actor = *pair.actor_;
 
-                        unit.record_bind_vert_buf(cmdbuf);
+                        unit.record_bind_vert_buf(cmdbuf, geo_binds);
 
                         descset_info.first_set(1)
                             .set(unit.get_desc_set(ctxt.f_index_.get()))
@@ -144,10 +146,12 @@ namespace { namespace task {
 
                         descset_info.first_set(0)
                             .set(actor.get_desc_set(ctxt.f_index_.get()))
+                            .dyn_offset(actor.ubuf_offset(ctxt.f_index_.get()))
                             .record(cmdbuf);
 
                         mirinae::U_ShadowPushConst push_const;
-                        push_const.pvm_ = cascade.light_mat_ * pair.model_mat_;
+                        push_const.pvm_ = cascade.light_mat_ *
+                                          draw_set.model_mat(pair);
 
                         mirinae::PushConstInfo{}
                             .layout(rp.pipe_layout())
@@ -155,7 +159,12 @@ namespace { namespace task {
                             .record(cmdbuf, push_const);
 
                         vkCmdDrawIndexed(
-                            cmdbuf, unit.vertex_count(), 1, 0, 0, 0
+                            cmdbuf,
+                            unit.vertex_count(),
+                            1,
+                            unit.first_index(),
+                            unit.vertex_offset(),
+                            0
                         );
                     }
 
@@ -175,10 +184,12 @@ namespace { namespace task {
 
                         descset_info.first_set(0)
                             .set(actor.get_descset(ctxt.f_index_))
+                            .dyn_offset(actor.ubuf_offset(ctxt.f_index_))
                             .record(cmdbuf);
 
                         mirinae::U_ShadowPushConst push_const;
-                        push_const.pvm_ = cascade.light_mat_ * pair.model_mat_;
+                        push_const.pvm_ = cascade.light_mat_ *
+                                          draw_set.model_mat(pair);
 
                         mirinae::PushConstInfo{}
                             .layout(rp.pipe_layout())
@@ -252,14 +263,16 @@ namespace { namespace task {
 
                 mirinae::DescSetBindInfo descset_info{ rp.pipe_layout() };
 
+                mirinae::GeometryBindCache geo_binds;
                 for (auto& pair : draw_set.trs()) {
                     auto& unit = *pair.unit_;
                     auto& actor = *pair.actor_;
 
-                    unit.record_bind_vert_buf(cmdbuf);
+                    unit.record_bind_vert_buf(cmdbuf, geo_binds);
 
                     descset_info.first_set(0)
                         .set(actor.get_desc_set(ctxt.f_index_.get()))
+                        .dyn_offset(actor.ubuf_offset(ctxt.f_index_.get()))
                         .record(cmdbuf);
 
                     descset_info.first_set(1)
@@ -267,14 +280,21 @@ namespace { namespace task {
                         .record(cmdbuf);
 
                     mirinae::U_ShadowPushConst push_const;
-                    push_const.pvm_ = light_mat * pair.model_mat_;
+                    push_const.pvm_ = light_mat * draw_set.model_mat(pair);
 
                     mirinae::PushConstInfo{}
                         .layout(rp.pipe_layout())
                         .add_stage_vert()
                         .record(cmdbuf, push_const);
 
-                    vkCmdDrawIndexed(cmdbuf, unit.vertex_count(), 1, 0, 0, 0);
+                    vkCmdDrawIndexed(
+                        cmdbuf,
+                        unit.vertex_count(),
+                        1,
+                        unit.first_index(),
+                        unit.vertex_offset(),
+                        0
+                    );
                 }
 
                 for (auto& pair : draw_set.skin_trs()) {
@@ -289,6 +309,7 @@ namespace { namespace task {
 
                     descset_info.first_set(0)
                         .set(actor.get_descset(ctxt.f_index_))
+                        .dyn_offset(actor.ubuf_offset(ctxt.f_index_))
                         .record(cmdbuf);
 
                     descset_info.first_set(1)
@@ -296,7 +317,7 @@ namespace { namespace task {
                         .record(cmdbuf);
 
                     mirinae::U_ShadowPushConst push_const;
-                    push_const.pvm_ = light_mat * pair.model_mat_;
+                    push_const.pvm_ = light_mat * draw_set.model_mat(pair);
 
                     mirinae::PushConstInfo{}
                         .layout(rp.pipe_layout())
@@ -315,11 +336,11 @@ namespace { namespace task {
         };
 
         mirinae::FenceTask fence_;
-        mirinae::DrawSetStatic draw_set_;
         VkCommandBuffer cmdbuf_ = VK_NULL_HANDLE;
 
         const mirinae::ShadowMapBundle* shadow_maps_ = nullptr;
         const entt::registry* reg_ = nullptr;
+        const mirinae::DrawSetCache* draw_sets_ = nullptr;
         const mirinae::IRenPass* rp_ = nullptr;
         const mirinae::RpCtxt* ctxt_ = nullptr;
         mirinae::RpCommandPool* cmd_pool_ = nullptr;
@@ -334,12 +355,15 @@ namespace { namespace task {
 
         void init(
             const entt::registry& reg,
+            const mirinae::DrawSetCache& draw_sets,
             const mirinae::IRenPass& rp,
             const mirinae::ShadowMapBundle& shadow_maps,
             mirinae::RpCommandPool& cmd_pool,
             mirinae::VulkanDevice& device
         ) {
-            record_tasks_.init(reg, rp, shadow_maps, cmd_pool, device);
+            record_tasks_.init(
+                reg, draw_sets, rp, shadow_maps, cmd_pool, device
+            );
         }
 
         std::string_view name() const override {
@@ -465,7 +489,12 @@ namespace {
 
             auto out = std::make_unique<task::RpTask>();
             out->init(
-                cosmos_.reg(), *this, *shadow_maps, rp_res_.cmd_pool_, device_
+                rp_res_.ren_states_.front().reg(),
+                rp_res_.draw_sets_,
+                *this,
+                *shadow_maps,
+                rp_res_.cmd_pool_,
+                device_
             );
             return out;
         }
@@ -359,7 +359,11 @@ namespace {
 
             auto out = std::make_unique<task::RpTask>();
             out->init(
-                cosmos_.reg(), *this, *shadow_maps, rp_res_.cmd_pool_, device_
+                rp_res_.ren_states_.front().reg(),
+                *this,
+                *shadow_maps,
+                rp_res_.cmd_pool_,
+                device_
             );
             return out;
         }
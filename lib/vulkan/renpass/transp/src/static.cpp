@@ -168,6 +168,7 @@ namespace {
 
         void init(
             const entt::registry& reg,
+            const mirinae::DrawSetCache& draw_sets,
             const mirinae::FbufImageBundle& gbufs,
             const mirinae::IRenPass& rp,
             const mirinae::IShadowMapBundle& shadows,
@@ -177,6 +178,7 @@ namespace {
         ) {
             cmd_pool_ = &cmd_pool;
             device_ = &device;
+            draw_sets_ = &draw_sets;
             frame_data_ = &frame_data;
             gbufs_ = &gbufs;
             reg_ = &reg;
@@ -203,13 +205,12 @@ namespace {
             auto& fd = frame_data_->at(ctxt_->f_index_.get());
             const auto fbuf_ext = gbufs_->extent();
 
-            draw_set_.clear();
-            draw_set_.fetch(*reg_);
+            auto& draw_set = draw_sets_->draw_set();
 
             mirinae::begin_cmdbuf(cmdbuf_, DEBUG_LABEL);
             this->update_ubuf(*reg_, *shadows_, *ctxt_, fd, *device_);
             this->record_barriers(cmdbuf_, *gbufs_, *ctxt_);
-            this->record(cmdbuf_, fd, draw_set_, *rp_, *ctxt_, fbuf_ext);
+            this->record(cmdbuf_, fd, draw_set, *rp_, *ctxt_, fbuf_ext);
             mirinae::end_cmdbuf(cmdbuf_, DEBUG_LABEL);
         }
 
@@ -331,11 +332,12 @@ namespace {
             mirinae::DescSetBindInfo descset_info{ rp.pipe_layout() };
             descset_info.first_set(0).set(fd.desc_).record(cmdbuf);
 
+            mirinae::GeometryBindCache geo_binds;
             for (auto& pair : draw_set.trs()) {
                 auto& unit = *pair.unit_;
                 auto& actor = *pair.actor_;
 
-                unit.record_bind_vert_buf(cmdbuf);
+                unit.record_bind_vert_buf(cmdbuf, geo_binds);
 
                 descset_info.first_set(1)
                     .set(unit.get_desc_set(ctxt.f_index_.get()))
@@ -343,9 +345,17 @@ namespace {
 
                 descset_info.first_set(2)
                     .set(actor.get_desc_set(ctxt.f_index_.get()))
+                    .dyn_offset(actor.ubuf_offset(ctxt.f_index_.get()))
                     .record(cmdbuf);
 
-                vkCmdDrawIndexed(cmdbuf, unit.vertex_count(), 1, 0, 0, 0);
+                vkCmdDrawIndexed(
+                    cmdbuf,
+                    unit.vertex_count(),
+                    1,
+                    unit.first_index(),
+                    unit.vertex_offset(),
+                    0
+                );
             }
 
             for (auto& pair : draw_set.skin_trs()) {
@@ -364,6 +374,7 @@ namespace {
 
                 descset_info.first_set(2)
                     .set(actor.get_descset(ctxt.f_index_))
+                    .dyn_offset(actor.ubuf_offset(ctxt.f_index_))
                     .record(cmdbuf);
 
                 vkCmdDrawIndexed(cmdbuf, unit.vertex_count(), 1, 0, 0, 0);
@@ -377,10 +388,10 @@ namespace {
         };
 
         mirinae::FenceTask fence_;
-        mirinae::DrawSetStatic draw_set_;
         VkCommandBuffer cmdbuf_ = VK_NULL_HANDLE;
 
         const entt::registry* reg_ = nullptr;
+        const mirinae::DrawSetCache* draw_sets_ = nullptr;
         const mirinae::FbufImageBundle* gbufs_ = nullptr;
         const mirinae::IRenPass* rp_ = nullptr;
         const mirinae::IShadowMapBundle* shadows_ = nullptr;
@@ -396,6 +407,7 @@ namespace {
     public:
         void init(
             const entt::registry& reg,
+            const mirinae::DrawSetCache& draw_sets,
             const mirinae::FbufImageBundle& gbufs,
             const mirinae::IRenPass& rp,
             const mirinae::IShadowMapBundle& shadows,
@@ -404,7 +416,14 @@ namespace {
             mirinae::VulkanDevice& device
         ) {
             record_tasks_.init(
-                reg, gbufs, rp, shadows, frame_data, cmd_pool, device
+                reg,
+                draw_sets,
+                gbufs,
+                rp,
+                shadows,
+                frame_data,
+                cmd_pool,
+                device
             );
         }
 
@@ -672,7 +691,8 @@ namespace {
         std::unique_ptr<mirinae::IRpTask> create_task() override {
             auto task = std::make_unique<RpTask>();
             task->init(
-                cosmos_.reg(),
+                rp_res_.ren_states_.front().reg(),
+                rp_res_.draw_sets_,
                 rp_res_.gbuf_,
                 *this,
                 *rp_res_.shadow_maps_,
@@ -0,0 +1,555 @@
+// Runs the simulation stages of `CosmosSimulator` without a renderer and
+// reports frame statistics as JSON, on stdout or in the `out` file.
+// Exits with 2 if `max_frame_ms` is given and the p95 frame time exceeds it.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <fmt/format.h>
+#include <entt/entity/registry.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <sung/basic/os_detect.hpp>
+
+#include "mirinae/cosmos.hpp"
+#include "mirinae/cpnt/light.hpp"
+#include "mirinae/cpnt/ocean.hpp"
+#include "mirinae/cpnt/ren_model.hpp"
+#include "mirinae/cpnt/transform.hpp"
+#include "mirinae/lightweight/input_proc.hpp"
+#include "mirinae/lightweight/task.hpp"
+#include "mirinae/lua/script.hpp"
+
+#ifdef SUNG_OS_WINDOWS
+    #include <windows.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+
+// Allocation counting
+namespace {
+
+    std::atomic<uint64_t> g_alloc_count = 0;
+    std::atomic<uint64_t> g_alloc_bytes = 0;
+
+    void* counted_alloc(size_t size) {
+        g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+        g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+        if (auto p = std::malloc(size ? size : 1))
+            return p;
+        throw std::bad_alloc{};
+    }
+
+    void* counted_alloc(size_t size, std::align_val_t align) {
+        g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+        g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+        const auto a = static_cast<size_t>(align);
+#ifdef SUNG_OS_WINDOWS
+        if (auto p = _aligned_malloc(size ? size : 1, a))
+            return p;
+#else
+        // Size must be a multiple of the alignment
+        const auto rounded = (std::max<size_t>(size, 1) + a - 1) / a * a;
+        if (auto p = std::aligned_alloc(a, rounded))
+            return p;
+#endif
+        throw std::bad_alloc{};
+    }
+
+    void aligned_free(void* p) {
+#ifdef SUNG_OS_WINDOWS
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+
+}  // namespace
+
+void* operator new(size_t size) { return ::counted_alloc(size); }
+void* operator new[](size_t size) { return ::counted_alloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+void* operator new(size_t size, std::align_val_t align) {
+    return ::counted_alloc(size, align);
+}
+void* operator new[](size_t size, std::align_val_t align) {
+    return ::counted_alloc(size, align);
+}
+void operator delete(void* p, std::align_val_t) noexcept {
+    ::aligned_free(p);
+}
+void operator delete[](void* p, std::align_val_t) noexcept {
+    ::aligned_free(p);
+}
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    ::aligned_free(p);
+}
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    ::aligned_free(p);
+}
+
+
+namespace {
+
+    struct BenchConfig {
+        size_t frames_ = 600;
+        size_t warmup_ = 60;
+        size_t skinned_ = 200;
+        size_t joints_ = 64;
+        size_t bodies_ = 1000;
+        size_t oceans_ = 1;
+        size_t lights_ = 16;
+        size_t transforms_ = 10000;
+        // Zero disables the check
+        size_t max_frame_ms_ = 0;
+        std::string out_;
+    };
+
+    void print_usage() {
+        fmt::print(
+            stderr,
+            "Usage: mirinae_bench_sim [key=value]...\n"
+            "  Counts: frames, warmup, skinned, joints, bodies, oceans, "
+            "lights, transforms\n"
+            "  max_frame_ms: fail if the p95 frame time is over this\n"
+            "  out: write the report to this file instead of stdout\n"
+        );
+    }
+
+    bool parse_args(int argc, char** argv, BenchConfig& cfg) {
+        std::map<std::string, size_t*> numbers{
+            { "frames", &cfg.frames_ },   { "warmup", &cfg.warmup_ },
+            { "skinned", &cfg.skinned_ }, { "joints", &cfg.joints_ },
+            { "bodies", &cfg.bodies_ },   { "oceans", &cfg.oceans_ },
+            { "lights", &cfg.lights_ },   { "transforms", &cfg.transforms_ },
+            { "max_frame_ms", &cfg.max_frame_ms_ },
+        };
+
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const auto eq = arg.find('=');
+            if (eq == std::string::npos) {
+                fmt::print(stderr, "Invalid argument: {}\n", arg);
+                return false;
+            }
+
+            const auto key = arg.substr(0, eq);
+            const auto value = arg.substr(eq + 1);
+            if (key == "out") {
+                cfg.out_ = value;
+            } else if (auto it = numbers.find(key); it != numbers.end()) {
+                const auto end = value.data() + value.size();
+                const auto [ptr, ec] = std::from_chars(
+                    value.data(), end, *it->second
+                );
+                if (ec != std::errc{} || ptr != end) {
+                    fmt::print(stderr, "Invalid number: {}\n", arg);
+                    return false;
+                }
+            } else {
+                fmt::print(stderr, "Unknown option: {}\n", key);
+                return false;
+            }
+        }
+
+        cfg.frames_ = std::max<size_t>(cfg.frames_, 1);
+        cfg.joints_ = std::max<size_t>(cfg.joints_, 1);
+        return true;
+    }
+
+
+    double cpu_time_sec() {
+#ifdef SUNG_OS_WINDOWS
+        FILETIME creation, exit, kernel, user;
+        GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+        const auto to_u64 = [](const FILETIME& t) {
+            return (uint64_t(t.dwHighDateTime) << 32) | t.dwLowDateTime;
+        };
+        return (to_u64(kernel) + to_u64(user)) * 1e-7;
+#else
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        const auto to_sec = [](const timeval& t) {
+            return t.tv_sec + t.tv_usec * 1e-6;
+        };
+        return to_sec(usage.ru_utime) + to_sec(usage.ru_stime);
+#endif
+    }
+
+
+    mirinae::HSkelAnim make_skel_anim(size_t joint_count) {
+        constexpr size_t KEY_COUNT = 120;
+
+        auto out = std::make_shared<mirinae::SkelAnimPair>();
+        for (size_t i = 0; i < joint_count; i++) {
+            auto& joint = out->skel_.joints_.emplace_back();
+            joint.name_ = "joint" + std::to_string(i);
+            joint.parent_index_ = static_cast<dal::jointID_t>(i) - 1;
+            joint.offset_mat_ = glm::translate(
+                glm::mat4{ 1 }, glm::vec3{ 0, -static_cast<float>(i), 0 }
+            );
+        }
+
+        auto& anim = out->anims_.emplace_back();
+        anim.name_ = "wave";
+        anim.ticks_per_sec_ = 30;
+        for (size_t i = 0; i < joint_count; i++) {
+            auto& joint = anim.joints_.emplace_back();
+            joint.name_ = "joint" + std::to_string(i);
+            for (size_t k = 0; k < KEY_COUNT; k++) {
+                const auto t = static_cast<float>(k);
+                const auto angle = std::sin(t * 0.1f + i) * 0.5f;
+                const auto rot = glm::angleAxis(angle, glm::vec3{ 0, 0, 1 });
+                joint.translations_.emplace_back(t, glm::vec3{ 0, 1, 0 });
+                joint.rotations_.emplace_back(t, rot);
+                joint.scales_.emplace_back(t, 1.f);
+            }
+        }
+
+        out->compile();
+        return out;
+    }
+
+
+    // Flat grid of triangles, used as the ground collider
+    class GridModel : public mirinae::IRenModel {
+
+    public:
+        GridModel(int cells, float cell_size)
+            : cells_(cells), cell_size_(cell_size) {}
+
+        bool is_ready() const override { return true; }
+
+        void access_positions(mirinae::IModelAccessor& acc) const override {
+            const auto half = cells_ * cell_size_ * 0.5f;
+            for (int x = 0; x < cells_; ++x) {
+                for (int z = 0; z < cells_; ++z) {
+                    const auto x0 = x * cell_size_ - half;
+                    const auto z0 = z * cell_size_ - half;
+                    const auto x1 = x0 + cell_size_;
+                    const auto z1 = z0 + cell_size_;
+
+                    acc.position(glm::vec3{ x0, 0, z0 });
+                    acc.position(glm::vec3{ x0, 0, z1 });
+                    acc.position(glm::vec3{ x1, 0, z1 });
+                    acc.position(glm::vec3{ x0, 0, z0 });
+                    acc.position(glm::vec3{ x1, 0, z1 });
+                    acc.position(glm::vec3{ x1, 0, z0 });
+                }
+            }
+        }
+
+        size_t ren_unit_count() const override { return 0; }
+        std::string_view ren_unit_name(size_t index) const override {
+            return {};
+        }
+
+    private:
+        int cells_;
+        float cell_size_;
+    };
+
+
+    void populate(mirinae::CosmosSimulator& cosmos, const BenchConfig& cfg) {
+        namespace cpnt = mirinae::cpnt;
+        auto& reg = cosmos.reg();
+        auto& clock = cosmos.scene().clock();
+
+        // Ground
+        {
+            const auto e = reg.create();
+            auto& mdl = reg.emplace<cpnt::MdlActorStatic>(e);
+            mdl.model_path_ = "bench/grid";
+            mdl.model_ = std::make_shared<::GridModel>(64, 4.f);
+            reg.emplace<cpnt::Transform>(e);
+            cosmos.phys_world().give_body_triangles(e, reg);
+        }
+
+        // Stacked in columns so they keep colliding while settling
+        const auto side = static_cast<size_t>(
+            std::ceil(std::sqrt(static_cast<double>(cfg.bodies_) / 8))
+        );
+        for (size_t i = 0; i < cfg.bodies_; ++i) {
+            const auto e = reg.create();
+            auto& tform = reg.emplace<cpnt::Transform>(e);
+            const auto col = i % (side * side);
+            const auto layer = i / (side * side);
+            tform.pos_ = glm::dvec3{
+                (col % side) * 1.1 - side * 0.55,
+                1.0 + layer * 1.1,
+                (col / side) * 1.1 - side * 0.55,
+            };
+            tform.set_scale(0.5);
+            cosmos.phys_world().give_body(e, reg);
+        }
+        cosmos.phys_world().optimize();
+
+        const auto skel_anim = ::make_skel_anim(cfg.joints_);
+        for (size_t i = 0; i < cfg.skinned_; ++i) {
+            const auto e = reg.create();
+            auto& actor = reg.emplace<cpnt::MdlActorSkinned>(e);
+            actor.anim_state_.set_skel_anim(skel_anim);
+            actor.anim_state_.select_anim_index(0, clock);
+            actor.anim_state_.set_play_speed(1.0 + (i % 7) * 0.1);
+
+            auto& tform = reg.emplace<cpnt::Transform>(e);
+            tform.pos_ = glm::dvec3{ i * 2.0, 0, -20 };
+        }
+
+        for (size_t i = 0; i < cfg.oceans_; ++i) {
+            const auto e = reg.create();
+            reg.emplace<cpnt::Ocean>(e);
+        }
+
+        for (size_t i = 0; i < cfg.lights_; ++i) {
+            const auto e = reg.create();
+            auto& tform = reg.emplace<cpnt::Transform>(e);
+            tform.pos_ = glm::dvec3{ i * 5.0, 10, 0 };
+            if (i % 2)
+                reg.emplace<cpnt::SLight>(e).color_.set_scaled_color(10);
+            else
+                reg.emplace<cpnt::VPLight>(e).color_.set_scaled_color(10);
+        }
+
+        for (size_t i = 0; i < cfg.transforms_; ++i) {
+            const auto e = reg.create();
+            auto& tform = reg.emplace<cpnt::Transform>(e);
+            tform.pos_ = glm::dvec3{ i * 0.01, 0, 0 };
+        }
+    }
+
+
+    // Stands in for the CPU side palette sampling done by the renderer
+    class TaskSkinSample : public mirinae::StageTask {
+
+    public:
+        TaskSkinSample(mirinae::CosmosSimulator& cosmos)
+            : StageTask("skin sample"), sample_(cosmos) {
+            sample_.succeed(this);
+            fence_.succeed(&sample_);
+            this->reads("clock").reads("transform");
+            this->writes("anim_state");
+        }
+
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
+            sample_.prepare();
+        }
+
+        enki::ITaskSet* get_fence() override { return &fence_; }
+
+    private:
+        class Sample : public mirinae::DependingTask {
+
+        public:
+            using Actor = mirinae::cpnt::MdlActorSkinned;
+
+            Sample(mirinae::CosmosSimulator& cosmos) : cosmos_(cosmos) {}
+
+            void prepare() {
+                this->set_size(cosmos_.reg().view<Actor>().size());
+            }
+
+            void ExecuteRange(enki::TaskSetPartition r, uint32_t) override {
+                auto& clock = cosmos_.scene().clock();
+                auto view = cosmos_.reg().view<Actor>();
+                auto it = view.begin() + r.start;
+                for (auto i = r.start; i < r.end; ++i, ++it) {
+                    auto& actor = view.get<Actor>(*it);
+                    actor.anim_state_.sample_anim_lod(1, i, clock);
+                }
+            }
+
+        private:
+            mirinae::CosmosSimulator& cosmos_;
+        };
+
+        Sample sample_;
+        mirinae::FenceTask fence_;
+    };
+
+
+    class Percentiles {
+
+    public:
+        void push(double value) { values_.push_back(value); }
+
+        double at(double p) {
+            if (values_.empty())
+                return 0;
+            std::sort(values_.begin(), values_.end());
+            const auto idx = static_cast<size_t>(p * (values_.size() - 1));
+            return values_[idx];
+        }
+
+        double mean() const {
+            if (values_.empty())
+                return 0;
+            double sum = 0;
+            for (auto v : values_) sum += v;
+            return sum / values_.size();
+        }
+
+    private:
+        std::vector<double> values_;
+    };
+
+
+    std::string make_report(
+        const BenchConfig& cfg,
+        std::vector<std::pair<std::string, ::Percentiles>>& stages,
+        double wall_sec,
+        double cpu_sec,
+        uint64_t alloc_count,
+        uint64_t alloc_bytes
+    ) {
+        const auto frames = static_cast<double>(cfg.frames_);
+        const auto threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+        std::string out = "{\n";
+        out += fmt::format(
+            "  \"config\": {{ \"frames\": {}, \"warmup\": {}, "
+            "\"skinned\": {}, \"joints\": {}, \"bodies\": {}, "
+            "\"oceans\": {}, \"lights\": {}, \"transforms\": {} }},\n",
+            cfg.frames_,
+            cfg.warmup_,
+            cfg.skinned_,
+            cfg.joints_,
+            cfg.bodies_,
+            cfg.oceans_,
+            cfg.lights_,
+            cfg.transforms_
+        );
+
+        out += "  \"stages_ms\": {\n";
+        for (size_t i = 0; i < stages.size(); ++i) {
+            auto& [name, p] = stages[i];
+            out += fmt::format(
+                "    \"{}\": {{ \"mean\": {:.4f}, \"p50\": {:.4f}, "
+                "\"p95\": {:.4f}, \"p99\": {:.4f} }}{}\n",
+                name,
+                p.mean(),
+                p.at(0.5),
+                p.at(0.95),
+                p.at(0.99),
+                i + 1 < stages.size() ? "," : ""
+            );
+        }
+        out += "  },\n";
+
+        out += fmt::format(
+            "  \"allocs_per_frame\": {:.1f},\n"
+            "  \"alloc_bytes_per_frame\": {:.1f},\n"
+            "  \"hardware_threads\": {},\n"
+            "  \"cpu_utilisation\": {:.4f}\n",
+            alloc_count / frames,
+            alloc_bytes / frames,
+            threads,
+            cpu_sec / (wall_sec * threads)
+        );
+        out += "}\n";
+        return out;
+    }
+
+}  // namespace
+
+
+int main(int argc, char** argv) {
+    ::BenchConfig cfg;
+    if (!::parse_args(argc, argv, cfg)) {
+        ::print_usage();
+        return 1;
+    }
+
+    mirinae::ScriptEngine script;
+    mirinae::CosmosSimulator cosmos(script);
+    mirinae::InputActionMapper action_map;
+
+    // Exactly one physics step per frame regardless of wall time
+    auto& step_cfg = cosmos.phys_world().step_config();
+    step_cfg.frame_dt_ = 1.0 / step_cfg.step_rate_;
+
+    ::populate(cosmos, cfg);
+
+    mirinae::TaskGraph tasks;
+    tasks.set_pipelined(true);
+    cosmos.register_tasks(tasks, action_map);
+    tasks.emplace_back<::TaskSkinSample>(cosmos);
+
+    for (size_t i = 0; i < cfg.warmup_; ++i) {
+        tasks.start();
+        tasks.wait_all();
+    }
+
+    std::vector<std::pair<std::string, ::Percentiles>> stages;
+    ::Percentiles frame_ms;
+
+    using clock_t = std::chrono::steady_clock;
+    const auto cpu_start = ::cpu_time_sec();
+    const auto alloc_count_start = g_alloc_count.load();
+    const auto alloc_bytes_start = g_alloc_bytes.load();
+    const auto wall_start = clock_t::now();
+
+    for (size_t i = 0; i < cfg.frames_; ++i) {
+        const auto frame_start = clock_t::now();
+        tasks.start();
+        tasks.wait_all();
+        const std::chrono::duration<double, std::milli> frame_dur =
+            clock_t::now() - frame_start;
+        frame_ms.push(frame_dur.count());
+
+        const auto timings = tasks.timings();
+        if (stages.empty()) {
+            for (auto& t : timings) stages.emplace_back(t.name_, Percentiles{});
+        }
+        for (size_t j = 0; j < timings.size(); ++j)
+            stages[j].second.push(timings[j].end_ - timings[j].begin_);
+    }
+
+    const std::chrono::duration<double> wall = clock_t::now() - wall_start;
+    const auto alloc_count = g_alloc_count.load() - alloc_count_start;
+    const auto alloc_bytes = g_alloc_bytes.load() - alloc_bytes_start;
+    const auto cpu_sec = ::cpu_time_sec() - cpu_start;
+
+    const auto frame_p95 = frame_ms.at(0.95);
+    stages.emplace_back("frame", std::move(frame_ms));
+    const auto report = ::make_report(
+        cfg, stages, wall.count(), cpu_sec, alloc_count, alloc_bytes
+    );
+
+    if (cfg.out_.empty()) {
+        fmt::print("{}", report);
+    } else {
+        std::ofstream file(cfg.out_, std::ios::trunc);
+        file << report;
+        if (!file) {
+            fmt::print(stderr, "Failed to write {}\n", cfg.out_);
+            return 1;
+        }
+    }
+
+    if (cfg.max_frame_ms_ > 0 && frame_p95 > cfg.max_frame_ms_) {
+        fmt::print(
+            stderr,
+            "p95 frame time {:.3f} ms is over {} ms\n",
+            frame_p95,
+            cfg.max_frame_ms_
+        );
+        return 2;
+    }
+
+    return 0;
+}
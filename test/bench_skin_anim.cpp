@@ -0,0 +1,101 @@
+#include "mirinae/lightweight/skin_anim.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include <fmt/format.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+
+namespace {
+
+    constexpr size_t JOINT_COUNT = 200;
+    constexpr size_t KEY_COUNT = 10000;
+    constexpr size_t FRAME_COUNT = 600;
+
+
+    mirinae::SkelAnimPair make_skel_anim() {
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<float> dist(-1, 1);
+
+        mirinae::SkelAnimPair out;
+        for (size_t i = 0; i < JOINT_COUNT; i++) {
+            auto& joint = out.skel_.joints_.emplace_back();
+            joint.name_ = "joint" + std::to_string(i);
+            joint.parent_index_ = static_cast<dal::jointID_t>(i) - 1;
+            joint.offset_mat_ = glm::translate(
+                glm::mat4{ 1 }, glm::vec3{ 0, static_cast<float>(i), 0 }
+            );
+        }
+
+        auto& anim = out.anims_.emplace_back();
+        anim.name_ = "mocap";
+        anim.ticks_per_sec_ = 120;
+        for (size_t i = 0; i < JOINT_COUNT; i++) {
+            auto& joint = anim.joints_.emplace_back();
+            joint.name_ = "joint" + std::to_string(i);
+            for (size_t k = 0; k < KEY_COUNT; k++) {
+                const auto t = static_cast<float>(k);
+                const glm::vec3 pos{ dist(rng), dist(rng), dist(rng) };
+                const glm::quat rot{ 1, dist(rng), dist(rng), dist(rng) };
+                joint.translations_.emplace_back(t, pos);
+                joint.rotations_.emplace_back(t, glm::normalize(rot));
+                joint.scales_.emplace_back(t, 1.f);
+            }
+        }
+
+        out.compile();
+        return out;
+    }
+
+    template <typename TFunc>
+    double measure_ms_per_frame(TFunc&& func) {
+        using clock = std::chrono::steady_clock;
+        const auto start = clock::now();
+        for (size_t i = 0; i < FRAME_COUNT; i++) {
+            // Plays through the whole clip, looping once
+            const auto tick = (2.0 * KEY_COUNT * i) / FRAME_COUNT;
+            func(std::fmod(tick, KEY_COUNT - 1.0));
+        }
+        const auto end = clock::now();
+        const std::chrono::duration<double, std::milli> elapsed = end - start;
+        return elapsed.count() / FRAME_COUNT;
+    }
+
+}  // namespace
+
+
+int main() {
+    const auto skel_anim = ::make_skel_anim();
+    const auto& skel = skel_anim.skel_;
+    const auto& anim = skel_anim.anims_.front();
+
+    double checksum = 0;
+    const auto legacy = ::measure_ms_per_frame([&](double tick) {
+        const auto mats = mirinae::make_skinning_matrix(tick, skel, anim);
+        checksum += mats.back()[3][0];
+    });
+
+    std::vector<glm::mat4> palette(JOINT_COUNT);
+    mirinae::AnimCursor cursor;
+    const auto compiled = ::measure_ms_per_frame([&](double tick) {
+        skel_anim.make_skinning_matrix(
+            tick, 0, cursor, palette.data(), palette.size()
+        );
+        checksum -= palette.back()[3][0];
+    });
+
+    fmt::print(
+        "{} joints, {} keys per channel, {} frames\n",
+        JOINT_COUNT,
+        KEY_COUNT,
+        FRAME_COUNT
+    );
+    fmt::print("legacy:   {:8.4f} ms/frame\n", legacy);
+    fmt::print("compiled: {:8.4f} ms/frame\n", compiled);
+    fmt::print("speedup:  {:8.2f}x\n", legacy / compiled);
+    fmt::print("checksum: {}\n", checksum);
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "mirinae/scene/collider_cache.hpp"
+
+#include <fstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <Jolt/Core/Factory.h>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/RegisterTypes.h>
+
+
+namespace {
+
+    class ColliderCacheTest : public ::testing::Test {
+
+    protected:
+        static void SetUpTestSuite() {
+            JPH::RegisterDefaultAllocator();
+            JPH::Factory::sInstance = new JPH::Factory();
+            JPH::RegisterTypes();
+        }
+
+        static void TearDownTestSuite() {
+            JPH::UnregisterTypes();
+            delete JPH::Factory::sInstance;
+            JPH::Factory::sInstance = nullptr;
+        }
+
+        void SetUp() override {
+            dir_ = std::filesystem::temp_directory_path() /
+                   "mirinae_test_collider_cache";
+            std::filesystem::remove_all(dir_);
+        }
+
+        void TearDown() override { std::filesystem::remove_all(dir_); }
+
+        std::vector<std::filesystem::path> list_files() const {
+            std::vector<std::filesystem::path> out;
+            for (auto& entry : std::filesystem::directory_iterator(dir_))
+                out.push_back(entry.path());
+            return out;
+        }
+
+        static uint64_t hash_of(float value) {
+            return mirinae::ColliderHasher{}.add(value).get();
+        }
+
+        std::filesystem::path dir_;
+        JPH::Ref<JPH::Shape> box_ = new JPH::BoxShape(JPH::Vec3(1, 2, 3));
+    };
+
+
+    TEST_F(ColliderCacheTest, RoundTrip) {
+        mirinae::ColliderCache cache(dir_);
+        const auto hash = hash_of(1);
+        EXPECT_EQ(cache.load("box", hash).GetPtr(), nullptr);
+        ASSERT_TRUE(cache.save("box", hash, *box_));
+
+        // A new instance reads what the old one wrote
+        mirinae::ColliderCache reopened(dir_);
+        const auto loaded = reopened.load("box", hash);
+        ASSERT_NE(loaded.GetPtr(), nullptr);
+        ASSERT_EQ(loaded->GetSubType(), JPH::EShapeSubType::Box);
+        const auto& box = static_cast<const JPH::BoxShape&>(*loaded);
+        EXPECT_TRUE(box.GetHalfExtent().IsClose(JPH::Vec3(1, 2, 3)));
+
+        // The temporary file was renamed, not left behind
+        const auto files = this->list_files();
+        ASSERT_EQ(files.size(), 1);
+        EXPECT_EQ(files[0].extension(), ".jshape");
+    }
+
+    TEST_F(ColliderCacheTest, SourceChangeMisses) {
+        mirinae::ColliderCache cache(dir_);
+        ASSERT_TRUE(cache.save("box", hash_of(1), *box_));
+        EXPECT_EQ(cache.load("box", hash_of(2)).GetPtr(), nullptr);
+        EXPECT_EQ(cache.load("other", hash_of(1)).GetPtr(), nullptr);
+
+        // Saving again replaces the stale entry
+        ASSERT_TRUE(cache.save("box", hash_of(2), *box_));
+        EXPECT_NE(cache.load("box", hash_of(2)).GetPtr(), nullptr);
+        EXPECT_EQ(cache.load("box", hash_of(1)).GetPtr(), nullptr);
+        EXPECT_EQ(this->list_files().size(), 1);
+    }
+
+    TEST_F(ColliderCacheTest, RejectsBadHeader) {
+        mirinae::ColliderCache cache(dir_);
+        ASSERT_TRUE(cache.save("box", hash_of(1), *box_));
+
+        const auto files = this->list_files();
+        ASSERT_EQ(files.size(), 1);
+        {
+            std::fstream file(files[0], std::ios::in | std::ios::out);
+            file.write("MRNCOL00", 8);
+        }
+        EXPECT_EQ(cache.load("box", hash_of(1)).GetPtr(), nullptr);
+
+        // Truncated right after the magic
+        {
+            std::ofstream file(files[0], std::ios::trunc);
+            file.write("MRNCOL01", 8);
+        }
+        EXPECT_EQ(cache.load("box", hash_of(1)).GetPtr(), nullptr);
+    }
+
+}  // namespace
@@ -0,0 +1,132 @@
+#include "mirinae/math/cull.hpp"
+
+#include <random>
+
+#include <gtest/gtest.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+
+namespace {
+
+    glm::dmat4 make_clip() {
+        auto proj = glm::perspectiveRH_ZO(glm::radians(60.0), 1.5, 0.1, 100.0);
+        proj[1][1] *= -1;
+        const auto view = glm::lookAtRH(
+            glm::dvec3{ 3, 2, 5 }, glm::dvec3{ 0 }, glm::dvec3{ 0, 1, 0 }
+        );
+        return proj * view;
+    }
+
+    mirinae::BoundingSphere make_sphere(float x, float y, float z, float r) {
+        mirinae::BoundingSphere out;
+        out.center_ = glm::vec3{ x, y, z };
+        out.radius_ = r;
+        return out;
+    }
+
+}  // namespace
+
+
+TEST(Cull, SphereAgainstFrustum) {
+    mirinae::FrustumPlanes frustum;
+    frustum.set(::make_clip());
+
+    EXPECT_TRUE(frustum.test(::make_sphere(0, 0, 0, 0.1f)));
+    EXPECT_FALSE(frustum.test(::make_sphere(-30, 0, 0, 1)));
+    EXPECT_TRUE(frustum.test(::make_sphere(-30, 0, 0, 40)));
+    // Behind the camera
+    EXPECT_FALSE(frustum.test(::make_sphere(6, 4, 10, 1)));
+
+    frustum.set(::make_clip(), false);
+    EXPECT_EQ(frustum.count_, 4u);
+    // Beyond the far plane but inside the side planes
+    EXPECT_TRUE(frustum.test(::make_sphere(-300, -200, -500, 1)));
+}
+
+
+TEST(Cull, TransformScalesRadius) {
+    const auto m = glm::scale(
+        glm::translate(glm::dmat4{ 1 }, glm::dvec3{ 1, 2, 3 }),
+        glm::dvec3{ 1, 4, 2 }
+    );
+    const auto s = ::make_sphere(1, 0, 0, 0.5f).transform(m);
+
+    EXPECT_FLOAT_EQ(s.center_.x, 2);
+    EXPECT_FLOAT_EQ(s.center_.y, 2);
+    EXPECT_FLOAT_EQ(s.center_.z, 3);
+    EXPECT_FLOAT_EQ(s.radius_, 2);
+}
+
+
+TEST(Cull, BatchMatchesScalar) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-50, 50);
+    std::uniform_real_distribution<float> rad(0, 5);
+
+    mirinae::FrustumPlanes frustum;
+    frustum.set(::make_clip());
+
+    // Not a multiple of the batch width
+    constexpr size_t COUNT = 1023;
+    std::vector<mirinae::BoundingSphere> spheres;
+    mirinae::SphereBatch batch;
+    for (size_t i = 0; i < COUNT; ++i) {
+        const auto& s = spheres.emplace_back(
+            ::make_sphere(pos(rng), pos(rng), pos(rng), rad(rng))
+        );
+        batch.push_back(s);
+    }
+    ASSERT_EQ(batch.size(), COUNT);
+
+    std::vector<uint8_t> mask(COUNT, 2);
+    const auto half = batch.block_count() / 2;
+    batch.cull(frustum, 0, half, mask.data());
+    batch.cull(frustum, half, batch.block_count(), mask.data());
+
+    size_t visible = 0;
+    for (size_t i = 0; i < COUNT; ++i) {
+        EXPECT_EQ(mask[i], frustum.test(spheres[i]) ? 1 : 0) << i;
+        visible += mask[i];
+    }
+    EXPECT_GT(visible, 0);
+    EXPECT_LT(visible, COUNT);
+}
+
+
+TEST(Cull, BatchSwapRemove) {
+    mirinae::FrustumPlanes frustum;
+    frustum.set(::make_clip());
+
+    const auto inside = ::make_sphere(0, 0, 0, 0.1f);
+    const auto outside = ::make_sphere(-30, 0, 0, 1);
+
+    // Visible only at the odd indices
+    constexpr size_t COUNT = 9;
+    std::vector<mirinae::BoundingSphere> spheres;
+    mirinae::SphereBatch batch;
+    for (size_t i = 0; i < COUNT; ++i) {
+        spheres.push_back(i % 2 ? inside : outside);
+        batch.push_back(spheres.back());
+    }
+
+    // Down to one block and then to none, crossing block boundaries
+    const size_t removes[] = { 1, 0, 3, 0, 2, 1, 0, 0, 0 };
+    for (const auto i : removes) {
+        spheres[i] = spheres.back();
+        spheres.pop_back();
+        batch.swap_remove(i);
+        ASSERT_EQ(batch.size(), spheres.size());
+        ASSERT_EQ(batch.block_count(), (spheres.size() + 3) / 4);
+
+        std::vector<uint8_t> mask(batch.block_count() * 4, 2);
+        batch.cull(frustum, 0, batch.block_count(), mask.data());
+        for (size_t j = 0; j < spheres.size(); ++j)
+            EXPECT_EQ(mask[j], frustum.test(spheres[j]) ? 1 : 0) << j;
+    }
+
+    // Padding left behind must not leak into a new block
+    batch.push_back(outside);
+    std::vector<uint8_t> mask(4, 2);
+    batch.cull(frustum, 0, 1, mask.data());
+    EXPECT_EQ(mask[0], 0);
+}
@@ -0,0 +1,61 @@
+#include "mirinae/lightweight/free_list_alloc.hpp"
+
+#include <gtest/gtest.h>
+
+
+namespace {
+
+    TEST(FreeListAllocator, AllocatesUntilFull) {
+        mirinae::FreeListAllocator alloc(64);
+
+        EXPECT_EQ(alloc.alloc(16), 0);
+        EXPECT_EQ(alloc.alloc(32), 16);
+        EXPECT_EQ(alloc.used(), 48);
+        EXPECT_EQ(alloc.largest_free(), 16);
+
+        EXPECT_FALSE(alloc.alloc(17));
+        EXPECT_FALSE(alloc.alloc(0));
+        EXPECT_EQ(alloc.alloc(16), 48);
+        EXPECT_FALSE(alloc.alloc(1));
+    }
+
+    TEST(FreeListAllocator, PicksSmallestFit) {
+        mirinae::FreeListAllocator alloc(64);
+
+        ASSERT_EQ(alloc.alloc(8), 0);
+        ASSERT_EQ(alloc.alloc(8), 8);
+        ASSERT_EQ(alloc.alloc(4), 16);
+        ASSERT_EQ(alloc.alloc(8), 20);
+        alloc.free(0, 8);
+        alloc.free(16, 4);
+
+        // Holes of 8 at 0, 4 at 16, and 36 at the end
+        EXPECT_EQ(alloc.alloc(4), 16);
+        EXPECT_EQ(alloc.alloc(6), 0);
+        EXPECT_EQ(alloc.alloc(20), 28);
+    }
+
+    TEST(FreeListAllocator, MergesNeighbours) {
+        mirinae::FreeListAllocator alloc(64);
+
+        ASSERT_EQ(alloc.alloc(16), 0);
+        ASSERT_EQ(alloc.alloc(16), 16);
+        ASSERT_EQ(alloc.alloc(16), 32);
+        ASSERT_EQ(alloc.alloc(16), 48);
+
+        alloc.free(0, 16);
+        alloc.free(32, 16);
+        EXPECT_EQ(alloc.largest_free(), 16);
+
+        // Joins both sides into one range
+        alloc.free(16, 16);
+        EXPECT_EQ(alloc.largest_free(), 48);
+        EXPECT_EQ(alloc.alloc(48), 0);
+
+        alloc.free(0, 48);
+        alloc.free(48, 16);
+        EXPECT_EQ(alloc.used(), 0);
+        EXPECT_EQ(alloc.alloc(64), 0);
+    }
+
+}  // namespace
@@ -0,0 +1,174 @@
+#include "mirinae/lightweight/log_ring.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#ifndef _WIN32
+    #include <pthread.h>
+    #include <signal.h>
+#endif
+
+
+namespace {
+
+    TEST(LogRing, KeepsNewestRecords) {
+        mirinae::LogRing ring(6);
+        ASSERT_EQ(ring.capacity(), 8);
+
+        for (int i = 0; i < 20; ++i) ring.push(2, std::to_string(i));
+
+        std::vector<mirinae::LogRecord> out;
+        EXPECT_EQ(ring.snapshot(0, out), 20);
+        ASSERT_EQ(out.size(), 8);
+        for (size_t i = 0; i < out.size(); ++i) {
+            EXPECT_EQ(out[i].seq_, i + 12);
+            EXPECT_EQ(out[i].text(), std::to_string(i + 12));
+            EXPECT_EQ(out[i].level_, 2);
+        }
+
+        out.clear();
+        ring.push(2, "new");
+        EXPECT_EQ(ring.snapshot(20, out), 21);
+        ASSERT_EQ(out.size(), 1);
+        EXPECT_EQ(out[0].text(), "new");
+    }
+
+    TEST(LogRing, TruncatesLongText) {
+        mirinae::LogRing ring(4);
+        const std::string text(mirinae::LogRecord::MAX_TEXT + 10, 'a');
+        ring.push(0, text);
+
+        std::vector<mirinae::LogRecord> out;
+        ring.snapshot(0, out);
+        ASSERT_EQ(out.size(), 1);
+        EXPECT_EQ(out[0].text().size(), mirinae::LogRecord::MAX_TEXT);
+    }
+
+    TEST(LogRing, ConcurrentWritersAndReader) {
+        constexpr int THREADS = 4;
+        constexpr int PER_THREAD = 20000;
+        mirinae::LogRing ring(256);
+
+        std::vector<std::thread> writers;
+        for (int t = 0; t < THREADS; ++t) {
+            writers.emplace_back([&ring, t]() {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    const auto text = std::to_string(t) + ':' +
+                                      std::to_string(i);
+                    ring.push(static_cast<uint8_t>(t), text);
+                }
+            });
+        }
+
+        // Every record read must be intact and belong to its writer
+        std::vector<mirinae::LogRecord> out;
+        uint64_t cursor = 0;
+        size_t read = 0;
+        const auto check = [&]() {
+            out.clear();
+            cursor = ring.snapshot(cursor, out);
+            for (auto& r : out) {
+                const std::string text{ r.text() };
+                const auto writer = text.substr(0, text.find(':'));
+                ASSERT_EQ(writer, std::to_string(r.level_));
+            }
+            read += out.size();
+        };
+        for (int i = 0; i < 200; ++i) check();
+
+        for (auto& w : writers) w.join();
+        check();
+
+        EXPECT_EQ(cursor, THREADS * PER_THREAD);
+        EXPECT_GT(read, 0);
+    }
+
+#ifndef _WIN32
+    std::atomic<bool> g_hold = false;
+    std::atomic<bool> g_held = false;
+
+    void hold_writer(int) {
+        g_held = true;
+        while (g_hold.load()) {
+        }
+        g_held = false;
+    }
+
+    // Pauses the writer at arbitrary points, including after it claimed a
+    // sequence number but before writing the record, which the reader must
+    // wait for instead of skipping
+    TEST(LogRing, ReaderWaitsForPausedWriter) {
+        constexpr uint64_t COUNT = 50000;
+        mirinae::LogRing ring(COUNT);
+
+        struct sigaction action {};
+        action.sa_handler = ::hold_writer;
+        sigemptyset(&action.sa_mask);
+        struct sigaction old_action {};
+        ASSERT_EQ(sigaction(SIGUSR1, &action, &old_action), 0);
+
+        std::atomic<bool> done = false;
+        std::thread writer([&]() {
+            for (uint64_t i = 0; i < COUNT; ++i) ring.push(0, "line");
+            done = true;
+        });
+
+        std::vector<mirinae::LogRecord> out;
+        uint64_t cursor = 0;
+        uint64_t expected = 0;
+        const auto check = [&]() {
+            out.clear();
+            cursor = ring.snapshot(cursor, out);
+            for (auto& r : out) {
+                ASSERT_EQ(r.seq_, expected);
+                ++expected;
+            }
+        };
+
+        while (!done) {
+            g_hold = true;
+            pthread_kill(writer.native_handle(), SIGUSR1);
+            while (!g_held && !done) std::this_thread::yield();
+            check();
+            g_hold = false;
+            while (g_held) std::this_thread::yield();
+        }
+
+        writer.join();
+        check();
+        sigaction(SIGUSR1, &old_action, nullptr);
+
+        EXPECT_EQ(expected, COUNT);
+        EXPECT_EQ(ring.dropped(), 0);
+    }
+#endif
+
+    TEST(LogRing, FlushesToFile) {
+        const auto path = std::filesystem::temp_directory_path() /
+                          "mirinae_test_log_ring.txt";
+        std::filesystem::remove(path);
+
+        {
+            mirinae::LogRing ring(16);
+            ring.start_file_flush(path);
+            ring.push(2, "hello");
+            ring.push(4, "world");
+            ring.stop_file_flush();
+        }
+
+        std::ifstream file(path);
+        ASSERT_TRUE(file);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        EXPECT_EQ(ss.str(), "[info] hello\n[error] world\n");
+
+        file.close();
+        std::filesystem::remove(path);
+    }
+
+}  // namespace
@@ -0,0 +1,67 @@
+#include "mirinae/lightweight/mapped_file.hpp"
+
+#include <fstream>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+
+namespace {
+
+    namespace fs = std::filesystem;
+
+
+    class MappedFileTest : public ::testing::Test {
+
+    protected:
+        void SetUp() override {
+            root_ = fs::temp_directory_path() / "mirinae_test_mapped_file";
+            fs::remove_all(root_);
+            fs::create_directories(root_ / "models");
+
+            std::ofstream file(root_ / "models" / "a.bin", std::ios::binary);
+            file << CONTENT;
+        }
+
+        void TearDown() override { fs::remove_all(root_); }
+
+        static std::string_view view(const uint8_t* data, size_t size) {
+            return { reinterpret_cast<const char*>(data), size };
+        }
+
+        constexpr static std::string_view CONTENT = "mapped contents";
+        fs::path root_;
+    };
+
+
+    TEST_F(MappedFileTest, MapsWholeFile) {
+        mirinae::MappedFile file;
+        ASSERT_TRUE(file.open(root_ / "models" / "a.bin"));
+        EXPECT_EQ(view(file.data(), file.size()), CONTENT);
+
+        auto moved = std::move(file);
+        EXPECT_FALSE(file.is_open());
+        EXPECT_EQ(view(moved.data(), moved.size()), CONTENT);
+
+        moved.close();
+        EXPECT_FALSE(moved.is_open());
+        EXPECT_FALSE(moved.open(root_ / "missing.bin"));
+    }
+
+    TEST_F(MappedFileTest, MapperResolvesRoots) {
+        mirinae::FileMapper mapper;
+        mapper.add_root(":asset", root_);
+        mapper.add_root("", root_ / "models");
+
+        mirinae::MappedFile file;
+        ASSERT_TRUE(mapper.map(":asset/models/a.bin", file));
+        EXPECT_EQ(view(file.data(), file.size()), CONTENT);
+
+        ASSERT_TRUE(mapper.map("a.bin", file));
+        EXPECT_EQ(view(file.data(), file.size()), CONTENT);
+
+        EXPECT_FALSE(mapper.map(":other/models/a.bin", file));
+        EXPECT_FALSE(mapper.map(":asset/a.bin", file));
+    }
+
+}  // namespace
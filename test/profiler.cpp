@@ -0,0 +1,109 @@
+#include "mirinae/lightweight/profiler.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+
+namespace {
+
+    const mirinae::ProfZoneStats* find_zone(
+        const std::vector<mirinae::ProfZoneStats>& stats, std::string_view name
+    ) {
+        for (auto& s : stats) {
+            if (s.name_ == name)
+                return &s;
+        }
+        return nullptr;
+    }
+
+
+    TEST(Profiler, StatsAcrossThreads) {
+        mirinae::Profiler profiler;
+        const auto t0 = mirinae::prof_clock_t::now();
+        const auto t1 = t0 + std::chrono::milliseconds(2);
+
+        for (int i = 0; i < 4; ++i) {
+            std::thread worker([&]() {
+                profiler.record("worker", t0, t1);
+                profiler.record("worker", t0, t1);
+            });
+            worker.join();
+            profiler.record("main", t0, t1);
+            profiler.new_frame();
+        }
+
+        const auto stats = profiler.stats();
+        const auto worker = ::find_zone(stats, "worker");
+        const auto main = ::find_zone(stats, "main");
+        ASSERT_NE(worker, nullptr);
+        ASSERT_NE(main, nullptr);
+        EXPECT_NEAR(worker->avg_ms_, 4, 0.01);
+        EXPECT_NEAR(worker->avg_calls_, 2, 0.01);
+        EXPECT_NEAR(main->max_ms_, 2, 0.01);
+    }
+
+    TEST(Profiler, DisabledRecordsNothing) {
+        mirinae::Profiler profiler;
+        profiler.set_enabled(false);
+
+        const auto t = mirinae::prof_clock_t::now();
+        profiler.record("zone", t, t);
+        profiler.new_frame();
+
+        EXPECT_EQ(::find_zone(profiler.stats(), "zone"), nullptr);
+    }
+
+    TEST(Profiler, InternedNameOutlivesSource) {
+        mirinae::Profiler profiler;
+
+        std::string_view name;
+        {
+            std::string source = "stage";
+            source += " 1";
+            name = profiler.intern(source);
+            EXPECT_EQ(name.data(), profiler.intern("stage 1").data());
+        }
+
+        const auto t = mirinae::prof_clock_t::now();
+        profiler.record(name, t, t);
+        profiler.new_frame();
+
+        EXPECT_NE(::find_zone(profiler.stats(), "stage 1"), nullptr);
+    }
+
+    TEST(Profiler, CaptureWritesTrace) {
+        const auto path = std::filesystem::temp_directory_path() /
+                          "mirinae_test_profiler.json";
+        std::filesystem::remove(path);
+
+        mirinae::Profiler profiler;
+        profiler.capture(2, path);
+
+        const auto t = mirinae::prof_clock_t::now();
+        profiler.record("stage \"a\"", t, t, "stages");
+        profiler.new_frame();
+        EXPECT_TRUE(profiler.is_capturing());
+        profiler.new_frame();
+        EXPECT_FALSE(profiler.is_capturing());
+
+        std::ifstream file(path);
+        ASSERT_TRUE(file);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        const auto content = ss.str();
+
+        const auto contains = [&](std::string_view str) {
+            return content.find(str) != std::string::npos;
+        };
+        EXPECT_EQ(content.rfind("{\"traceEvents\":[", 0), 0);
+        EXPECT_TRUE(contains("\"name\":\"stage \\\"a\\\"\""));
+        EXPECT_TRUE(contains("\"args\":{\"name\":\"stages\"}"));
+
+        file.close();
+        std::filesystem::remove(path);
+    }
+
+}  // namespace
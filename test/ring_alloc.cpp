@@ -0,0 +1,54 @@
+#include "mirinae/lightweight/ring_alloc.hpp"
+
+#include <gtest/gtest.h>
+
+
+namespace {
+
+    TEST(RingAllocator, AllocatesInOrder) {
+        mirinae::RingAllocator ring(64);
+
+        EXPECT_EQ(ring.alloc(10, 4), 0);
+        EXPECT_EQ(ring.alloc(10, 4), 12);
+        EXPECT_EQ(ring.alloc(8, 16), 32);
+        EXPECT_EQ(ring.used(), 40);
+
+        // Does not fit before the end and the start is still in use
+        EXPECT_FALSE(ring.alloc(30, 4));
+        EXPECT_EQ(ring.alloc(24, 4), 40);
+        EXPECT_FALSE(ring.alloc(1, 1));
+        EXPECT_FALSE(ring.alloc(65, 1));
+    }
+
+    TEST(RingAllocator, WrapsAfterRelease) {
+        mirinae::RingAllocator ring(64);
+
+        ASSERT_EQ(ring.alloc(40, 4), 0);
+        const auto first = ring.head();
+        ASSERT_EQ(ring.alloc(16, 4), 40);
+
+        // The range may not straddle the end of the buffer
+        EXPECT_FALSE(ring.alloc(16, 4));
+        ring.release(first);
+        EXPECT_EQ(ring.alloc(16, 4), 0);
+        EXPECT_EQ(ring.alloc(24, 4), 16);
+        EXPECT_FALSE(ring.alloc(1, 1));
+    }
+
+    TEST(RingAllocator, RestartsWhenEmpty) {
+        mirinae::RingAllocator ring(64);
+
+        ASSERT_EQ(ring.alloc(48, 4), 0);
+        ring.release(ring.head());
+        EXPECT_EQ(ring.used(), 0);
+
+        // Would not fit after offset 48, but nothing else is in use
+        EXPECT_EQ(ring.alloc(64, 4), 0);
+        EXPECT_EQ(ring.used(), 64);
+
+        // Stale positions are ignored
+        ring.release(0);
+        EXPECT_EQ(ring.used(), 64);
+    }
+
+}  // namespace
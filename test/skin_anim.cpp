@@ -0,0 +1,186 @@
+#include "mirinae/lightweight/skin_anim.hpp"
+
+#include <random>
+
+#include <gtest/gtest.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+
+namespace {
+
+    mirinae::SkelAnimPair make_skel_anim(
+        size_t joint_count, size_t key_count, uint32_t seed
+    ) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> dist(-1, 1);
+        const auto rand_vec = [&]() {
+            return glm::vec3{ dist(rng), dist(rng), dist(rng) };
+        };
+        const auto rand_quat = [&]() {
+            return glm::normalize(
+                glm::quat{ dist(rng), dist(rng), dist(rng), dist(rng) }
+            );
+        };
+
+        mirinae::SkelAnimPair out;
+        out.skel_.root_transform_ = glm::translate(
+            glm::mat4{ 1 }, rand_vec()
+        );
+
+        // Stored in reverse so children come before their parents
+        for (size_t i = 0; i < joint_count; i++) {
+            auto& joint = out.skel_.joints_.emplace_back();
+            joint.name_ = "joint" + std::to_string(i);
+            joint.parent_index_ = static_cast<dal::jointID_t>(i + 1);
+            joint.offset_mat_ = glm::translate(glm::mat4{ 1 }, rand_vec()) *
+                                glm::mat4_cast(rand_quat());
+        }
+        out.skel_.joints_.back().parent_index_ = -1;
+
+        auto& anim = out.anims_.emplace_back();
+        anim.name_ = "anim";
+        anim.ticks_per_sec_ = 30;
+        for (size_t i = 0; i < joint_count; i += 2) {
+            auto& joint = anim.joints_.emplace_back();
+            joint.name_ = "joint" + std::to_string(i);
+            for (size_t k = 0; k < key_count; k++) {
+                const auto t = static_cast<float>(k);
+                joint.translations_.emplace_back(t, rand_vec());
+                joint.rotations_.emplace_back(t * 1.5f, rand_quat());
+                joint.scales_.emplace_back(t * 0.5f, 1 + 0.1f * dist(rng));
+            }
+        }
+
+        out.compile();
+        return out;
+    }
+
+
+    TEST(SkinAnim, CompiledMatchesReference) {
+        auto skel_anim = ::make_skel_anim(32, 64, 1);
+        ASSERT_TRUE(skel_anim.is_compiled());
+
+        const auto& skel = skel_anim.skel_;
+        const auto& anim = skel_anim.anims_.front();
+        std::vector<glm::mat4> palette(skel.joints_.size());
+        mirinae::AnimCursor cursor;
+
+        // Forward playback, then seeks and loops back to the start
+        const double ticks[] = { 0,  0.25, 0.5,  1.75, 2.0,  17.3, 63.0,
+                                 95, 96.0, 3.1,  0.0,  40.4, 40.5, -1.0 };
+        for (const auto tick : ticks) {
+            const auto expected = mirinae::make_skinning_matrix(
+                tick, skel, anim
+            );
+            ASSERT_TRUE(skel_anim.make_skinning_matrix(
+                tick, 0, cursor, palette.data(), palette.size()
+            ));
+
+            for (size_t i = 0; i < palette.size(); i++) {
+                for (int c = 0; c < 4; c++) {
+                    for (int r = 0; r < 4; r++) {
+                        EXPECT_NEAR(expected[i][c][r], palette[i][c][r], 1e-4)
+                            << "tick " << tick << ", joint " << i;
+                    }
+                }
+            }
+        }
+    }
+
+    TEST(SkinAnim, RejectsSmallBuffer) {
+        auto skel_anim = ::make_skel_anim(8, 4, 2);
+        std::vector<glm::mat4> palette(4);
+        mirinae::AnimCursor cursor;
+        EXPECT_FALSE(skel_anim.make_skinning_matrix(
+            0, 0, cursor, palette.data(), palette.size()
+        ));
+        EXPECT_FALSE(skel_anim.make_skinning_matrix(
+            0, 1, cursor, palette.data(), palette.size()
+        ));
+    }
+
+    TEST(SkinAnim, BlendWithJointMask) {
+        auto skel_anim = ::make_skel_anim(32, 16, 3);
+        auto& second = skel_anim.anims_.emplace_back(skel_anim.anims_[0]);
+        second.name_ = "second";
+        for (auto& joint : second.joints_) {
+            for (auto& key : joint.translations_)
+                key.second += glm::vec3{ 2, 0, 0 };
+        }
+        skel_anim.compile();
+
+        // Joints are stored leaf first, so joint10 owns joint0 to joint9.
+        // Only even joints are animated.
+        mirinae::AnimJointMask mask;
+        ASSERT_TRUE(skel_anim.make_joint_mask("joint10", mask));
+
+        mirinae::AnimBlendInput inputs[2];
+        inputs[0].anim_idx_ = 0;
+        inputs[0].tick_ = 5.5;
+        inputs[1].anim_idx_ = 1;
+        inputs[1].tick_ = 5.5;
+        inputs[1].mask_ = &mask;
+
+        mirinae::AnimBlender blender;
+        const auto pose = blender.blend(skel_anim, inputs, 2);
+        ASSERT_NE(nullptr, pose);
+
+        mirinae::AnimCursor cursor;
+        mirinae::AnimPose base;
+        ASSERT_TRUE(skel_anim.sample_pose(5.5, 0, cursor, base));
+
+        for (size_t i = 0; i < skel_anim.joint_count(); i++) {
+            const auto offset = (i <= 10 && i % 2 == 0) ? 1.f : 0.f;
+            EXPECT_NEAR(base.tx_[i] + offset, pose->tx_[i], 1e-5);
+            EXPECT_NEAR(base.ty_[i], pose->ty_[i], 1e-5);
+            EXPECT_NEAR(base.rw_[i], pose->rw_[i], 1e-5);
+        }
+    }
+
+    TEST(SkinAnim, BlendSkipsZeroWeightInput) {
+        auto skel_anim = ::make_skel_anim(16, 16, 4);
+        auto& second = skel_anim.anims_.emplace_back(skel_anim.anims_[0]);
+        second.name_ = "second";
+        for (auto& joint : second.joints_) {
+            for (auto& key : joint.translations_)
+                key.second += glm::vec3{ 2, 0, 0 };
+        }
+        skel_anim.compile();
+
+        mirinae::AnimJointMask zero_mask;
+        zero_mask.resize(skel_anim.joint_count(), 0);
+        mirinae::AnimJointMask mask;
+        ASSERT_TRUE(skel_anim.make_joint_mask("joint10", mask));
+
+        // The first input has no weight anywhere, so it must not show up
+        // even on joints no other input covers
+        mirinae::AnimBlendInput inputs[2];
+        inputs[0].anim_idx_ = 1;
+        inputs[0].tick_ = 3.5;
+        inputs[0].mask_ = &zero_mask;
+        inputs[1].anim_idx_ = 0;
+        inputs[1].tick_ = 3.5;
+        inputs[1].mask_ = &mask;
+
+        mirinae::AnimBlender blender;
+        const auto pose = blender.blend(skel_anim, inputs, 2);
+        ASSERT_NE(nullptr, pose);
+
+        mirinae::AnimCursor cursor;
+        mirinae::AnimPose base;
+        ASSERT_TRUE(skel_anim.sample_pose(3.5, 0, cursor, base));
+
+        for (size_t i = 0; i < skel_anim.joint_count(); i++) {
+            EXPECT_NEAR(base.tx_[i], pose->tx_[i], 1e-5);
+            EXPECT_NEAR(base.rw_[i], pose->rw_[i], 1e-5);
+        }
+    }
+
+}  // namespace
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
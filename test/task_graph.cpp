@@ -0,0 +1,195 @@
+#include "mirinae/lightweight/task.hpp"
+
+#include <atomic>
+#include <string>
+
+#include <gtest/gtest.h>
+
+
+namespace {
+
+    class Trace {
+
+    public:
+        void push(std::string_view name) {
+            const auto i = count_.fetch_add(1);
+            names_[i] = name;
+        }
+
+        size_t index_of(std::string_view name) const {
+            for (size_t i = 0; i < count_; ++i) {
+                if (names_[i] == name)
+                    return i;
+            }
+            return -1;
+        }
+
+        size_t size() const { return count_; }
+
+    private:
+        std::string names_[16];
+        std::atomic_size_t count_ = 0;
+    };
+
+
+    class TestStage : public mirinae::StageTask {
+
+    public:
+        TestStage(std::string_view name, Trace& trace)
+            : StageTask(name), trace_(trace) {
+            fence_.succeed(this);
+        }
+
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
+            trace_.push(this->name());
+        }
+
+        enki::ITaskSet* get_fence() override { return &fence_; }
+
+    private:
+        Trace& trace_;
+        mirinae::FenceTask fence_;
+    };
+
+
+    class TestTask : public mirinae::DependingTask {
+
+    public:
+        TestTask(std::string_view name, Trace& trace)
+            : name_(name), trace_(trace) {}
+
+        void ExecuteRange(enki::TaskSetPartition range, uint32_t tid) override {
+            trace_.push(name_);
+        }
+
+    private:
+        std::string name_;
+        Trace& trace_;
+    };
+
+
+    class LinkedStage : public mirinae::StageTask {
+
+    public:
+        LinkedStage(Trace& trace)
+            : StageTask("linked")
+            , first_("first", trace)
+            , second_("second", trace) {
+            linker_.add("first", first_, {}, { "x" });
+            linker_.add("second", second_, { "x" }, {});
+            linker_.link(*this, fence_);
+        }
+
+        void ExecuteRange(
+            enki::TaskSetPartition range, uint32_t tid
+        ) override {}
+
+        enki::ITaskSet* get_fence() override { return &fence_; }
+
+    private:
+        TestTask first_;
+        TestTask second_;
+        mirinae::TaskLinker linker_;
+        mirinae::FenceTask fence_;
+    };
+
+
+    TEST(TaskGraph, WritersRunBeforeReaders) {
+        for (const auto pipelined : { false, true }) {
+            Trace trace;
+            mirinae::TaskGraph graph;
+            graph.set_pipelined(pipelined);
+            graph.emplace_back<TestStage>("reader", trace)->reads("x");
+            graph.emplace_back<TestStage>("writer b", trace)->writes("x");
+            graph.emplace_back<TestStage>("writer a", trace)
+                ->reads_last_frame("y")
+                .writes("x");
+            graph.emplace_back<TestStage>("y", trace)->writes("y");
+
+            graph.start();
+            graph.wait_all();
+
+            ASSERT_EQ(4, trace.size());
+            EXPECT_LT(trace.index_of("writer b"), trace.index_of("writer a"));
+            EXPECT_LT(trace.index_of("writer a"), trace.index_of("reader"));
+            EXPECT_LT(trace.index_of("writer a"), trace.index_of("y"));
+        }
+    }
+
+    TEST(TaskGraph, AfterSyncStagesWaitForTheirStart) {
+        for (const auto pipelined : { false, true }) {
+            Trace trace;
+            mirinae::TaskGraph graph;
+            graph.set_pipelined(pipelined);
+            graph.emplace_back<TestStage>("render", trace)
+                ->after_sync()
+                .reads_buffered("state")
+                .writes("render");
+            graph.emplace_back<TestStage>("sim", trace)->writes("state");
+
+            graph.start();
+            graph.wait_all();
+            ASSERT_EQ(1, trace.size());
+            EXPECT_EQ(0, trace.index_of("sim"));
+
+            graph.start_after_sync();
+            graph.start();
+            graph.wait_all();
+            ASSERT_EQ(3, trace.size());
+            EXPECT_EQ(1, trace.index_of("render"));
+        }
+    }
+
+    TEST(TaskGraph, RejectsCycles) {
+        Trace trace;
+        mirinae::TaskGraph graph;
+        graph.emplace_back<TestStage>("a", trace)->reads("x").writes("y");
+        graph.emplace_back<TestStage>("b", trace)->reads("y").writes("x");
+        // The message goes to the logger, not to stderr
+        EXPECT_DEATH(graph.start(), "");
+    }
+
+    TEST(TaskLinker, LinksByResources) {
+        Trace trace;
+        TestTask start("start", trace);
+        TestTask consume("consume", trace);
+        TestTask produce("produce", trace);
+        TestTask other("other", trace);
+        mirinae::FenceTask fence;
+
+        mirinae::TaskLinker linker;
+        linker.add("consume", consume, { "x" }, {});
+        linker.add("produce", produce, {}, { "x" });
+        linker.add("other", other, {}, { "y" });
+        linker.link(start, fence);
+
+        dal::tasker().AddTaskSetToPipe(&start);
+        dal::tasker().WaitforTask(&fence);
+
+        ASSERT_EQ(4, trace.size());
+        EXPECT_EQ(0, trace.index_of("start"));
+        EXPECT_LT(trace.index_of("produce"), trace.index_of("consume"));
+    }
+
+    TEST(TaskGraph, TimingsIncludeLinkedTasks) {
+        Trace trace;
+        mirinae::TaskGraph graph;
+        graph.emplace_back<LinkedStage>(trace);
+        graph.start();
+        graph.wait_all();
+
+        const auto timings = graph.timings();
+        ASSERT_EQ(3, timings.size());
+        EXPECT_EQ("linked", timings[0].name_);
+        EXPECT_EQ("linked / first", timings[1].name_);
+        EXPECT_EQ("linked / second", timings[2].name_);
+        EXPECT_LE(timings[1].end_, timings[2].begin_);
+    }
+
+}  // namespace
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,409 @@
+#include "mirinae/vulkan/base/render/upload.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mirinae/vulkan/base/render/cmdbuf.hpp"
+#include "mirinae/vulkan/base/render/mem_cinfo.hpp"
+#include "mirinae/vulkan/base/render/vkmajorplayers.hpp"
+
+
+namespace {
+
+    // Any device with a graphics queue, such as lavapipe. Tests are skipped
+    // if there is no Vulkan driver at all.
+    class HeadlessDevice {
+
+    public:
+        ~HeadlessDevice() { this->destroy(); }
+
+        bool init() {
+            VkApplicationInfo app_info{};
+            app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+            app_info.apiVersion = VK_API_VERSION_1_1;
+
+            VkInstanceCreateInfo inst_cinfo{};
+            inst_cinfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+            inst_cinfo.pApplicationInfo = &app_info;
+            if (VK_SUCCESS != vkCreateInstance(&inst_cinfo, nullptr, &inst_))
+                return false;
+
+            uint32_t count = 0;
+            vkEnumeratePhysicalDevices(inst_, &count, nullptr);
+            std::vector<VkPhysicalDevice> phys_devices(count);
+            vkEnumeratePhysicalDevices(inst_, &count, phys_devices.data());
+            for (auto phys_device : phys_devices) {
+                if (this->select(phys_device))
+                    break;
+            }
+            if (VK_NULL_HANDLE == phys_)
+                return false;
+
+            const float priority = 1;
+            std::vector<VkDeviceQueueCreateInfo> queue_cinfos;
+            for (auto family : { gfx_family_, xfer_family_ }) {
+                if (family == NONE)
+                    continue;
+                auto& q = queue_cinfos.emplace_back();
+                q.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+                q.queueFamilyIndex = family;
+                q.queueCount = 1;
+                q.pQueuePriorities = &priority;
+            }
+
+            VkDeviceCreateInfo dev_cinfo{};
+            dev_cinfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+            dev_cinfo.queueCreateInfoCount = static_cast<uint32_t>(
+                queue_cinfos.size()
+            );
+            dev_cinfo.pQueueCreateInfos = queue_cinfos.data();
+            if (VK_SUCCESS != vkCreateDevice(phys_, &dev_cinfo, nullptr, &dev_))
+                return false;
+
+            vkGetDeviceQueue(dev_, gfx_family_, 0, &gfx_q_);
+            if (xfer_family_ != NONE)
+                vkGetDeviceQueue(dev_, xfer_family_, 0, &xfer_q_);
+
+            alloc_ = mirinae::create_vma_allocator(inst_, phys_, dev_);
+            pool_.init(gfx_family_, dev_);
+            return true;
+        }
+
+        void destroy() {
+            if (VK_NULL_HANDLE != dev_) {
+                vkDeviceWaitIdle(dev_);
+                pool_.destroy(dev_);
+                if (alloc_)
+                    mirinae::destroy_vma_allocator(alloc_);
+                vkDestroyDevice(dev_, nullptr);
+            }
+            if (VK_NULL_HANDLE != inst_)
+                vkDestroyInstance(inst_, nullptr);
+
+            alloc_ = nullptr;
+            dev_ = VK_NULL_HANDLE;
+            inst_ = VK_NULL_HANDLE;
+        }
+
+        bool has_transfer_queue() const { return xfer_family_ != NONE; }
+
+        std::unique_ptr<mirinae::UploadService> make_uploader(bool transfer) {
+            std::optional<mirinae::UploadQueue> xfer;
+            if (transfer)
+                xfer = mirinae::UploadQueue{ xfer_q_, xfer_family_ };
+
+            return std::make_unique<mirinae::UploadService>(
+                dev_,
+                alloc_,
+                mirinae::UploadQueue{ gfx_q_, gfx_family_ },
+                xfer,
+                limits_.optimalBufferCopyOffsetAlignment
+            );
+        }
+
+        // Records with `func` and waits for the graphics queue
+        template <typename TFunc>
+        void run(TFunc&& func) {
+            const auto cmdbuf = pool_.begin_single_time(dev_);
+            func(cmdbuf);
+            pool_.end_single_time(cmdbuf, gfx_q_, dev_);
+        }
+
+        mirinae::Buffer make_readback(VkDeviceSize size) {
+            mirinae::BufferCreateInfo cinfo;
+            cinfo.set_size(size)
+                .add_usage(VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+                .prefer_host();
+            cinfo.alloc_info_.flags |=
+                VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+
+            mirinae::Buffer out;
+            out.init(cinfo, alloc_);
+            return out;
+        }
+
+        VkDevice dev_ = VK_NULL_HANDLE;
+        mirinae::VulkanMemoryAllocator alloc_ = nullptr;
+
+    private:
+        static constexpr uint32_t NONE = ~uint32_t(0);
+
+        bool select(VkPhysicalDevice phys_device) {
+            uint32_t count = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(
+                phys_device, &count, nullptr
+            );
+            std::vector<VkQueueFamilyProperties> families(count);
+            vkGetPhysicalDeviceQueueFamilyProperties(
+                phys_device, &count, families.data()
+            );
+
+            gfx_family_ = NONE;
+            xfer_family_ = NONE;
+            for (uint32_t i = 0; i < count; ++i) {
+                const auto flags = families[i].queueFlags;
+                if (flags & VK_QUEUE_GRAPHICS_BIT) {
+                    if (gfx_family_ == NONE)
+                        gfx_family_ = i;
+                } else if (flags & VK_QUEUE_TRANSFER_BIT) {
+                    if (xfer_family_ == NONE)
+                        xfer_family_ = i;
+                }
+            }
+            if (gfx_family_ == NONE)
+                return false;
+
+            VkPhysicalDeviceProperties props;
+            vkGetPhysicalDeviceProperties(phys_device, &props);
+            limits_ = props.limits;
+            phys_ = phys_device;
+            return true;
+        }
+
+        VkInstance inst_ = VK_NULL_HANDLE;
+        VkPhysicalDevice phys_ = VK_NULL_HANDLE;
+        VkPhysicalDeviceLimits limits_{};
+        uint32_t gfx_family_ = NONE;
+        uint32_t xfer_family_ = NONE;
+        VkQueue gfx_q_ = VK_NULL_HANDLE;
+        VkQueue xfer_q_ = VK_NULL_HANDLE;
+        mirinae::CommandPool pool_;
+    };
+
+
+    // Makes every earlier device write visible to the transfer stage
+    void record_mem_barrier(VkCommandBuffer cmdbuf) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(
+            cmdbuf,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            1,
+            &barrier,
+            0,
+            nullptr,
+            0,
+            nullptr
+        );
+    }
+
+    // Makes copies into the readback buffer visible to the host
+    void record_host_barrier(VkCommandBuffer cmdbuf) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(
+            cmdbuf,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT,
+            0,
+            1,
+            &barrier,
+            0,
+            nullptr,
+            0,
+            nullptr
+        );
+    }
+
+
+    // Parameter is whether to use a dedicated transfer queue
+    class UploadTest : public ::testing::TestWithParam<bool> {
+
+    protected:
+        void SetUp() override {
+            if (!dev_.init())
+                GTEST_SKIP() << "No Vulkan device";
+            if (GetParam() && !dev_.has_transfer_queue())
+                GTEST_SKIP() << "No dedicated transfer queue";
+            uploader_ = dev_.make_uploader(GetParam());
+        }
+
+        void TearDown() override { uploader_.reset(); }
+
+        std::vector<uint8_t> read_buffer(VkBuffer src, VkDeviceSize size) {
+            auto readback = dev_.make_readback(size);
+            dev_.run([&](VkCommandBuffer cmdbuf) {
+                ::record_mem_barrier(cmdbuf);
+                VkBufferCopy region{};
+                region.size = size;
+                vkCmdCopyBuffer(cmdbuf, src, readback.buffer(), 1, &region);
+                ::record_host_barrier(cmdbuf);
+            });
+
+            std::vector<uint8_t> out(size);
+            const auto mapped = readback.map();
+            readback.invalidate();
+            std::memcpy(out.data(), mapped, size);
+            readback.destroy();
+            return out;
+        }
+
+        mirinae::Buffer make_dst_buffer(VkDeviceSize size) {
+            mirinae::BufferCreateInfo cinfo;
+            cinfo.preset_vertices(size)
+                .add_usage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+                .prefer_device();
+
+            mirinae::Buffer out;
+            out.init(cinfo, dev_.alloc_);
+            return out;
+        }
+
+        HeadlessDevice dev_;
+        std::unique_ptr<mirinae::UploadService> uploader_;
+    };
+
+
+    TEST_P(UploadTest, Buffer) {
+        std::vector<uint8_t> data(1000);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<uint8_t>(i * 7);
+
+        auto dst = this->make_dst_buffer(1024);
+        const auto ticket = uploader_->upload_buffer(
+            dst.buffer(), 24, data.data(), data.size()
+        );
+        EXPECT_FALSE(uploader_->is_done(ticket));
+        uploader_->tick();
+        uploader_->wait(ticket);
+        EXPECT_TRUE(uploader_->is_done(ticket));
+
+        const auto read = this->read_buffer(dst.buffer(), 1024);
+        EXPECT_EQ(0, std::memcmp(read.data() + 24, data.data(), data.size()));
+        dst.destroy();
+    }
+
+    // Each chunk takes over a quarter of the ring, so staging has to wait
+    // for earlier batches to retire and then wrap around
+    TEST_P(UploadTest, BufferOverflowsRing) {
+        constexpr size_t CHUNK = 9 * 1024 * 1024;
+        constexpr size_t COUNT = 8;
+
+        auto dst = this->make_dst_buffer(CHUNK * COUNT);
+        std::vector<uint8_t> data(CHUNK);
+        std::vector<mirinae::UploadTicket> tickets;
+        for (size_t i = 0; i < COUNT; ++i) {
+            std::fill(data.begin(), data.end(), static_cast<uint8_t>(i + 1));
+            tickets.push_back(uploader_->upload_buffer(
+                dst.buffer(), i * CHUNK, data.data(), data.size()
+            ));
+        }
+
+        EXPECT_TRUE(std::is_sorted(tickets.begin(), tickets.end()));
+        EXPECT_LT(tickets.front(), tickets.back());
+        // Made room by retiring the oldest batches
+        EXPECT_TRUE(uploader_->is_done(tickets.front()));
+
+        uploader_->wait_all();
+        for (auto t : tickets) EXPECT_TRUE(uploader_->is_done(t));
+
+        const auto read = this->read_buffer(dst.buffer(), CHUNK * COUNT);
+        for (size_t i = 0; i < COUNT; ++i) {
+            const auto begin = read.begin() + i * CHUNK;
+            const auto expected = static_cast<uint8_t>(i + 1);
+            EXPECT_TRUE(std::all_of(begin, begin + CHUNK, [&](uint8_t v) {
+                return v == expected;
+            })) << "chunk " << i;
+        }
+        dst.destroy();
+    }
+
+    TEST_P(UploadTest, ImageMipChain) {
+        constexpr uint32_t SIZE = 8;
+        constexpr uint32_t MIPS = 4;
+        constexpr uint8_t COLOR[4] = { 10, 20, 30, 255 };
+
+        std::vector<uint8_t> texels(SIZE * SIZE * 4);
+        for (size_t i = 0; i < texels.size(); ++i) texels[i] = COLOR[i % 4];
+
+        mirinae::ImageCreateInfo cinfo;
+        cinfo.set_dimensions(SIZE)
+            .set_format(VK_FORMAT_R8G8B8A8_UNORM)
+            .set_mip_levels(MIPS)
+            .add_usage(VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+            .add_usage(VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+            .add_usage_sampled();
+        mirinae::Image img;
+        img.init(cinfo.get(), dev_.alloc_);
+
+        const auto ticket = uploader_->upload_image(
+            img.image(), SIZE, SIZE, MIPS, texels.data(), texels.size()
+        );
+        uploader_->tick();
+        uploader_->wait(ticket);
+        ASSERT_TRUE(uploader_->is_done(ticket));
+
+        // Mips are packed one after another in the readback buffer
+        std::vector<VkBufferImageCopy> regions;
+        VkDeviceSize total = 0;
+        for (uint32_t i = 0; i < MIPS; ++i) {
+            const auto len = std::max(SIZE >> i, 1u);
+            auto& region = regions.emplace_back();
+            region.bufferOffset = total;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = i;
+            region.imageSubresource.layerCount = 1;
+            region.imageExtent = { len, len, 1 };
+            total += len * len * 4;
+        }
+
+        auto readback = dev_.make_readback(total);
+        dev_.run([&](VkCommandBuffer cmdbuf) {
+            mirinae::ImageMemoryBarrier barrier;
+            barrier.image(img.image())
+                .set_aspect_mask(VK_IMAGE_ASPECT_COLOR_BIT)
+                .mip_base(0)
+                .mip_count(MIPS)
+                .layer_base(0)
+                .layer_count(1)
+                .set_src_access(VK_ACCESS_MEMORY_WRITE_BIT)
+                .set_dst_access(VK_ACCESS_TRANSFER_READ_BIT)
+                .old_layout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+                .new_layout(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+            barrier.record_single(
+                cmdbuf,
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT
+            );
+
+            vkCmdCopyImageToBuffer(
+                cmdbuf,
+                img.image(),
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                readback.buffer(),
+                static_cast<uint32_t>(regions.size()),
+                regions.data()
+            );
+            ::record_host_barrier(cmdbuf);
+        });
+
+        const auto mapped = static_cast<const uint8_t*>(readback.map());
+        readback.invalidate();
+        // A uniform image has the same color in every mip
+        for (VkDeviceSize i = 0; i < total; ++i) {
+            ASSERT_EQ(mapped[i], COLOR[i % 4]) << "byte " << i;
+        }
+
+        readback.destroy();
+        img.destroy(dev_.alloc_);
+    }
+
+    INSTANTIATE_TEST_SUITE_P(
+        Queues,
+        UploadTest,
+        ::testing::Bool(),
+        [](const ::testing::TestParamInfo<bool>& info) {
+            return info.param ? "Transfer" : "Graphics";
+        }
+    );
+
+}  // namespace